@@ -287,6 +287,8 @@ struct array_strings {
 
 extern void clear_attr(attribute *pattr, attribute_def *pdef);
 extern int  find_attr  (attribute_def *attrdef, char *name, int limit);
+extern unsigned int attr_name_hash(char *name);
+extern int  build_attr_index(attribute_def *attrdef, int limit);
 extern int  recov_attr_fs(int fd, void *parent, attribute_def *padef,
 	attribute *pattr, int limit, int unknown);
 extern void free_null  (attribute *attr);
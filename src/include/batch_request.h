@@ -207,6 +207,14 @@ struct rq_status {
 	pbs_list_head rq_attr;
 };
 
+/* Status events, the state change journal */
+
+struct rq_statevents {
+	unsigned long long rq_seq;	/* first sequence number wanted */
+	unsigned long long rq_epoch;	/* journal epoch of rq_seq, 0 if none */
+	int	rq_wait;	/* seconds to wait for one, 0 for none */
+};
+
 /* Select Job  and selstat */
 
 struct rq_selstat {
@@ -355,6 +363,7 @@ struct batch_request {
 		int			rq_shutdown;
 		struct rq_signal	rq_signal;
 		struct rq_status        rq_status;
+		struct rq_statevents	rq_statevents;
 		struct rq_track		rq_track;
 		struct rq_cpyfile	rq_cpyfile;
 		struct rq_cpyfile_cred	rq_cpyfile_cred;
@@ -408,6 +417,7 @@ extern void  req_selectjobs(struct batch_request *req);
 extern void  req_stat_que(struct batch_request *req);
 extern void  req_stat_svr(struct batch_request *req);
 extern void  req_stat_sched(struct batch_request *req);
+extern void  req_stat_events(struct batch_request *req);
 extern void  req_trackjob(struct batch_request *req);
 extern void  req_stat_rsc(struct batch_request *req);
 #else
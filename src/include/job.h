@@ -378,8 +378,24 @@ typedef struct	noderes {
 	long		nr_cput;	/* cpu time */
 	long		nr_mem;		/* memory */
 	long		nr_cpupercent;  /* cpu percent */
+	int		nr_flags;	/* poll tree state, see below */
 } noderes;
 
+/* values for nr_flags */
+#define NR_FLG_SUBTREE	0x01	/* usage of the node's whole poll subtree */
+
+/*
+ **	A sister in the poll tree holds the combined usage last reported
+ **	by each of its children for their part of the tree.
+ */
+typedef struct	treeres {
+	long		tr_cput;	/* cpu time */
+	long		tr_mem;		/* memory */
+	long		tr_cpupercent;	/* cpu percent */
+	tm_node_id	tr_nodekill;	/* node which wants the job to die */
+	int		tr_valid;	/* the child has reported */
+} treeres;
+
 /* State for a sister */
 
 #define SISTER_OKAY		0
@@ -403,7 +419,7 @@ typedef struct	noderes {
  * specific structures for Job Array attributes
  */
 
-/* individual entries in array job index table */
+/* individual entries in array job index table, as kept in the job file */
 struct ajtrk {
 	int trk_index;	/* actual index     */
 	int trk_status; /* status           */
@@ -414,6 +430,18 @@ struct ajtrk {
 
 };
 
+/*
+ * individual entries in the in-memory index table.  The index of an entry
+ * is tkm_first + offset * tkm_step and its state is kept in the state
+ * bitmaps of struct ajtrkmap, so neither is stored here.
+ */
+struct ajtrkent {
+	int	    trk_error;	  /* error code       */
+	short	    trk_substate; /* sub state        */
+	signed char trk_stgout;	  /* stageout status  */
+	char	    trk_exitstat; /* if executed and exitstat set */
+};
+
 /* subjob index table */
 struct ajtrkhd {
 	size_t  tkm_size;	 /* size of whole table */
@@ -421,11 +449,48 @@ struct ajtrkhd {
 	int	tkm_step;	 /* stepping factor for range (z in x-y:z) */
 	int	tkm_flags;	 /* special flags for array job		   */
 	int 	tkm_subjsct[PBS_NUMJOBSTATE];  /* count of subjobs in various states */
-	struct ajtrk tkm_tbl[1]; /* ptr to array of individual entries     */
+	int	tkm_first;	 /* index of the first entry (x in x-y:z)  */
+	struct ajtrkent tkm_tbl[1]; /* ptr to array of individual entries  */
 	/* when table is malloced, room for the additional required number */
 	/* of tkm_tbl entries (ct-1) will be included			   */
 };
 
+/*
+ * subjob index table as written to the job file, see job_save_fs()
+ */
+struct ajtrkhd_fs {
+	size_t  tkm_size;	 /* size of whole table */
+	int	tkm_ct;		 /* count of original entries in table */
+	int	tkm_step;	 /* stepping factor for range (z in x-y:z) */
+	int	tkm_flags;	 /* special flags for array job		   */
+	int 	tkm_subjsct[PBS_NUMJOBSTATE];  /* count of subjobs in various states */
+	struct ajtrk tkm_tbl[1]; /* ptr to array of individual entries     */
+};
+
+/*
+ * bitmaps over the subjob index table, one bit per tkm_tbl entry
+ */
+#define AJ_MAPBITS	(sizeof(unsigned long) * 8)
+#define AJ_MAPWORDS(n)	(((n) + AJ_MAPBITS - 1) / AJ_MAPBITS)
+#define AJ_MAPSET(m, i)	((m)[(i) / AJ_MAPBITS] |= (1UL << ((i) % AJ_MAPBITS)))
+#define AJ_MAPCLR(m, i)	((m)[(i) / AJ_MAPBITS] &= ~(1UL << ((i) % AJ_MAPBITS)))
+#define AJ_MAPTST(m, i)	(((m)[(i) / AJ_MAPBITS] >> ((i) % AJ_MAPBITS)) & 1UL)
+
+/* subjob index of the entry at offset "i" of index table "t" */
+#define AJ_INDEX(t, i)	((t)->tkm_first + (i) * (t)->tkm_step)
+
+/*
+ * in-memory companion to the subjob index table, allocated with the table
+ * and never saved.  It holds the state of every entry.
+ */
+struct ajtrkmap {
+	size_t	       tkx_words;		     /* words in each bitmap */
+	int	       tkx_ndirty;		     /* entries set in tkx_dirty */
+	unsigned long *tkx_state[PBS_NUMJOBSTATE];  /* entries in each state */
+	unsigned long *tkx_dirty;		     /* entries changed since save */
+	/* bitmap words follow the structure in the same allocation	   */
+};
+
 /*
  * Discard Job Structure,  see Server's discard_job function
  *	Used to record which Mom has responded to when we need to tell them
@@ -500,6 +565,8 @@ struct job {
 	time_t		ji_chkptnext;	/* next checkpoint time */
 	time_t		ji_sampletim;	/* last usage sample time, irix only */
 	time_t		ji_polltime;	/* last poll from mom superior */
+	time_t		ji_polldue;	/* next usage sample, see limit_headroom */
+	int		ji_memwatch;	/* inotify watch on cgroup memory.events */
 	time_t		ji_actalarm;	/* time of site callout alarm */
 	/* also, time obit sent, all */
 	time_t		ji_overlmt_timestamp;	/*time the job exceeded limit*/
@@ -521,6 +588,11 @@ struct job {
 	vmpiprocs      *ji_vnods;	/* ptr to job vnode management stuff */
 	vmpiprocs      *ji_vnods0;	/* ptr to 0 cpu assigned vnodes (for hooks) */
 	noderes	       *ji_resources;	/* ptr to array of node resources */
+	treeres	       *ji_treeres;	/* sister: usage of my children's */
+					/* parts of the poll tree, to pass up */
+	int		ji_numtree;	/* poll tree fanout used for the job, */
+					/* entries in ji_treeres on a sister */
+	pbs_list_head	ji_usedsent;	/* resources_used last sent to server */
 	pbs_list_head       ji_tasks;	/* list of task structs */
 	tm_node_id	ji_nodekill;	/* set to nodeid requesting job die */
 	int		ji_flags;	/* mom only flags */
@@ -546,9 +618,16 @@ struct job {
 	int		ji_terminated;	/* job terminated by deljob batch req */
 	int		ji_deletehistory; /* job history should not be saved */
 	pbs_list_head	ji_rejectdest;	/* list of rejected destinations */
+	pbs_list_link	ji_histjobs;	/* link to svr_histjobs, by expiry */
+	pbs_list_link	ji_svrstate;	/* link to svr_jobs_bystate[state] */
+	pbs_list_link	ji_questate;	/* link to qu_jobs_bystate[state] */
+	pbs_list_link	ji_ownerjobs;	/* link to owner's jobs, see ji_ownerix */
+	pbs_list_link	ji_arrayjobs;	/* ArrayJob: link to svr_arrayjobs */
+	struct owner_jobs *ji_ownerix;	/* owner index entry job is linked to */
 	int		ji_modifyct;	/* count of changes before save */
 	struct job     *ji_parentaj;	/* subjob:   parent Array Job */
 	struct ajtrkhd *ji_ajtrk;	/* ArrayJob: index tracking table */
+	struct ajtrkmap *ji_ajmap;	/* ArrayJob: state/dirty bitmaps of table */
 	int		ji_subjindx;	/* subjob:   its index into the table */
 	struct jbdscrd *ji_discard;	/* see discard_job() */
 	char	       *ji_acctrec;	/* holder for accounting info */
@@ -820,6 +899,7 @@ typedef struct	infoent {
 #define IM_REQUEUE		18
 #define	IM_DELETE_JOB_REPLY	19
 #define IM_SETUP_JOB		20
+#define IM_POLL_TREE		21
 #define IM_ERROR		99
 #define IM_ERROR2		100
 
@@ -1060,6 +1140,7 @@ extern int   site_check_user_map(void *, int, char *);
 extern int   site_allow_u(char *user, char *host);
 extern void  svr_dequejob(job *);
 extern int   svr_enquejob(job *);
+extern void  svr_jobidx_reorder(job *, job *);
 extern void  svr_evaljobstate(job *, int *, int *, int);
 extern void  set_statechar(job *);
 extern int   svr_setjobstate(job *, int, int);
@@ -133,6 +133,12 @@ extern int * __pbs_tcperrno_location(void);
 #define pbs_tcp_errno (*__pbs_tcperrno_location ())
 #endif
 
+#ifndef __PBS_STAT_ARENA_MODE
+#define __PBS_STAT_ARENA_MODE
+extern int * __pbs_stat_arena_mode_location(void);
+#define pbs_stat_arena_mode (*__pbs_stat_arena_mode_location ())
+#endif
+
 extern char pbs_current_group[];
 
 #define NCONNECTS 50
@@ -191,6 +197,8 @@ struct brp_rescq {            /* reply to Resource Query Request */
 #define BATCH_REPLY_CHOICE_Text		7	/* text,   see brp_txt	  */
 #define BATCH_REPLY_CHOICE_Locate	8	/* locate, see brp_locate */
 #define BATCH_REPLY_CHOICE_RescQuery	9	/* Resource Query         */
+#define BATCH_REPLY_CHOICE_StatArena	10	/* status decoded into an arena, */
+						/* see brp_stata, never encoded */
 
 struct batch_reply {
 	int	brp_code;
@@ -201,6 +209,7 @@ struct batch_reply {
 		struct brp_select *brp_select;	/* select replies */
 		pbs_list_head 	   brp_status;	/* status (svr) replies */
 		struct brp_cmdstat *brp_statc;  /* status (cmd) replies) */
+		struct batch_status *brp_stata;	/* status (cmd) replies in arena */
 		struct {
 			int   brp_txtlen;
 			char *brp_str;
@@ -278,6 +287,7 @@ struct batch_reply {
 #define PBS_BATCH_DelHookFile	86
 #define PBS_BATCH_MomRestart	87
 #define PBS_BATCH_AuthExternal	88
+#define PBS_BATCH_StatusEvents	89
 
 #define PBS_BATCH_FileOpt_Default	0
 #define PBS_BATCH_FileOpt_OFlg		1
@@ -304,6 +314,31 @@ struct batch_reply {
 extern int is_compose(int stream, int command);
 extern int is_compose_cmd(int stream, int command, char **msgid);
 extern void PBS_free_aopl(struct attropl * aoplp);
+
+/*
+ * A status reply decoded in arena mode (see pbs_stat_arena()) is carved
+ * out of a short chain of large blocks owned by a stat_arena, with the
+ * attribute and resource names interned.  pbs_statfree() releases the
+ * whole reply by freeing the chain.
+ */
+struct stat_arena_blk {
+	struct stat_arena_blk *sb_next;	/* older block */
+	size_t sb_size;			/* usable bytes following header */
+};
+
+struct stat_arena {
+	struct stat_arena *sa_next;	/* link in list of live arenas */
+	struct batch_status *sa_head;	/* the reply owned by this arena */
+	struct stat_arena_blk *sa_blks;	/* blocks, newest first */
+	char *sa_cur;			/* next free byte in newest block */
+	size_t sa_left;			/* bytes left in newest block */
+};
+
+extern struct stat_arena *stat_arena_new(void);
+extern void *stat_arena_alloc(struct stat_arena *sa, size_t size, int align);
+extern void stat_arena_trim(struct stat_arena *sa, char *end);
+extern void stat_arena_own(struct stat_arena *sa, struct batch_status *bsp);
+extern void stat_arena_free(struct stat_arena *sa);
 extern void advise(char *, ...);
 extern int PBSD_rdytocmt(int connect, char *jobid, int rpp, char **msgid);
 extern int PBSD_commit(int connect, char *jobid, int rpp, char **msgid);
@@ -340,6 +375,7 @@ extern char * PBSD_queuejob(int c, char *j, char *d,
 	struct attropl *a, char *ex, int rpp, char **msgid);
 extern int decode_DIS_svrattrl(int sock, pbs_list_head *phead);
 extern int decode_DIS_attrl(int sock, struct attrl **ppatt);
+extern int decode_DIS_attrl_arena(int sock, struct batch_status **ppbs);
 extern int decode_DIS_JobId(int socket, char *jobid);
 extern int decode_DIS_replyCmd(int socket, struct batch_reply *);
 
@@ -226,6 +226,46 @@ int
 lock_file(FILE *fp, int op, char *filename, int lock_retry,
 	char *err_msg, size_t err_msg_len);
 
+/*
+ * Job-ID sidecar index kept next to a daily log (<logfile>.jix).
+ * Each record is JOBIX_RECSZ bytes: a 4 byte hash of the job id
+ * sequence number and the 8 byte offset of the log line, both stored
+ * big-endian.  The reserved hash values mark where a writer opened and
+ * closed the log; the offset is then the log size at that moment.
+ */
+#define JOBIX_SUFFIX	".jix"
+#define JOBIX_RECSZ	12
+#define JOBIX_OPEN	0
+#define JOBIX_CLOSE	1
+unsigned int jobix_hash(char *jobid);
+int jobix_write(FILE *fp, unsigned int hash, long long off);
+int jobix_read(FILE *fp, unsigned int *hash, long long *off);
+
+/*
+ * Binary accounting stream kept next to a daily accounting file
+ * (<acctfile>.bin).  Each record is a 4 byte body length followed by
+ * the body: 8 byte time, 1 byte record type, 2 byte field count, then
+ * the record id and each field name and value as a 4 byte length, the
+ * bytes and a terminating NUL.  Integers are stored big-endian.
+ */
+#define ACCTBIN_SUFFIX	".bin"
+#define ACCTBIN_MAXREC	(64 * 1024 * 1024)	/* sanity limit on a body */
+typedef struct acctbin_rec {
+	long long ab_time;	/* time of the record */
+	int	  ab_type;	/* record type, e.g. 'E' */
+	char	 *ab_id;	/* job, reservation or other id */
+	int	  ab_nfld;	/* number of fields */
+	char	**ab_name;	/* field names, "" for a bare word */
+	char	**ab_value;	/* field values, quotes removed */
+	char	 *ab_buf;	/* private: record body */
+	size_t	  ab_bufsz;
+	int	  ab_fldsz;
+} acctbin_rec;
+int acctbin_write(FILE *fp, time_t when, int type, char *id, char *text);
+int acctbin_read(FILE *fp, acctbin_rec *rec);
+char *acctbin_value(acctbin_rec *rec, char *name);
+void acctbin_free(acctbin_rec *rec);
+
 /* RSHD/RCP related */
 /* Size of the buffer used in communication with rshd deamon */
 #define RCP_BUFFER_SIZE 65536
@@ -89,6 +89,8 @@ extern int  log_open_main(char *name, char *directory, int silent);
 extern void log_record(int type, int objclass, int severity, const char *objname, const char *text);
 extern char log_buffer[LOG_BUF_SIZE];
 extern int log_level_2_etype(int level);
+extern int log_mutex_lock(void);
+extern int log_mutex_unlock(void);
 
 extern int  chk_path_sec(char *path, int dir, int sticky, int bad, int);
 extern int  chk_file_sec(char *path, int isdir, int sticky,
@@ -55,6 +55,9 @@ struct var_table {
 	char **v_envp;
 	int    v_ensize;
 	int    v_used;
+	int   *v_hash;	/* v_envp index of each name, by hash of name */
+	int    v_hsize;	/* slots in v_hash, a power of 2 */
+	int    v_hused;	/* leading v_envp entries entered in v_hash */
 };
 
 /* struct sig_tbl = used to hold map of local signal names to values */
@@ -177,6 +180,9 @@ extern int   start_checkpoint(job *, int, struct batch_request *);
 extern int   local_checkpoint(job *, int, struct batch_request *);
 extern int   start_restart(job *, struct batch_request *);
 extern int   local_restart(job *, struct batch_request *);
+#ifdef	linux
+extern void  memory_unwatch(job *);
+#endif
 
 #ifdef WIN32
 extern void  wait_action(void);
@@ -201,6 +207,8 @@ extern void  mom_freenodes(job *);
 extern void  unset_job(job *, int);
 extern int   set_mach_vars(job *, struct var_table *);
 struct passwd	*check_pwd(job *);
+extern struct passwd *getpwnam_cached(char *);
+extern int   pwd_cache_groups(char *, gid_t, gid_t **);
 extern char *set_shell(job *, struct passwd *);
 extern void  start_exec(job *);
 extern void  send_obit(job *, int);
@@ -239,6 +247,7 @@ extern char	*std_file_name(job *, enum job_file, int *keeping);
 extern void	end_proc(void);
 extern int	task_recov(job *pjob);
 extern int	send_sisters(job *pjob, int com, pbs_jobndstm_t);
+extern int	send_sisters_poll(job *pjob);
 extern int	im_compose(int stream, char *jobid, char *cookie,
 	int command, tm_event_t	event, tm_task_id taskid, int version);
 extern int	message_job(job *pjob, enum job_file jft, char *text);
@@ -325,6 +334,11 @@ extern int is_child_path(char *, char *);
 extern int pbs_glob(char *, char *);
 extern void  rmjobdir(char *, char *, uid_t, gid_t);
 extern int stage_file(int, int, char *, struct rqfpair *, int, cpy_files *, char *);
+#ifndef WIN32
+extern int stage_pairs(int, char *, struct rqfpair *, int, cpy_files *, int *);
+extern int cleanup_enqueue(char *, char *, char *, uid_t, gid_t);
+extern void cleanup_start(void);
+#endif
 #ifdef WIN32
 extern void  bld_wenv_variables(char *, char *);
 extern void  init_envp(void);
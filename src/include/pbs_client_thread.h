@@ -113,6 +113,8 @@ struct pbs_client_thread_context {
 	int			th_pbs_tcp_interrupt;
 	int			th_pbs_tcp_errno;
 	int			th_pbs_mode;
+	/** decode status replies into an arena, see pbs_stat_arena() */
+	int			th_pbs_stat_arena;
 };
 
 
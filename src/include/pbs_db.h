@@ -318,9 +318,16 @@ typedef struct pbs_db_jobscr_info pbs_db_jobscr_info_t;
 struct pbs_db_query_options {
 	int	flags;
 	time_t	timestamp;
+	char	*start_id;	/* FIND_JOBS_BATCH: first job of the batch */
+	INTEGER	start_qrank;	/* FIND_JOBS_BATCH: qrank of that job */
+	int	limit;		/* FIND_JOBS_BATCH: number of jobs in the batch */
 };
 typedef struct pbs_db_query_options pbs_db_query_options_t;
 
+/* query option flags */
+#define FIND_JOBS_BY_QUE	1	/* jobs of the queue ji_queue */
+#define FIND_JOBS_BATCH		2	/* attributes or subjobs of a batch of jobs */
+
 #define PBS_DB_JOB 			0
 #define PBS_DB_RESV			1
 #define PBS_DB_SVR			2
@@ -487,6 +487,21 @@ enum resv_states { RESV_NONE, RESV_UNCONFIRMED, RESV_CONFIRMED, RESV_WAIT,
 	RESV_TIME_TO_RUN, RESV_RUNNING, RESV_FINISHED,
 	RESV_BEING_DELETED, RESV_DELETED, RESV_DELETING_JOBS, RESV_DEGRADED };
 
+/*
+ * Entries returned by pbs_statevents(), one per vnode or job state
+ * change.  The entry's name is the vnode name or job id.
+ */
+#define STATEV_SEQ	"event_seq"	/* journal sequence number */
+#define STATEV_EPOCH	"event_epoch"	/* journal epoch, server start time */
+#define STATEV_TIME	"event_time"	/* time of the change */
+#define STATEV_TYPE	"event_type"	/* STATEV_NODE or STATEV_JOB */
+#define STATEV_OLD	"old_state"	/* state before the change */
+#define STATEV_NEW	"new_state"	/* state after the change */
+#define STATEV_NODE	"node"
+#define STATEV_JOB	"job"
+#define STATEV_PURGED	"purged"	/* STATEV_NEW of a job that is gone */
+#define STATEV_MAXWAIT	300		/* longest wait, in seconds */
+
 #ifdef _USRDLL		/* This is only for building Windows DLLs
 			 * and not their static libraries
 			 */
@@ -573,6 +588,8 @@ DECLDIR struct batch_status *pbs_statresv(int, char *, struct attrl *, char *);
 
 DECLDIR struct batch_status *pbs_stathook(int , char *, struct attrl *, char *);
 
+DECLDIR struct batch_status *pbs_statevents(int, long long *, long long *, int, long long *, char *);
+
 DECLDIR struct ecl_attribute_errors * pbs_get_attributes_in_error(int);
 
 DECLDIR char *pbs_submit(int, struct attropl *, char *, char *, char *);
@@ -660,6 +677,8 @@ extern struct batch_status *pbs_statresv(int, char *, struct attrl *, char *);
 
 extern struct batch_status *pbs_stathook(int, char *, struct attrl *, char *);
 
+extern struct batch_status *pbs_statevents(int, long long *, long long *, int, long long *, char *);
+
 extern struct ecl_attribute_errors * pbs_get_attributes_in_error(int);
 
 extern char *pbs_submit(int, struct attropl *, char *, char *, char *);
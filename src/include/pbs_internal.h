@@ -178,6 +178,8 @@ struct pbs_config
 	unsigned start_sched:1;		/* should the scheduler be started */
 	unsigned start_comm:1; 		/* should the comm daemon be started */
 	unsigned locallog:1;			/* do local logging */
+	unsigned log_jobindex:1;		/* write job-ID sidecar index for logs */
+	unsigned acct_binary:1;		/* also write binary accounting records */
 	unsigned auth_method;		/* set auth_method to use */
 	unsigned int sched_modify_event:1;	/* whether to trigger modifyjob hook event or not */
 	unsigned syslogfac;		        /* syslog facility */
@@ -222,6 +224,7 @@ struct pbs_config
 	long  pbs_comm_log_events;      /* log_events for pbs_comm process, default 0 */
 	unsigned int pbs_comm_threads;	/* number of threads for router, default 4 */
 	char *pbs_mom_node_name;	/* mom short name used for natural node, default NULL */
+	unsigned int pbs_mom_hello_limit;	/* max Moms in hello handshake at once, 0 is no limit */
 #ifdef WIN32
 	char *pbs_conf_remote_viewer; /* Remote viewer client executable for PBS GUI jobs, alongwith launch options */
 #endif
@@ -242,6 +245,8 @@ extern struct pbs_config pbs_conf;
 #define PBS_CONF_START_SCHED	"PBS_START_SCHED"    /* start the scheduler? */
 #define PBS_CONF_START_COMM 	"PBS_START_COMM"    /* start the comm? */
 #define PBS_CONF_LOCALLOG	"PBS_LOCALLOG"	/* non-zero to force logging */
+#define PBS_CONF_LOG_JOBINDEX	"PBS_LOG_JOBINDEX" /* non-zero to index logs by job id */
+#define PBS_CONF_ACCT_BINARY	"PBS_ACCT_BINARY" /* non-zero for binary accounting */
 #define PBS_CONF_SYSLOG		"PBS_SYSLOG"	  /* non-zero for syslogging */
 #define PBS_CONF_SYSLOGSEVR	"PBS_SYSLOGSEVR"  /* severity lvl for syslog */
 #define PBS_CONF_BATCH_SERVICE_PORT	     "PBS_BATCH_SERVICE_PORT"
@@ -284,6 +289,8 @@ extern struct pbs_config pbs_conf;
 #define PBS_CONF_AUTH           "PBS_AUTH_METHOD"
 #define PBS_CONF_SCHEDULER_MODIFY_EVENT	"PBS_SCHEDULER_MODIFY_EVENT"
 #define PBS_CONF_MOM_NODE_NAME	"PBS_MOM_NODE_NAME"
+#define PBS_CONF_MOM_HELLO_LIMIT	"PBS_MOM_HELLO_LIMIT"	/* admission limit on Mom hellos */
+#define PBS_MOM_HELLO_LIMIT_DFLT	1000
 #ifdef WIN32
 #define PBS_CONF_REMOTE_VIEWER "PBS_REMOTE_VIEWER"	/* Executable for remote viewer application alongwith its launch options, for PBS GUI jobs */
 #endif
@@ -405,6 +412,8 @@ DECLDIR int pbs_confirmresv(int, char *, char *, unsigned long, char *);
 
 DECLDIR int pbs_defschreply(int, int, char *, int, char *, char *);
 
+DECLDIR int pbs_stat_arena(int);
+
 DECLDIR int pbs_quote_parse(char *, char **, char **, int);
 
 DECLDIR char *pbs_parse_err_msg(int);
@@ -472,6 +481,8 @@ extern int pbs_confirmresv(int, char *, char *, unsigned long, char *);
 
 extern int pbs_defschreply(int, int, char *, int, char *, char *);
 
+extern int pbs_stat_arena(int);
+
 extern char *pbs_strsep(char **, const char *);
 
 extern int pbs_quote_parse(char *, char **, char **, int);
@@ -136,6 +136,7 @@ struct mom_svrinfo {
 	int	      msr_stream;   /* RPP stream to Mom */
 	time_t	      msr_timedown; /* time Mom marked down */
 	time_t	      msr_timeinit; /* time Mom marked initializing */
+	time_t	      msr_timehello; /* time of unanswered IS_HELLO, 0 none */
 	struct work_task *msr_wktask;	/* work task for reque jobs */
 	pbs_list_head	msr_deferred_cmds;	/* links to svr work_task list for RPP replies */
 	unsigned long *msr_addrs;   /* IP addresses of host */
@@ -144,6 +145,7 @@ struct mom_svrinfo {
 	struct pbsnode **msr_children;  /* array of vnodes supported by Mom */
 	int	      msr_jbinxsz;  /* size of job index array */
 	struct job  **msr_jobindx;  /* index array of jobs on this Mom */
+	long	      msr_vnl_seq;  /* vnode deltas applied, -1 none */
 #ifdef PBS_CRED_GRIDPROXY
 	gss_ctx_id_t  msr_gsscontext; /* gss context */
 #endif /* PBS_CRED_GRIDPROXY */
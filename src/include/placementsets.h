@@ -238,6 +238,19 @@ extern vnl_t	*vn_merge(vnl_t *, vnl_t *, callfunc_t);
  */
 extern vnl_t	*vn_merge2(vnl_t *, vnl_t *, char *, callfunc_t);
 
+/**
+ * @brief	list the attributes of a vnode list that differ from an earlier one
+ *
+ * @return
+ *	a vnode list holding only the changed attributes
+ *
+ * @retval	NULL	attributes were dropped, or error
+ *
+ * @par Side-effects
+ *	Space allocated for vnode list should be freed with vnl_free().
+ */
+extern vnl_t	*vn_delta(vnl_t *, vnl_t *);
+
 /**
  * @brief	parse a file containing vnode information into a vnode list
  *
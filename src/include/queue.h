@@ -155,6 +155,7 @@ struct pbs_queue {
 
 	int	qu_numjobs;			/* current numb jobs in queue */
 	int	qu_njstate[PBS_NUMJOBSTATE];	/* # of jobs per state */
+	pbs_list_head	qu_jobs_bystate[PBS_NUMJOBSTATE]; /* jobs per state, by rank */
 	char	qu_jobstbuf[150];
 
 	/* the queue attributes */
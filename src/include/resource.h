@@ -119,6 +119,8 @@ extern int	     svr_resc_unk;	/* index to "unknown" resource   */
 
 extern resource     *add_resource_entry(attribute *, resource_def *);
 extern resource_def *find_resc_def(resource_def *, char *, int);
+extern int  build_resc_def_index(resource_def *, int);
+extern void reset_resc_def_index(void);
 extern resource     *find_resc_entry(attribute *, resource_def *);
 extern int          is_builtin(resource_def *rscdef);
 extern int           update_resource_def_file(char *name, resdef_op_t op, int type, int perms);
@@ -50,5 +50,6 @@ int	allreq		(char *);
 char*	getreq		(int);
 int	flushreq	(void);
 int	activereq	(void);
+int	waitreq		(int);
 void	fullresp	(int);
 
@@ -210,6 +210,21 @@ struct sched {
 extern struct server	server;
 extern struct sched	scheduler;
 extern	pbs_list_head	svr_alljobs;
+extern	pbs_list_head	svr_histjobs;	/* history jobs, oldest expiry first */
+extern	pbs_list_head	svr_jobs_bystate[PBS_NUMJOBSTATE]; /* jobs per state, by rank */
+extern	pbs_list_head	svr_arrayjobs;	/* array jobs, by rank */
+extern	int		svr_numarrayjobs;
+
+/*
+ * Entry in the owner index: all jobs in the server whose Job_Owner has
+ * the user name oj_name, in queue rank order.  See find_owner_jobs().
+ */
+struct owner_jobs {
+	pbs_list_head	oj_jobs;
+	int		oj_numjobs;
+	char		oj_name[PBS_MAXUSER+1];
+};
+extern int find_owner_jobs(char *user, struct owner_jobs **ppoj);
 extern	pbs_list_head	svr_newresvs;	/* incomming new reservations */
 extern	pbs_list_head	svr_allresvs;	/* all reservations in server */
 extern  int		svr_ping_rate;	/* time between rounds of ping */
@@ -118,6 +118,9 @@ extern int node_delete_db(struct pbsnode *);
 extern int node_recov_db_raw(void *, pbs_list_head *);
 extern int save_attr_db(pbs_db_conn_t *, pbs_db_attr_info_t *,	struct attribute_def *, struct attribute *, int , int);
 extern int recov_attr_db(pbs_db_conn_t *, void *, pbs_db_attr_info_t *, struct attribute_def *, struct attribute *, int , int);
+extern int recov_attr_db_cursor(pbs_db_conn_t *, void *, char *, int *, void *, pbs_db_attr_info_t *, struct attribute_def *, struct attribute *, int , int);
+extern job *job_recov_db_batch(pbs_db_job_info_t *);
+extern void job_recov_db_batch_end(void);
 extern int svr_migrate_data_from_fs(void);
 extern int pbsd_init(int);
 extern int setup_nodes_fs(int);
@@ -131,6 +134,9 @@ extern int apply_select_inchunk_rules(resource *, attribute *, void *, int, int)
 extern int svr_create_tmp_jobscript(job *, char *);
 extern void unset_jobscript_max_size(void);
 extern char *svr_load_jobscript(job *);
+extern void  journal_vnode_state(char *, int, int);
+extern void  journal_job_state(char *, int, int, int, int);
+extern void  journal_job_purge(char *, int, int);
 
 #ifdef	_PROVISION_H
 extern int find_prov_vnode_list(job *pjob, exec_vnode_listtype *prov_vnodes, char **aoe_name);
@@ -177,7 +183,7 @@ extern void  renew_credential(job *);
 extern char *lastname(char *shell);
 extern void  chk_array_doneness(job *parent);
 extern job  *create_subjob(job *parent, char *newjid, int *rc);
-extern char *cvt_range(struct ajtrkhd *t, int state);
+extern char *cvt_range(job *parent, int state);
 extern job  *find_arrayparent(char *subjobid);
 extern int   get_subjob_state(job *parent, int offset);
 extern char *mk_subjob_id(job *parent, int offset);
@@ -187,9 +193,15 @@ extern void  update_subjob_state_ct(job *pjob);
 extern char *subst_array_index(job *, char *);
 extern int   subjob_index_to_offset(job *parent, char *indexs);
 extern int   numindex_to_offset(job *parent, int iindx);
+extern int   mk_subjob_tbl(job *parent, int ct);
+extern void  set_subjob_entry(job *parent, int offset, struct ajtrk *trk);
+extern void  get_subjob_entry(job *parent, int offset, struct ajtrk *trk);
+extern int   next_subjob_dirty(job *parent, int offset);
+extern void  clear_subjob_dirty(job *parent);
 #ifndef PBS_MOM
 extern void svr_setjob_histinfo(job *pjob, histjob_type type);
 extern void svr_histjob_update(job *pjob, int newstate, int newsubstate);
+extern int svr_histjob_index(job *pjob);
 extern void complete_running(job *);
 extern void am_jobs_add(job *);
 extern int  was_job_alteredmoved(job *);
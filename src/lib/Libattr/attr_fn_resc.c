@@ -449,10 +449,119 @@ free_resc(attribute *pattr)
 	CLEAR_HEAD(pattr->at_val.at_list);
 }
 
+/* number of resource_def chains which may be indexed at once */
+#define RESC_IX_CHAINS	8
+
+/*
+ * Case insensitive hash index over one resource_def chain searched by
+ * find_resc_def(), built by build_resc_def_index().  Each chain (the
+ * server's, pbs_python's, ...) keeps its own index until
+ * reset_resc_def_index() drops them all.  When every index is in use the
+ * oldest one is rebuilt for the new chain.
+ */
+struct resc_def_ix {
+	resource_def	 *rx_head;	/* first def of the chain indexed */
+	int		  rx_limit;	/* number of defs indexed */
+	unsigned int	  rx_mask;	/* number of slots - 1 */
+	resource_def	**rx_slot;	/* NULL if empty */
+};
+
+static struct resc_def_ix resc_ix[RESC_IX_CHAINS];
+static int resc_ix_next = 0;	/* the index to rebuild next */
+
+/**
+ * @brief
+ * 	reset_resc_def_index - drop the resource definition indexes
+ *
+ *	Like build_resc_def_index(), only to be called while no other thread
+ *	may be in find_resc_def().
+ *
+ * @return	Void
+ *
+ */
+
+void
+reset_resc_def_index(void)
+{
+	int i;
+
+	for (i = 0; i < RESC_IX_CHAINS; i++)
+		free(resc_ix[i].rx_slot);
+	memset(resc_ix, 0, sizeof(resc_ix));
+	resc_ix_next = 0;
+}
+
+/**
+ * @brief
+ * 	build_resc_def_index - (re)build the hash index find_resc_def() uses
+ *	for the first limit defs of a chain
+ *
+ *	find_resc_def() reads the indexes without a lock, so they are built
+ *	at start up, before any thread is started, and rebuilt by the single
+ *	threaded daemon whenever a resource_def is added or removed.  The
+ *	index of the chain is replaced, or else the oldest one.  A chain
+ *	without an index is searched linearly.
+ *
+ * @param[in] rscdf - first resource_def of the chain
+ * @param[in] limit - number of members in the chain
+ *
+ * @return	int
+ * @retval	0	index built
+ * @retval	-1	no memory, the chain is searched linearly
+ *
+ */
+
+int
+build_resc_def_index(resource_def *rscdf, int limit)
+{
+	struct resc_def_ix *ix = NULL;
+	unsigned int size;
+	unsigned int h;
+	resource_def **slot;
+	int i;
+
+	for (i = 0; i < RESC_IX_CHAINS; i++) {
+		if (resc_ix[i].rx_head == rscdf) {
+			ix = &resc_ix[i];
+			break;
+		}
+	}
+	if (ix == NULL) {
+		ix = &resc_ix[resc_ix_next];
+		resc_ix_next = (resc_ix_next + 1) % RESC_IX_CHAINS;
+	}
+	free(ix->rx_slot);
+	memset(ix, 0, sizeof(*ix));
+
+	if (rscdf == NULL || limit <= 0)
+		return (-1);
+
+	for (size = 64; size < (unsigned int)limit * 2; size <<= 1)
+		;
+	if ((slot = calloc(size, sizeof(resource_def *))) == NULL)
+		return (-1);
+
+	ix->rx_head = rscdf;
+	ix->rx_limit = limit;
+	for (; limit-- && rscdf != NULL; rscdf = rscdf->rs_next) {
+		for (h = attr_name_hash(rscdf->rs_name) & (size - 1); slot[h];
+			h = (h + 1) & (size - 1)) {
+			/* first of duplicate names wins, as in a linear search */
+			if (strcasecmp(slot[h]->rs_name, rscdf->rs_name) == 0)
+				break;
+		}
+		if (slot[h] == NULL)
+			slot[h] = rscdf;
+	}
+	ix->rx_mask = size - 1;
+	ix->rx_slot = slot;
+	return (0);
+}
+
 /**
  * @brief
  * 	find_resc_def - find the resource_def structure for a resource with
- *	a given name
+ *	a given name, through the hash index of the chain if it has one
  *
  * @param[in] rscdf - address of array of resource_def structs 
  * @param[in] name - name of resource
@@ -467,9 +576,24 @@ free_resc(attribute *pattr)
 resource_def *
 find_resc_def(resource_def *rscdf, char *name, int limit)
 {
+	struct resc_def_ix *ix;
+	unsigned int h;
+
 	if (rscdf == NULL || name == NULL)
 		return ((resource_def *)0);
 
+	for (ix = resc_ix; ix < resc_ix + RESC_IX_CHAINS; ix++) {
+		if (ix->rx_slot == NULL || ix->rx_head != rscdf ||
+			ix->rx_limit != limit)
+			continue;
+		for (h = attr_name_hash(name) & ix->rx_mask; ix->rx_slot[h];
+			h = (h + 1) & ix->rx_mask) {
+			if (strcasecmp(ix->rx_slot[h]->rs_name, name) == 0)
+				return (ix->rx_slot[h]);
+		}
+		return ((resource_def *)0);
+	}
+
 	while (limit--) {
 		if (strcasecmp(rscdf->rs_name, name) == 0)
 			return (rscdf);
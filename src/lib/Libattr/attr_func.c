@@ -53,6 +53,8 @@
  * This file contains general functions for manipulating attributes and attribute lists.
  * Included are:
  *	clear_attr()
+ *	attr_name_hash()
+ *	build_attr_index()
  *	find_attr()
  *	free_null()
  *	attrlist_alloc()
@@ -105,12 +107,113 @@ clear_attr(attribute *pattr, struct attribute_def *pdef)
 		CLEAR_HEAD(pattr->at_val.at_list);
 }
 
+/* number of attribute definition tables which may be indexed */
+#define ATTR_IX_TABLES	32
+
+/*
+ * Case insensitive hash index over one attribute definition table,
+ * built by build_attr_index().
+ */
+struct attr_def_ix {
+	struct attribute_def *ix_def;	/* the table indexed */
+	int		      ix_limit;	/* number of entries indexed */
+	unsigned int	      ix_mask;	/* number of slots - 1 */
+	int		     *ix_slot;	/* entry index + 1, 0 if empty */
+};
+
+static struct attr_def_ix attr_ix[ATTR_IX_TABLES];
+static int attr_ix_num = 0;
+
+/**
+ * @brief
+ * 	attr_name_hash - case insensitive hash of an attribute or resource name
+ *
+ * @param[in] name - the name
+ *
+ * @return	unsigned int
+ * @retval	hash value
+ *
+ */
+
+unsigned int
+attr_name_hash(char *name)
+{
+	unsigned int h = 5381;
+
+	while (*name)
+		h = h * 33 + tolower((unsigned char)*name++);
+	return h;
+}
+
+/**
+ * @brief
+ * 	build_attr_index - build the hash index find_attr() uses for a
+ *	definition table
+ *
+ *	The indexes are read by find_attr() without a lock, so they must be
+ *	built while the program is still single threaded, at start up.  An
+ *	index is never changed or freed once built.  A table without an
+ *	index is searched linearly.
+ *
+ * @param[in] attr_def - ptr to attribute definitions
+ * @param[in] limit - limit on size of def array
+ *
+ * @return	int
+ * @retval	0	index built, or the table was already indexed
+ * @retval	-1	no room or no memory, the table is searched linearly
+ *
+ */
+
+int
+build_attr_index(struct attribute_def *attr_def, int limit)
+{
+	struct attr_def_ix *ix;
+	unsigned int size;
+	unsigned int h;
+	int *slot;
+	int i;
+
+	for (i = 0; i < attr_ix_num; i++) {
+		if (attr_ix[i].ix_def == attr_def && attr_ix[i].ix_limit == limit)
+			return (0);
+	}
+	if (attr_def == NULL || attr_ix_num == ATTR_IX_TABLES || limit <= 0)
+		return (-1);
+
+	for (size = 16; size < (unsigned int)limit * 2; size <<= 1)
+		;
+	if ((slot = calloc(size, sizeof(int))) == NULL)
+		return (-1);
+
+	for (i = 0; i < limit; i++) {
+		if (attr_def[i].at_name == NULL)
+			continue;
+		for (h = attr_name_hash(attr_def[i].at_name) & (size - 1); slot[h];
+			h = (h + 1) & (size - 1)) {
+			/* first of duplicate names wins, as in a linear search */
+			if (!strcasecmp(attr_def[slot[h] - 1].at_name, attr_def[i].at_name))
+				break;
+		}
+		if (slot[h] == 0)
+			slot[h] = i + 1;
+	}
+
+	ix = &attr_ix[attr_ix_num];
+	ix->ix_def = attr_def;
+	ix->ix_limit = limit;
+	ix->ix_mask = size - 1;
+	ix->ix_slot = slot;
+	attr_ix_num++;
+	return (0);
+}
+
 /**
  * @brief
  * 	find_attr - find attribute definition by name
  *
  *	Searches array of attribute definition strutures to find one
- *	whose name matches the requested name.
+ *	whose name matches the requested name.  A table indexed at start up
+ *	by build_attr_index() is looked up through its index.
  *
  * @param[in] attr_def - ptr to attribute definitions
  * @param[in] name - attribute name to find 
@@ -126,13 +229,28 @@ int
 find_attr(struct attribute_def *attr_def, char *name, int limit)
 {
 	int index;
-
-	if (attr_def) {
-		for (index = 0; index < limit; index++) {
-			if (!strcasecmp(attr_def->at_name, name))
+	unsigned int h;
+	struct attr_def_ix *ix;
+
+	if (attr_def == NULL || name == NULL)
+		return (-1);
+
+	for (ix = attr_ix; ix < attr_ix + attr_ix_num; ix++) {
+		if (ix->ix_def != attr_def || ix->ix_limit != limit)
+			continue;
+		for (h = attr_name_hash(name) & ix->ix_mask; ix->ix_slot[h];
+			h = (h + 1) & ix->ix_mask) {
+			index = ix->ix_slot[h] - 1;
+			if (!strcasecmp(attr_def[index].at_name, name))
 				return (index);
-			attr_def++;
 		}
+		return (-1);
+	}
+
+	for (index = 0; index < limit; index++) {
+		if (!strcasecmp(attr_def->at_name, name))
+			return (index);
+		attr_def++;
 	}
 	return (-1);
 }
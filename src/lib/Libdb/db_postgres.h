@@ -96,6 +96,7 @@ extern "C" {
 #define STMT_DELETE_JOBSCR  "delete_jobscr"
 
 #define STMT_SELECT_JOBATTR "select_jobattr"
+#define STMT_SELECT_JOBATTR_BATCH "select_jobattr_batch"
 #define STMT_INSERT_JOBATTR "insert_jobattr"
 #define STMT_UPDATE_JOBATTR "update_jobattr"
 #define STMT_UPDATE_JOBATTR_RESC "update_jobattr_resc"
@@ -107,6 +108,7 @@ extern "C" {
 #define STMT_INSERT_SUBJOB "insert_subjob"
 #define STMT_UPDATE_SUBJOB "update_subjob"
 #define STMT_FIND_SUBJOB_ORDBY_INDEX "find_subjob_ordby_index"
+#define STMT_FIND_SUBJOB_BATCH "find_subjob_batch"
 #define STMT_DELETE_SUBJOB "delete_subjob"
 
 /* reservation statement names */
@@ -320,8 +322,6 @@ typedef struct postgres_db_fn pg_db_fn_t;
 
 
 
-#define FIND_JOBS_BY_QUE 1
-
 /* common functions */
 int pg_db_prepare_job_sqls(pbs_db_conn_t *conn);
 int pg_db_prepare_resv_sqls(pbs_db_conn_t *conn);
@@ -69,6 +69,11 @@
 static void
 load_attr(PGresult *res, pbs_db_attr_info_t *pattr, int row)
 {
+	int col;
+
+	/* only queries spanning several parents return the parent id */
+	if ((col = PQfnumber(res, "ji_jobid")) >= 0)
+		pattr->parent_id = PQgetvalue(res, row, col);
 	strcpy(pattr->attr_name, PQgetvalue(res, row,
 		PQfnumber(res, "attr_name"))); /* name */
 	pattr->attr_resc = PQgetvalue(res, row,
@@ -471,11 +476,15 @@ pg_db_find_attr(pbs_db_conn_t *conn, void* st,
 	pg_query_state_t *state = (pg_query_state_t *) st;
 	pbs_db_attr_info_t *pattr = info->pbs_db_un.pbs_db_attr;
 	int rc;
+	int params;
 
 	if (!state)
 		return -1;
 
-	if (pattr->parent_obj_type == PARENT_TYPE_JOB)
+	if (pattr->parent_obj_type == PARENT_TYPE_JOB &&
+		opts != NULL && opts->flags == FIND_JOBS_BATCH)
+		strcpy(conn->conn_sql, STMT_SELECT_JOBATTR_BATCH);
+	else if (pattr->parent_obj_type == PARENT_TYPE_JOB)
 		strcpy(conn->conn_sql, STMT_SELECT_JOBATTR);
 	else if (pattr->parent_obj_type == PARENT_TYPE_SERVER)
 		strcpy(conn->conn_sql, STMT_SELECT_SVRATTR);
@@ -488,8 +497,16 @@ pg_db_find_attr(pbs_db_conn_t *conn, void* st,
 	else if (pattr->parent_obj_type == PARENT_TYPE_SCHED)
 		strcpy(conn->conn_sql, STMT_SELECT_SCHEDATTR);
 
-	LOAD_STR(conn, pattr->parent_id, 0);
-	if ((rc = pg_db_query(conn, conn->conn_sql, 1, &res)) != 0)
+	if (opts != NULL && opts->flags == FIND_JOBS_BATCH) {
+		LOAD_INTEGER(conn, opts->start_qrank, 0);
+		LOAD_STR(conn, opts->start_id, 1);
+		LOAD_BIGINT(conn, opts->limit, 2);
+		params = 3;
+	} else {
+		LOAD_STR(conn, pattr->parent_id, 0);
+		params = 1;
+	}
+	if ((rc = pg_db_query(conn, conn->conn_sql, params, &res)) != 0)
 		return rc;
 
 	state->row = 0;
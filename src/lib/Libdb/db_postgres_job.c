@@ -151,6 +151,7 @@ pg_db_prepare_job_sqls(pbs_db_conn_t *conn)
 		"ji_4jid,"
 		"ji_4ash,"
 		"ji_credtype,"
+		"ji_qrank,"
 		"extract(epoch from ji_savetm)::bigint as ji_savetm, "
 		"extract(epoch from ji_creattm)::bigint as ji_creattm "
 		"from pbs.job where ji_jobid = $1");
@@ -187,6 +188,22 @@ pg_db_prepare_job_sqls(pbs_db_conn_t *conn)
 	if (pg_prepare_stmt(conn, STMT_SELECT_JOBATTR, conn->conn_sql, 1) != 0)
 		return -1;
 
+	/*
+	 * Attributes of the jobs of one recovery batch: the $3 jobs from
+	 * ($1, $2) onwards in (ji_qrank, ji_jobid) order, returned in that
+	 * same order so that they can be merged with the job cursor.
+	 */
+	sprintf(conn->conn_sql, "select "
+		"a.ji_jobid, a.attr_name, a.attr_resource, a.attr_value, a.attr_flags "
+		"from pbs.job_attr a, "
+		"(select ji_jobid, ji_qrank from pbs.job "
+		"where (ji_qrank, ji_jobid) >= ($1, $2) "
+		"order by ji_qrank, ji_jobid limit $3) j "
+		"where a.ji_jobid = j.ji_jobid "
+		"order by j.ji_qrank, j.ji_jobid");
+	if (pg_prepare_stmt(conn, STMT_SELECT_JOBATTR_BATCH, conn->conn_sql, 3) != 0)
+		return -1;
+
 	/*
 	 * Use the sql encode function to encode the $2 parameter. Encode using
 	 * 'escape' mode. Encode considers $2 as a bytea and returns a escaped
@@ -239,9 +256,10 @@ pg_db_prepare_job_sqls(pbs_db_conn_t *conn)
 		"ji_4jid,"
 		"ji_4ash,"
 		"ji_credtype,"
+		"ji_qrank,"
 		"extract(epoch from ji_savetm)::bigint as ji_savetm, "
 		"extract(epoch from ji_creattm)::bigint as ji_creattm "
-		"from pbs.job order by ji_qrank");
+		"from pbs.job order by ji_qrank, ji_jobid");
 	if (pg_prepare_stmt(conn, STMT_FINDJOBS_ORDBY_QRANK, conn->conn_sql, 0) != 0)
 		return -1;
 
@@ -269,10 +287,11 @@ pg_db_prepare_job_sqls(pbs_db_conn_t *conn)
 		"ji_4jid,"
 		"ji_4ash,"
 		"ji_credtype,"
+		"ji_qrank,"
 		"extract(epoch from ji_savetm)::bigint as ji_savetm, "
 		"extract(epoch from ji_creattm)::bigint as ji_creattm "
 		"from pbs.job where ji_queue = $1"
-		" order by ji_qrank");
+		" order by ji_qrank, ji_jobid");
 	if (pg_prepare_stmt(conn, STMT_FINDJOBS_BYQUE_ORDBY_QRANK,
 		conn->conn_sql, 1) != 0)
 		return -1;
@@ -342,6 +361,24 @@ pg_db_prepare_job_sqls(pbs_db_conn_t *conn)
 		conn->conn_sql, 1) != 0)
 		return -1;
 
+	sprintf(conn->conn_sql, "select "
+		"s.ji_jobid, "
+		"s.trk_index, "
+		"s.trk_status, "
+		"s.trk_error, "
+		"s.trk_exitstat, "
+		"s.trk_substate, "
+		"s.trk_stgout "
+		"from pbs.subjob_track s, "
+		"(select ji_jobid, ji_qrank from pbs.job "
+		"where (ji_qrank, ji_jobid) >= ($1, $2) "
+		"order by ji_qrank, ji_jobid limit $3) j "
+		"where s.ji_jobid = j.ji_jobid "
+		"order by j.ji_qrank, j.ji_jobid, s.trk_index");
+	if (pg_prepare_stmt(conn, STMT_FIND_SUBJOB_BATCH,
+		conn->conn_sql, 3) != 0)
+		return -1;
+
 	sprintf(conn->conn_sql, "delete from pbs.subjob_track where ji_jobid = $1");
 	if (pg_prepare_stmt(conn, STMT_DELETE_SUBJOB, conn->conn_sql, 1) != 0)
 		return -1;
@@ -383,6 +420,8 @@ load_job(PGresult *res, pbs_db_job_info_t *pj, int row)
 		PQfnumber(res, "ji_destin")));
 	pj->ji_credtype = strtol(PQgetvalue(res, row,
 		PQfnumber(res, "ji_credtype")), NULL, 10);
+	pj->ji_qrank = strtol(PQgetvalue(res, row,
+		PQfnumber(res, "ji_qrank")), NULL, 10);
 	strcpy(pj->ji_4jid, PQgetvalue(res, row, PQfnumber(res, "ji_4jid")));
 	strcpy(pj->ji_4ash, PQgetvalue(res, row, PQfnumber(res, "ji_4ash")));
 	pj->ji_un_type = strtol(PQgetvalue(res, row,
@@ -811,9 +850,17 @@ pg_db_find_subjob(pbs_db_conn_t *conn, void *st, pbs_db_obj_info_t *obj,
 	if (!state)
 		return -1;
 
-	LOAD_STR(conn, psubjob->ji_jobid, 0);
-	params=1;
-	strcpy(conn->conn_sql, STMT_FIND_SUBJOB_ORDBY_INDEX);
+	if (opts != NULL && opts->flags == FIND_JOBS_BATCH) {
+		LOAD_INTEGER(conn, opts->start_qrank, 0);
+		LOAD_STR(conn, opts->start_id, 1);
+		LOAD_BIGINT(conn, opts->limit, 2);
+		params=3;
+		strcpy(conn->conn_sql, STMT_FIND_SUBJOB_BATCH);
+	} else {
+		LOAD_STR(conn, psubjob->ji_jobid, 0);
+		params=1;
+		strcpy(conn->conn_sql, STMT_FIND_SUBJOB_ORDBY_INDEX);
+	}
 	if ((rc = pg_db_query(conn, conn->conn_sql, params, &res)) != 0)
 		return rc;
 
@@ -1483,3 +1483,29 @@ __pbs_tcperrno_location(void)
 		pbs_client_thread_get_context_data();
 	return (&p->th_pbs_tcp_errno);
 }
+
+
+/**
+ * @brief
+ *	Returns the location of pbs_stat_arena_mode.
+ *
+ * @par Functionality:
+ *	This function returns address of the per thread location of
+ *	pbs_stat_arena_mode from the TLS
+ *	by calling @see __pbs_client_thread_get_context_data
+ *
+ * @retval	Address of the pbs_stat_arena_mode from TLS (success)
+ *
+ * @par Side-effects:
+ *	None
+ *
+ * @par Reentrancy:
+ *	Reentrant
+ */
+int *
+__pbs_stat_arena_mode_location(void)
+{
+	struct pbs_client_thread_context *p =
+		pbs_client_thread_get_context_data();
+	return (&p->th_pbs_stat_arena);
+}
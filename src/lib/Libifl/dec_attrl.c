@@ -39,6 +39,7 @@
 #include <pbs_config.h>   /* the master config generated by configure */
 
 #include <stdlib.h>
+#include <string.h>
 #include "libpbs.h"
 #include "dis.h"
 
@@ -137,3 +138,269 @@ decode_DIS_attrl(int sock, struct attrl **ppatt)
 		PBS_free_aopl((struct attropl *)pat);
 	return rc;
 }
+
+/* open addressed table of interned attribute and resource names */
+struct name_tbl {
+	char	**nt_slot;
+	size_t	  nt_size;	/* power of 2 */
+	size_t	  nt_used;
+};
+
+/**
+ * @brief
+ *	intern a name read into arena space
+ *
+ * @param[in]   nt - table of names interned so far
+ * @param[in]   name - the name just read, in arena space
+ * @param[out]  dup - set to 1 if an earlier copy is returned, in which
+ *		      case the arena space of name may be reused
+ *
+ * @return char *
+ * @retval interned copy of name
+ * @retval NULL on malloc failure
+ */
+static char *
+intern_name(struct name_tbl *nt, char *name, int *dup)
+{
+	unsigned long	 h = 5381;
+	unsigned char	*p;
+	size_t		 i;
+	size_t		 j;
+	char		**nslot;
+
+	*dup = 0;
+	if (nt->nt_used * 2 >= nt->nt_size) {
+		size_t nsize = nt->nt_size ? nt->nt_size * 2 : 256;
+
+		nslot = calloc(nsize, sizeof(char *));
+		if (nslot == NULL)
+			return NULL;
+		for (i = 0; i < nt->nt_size; i++) {
+			if (nt->nt_slot[i] == NULL)
+				continue;
+			h = 5381;
+			for (p = (unsigned char *)nt->nt_slot[i]; *p; p++)
+				h = h * 33 + *p;
+			for (j = h & (nsize - 1); nslot[j]; j = (j + 1) & (nsize - 1))
+				;
+			nslot[j] = nt->nt_slot[i];
+		}
+		free(nt->nt_slot);
+		nt->nt_slot = nslot;
+		nt->nt_size = nsize;
+		h = 5381;
+	}
+
+	for (p = (unsigned char *)name; *p; p++)
+		h = h * 33 + *p;
+	for (i = h & (nt->nt_size - 1); nt->nt_slot[i];
+		i = (i + 1) & (nt->nt_size - 1)) {
+		if (strcmp(nt->nt_slot[i], name) == 0) {
+			*dup = 1;
+			return nt->nt_slot[i];
+		}
+	}
+	nt->nt_slot[i] = name;
+	nt->nt_used++;
+	return name;
+}
+
+/**
+ * @brief
+ *	read one counted string into the arena space at *pos, which has
+ *	*left bytes.  If the sender understated the space, the string is
+ *	read into malloc'ed space and copied into the arena instead.
+ *
+ * @param[in]     sock - socket descriptor
+ * @param[in]     sa - the arena
+ * @param[in,out] pos - where to put the string, advanced past it
+ * @param[in,out] left - space at pos
+ *
+ * @return char *
+ * @retval the string
+ * @retval NULL on error, rc holds the DIS error
+ */
+static char *
+arena_rdstr(int sock, struct stat_arena *sa, char **pos, size_t *left, int *rc)
+{
+	char	*str;
+	char	*tmp;
+	size_t	 len;
+
+	if (*left > 0) {
+		*rc = disrfst(sock, *left - 1, *pos);
+		if (*rc == DIS_SUCCESS) {
+			str = *pos;
+			len = strlen(str) + 1;
+			*pos += len;
+			*left -= len;
+			return str;
+		}
+		if (*rc != DIS_OVERFLOW)
+			return NULL;
+	}
+
+	/* the string was not consumed, take the slow path */
+	tmp = disrst(sock, rc);
+	if (*rc)
+		return NULL;
+	len = strlen(tmp) + 1;
+	stat_arena_trim(sa, *pos);
+	str = stat_arena_alloc(sa, len, 0);
+	if (str == NULL) {
+		free(tmp);
+		*rc = DIS_NOMALLOC;
+		return NULL;
+	}
+	memcpy(str, tmp, len);
+	free(tmp);
+	*pos = str + len;
+	*left = 0;
+	return str;
+}
+
+/**
+ * @brief
+ *	decode the objects of a status reply into a list of PBS API
+ *	"batch_status" structures held in one arena
+ *
+ *	This reads the same encoding as the status choice of
+ *	decode_DIS_replyCmd() followed by decode_DIS_attrl(), but instead of
+ *	a malloc for every structure and string, everything is carved out of
+ *	a stat_arena.  The per-attribute size in the encoding is used to
+ *	reserve space for the strings, and attribute and resource names are
+ *	interned so each distinct name is stored once.  The reply is freed
+ *	as a whole by pbs_statfree().
+ *
+ * @param[in]   sock - socket descriptor
+ * @param[out]  ppbs - head of the decoded list, NULL if no objects
+ *
+ * @return int
+ * @retval 0 on SUCCESS
+ * @retval >0 on failure
+ */
+
+int
+decode_DIS_attrl_arena(int sock, struct batch_status **ppbs)
+{
+	struct stat_arena	 *sa;
+	struct batch_status	 *bsp;
+	struct batch_status	**pbsx;
+	struct attrl		 *pat;
+	struct attrl		**patx;
+	struct name_tbl		  names = {NULL, 0, 0};
+	char			  objname[PBS_MAXSVRJOBID + 1];
+	char			 *pos;
+	char			 *str;
+	size_t			  left;
+	size_t			  size;
+	unsigned int		  ct;
+	unsigned int		  numpat;
+	int			  hasresc;
+	int			  dup;
+	int			  rc = 0;
+
+	*ppbs = NULL;
+	ct = disrui(sock, &rc);
+	if (rc)
+		return rc;
+	if ((sa = stat_arena_new()) == NULL)
+		return DIS_NOMALLOC;
+	pbsx = ppbs;
+
+	while (ct-- && rc == 0) {
+		(void) disrui(sock, &rc);	/* object type, unused */
+		if (rc)
+			break;
+		rc = disrfst(sock, PBS_MAXSVRJOBID + 1, objname);
+		if (rc)
+			break;
+
+		bsp = stat_arena_alloc(sa, sizeof(struct batch_status), 1);
+		size = strlen(objname) + 1;
+		if (bsp == NULL ||
+			(bsp->name = stat_arena_alloc(sa, size, 0)) == NULL) {
+			rc = DIS_NOMALLOC;
+			break;
+		}
+		memcpy(bsp->name, objname, size);
+		bsp->attribs = NULL;
+		bsp->text = NULL;
+		bsp->next = NULL;
+		*pbsx = bsp;
+		pbsx = &bsp->next;
+
+		numpat = disrui(sock, &rc);
+		patx = &bsp->attribs;
+		while (rc == 0 && numpat--) {
+			size = disrui(sock, &rc);
+			if (rc)
+				break;
+
+			pat = stat_arena_alloc(sa, sizeof(struct attrl), 1);
+			if (pat == NULL ||
+				(pos = stat_arena_alloc(sa, size, 0)) == NULL) {
+				rc = DIS_NOMALLOC;
+				break;
+			}
+			left = size;
+			pat->next = NULL;
+			pat->resource = NULL;
+
+			/* names already seen give their space back to the value */
+			str = arena_rdstr(sock, sa, &pos, &left, &rc);
+			if (str == NULL)
+				break;
+			if ((pat->name = intern_name(&names, str, &dup)) == NULL) {
+				rc = DIS_NOMALLOC;
+				break;
+			}
+			if (dup) {
+				left += pos - str;
+				pos = str;
+			}
+
+			hasresc = disrui(sock, &rc);
+			if (rc)
+				break;
+			if (hasresc) {
+				str = arena_rdstr(sock, sa, &pos, &left, &rc);
+				if (str == NULL)
+					break;
+				if ((pat->resource = intern_name(&names, str, &dup)) == NULL) {
+					rc = DIS_NOMALLOC;
+					break;
+				}
+				if (dup) {
+					left += pos - str;
+					pos = str;
+				}
+			}
+
+			pat->value = arena_rdstr(sock, sa, &pos, &left, &rc);
+			if (pat->value == NULL)
+				break;
+			stat_arena_trim(sa, pos);
+
+#ifdef NAS /* localmod 005 */
+			pat->op = (enum batch_op) disrui(sock, &rc);
+#else
+			pat->op = disrui(sock, &rc);
+#endif /* localmod 005 */
+			if (rc)
+				break;
+
+			*patx = pat;
+			patx = &pat->next;
+		}
+	}
+
+	free(names.nt_slot);
+	if (rc || *ppbs == NULL) {
+		stat_arena_free(sa);
+		*ppbs = NULL;
+		return rc;
+	}
+	stat_arena_own(sa, *ppbs);
+	return 0;
+}
@@ -147,6 +147,16 @@ decode_DIS_replyCmd(int sock, struct batch_reply *reply)
 
 		case BATCH_REPLY_CHOICE_Status:
 
+			if (pbs_stat_arena_mode) {
+				/* whole reply into one arena, see pbs_stat_arena() */
+				reply->brp_un.brp_stata = NULL;
+				rc = decode_DIS_attrl_arena(sock, &reply->brp_un.brp_stata);
+				if (rc)
+					return rc;
+				reply->brp_choice = BATCH_REPLY_CHOICE_StatArena;
+				break;
+			}
+
 			/* have to get count of number of status objects first */
 
 			reply->brp_un.brp_statc = (struct brp_cmdstat *)0;
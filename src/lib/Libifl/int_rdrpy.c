@@ -202,6 +202,8 @@ struct batch_reply *reply;
 			(void)free(pstc);
 			pstc = pstcx;
 		}
+	} else if (reply->brp_choice == BATCH_REPLY_CHOICE_StatArena) {
+		pbs_statfree(reply->brp_un.brp_stata);
 	} else if (reply->brp_choice == BATCH_REPLY_CHOICE_RescQuery) {
 		(void)free(reply->brp_un.brp_rescq.brq_avail);
 		(void)free(reply->brp_un.brp_rescq.brq_alloc);
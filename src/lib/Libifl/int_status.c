@@ -113,8 +113,16 @@ struct batch_status *PBSD_status_get(int c)
 		pbs_errno = PBSE_PROTOCOL;
 	} else if (reply->brp_choice != BATCH_REPLY_CHOICE_NULL  &&
 		reply->brp_choice != BATCH_REPLY_CHOICE_Text &&
-		reply->brp_choice != BATCH_REPLY_CHOICE_Status) {
+		reply->brp_choice != BATCH_REPLY_CHOICE_Status &&
+		reply->brp_choice != BATCH_REPLY_CHOICE_StatArena) {
 		pbs_errno = PBSE_PROTOCOL;
+	} else if (reply->brp_choice == BATCH_REPLY_CHOICE_StatArena) {
+		/* decoded straight into batch_status, just take it over */
+		if (connection[c].ch_errno == 0) {
+			rbsp = reply->brp_un.brp_stata;
+			reply->brp_un.brp_stata = NULL;
+			pbs_errno = 0;
+		}
 	} else if (connection[c].ch_errno == 0) {
 		/* have zero or more attrl structs to decode here */
 		stp = reply->brp_un.brp_statc;
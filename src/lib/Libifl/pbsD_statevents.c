@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 1994-2016 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *  
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ * 
+ * Open Source License Information:
+ *  
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free 
+ * Software Foundation, either version 3 of the License, or (at your option) any 
+ * later version.
+ *  
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  
+ * Commercial License Information: 
+ * 
+ * The PBS Pro software is licensed under the terms of the GNU Affero General 
+ * Public License agreement ("AGPL"), except where a separate commercial license 
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *  
+ * Altair’s dual-license business model allows companies, individuals, and 
+ * organizations to create proprietary derivative works of PBS Pro and distribute 
+ * them - whether embedded or bundled with other software - under a commercial 
+ * license agreement.
+ * 
+ * Use of Altair’s trademarks, including but not limited to "PBS™", 
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's 
+ * trademark licensing policies.
+ *
+ */
+/*	pbsD_statevents.c
+ *		Read the server's vnode and job state change journal
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "libpbs.h"
+#include "dis.h"
+#include "pbs_error.h"
+#include "pbs_ecl.h"
+
+
+/**
+ * @brief
+ *	- Get the vnode and job state changes the server journaled from
+ *	sequence number *seq on, waiting up to wait seconds for one if
+ *	there are none yet.
+ *
+ * @par	Each change is returned as a batch_status entry named for the vnode
+ *	or job, with the attributes STATEV_SEQ, STATEV_EPOCH, STATEV_TIME,
+ *	STATEV_TYPE, STATEV_OLD and STATEV_NEW.  On return *seq is the
+ *	sequence number to ask for next and *epoch the journal epoch it
+ *	belongs to.  A client streams the changes by calling this in a loop,
+ *	starting with *seq and *epoch set to 0 for everything the server kept.
+ *
+ * @param[in] c - connection handler
+ * @param[in,out] seq - first sequence number wanted, then the next one
+ * @param[in,out] epoch - journal epoch of *seq, 0 if not known
+ * @param[in] wait - seconds to wait for a change, at most STATEV_MAXWAIT
+ * @param[out] lost - if not NULL, the number of changes the server dropped
+ *		      before they were read, or -1 if the server restarted and
+ *		      the number is not known.  The client should then refresh
+ *		      its view with pbs_statvnode() and pbs_statjob().
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return	structure handle
+ * @retval	pointer to batch status	success
+ * @retval	NULL	no change within wait seconds (pbs_errno is 0) or error
+ *
+ */
+struct batch_status *
+pbs_statevents(int c, long long *seq, long long *epoch, int wait,
+	long long *lost, char *extend)
+{
+	int	rc;
+	int	sock;
+	long long eseq;
+	long long newepoch;
+	struct batch_status *ret;
+	struct batch_status *bsp;
+	struct attrl *pat;
+
+	if (seq == NULL || *seq < 0 || epoch == NULL || *epoch < 0 || wait < 0) {
+		pbs_errno = PBSE_IVALREQ;
+		return NULL;
+	}
+	if (lost != NULL)
+		*lost = 0;
+
+	sock = connection[c].ch_socket;
+
+	/* initialize the thread context data, if not already initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return NULL;
+
+	/* lock pthread mutex here for this connection */
+	/* blocking call, waits for mutex release */
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return NULL;
+
+	/* setup DIS support routines for following DIS calls */
+
+	DIS_tcp_setup(sock);
+
+	/* encode request */
+
+	if ((rc = encode_DIS_ReqHdr(sock, PBS_BATCH_StatusEvents,
+		pbs_current_user)) ||
+		(rc = diswull(sock, (u_Long)*seq)  != 0)              ||
+		(rc = diswull(sock, (u_Long)*epoch)  != 0)            ||
+		(rc = diswsi(sock, wait)  != 0)                       ||
+		(rc = encode_DIS_ReqExtend(sock, extend)) ) {
+		connection[c].ch_errtxt = strdup(dis_emsg[rc]);
+		if (connection[c].ch_errtxt == NULL) {
+			pbs_errno = PBSE_SYSTEM;
+		} else {
+			pbs_errno = PBSE_PROTOCOL;
+		}
+		(void)pbs_client_thread_unlock_connection(c);
+		return NULL;
+	}
+
+	if (DIS_tcp_wflush(sock)) {
+		pbs_errno = PBSE_PROTOCOL;
+		(void)pbs_client_thread_unlock_connection(c);
+		return NULL;
+	}
+
+	/* get reply */
+
+	ret = PBSD_status_get(c);
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0) {
+		pbs_statfree(ret);
+		return NULL;
+	}
+
+	/*
+	 * note where this batch starts and where the next one should; a
+	 * new epoch means the server restarted and numbered from 1 again
+	 */
+	for (bsp = ret; bsp != NULL; bsp = bsp->next) {
+		eseq = 0;
+		newepoch = 0;
+		for (pat = bsp->attribs; pat != NULL; pat = pat->next) {
+			if (strcmp(pat->name, STATEV_EPOCH) == 0)
+				newepoch = strtoll(pat->value, NULL, 10);
+			else if (strcmp(pat->name, STATEV_SEQ) == 0)
+				eseq = strtoll(pat->value, NULL, 10);
+		}
+		if (eseq == 0)
+			continue;
+		if (bsp == ret) {
+			if ((*seq != 0) && (lost != NULL)) {
+				if ((*epoch != 0) && (newepoch != *epoch))
+					*lost = -1;
+				else if (eseq > *seq)
+					*lost = eseq - *seq;
+				else if (eseq < *seq)
+					*lost = -1;
+			}
+		}
+		*seq = eseq + 1;
+		*epoch = newepoch;
+	}
+
+	return ret;
+}
@@ -894,12 +894,15 @@ struct batch_status *pbs_stathost(int con, char *hid, struct attrl *attrib, char
 	struct consumable *consum          = NULL;
 	int		  host_list_size  = 0;
 	int		  consumable_size = 0;
+	int		  arena;
 	struct pbs_client_thread_connect_context *context;
 
 	breturn = NULL;
 
-	/* get status of all vnodes */
+	/* get status of all vnodes, attribs are moved out so no arena */
+	arena = pbs_stat_arena(0);
 	bstatus = pbs_statvnode(con, "", attrib, extend);
+	(void)pbs_stat_arena(arena);
 
 	if (bstatus == NULL)
 		return NULL;
@@ -75,6 +75,8 @@ struct pbs_config pbs_conf = {
 	0,					/* start_sched */
 	0,					/* start comm */
 	0,					/* locallog */
+	0,					/* log_jobindex */
+	0,					/* acct_binary */
 	AUTH_RESV_PORT,				/* default to reserved port authentication */
 	0,					/* sched_modify_event */
 	0,					/* syslogfac */
@@ -118,7 +120,8 @@ struct pbs_config pbs_conf = {
 	NULL,					/* for router, default communication routers list */
 	0,					/* default comm logevent mask */
 	4,					/* default number of threads */
-	NULL					/* mom short name override */
+	NULL,					/* mom short name override */
+	PBS_MOM_HELLO_LIMIT_DFLT		/* max Moms in hello handshake at once */
 #ifdef WIN32
 	,NULL					/* remote viewer launcher executable alongwith launch options */
 #endif
@@ -392,6 +395,14 @@ pbs_loadconf(int reload)
 				if (sscanf(conf_value, "%u", &uvalue) == 1)
 					pbs_conf.locallog = ((uvalue > 0) ? 1 : 0);
 			}
+			else if (!strcmp(conf_name, PBS_CONF_LOG_JOBINDEX)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.log_jobindex = ((uvalue > 0) ? 1 : 0);
+			}
+			else if (!strcmp(conf_name, PBS_CONF_ACCT_BINARY)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.acct_binary = ((uvalue > 0) ? 1 : 0);
+			}
 			else if (!strcmp(conf_name, PBS_CONF_SYSLOG)) {
 				if (sscanf(conf_value, "%u", &uvalue) == 1)
 					pbs_conf.syslogfac = ((uvalue <= (23<<3)) ? uvalue : 0);
@@ -561,6 +572,10 @@ pbs_loadconf(int reload)
 				free(pbs_conf.pbs_mom_node_name);
 				pbs_conf.pbs_mom_node_name = strdup(conf_value);
 			}
+			else if (!strcmp(conf_name, PBS_CONF_MOM_HELLO_LIMIT)) {
+				if (sscanf(conf_value, "%u", &uvalue) == 1)
+					pbs_conf.pbs_mom_hello_limit = uvalue;
+			}
 #ifdef WIN32
 			else if (!strcmp(conf_name, PBS_CONF_REMOTE_VIEWER)) {
 				free(pbs_conf.pbs_conf_remote_viewer);
@@ -610,6 +625,14 @@ pbs_loadconf(int reload)
 		if (sscanf(gvalue, "%u", &uvalue) == 1)
 			pbs_conf.locallog = ((uvalue > 0) ? 1 : 0);
 	}
+	if ((gvalue = getenv(PBS_CONF_LOG_JOBINDEX)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.log_jobindex = ((uvalue > 0) ? 1 : 0);
+	}
+	if ((gvalue = getenv(PBS_CONF_ACCT_BINARY)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.acct_binary = ((uvalue > 0) ? 1 : 0);
+	}
 	if ((gvalue = getenv(PBS_CONF_SYSLOG)) != NULL) {
 		if (sscanf(gvalue, "%u", &uvalue) == 1)
 			pbs_conf.syslogfac = ((uvalue <= (23<<3)) ? uvalue : 0);
@@ -781,6 +804,10 @@ pbs_loadconf(int reload)
 		free(pbs_conf.pbs_mom_node_name);
 		pbs_conf.pbs_mom_node_name = strdup(gvalue);
 	}
+	if ((gvalue = getenv(PBS_CONF_MOM_HELLO_LIMIT)) != NULL) {
+		if (sscanf(gvalue, "%u", &uvalue) == 1)
+			pbs_conf.pbs_mom_hello_limit = uvalue;
+	}
 
 	/* rcp_path is inferred from pbs_conf.pbs_exec_path - see below */
 	/* pbs_demux_path is inferred from pbs_conf.pbs_exec_path - see below */
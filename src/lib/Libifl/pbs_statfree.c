@@ -36,15 +36,221 @@
  */
 /*	pbs_statfree.c
 
- The function that deallocates a "batch_status" structure
+ The function that deallocates a "batch_status" structure, and the
+ arena that backs status replies decoded in arena mode
  */
 
 #include <pbs_config.h>   /* the master config generated by configure */
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <pthread.h>
 #include "libpbs.h"
 
+/* first arena block size, later blocks double up to the max */
+#define STAT_ARENA_MINBLK	(64 * 1024)
+#define STAT_ARENA_MAXBLK	(4 * 1024 * 1024)
+#define STAT_ARENA_ALIGN(n)	(((n) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+
+/* arenas which own a reply not yet passed to pbs_statfree() */
+static struct stat_arena *live_arenas = NULL;
+static pthread_mutex_t stat_arena_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief
+ *	-Turn arena decoding of status replies on or off for the calling
+ *	thread.
+ *
+ * @par	Functionality:
+ *	In arena mode, each status reply is decoded into a few large blocks
+ *	with interned attribute and resource names, and pbs_statfree() frees
+ *	the blocks rather than every attrl and string.  The batch_status and
+ *	attrl layout is unchanged, but the strings and structures of such a
+ *	reply must not be freed, realloc'ed or spliced into another list by
+ *	the caller, and only the head of the list may be passed to
+ *	pbs_statfree().  The setting lives in the thread's client context,
+ *	so other threads of the process keep their own.
+ *
+ * @param[in] enable - 1 to turn arena mode on, 0 to turn it off
+ *
+ * @return	int
+ * @retval	previous setting
+ */
+int
+pbs_stat_arena(int enable)
+{
+	int old = pbs_stat_arena_mode;
+
+	pbs_stat_arena_mode = (enable != 0);
+	return old;
+}
+
+/**
+ * @brief
+ *	-Allocate an empty status arena.
+ *
+ * @return	struct stat_arena *
+ * @retval	new arena on success
+ * @retval	NULL on malloc failure
+ */
+struct stat_arena *
+stat_arena_new(void)
+{
+	struct stat_arena *sa;
+
+	sa = MH(struct stat_arena);
+	if (sa == NULL)
+		return NULL;
+	sa->sa_next = NULL;
+	sa->sa_head = NULL;
+	sa->sa_blks = NULL;
+	sa->sa_cur = NULL;
+	sa->sa_left = 0;
+	return sa;
+}
+
+/**
+ * @brief
+ *	-Carve space out of a status arena, adding a block if needed.
+ *
+ * @param[in] sa - the arena
+ * @param[in] size - number of bytes wanted
+ * @param[in] align - nonzero if the space will hold a structure
+ *
+ * @return	void *
+ * @retval	pointer to the space on success
+ * @retval	NULL on malloc failure
+ */
+void *
+stat_arena_alloc(struct stat_arena *sa, size_t size, int align)
+{
+	struct stat_arena_blk *blk;
+	size_t pad = 0;
+	size_t bsize;
+	void *p;
+
+	if (align && sa->sa_cur != NULL)
+		pad = STAT_ARENA_ALIGN((size_t)sa->sa_cur) - (size_t)sa->sa_cur;
+
+	if (sa->sa_cur == NULL || size + pad > sa->sa_left) {
+		if (sa->sa_blks == NULL)
+			bsize = STAT_ARENA_MINBLK;
+		else if (sa->sa_blks->sb_size < STAT_ARENA_MAXBLK)
+			bsize = sa->sa_blks->sb_size * 2;
+		else
+			bsize = STAT_ARENA_MAXBLK;
+		if (bsize < size)
+			bsize = size;
+
+		blk = malloc(STAT_ARENA_ALIGN(sizeof(struct stat_arena_blk)) + bsize);
+		if (blk == NULL)
+			return NULL;
+		blk->sb_size = bsize;
+		blk->sb_next = sa->sa_blks;
+		sa->sa_blks = blk;
+		sa->sa_cur = (char *)blk + STAT_ARENA_ALIGN(sizeof(struct stat_arena_blk));
+		sa->sa_left = bsize;
+		pad = 0;
+	}
+
+	p = sa->sa_cur + pad;
+	sa->sa_cur += pad + size;
+	sa->sa_left -= pad + size;
+	return p;
+}
+
+/**
+ * @brief
+ *	-Give back the unused tail of the most recent allocation.
+ *
+ * @param[in] sa - the arena
+ * @param[in] end - first byte not used of the most recent allocation
+ *
+ * @return	Void
+ */
+void
+stat_arena_trim(struct stat_arena *sa, char *end)
+{
+	if (end < sa->sa_cur) {
+		sa->sa_left += sa->sa_cur - end;
+		sa->sa_cur = end;
+	}
+}
+
+/**
+ * @brief
+ *	-Record that the arena owns a reply, so that pbs_statfree() on the
+ *	head of the reply releases the arena.
+ *
+ * @param[in] sa - the arena
+ * @param[in] bsp - head of the decoded reply
+ *
+ * @return	Void
+ */
+void
+stat_arena_own(struct stat_arena *sa, struct batch_status *bsp)
+{
+	sa->sa_head = bsp;
+	pthread_mutex_lock(&stat_arena_lock);
+	sa->sa_next = live_arenas;
+	live_arenas = sa;
+	pthread_mutex_unlock(&stat_arena_lock);
+}
+
+/**
+ * @brief
+ *	-Free every block of an arena and the arena itself.
+ *
+ * @param[in] sa - the arena, must not be on the live list
+ *
+ * @return	Void
+ */
+void
+stat_arena_free(struct stat_arena *sa)
+{
+	struct stat_arena_blk *blk;
+	struct stat_arena_blk *nxt;
+
+	if (sa == NULL)
+		return;
+	for (blk = sa->sa_blks; blk != NULL; blk = nxt) {
+		nxt = blk->sb_next;
+		free(blk);
+	}
+	free(sa);
+}
+
+/**
+ * @brief
+ *	-Find and unlink the live arena owning a reply.
+ *
+ * @param[in] bsp - head of a reply
+ *
+ * @return	struct stat_arena *
+ * @retval	the arena, now off the live list
+ * @retval	NULL if the reply was not decoded into an arena
+ */
+static struct stat_arena *
+stat_arena_unlink(struct batch_status *bsp)
+{
+	struct stat_arena **psa;
+	struct stat_arena *sa = NULL;
+
+	if (live_arenas == NULL)
+		return NULL;
+
+	pthread_mutex_lock(&stat_arena_lock);
+	for (psa = &live_arenas; *psa != NULL; psa = &(*psa)->sa_next) {
+		if ((*psa)->sa_head == bsp) {
+			sa = *psa;
+			*psa = sa->sa_next;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&stat_arena_lock);
+	return sa;
+}
+
 
 /**
  * @brief
@@ -60,6 +266,16 @@ pbs_statfree(struct batch_status *bsp)
 {
 	struct attrl        *atnxt;
 	struct batch_status *bsnxt;
+	struct stat_arena   *sa;
+
+	if (bsp == NULL)
+		return;
+
+	/* a reply decoded in arena mode goes all at once */
+	if ((sa = stat_arena_unlink(bsp)) != NULL) {
+		stat_arena_free(sa);
+		return;
+	}
 
 	while (bsp != (struct batch_status *)NULL) {
 		if (bsp->name != (char *)NULL)(void)free(bsp->name);
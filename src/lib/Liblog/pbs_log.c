@@ -40,6 +40,7 @@
  *
  * Functions included are:
  *	log_open()
+ *	log_jobindex_open()
  *	log_open_main()
  *	log_err()
  *	log_joberr()
@@ -57,6 +58,7 @@
 #include <sys/param.h>
 #include <sys/types.h>
 #include <limits.h>
+#include <ctype.h>
 #include <time.h>
 #include <fcntl.h>
 #include <stdio.h>
@@ -69,6 +71,7 @@
 #include "pbs_ifl.h"
 #include "pbs_internal.h"
 #include "pbs_version.h"
+#include "libutil.h"
 #if SYSLOG
 #include <syslog.h>
 #endif
@@ -100,6 +103,7 @@ char *msg_daemonname;
 static int	     log_auto_switch = 0;
 static int	     log_open_day;
 static FILE	    *logfile;		/* open stream for log file */
+static FILE	    *logjix;		/* job-ID sidecar index of logfile */
 static volatile int  log_opened = 0;
 #if SYSLOG
 static int	     syslogopen = 0;
@@ -350,6 +354,42 @@ log_open(char *filename, char *directory)
 	return (log_open_main(filename, directory, 0));
 }
 
+/**
+ * @brief
+ *	log_jobindex_open - open the job-ID sidecar index of a log file
+ *
+ * @par Functionality:
+ *	The index is <filename>.jix.  An open marker carrying the current
+ *	size of the log is appended so that a reader knows which part of
+ *	the log is covered by the records that follow.  Failure to open
+ *	the index is not fatal, the log is then simply not indexed.
+ *
+ * @param[in] filename - path of the log file just opened
+ * @param[in] fds - descriptor of the log file
+ *
+ * @return	void
+ */
+static void
+log_jobindex_open(char *filename, int fds)
+{
+	char	    ixname[_POSIX_PATH_MAX];
+	struct stat sb;
+
+	if (logjix != NULL) {
+		(void)fclose(logjix);
+		logjix = NULL;
+	}
+	if ((strlen(filename) + sizeof(JOBIX_SUFFIX)) > sizeof(ixname))
+		return;
+	snprintf(ixname, sizeof(ixname), "%s%s", filename, JOBIX_SUFFIX);
+	if (fstat(fds, &sb) == -1)
+		return;
+	if ((logjix = fopen(ixname, "ab")) == NULL)
+		return;
+	(void)setvbuf(logjix, NULL, _IONBF, 0);	/* each record one write */
+	(void)jobix_write(logjix, JOBIX_OPEN, (long long)sb.st_size);
+}
+
 /**
  *
  * @brief
@@ -455,6 +495,9 @@ log_open_main(char *filename, char *directory, int silent)
 #endif
 		log_opened = 1;			/* note that file is open */
 
+		if (pbs_conf.log_jobindex)
+			log_jobindex_open(filename, fds);
+
 		if (!silent) {
 			log_record(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_INFO, "Log", "Log opened");
 			snprintf(tbuf, LOG_BUF_SIZE, "pbs_version=%s", pbs_version);
@@ -774,6 +817,13 @@ log_record(int eventtype, int objclass, int sev, const char *objname, const char
 	}
 
 	if (pbs_conf.locallog != 0 || pbs_conf.syslogfac == 0) {
+		if ((logjix != NULL) && isdigit((int)*objname)) {
+			off_t off;
+
+			/* line buffered, so the end of file is where this line lands */
+			if ((off = lseek(fileno(logfile), (off_t)0, SEEK_END)) != (off_t)-1)
+				(void)jobix_write(logjix, jobix_hash((char *)objname), (long long)off);
+		}
 		rc = fprintf(logfile,
 			"%02d/%02d/%04d %02d:%02d:%02d;%04x;%s;%s;%s;%s\n",
 			ptm->tm_mon+1, ptm->tm_mday, ptm->tm_year+1900,
@@ -833,6 +883,14 @@ log_close(int msg)
 			log_record(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER,
 				LOG_INFO, "Log", "Log closed");
 		}
+		if (logjix != NULL) {
+			struct stat sb;
+
+			if (fstat(fileno(logfile), &sb) == 0)
+				(void)jobix_write(logjix, JOBIX_CLOSE, (long long)sb.st_size);
+			(void)fclose(logjix);
+			logjix = NULL;
+		}
 		(void)fclose(logfile);
 		log_opened = 0;
 	}
@@ -51,6 +51,7 @@
 #include	<sys/socket.h>
 #include	<sys/param.h>
 #include	<sys/time.h>
+#include	<time.h>
 #include	<netdb.h>
 #include	<netinet/in.h>
 #include	<arpa/inet.h>
@@ -84,6 +85,7 @@ static	int	full = 1;
 struct	out {
 	int	stream;
 	int	len;
+	int	ready;		/* waitreq() has seen the answer arrive */
 	struct	out	*next;
 };
 
@@ -114,6 +116,7 @@ addrm(int stream)
 	head = &outs[stream % HASHOUT];
 	op->stream = stream;
 	op->len = -1;
+	op->ready = 0;
 	op->next = *head;
 	*head = op;
 	return 0;
@@ -374,8 +377,19 @@ simpleget(int stream)
 
 #if RPP
 	fd_set selset;
-	
-	while(1) {
+	struct	out	*op;
+
+	/*
+	 * waitreq() has already taken the poll event for this stream,
+	 * so the answer is there to be read without waiting for it
+	 */
+	for (op=outs[stream % HASHOUT]; op; op=op->next) {
+		if (op->stream == stream)
+			break;
+	}
+	if (op != NULL && op->ready) {
+		op->ready = 0;
+	} else while(1) {
 		/* since tpp recvs are essentially allways non blocking
 		 * we can call a dis function only if we are sure we have
 		 * data on that rpp fd
@@ -759,6 +773,89 @@ flushreq()
 	return did;
 }
 
+/**
+ * @brief
+ *	Wait up to timeout seconds for an answer on any of the streams
+ *	opened with openrm().  Requests added with addreq() are sent first,
+ *	so a caller can have requests outstanding to many resource monitors
+ *	at once and read each answer with getreq() as it arrives.
+ *
+ * @param[in] timeout - the most seconds to wait, 0 to only poll
+ *
+ * @return	int
+ * @retval	stream	an answer can be read from this stream
+ * @retval	-2	no answer arrived in time
+ * @retval	-1	error, pbs_errno set
+ */
+int
+waitreq(int timeout)
+{
+	struct	out	*op;
+	int		i, num;
+	time_t		now, end;
+	struct	timeval	tv;
+	fd_set		fdset;
+
+	pbs_errno = 0;
+	flushreq();
+	end = time(NULL) + timeout;
+
+	for (;;) {
+#if	RPP
+		while ((i = rpp_poll()) >= 0) {
+			if ((op = findout(i)) != NULL) {
+				op->ready = 1;
+				return i;
+			}
+			/* not a stream we opened, nobody will read it */
+			close_dis(i);
+		}
+		if (i == -1) {
+			pbs_errno = errno;
+			return -1;
+		}
+		if ((now = time(NULL)) >= end)
+			return -2;
+		FD_ZERO(&fdset);
+		FD_SET(rpp_fd, &fdset);
+#else
+		FD_ZERO(&fdset);
+		num = 0;
+		for (i=0; i<HASHOUT; i++) {
+			for (op=outs[i]; op; op=op->next) {
+				if (op->len == -2) {
+					FD_SET(op->stream, &fdset);
+					num++;
+				}
+			}
+		}
+		if (num == 0)
+			return -2;
+		now = time(NULL);
+#endif
+		tv.tv_sec = (end > now) ? (end - now) : 0;
+		tv.tv_usec = 0;
+		num = select(FD_SETSIZE, &fdset, NULL, NULL, &tv);
+		if (num == -1) {
+			if (errno == EINTR)
+				continue;
+			pbs_errno = errno;
+			DBPRT(("%s: select %d\n", __func__, pbs_errno))
+			return -1;
+		}
+#if	!RPP
+		if (num == 0)
+			return -2;
+		for (i=0; i<HASHOUT; i++) {
+			for (op=outs[i]; op; op=op->next) {
+				if (op->len == -2 && FD_ISSET(op->stream, &fdset))
+					return op->stream;
+			}
+		}
+#endif
+	}
+}
+
 /**
  * @brief
  *	Return the stream number of the next stream with something
@@ -797,6 +894,7 @@ activereq()
 			bucket = i % HASHOUT;
 			op->stream = i;
 			op->len = -2;
+			op->ready = 0;
 			op->next = outs[bucket];
 			outs[bucket] = op;
 		}
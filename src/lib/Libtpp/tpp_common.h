@@ -130,14 +130,19 @@ typedef struct {
  * Packet structure used at various places to hold a data and the
  * current position to which data has been consumed or processed
  */
-typedef struct {
+typedef struct tpp_packet {
 	char *data;	/* pointer to the data buffer */
 	int len;	/* length of the data buffer */
 	char *pos;	/* current position - till which data is consumed */
 	void *extra_data;	/* any additional data */
 	int ref_count;	/* number of accessors */
+	struct tpp_packet *tail; /* shared packet sent after data, or NULL */
+	int tail_pos;	/* bytes of tail already sent on this connection */
 } tpp_packet_t;
 
+/* total number of bytes a packet puts on the wire, including its tail */
+#define TPP_PKT_WIRE_LEN(p)	((p)->len + ((p)->tail ? (p)->tail->len : 0))
+
 /*
  * Structure used to describe chunks of data to be sent to a gather-and-send
  * api "tpp_transport_vsend". Each chunk has this structure.
@@ -429,6 +434,9 @@ void tpp_terminate(void);
 int tpp_poll(void);
 char *tpp_parse_hostname(char *full, int *port);
 tpp_packet_t *tpp_cr_pkt(void *data, int len, int mk_data);
+tpp_packet_t *tpp_cr_shared_pkt(tpp_chunk_t *chunk, int count);
+void tpp_hold_shared_pkt(tpp_packet_t *pkt);
+void tpp_put_shared_pkt(tpp_packet_t *pkt);
 
 void tpp_router_shutdown(void);
 void tpp_router_terminate(void);
@@ -438,6 +446,7 @@ int tpp_transport_connect(char *hostname, int authtype, int delay, void *ctx, in
 int tpp_transport_vsend(int tfd, tpp_chunk_t *chunk, int count);
 int tpp_transport_isresvport(int tfd);
 int tpp_transport_vsend_extra(int tfd, tpp_chunk_t *chunk, int count, void *extra);
+int tpp_transport_vsend_shared(int tfd, tpp_chunk_t *chunk, int count, tpp_packet_t *shared);
 int tpp_transport_init(struct tpp_config *conf);
 void tpp_transport_set_handlers(
 	int (*pkt_presend_handler)(int phy_con, tpp_packet_t *pkt),
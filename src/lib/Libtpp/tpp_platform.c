@@ -374,6 +374,29 @@ tpp_sock_send(int s, const char *buf, int len, int flags)
 	return ret;
 }
 
+/*
+ * gather-write over tpp_sock_send(), since windows has no writev().
+ * Like writev(), returns the number of bytes sent, which is short if a
+ * send would block part way through
+ */
+int
+tpp_sock_writev(int s, const struct iovec *iov, int iovcnt)
+{
+	int total = 0;
+	int ret;
+	int i;
+
+	for (i = 0; i < iovcnt; i++) {
+		ret = tpp_sock_send(s, iov[i].iov_base, (int) iov[i].iov_len, 0);
+		if (ret == -1)
+			return (total > 0) ? total : -1;
+		total += ret;
+		if (ret < (int) iov[i].iov_len)
+			break;
+	}
+	return total;
+}
+
 /*
  * wrapper to call windows select() and map windows
  * error code to errno and massage the return value
@@ -52,6 +52,7 @@ extern "C" {
 
 #ifndef WIN32
 
+#include <sys/uio.h>
 
 #define tpp_pipe_cr(a)               pipe(a)
 #define tpp_pipe_read(a, b, c)         read(a, b, c)
@@ -65,6 +66,7 @@ extern "C" {
 #define tpp_sock_connect(a, b, c)      connect(a, b, c)
 #define tpp_sock_recv(a, b, c, d)       recv(a, b, c, d)
 #define tpp_sock_send(a, b, c, d)       send(a, b, c, d)
+#define tpp_sock_writev(a, b, c)       writev(a, b, c)
 #define tpp_sock_select(a, b, c, d, e)   select(a, b, c, d, e)
 #define tpp_sock_close(a)            close(a)
 #define tpp_sock_getsockopt(a, b, c, d, e)   getsockopt(a, b, c, d, e)
@@ -86,6 +88,11 @@ int tpp_sock_bind(int s, const struct sockaddr *name, int namelen);
 int tpp_sock_connect(int s, const struct sockaddr *name, int namelen);
 int tpp_sock_recv(int s, char *buf, int len, int flags);
 int tpp_sock_send(int s, const char *buf, int len, int flags);
+struct iovec {
+	void *iov_base;
+	size_t iov_len;
+};
+int tpp_sock_writev(int s, const struct iovec *iov, int iovcnt);
 int tpp_sock_select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds, const struct timeval *timeout);
 int tpp_sock_close(int s);
 int tpp_sock_getsockopt(int s, int level, int optname, int *optval, int *optlen);
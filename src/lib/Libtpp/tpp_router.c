@@ -333,6 +333,7 @@ broadcast_to_my_routers(tpp_chunk_t *chunks, int count, int origin_tfd)
 	int list[TPP_MAX_ROUTERS];
 	int max_cons = 0;
 	int i;
+	tpp_packet_t *shared = NULL;
 
 	pkey = tpp_avlkey_create(AVL_routers, NULL);
 	if (pkey == NULL) {
@@ -355,11 +356,20 @@ broadcast_to_my_routers(tpp_chunk_t *chunks, int count, int origin_tfd)
 
 	free(pkey);
 
+	/* copy the data once for all routers if there is more than one */
+	if (max_cons > 1)
+		shared = tpp_cr_shared_pkt(chunks, count);
+
 	for (i = 0; i < max_cons; i++) {
-		if (tpp_transport_vsend(list[i], chunks, count) != 0) {
+		if (shared)
+			rc = tpp_transport_vsend_shared(list[i], NULL, 0, shared);
+		else
+			rc = tpp_transport_vsend(list[i], chunks, count);
+		if (rc != 0) {
 			tpp_log_func(LOG_ERR, __func__, "send failed");
 		}
 	}
+	tpp_put_shared_pkt(shared);
 	return 0;
 }
 
@@ -400,6 +410,7 @@ broadcast_to_my_leaves(tpp_chunk_t *chunks, int count, int origin_tfd, int type)
 	int max_cons = 0;
 	int i;
 	AVL_IX_DESC *AVL_traverse_tree = NULL;
+	tpp_packet_t *shared = NULL;
 
 	if (type == 1)
 		AVL_traverse_tree = AVL_my_leaves_notify;
@@ -450,12 +461,21 @@ broadcast_to_my_leaves(tpp_chunk_t *chunks, int count, int origin_tfd, int type)
 	tpp_unlock(&router_lock);
 	free(pkey);
 
+	/* copy the data once for all leaves if there is more than one */
+	if (max_cons > 1)
+		shared = tpp_cr_shared_pkt(chunks, count);
+
 	for (i = 0; i < max_cons; i++) {
-		if (tpp_transport_vsend(list[i], chunks, count) != 0) {
+		if (shared)
+			rc = tpp_transport_vsend_shared(list[i], NULL, 0, shared);
+		else
+			rc = tpp_transport_vsend(list[i], chunks, count);
+		if (rc != 0) {
 			if (errno != ENOTCONN)
 				tpp_log_func(LOG_ERR, __func__, "send failed");
 		}
 	}
+	tpp_put_shared_pkt(shared);
 
 	free(list);
 	return 0;
@@ -1472,6 +1492,8 @@ router_pkt_handler(int tfd, void *data, int len, void *c)
 			unsigned int info_len = ntohl(mhdr->info_len);
 			tpp_chunk_t mchunks[1];
 			int already_sent;
+			tpp_packet_t *shared = NULL; /* payload shared by local leaves */
+			int rc;
 
 			if (cmprsd_len > 0) {
 				payload_len = len - sizeof(tpp_mcast_pkt_hdr_t) - cmprsd_len;
@@ -1563,9 +1585,21 @@ router_pkt_handler(int tfd, void *data, int len, void *c)
 
 					TPP_DBPRT(("Send mcast indiv packet to %s", tpp_netaddr(&shdr.dest_addr)));
 
-					if (tpp_transport_vsend(target_fd, chunks, 2) != 0) {
+					/*
+					 * every local leaf gets the same payload after its own
+					 * header, so copy the payload once and let each leaf's
+					 * packet refer to it
+					 */
+					if (shared == NULL && num_streams > 1)
+						shared = tpp_cr_shared_pkt(&chunks[1], 1);
+					if (shared)
+						rc = tpp_transport_vsend_shared(target_fd, chunks, 1, shared);
+					else
+						rc = tpp_transport_vsend(target_fd, chunks, 2);
+					if (rc != 0) {
 						tpp_log_func(LOG_ERR, __func__, "Failed to send mcast indiv pkt");
 						tpp_transport_close(target_fd);
+						tpp_put_shared_pkt(shared);
 						if (rlist)
 							free(rlist);
 						if (cmprsd_len > 0)
@@ -1579,6 +1613,7 @@ router_pkt_handler(int tfd, void *data, int len, void *c)
 						rsize = RLIST_INC;
 						rlist = malloc(sizeof(int) * rsize);
 						if (!rlist) {
+							tpp_put_shared_pkt(shared);
 							if (cmprsd_len > 0)
 								free(minfo_base);
 							snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Out of memory allocating pbs_comm list of %lu bytes",
@@ -1610,6 +1645,7 @@ router_pkt_handler(int tfd, void *data, int len, void *c)
 						tmp = realloc(rlist, sizeof(int) * (rsize + RLIST_INC));
 						if (!tmp) {
 							free(rlist);
+							tpp_put_shared_pkt(shared);
 							if (cmprsd_len > 0)
 								free(minfo_base);
 							snprintf(tpp_get_logbuf(), TPP_LOGBUF_SZ, "Out of memory resizing pbs_comm list to %lu bytes",
@@ -1638,6 +1674,8 @@ router_pkt_handler(int tfd, void *data, int len, void *c)
 			if (rlist)
 				free(rlist);
 
+			tpp_put_shared_pkt(shared);
+
 			tpp_log_func(LOG_INFO, NULL, "mcast done");
 
 			return 0;
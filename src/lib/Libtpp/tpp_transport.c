@@ -1061,6 +1061,67 @@ tpp_transport_vsend_extra(int tfd, tpp_chunk_t *chunk, int count, void *extra)
 	return 0;
 }
 
+/**
+ * @brief
+ *	Queue data to be sent out by the IO thread, followed by a shared
+ *	packet. The chunks (typically a small per-destination header) are
+ *	copied, the shared packet is not: the same shared packet can be
+ *	queued to any number of connections and is written out by each IO
+ *	thread straight from the one buffer.
+ *
+ * @param[in] tfd    - The file descriptor of the connection
+ * @param[in] chunk  - Array of chunks sent ahead of the shared data
+ * @param[in] count  - Number of chunks in the array of chunks
+ * @param[in] shared - Packet created by tpp_cr_shared_pkt
+ *
+ * @return  Error code
+ * @retval  -1 - Failure
+ * @retval   0 - Success
+ *
+ * @par Side Effects:
+ *	A reference on shared is held until the data has been sent
+ *
+ * @par MT-safe: No
+ *
+ */
+int
+tpp_transport_vsend_shared(int tfd, tpp_chunk_t *chunk, int count, tpp_packet_t *shared)
+{
+	tpp_packet_t *pkt;
+	int i;
+	int ntotlen;
+	int hdrlen = 0;
+
+	errno = 0;
+
+	for (i = 0; i < count; i++)
+		hdrlen += chunk[i].len;
+
+	pkt = tpp_cr_pkt(NULL, hdrlen + sizeof(int), 1);
+	if (!pkt)
+		return -1;
+
+	ntotlen = htonl(hdrlen + shared->len);
+	memcpy(pkt->pos, &ntotlen, sizeof(int));
+	pkt->pos = pkt->pos + sizeof(int);
+
+	for (i = 0; i < count; i++) {
+		memcpy(pkt->pos, chunk[i].data, chunk[i].len);
+		pkt->pos = pkt->pos + chunk[i].len;
+	}
+	pkt->pos = pkt->data;
+
+	tpp_hold_shared_pkt(shared);
+	pkt->tail = shared;
+
+	/* write to worker threads send pipe */
+	if (tpp_post_cmd(tfd, TPP_CMD_SEND, (void *) pkt) != 0) {
+		tpp_free_pkt(pkt);
+		return -1;
+	}
+	return 0;
+}
+
 /**
  * @brief
  *	Wrapper over tpp_transport_vsend_extra, calls tpp_transport_vsend_extra
@@ -1385,7 +1446,7 @@ handle_cmd(thrd_data_t *td, int tfd, int cmd, void *data)
 			tpp_log_func(LOG_CRIT, __func__, "Out of memory enqueing to send queue");
 			return;
 		}
-		conn->send_queue_size += pkt->len;
+		conn->send_queue_size += TPP_PKT_WIRE_LEN(pkt);
 
 		/* handle socket add calls */
 		send_data(conn);
@@ -1980,9 +2041,11 @@ send_data(phy_conn_t *conn)
 {
 	tpp_packet_t *p = NULL;
 	int tosend = 0;
+	int headlen;
 	int rc;
 	int can_send_more;
 	tpp_que_elem_t *n;
+	struct iovec iov[2];
 
 	/*
 	 * if a socket is still connecting, we will wait to send out data,
@@ -2000,8 +2063,9 @@ send_data(phy_conn_t *conn)
 	can_send_more = 1;
 
 	while (p && can_send_more) {
-		tosend = p->len - (p->pos - p->data);
-		if (p->pos == p->data) {
+		headlen = p->len - (p->pos - p->data);
+		tosend = headlen + (p->tail ? (p->tail->len - p->tail_pos) : 0);
+		if (p->pos == p->data && p->tail_pos == 0) {
 			if (the_pkt_presend_handler) {
 				if (the_pkt_presend_handler(conn->sock_fd, p) != 0) {
 					/* handler asked not to send data, skip packet */
@@ -2015,7 +2079,15 @@ send_data(phy_conn_t *conn)
 		}
 
 		while (tosend > 0) {
-			rc = tpp_sock_send(conn->sock_fd, p->pos, tosend, 0);
+			if (p->tail) {
+				/* own header and the shared data in one write */
+				iov[0].iov_base = p->pos;
+				iov[0].iov_len = headlen;
+				iov[1].iov_base = p->tail->data + p->tail_pos;
+				iov[1].iov_len = p->tail->len - p->tail_pos;
+				rc = tpp_sock_writev(conn->sock_fd, iov, 2);
+			} else
+				rc = tpp_sock_send(conn->sock_fd, p->pos, tosend, 0);
 			if (rc < 0) {
 				if (errno == EWOULDBLOCK || errno == EAGAIN) {
 					/* set this socket in POLLOUT */
@@ -2035,12 +2107,19 @@ send_data(phy_conn_t *conn)
 				break;
 			}
 			TPP_DBPRT(("tfd=%d, sending out %d bytes", conn->sock_fd, rc));
-			p->pos += rc;
 			tosend -= rc;
+			if (rc <= headlen) {
+				p->pos += rc;
+				headlen -= rc;
+			} else {
+				p->pos += headlen;
+				p->tail_pos += rc - headlen;
+				headlen = 0;
+			}
 		}
 
 		if (tosend == 0) {
-			conn->send_queue_size -= p->len;
+			conn->send_queue_size -= TPP_PKT_WIRE_LEN(p);
 
 			if (the_pkt_postsend_handler)
 				the_pkt_postsend_handler(conn->sock_fd, p);
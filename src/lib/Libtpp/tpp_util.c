@@ -90,6 +90,7 @@ long tpp_log_event_mask = 0;
 AVL_IX_DESC *AVL_addrcache = NULL;
 
 pthread_mutex_t addrcache_lock;       /* global lock for the cache tree */
+static pthread_mutex_t shared_pkt_lock = PTHREAD_MUTEX_INITIALIZER; /* ref counts of shared packets */
 
 struct cache_rec {
 	tpp_addr_t *addrs;
@@ -144,10 +145,98 @@ tpp_cr_pkt(void *data, int len, int mk_data)
 	pkt->extra_data = NULL;
 	pkt->len = len;
 	pkt->ref_count = 1;
+	pkt->tail = NULL;
+	pkt->tail_pos = 0;
 
 	return pkt;
 }
 
+/**
+ * @brief
+ *	Create a packet whose data is to be sent, without copying, to many
+ *	connections as the tail of per-connection packets
+ *	(see tpp_transport_vsend_shared).
+ *
+ * @param[in] - chunk - Array of chunks that make up the data
+ * @param[in] - count - Number of chunks in the array
+ *
+ * @return Newly allocated packet structure, with one reference held by
+ *	   the caller and released with tpp_put_shared_pkt
+ * @retval NULL - Failure (Out of memory)
+ *
+ * @par MT-safe: Yes
+ *
+ */
+tpp_packet_t *
+tpp_cr_shared_pkt(tpp_chunk_t *chunk, int count)
+{
+	tpp_packet_t *pkt;
+	int totlen = 0;
+	char *p;
+	int i;
+
+	for (i = 0; i < count; i++)
+		totlen += chunk[i].len;
+
+	if ((pkt = tpp_cr_pkt(NULL, totlen, 1)) == NULL)
+		return NULL;
+
+	for (i = 0, p = pkt->data; i < count; i++) {
+		memcpy(p, chunk[i].data, chunk[i].len);
+		p += chunk[i].len;
+	}
+	return pkt;
+}
+
+/**
+ * @brief
+ *	Take a reference on a shared packet. Shared packets are released by
+ *	the IO threads of several connections, so their reference count is
+ *	only changed under shared_pkt_lock.
+ *
+ * @param[in] - pkt - The shared packet
+ *
+ * @par MT-safe: Yes
+ *
+ */
+void
+tpp_hold_shared_pkt(tpp_packet_t *pkt)
+{
+	tpp_lock(&shared_pkt_lock);
+	pkt->ref_count++;
+	tpp_unlock(&shared_pkt_lock);
+}
+
+/**
+ * @brief
+ *	Drop a reference on a shared packet, freeing it with the last one
+ *
+ * @param[in] - pkt - The shared packet
+ *
+ * @par MT-safe: Yes
+ *
+ */
+void
+tpp_put_shared_pkt(tpp_packet_t *pkt)
+{
+	int refs;
+
+	if (pkt == NULL)
+		return;
+
+	tpp_lock(&shared_pkt_lock);
+	refs = --pkt->ref_count;
+	tpp_unlock(&shared_pkt_lock);
+
+	if (refs <= 0) {
+		if (pkt->data)
+			free(pkt->data);
+		if (pkt->extra_data)
+			free(pkt->extra_data);
+		free(pkt);
+	}
+}
+
 /**
  * @brief
  *	Free a packet structure
@@ -167,6 +256,8 @@ tpp_free_pkt(tpp_packet_t *pkt)
 		pkt->ref_count--;
 
 		if (pkt->ref_count <= 0) {
+			if (pkt->tail)
+				tpp_put_shared_pkt(pkt->tail);
 			if (pkt->data)
 				free(pkt->data);
 			if (pkt->extra_data)
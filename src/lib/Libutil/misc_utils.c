@@ -962,3 +962,362 @@ validate_ext_auth_data(int auth_type, void *data, int data_len, char *ebuf, int
 	return -1;
 }
 
+
+/**
+ * @brief
+ *	jobix_hash - hash a job id for the log sidecar index
+ *
+ * @par Functionality:
+ *	Only the sequence number part of the id (up to the first '.') is
+ *	hashed so that "123", "123.svr" and "123.svr.domain" all map to
+ *	the same value.  The values reserved for the open and close
+ *	markers are never returned.
+ *
+ * @param[in] jobid - job id or sequence number
+ *
+ * @return	unsigned int
+ * @retval	hash value, never JOBIX_OPEN or JOBIX_CLOSE
+ */
+unsigned int
+jobix_hash(char *jobid)
+{
+	unsigned int h = 5381;
+
+	while (*jobid != '\0' && *jobid != '.')
+		h = ((h << 5) + h) + (unsigned char)*jobid++;
+	h &= 0xffffffff;
+	if (h <= JOBIX_CLOSE)
+		h += JOBIX_CLOSE + 1;
+	return h;
+}
+
+/**
+ * @brief
+ *	jobix_write - append one record to a log sidecar index
+ *
+ * @param[in] fp   - index file
+ * @param[in] hash - job id hash or JOBIX_OPEN/JOBIX_CLOSE
+ * @param[in] off  - offset of the log line, or log size for a marker
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	-1	write error
+ */
+int
+jobix_write(FILE *fp, unsigned int hash, long long off)
+{
+	unsigned char rec[JOBIX_RECSZ];
+	int i;
+
+	for (i = 0; i < 4; i++)
+		rec[i] = (hash >> (8 * (3 - i))) & 0xff;
+	for (i = 0; i < 8; i++)
+		rec[4 + i] = (off >> (8 * (7 - i))) & 0xff;
+	if (fwrite(rec, JOBIX_RECSZ, 1, fp) != 1)
+		return -1;
+	return 0;
+}
+
+/**
+ * @brief
+ *	jobix_read - read the next record of a log sidecar index
+ *
+ * @param[in]  fp   - index file
+ * @param[out] hash - job id hash or JOBIX_OPEN/JOBIX_CLOSE
+ * @param[out] off  - offset of the log line, or log size for a marker
+ *
+ * @return	int
+ * @retval	0	record read
+ * @retval	-1	end of file or short (partially written) record
+ */
+int
+jobix_read(FILE *fp, unsigned int *hash, long long *off)
+{
+	unsigned char rec[JOBIX_RECSZ];
+	unsigned long long o = 0;
+	unsigned int h = 0;
+	int i;
+
+	if (fread(rec, JOBIX_RECSZ, 1, fp) != 1)
+		return -1;
+	for (i = 0; i < 4; i++)
+		h = (h << 8) | rec[i];
+	for (i = 0; i < 8; i++)
+		o = (o << 8) | rec[4 + i];
+	*hash = h;
+	*off = (long long)o;
+	return 0;
+}
+
+static char	*acctbin_buf = NULL;	/* record being built by acctbin_write */
+static size_t	 acctbin_bufsz = 0;
+
+/**
+ * @brief
+ *	acctbin_put - append a length prefixed, NUL terminated string to the
+ *	record being built by acctbin_write()
+ *
+ * @param[in,out] pos - offset in acctbin_buf, advanced past the string
+ * @param[in]     str - bytes to append
+ * @param[in]     len - number of bytes in str
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	-1	out of memory
+ */
+static int
+acctbin_put(size_t *pos, char *str, size_t len)
+{
+	size_t need = *pos + 4 + len + 1;
+	char *new;
+	int i;
+
+	if (need > acctbin_bufsz) {
+		need += 1024;
+		if ((new = realloc(acctbin_buf, need)) == NULL)
+			return -1;
+		acctbin_buf = new;
+		acctbin_bufsz = need;
+	}
+	for (i = 0; i < 4; i++)
+		acctbin_buf[*pos + i] = (len >> (8 * (3 - i))) & 0xff;
+	memcpy(acctbin_buf + *pos + 4, str, len);
+	acctbin_buf[*pos + 4 + len] = '\0';
+	*pos += 4 + len + 1;
+	return 0;
+}
+
+/**
+ * @brief
+ *	acctbin_write - append one record to a binary accounting stream
+ *
+ * @par Functionality:
+ *	The text of an accounting record is split into its name=value
+ *	fields.  A value quoted with " or ' (see cpy_quote_value() in the
+ *	server) is stored without the quotes.  A word without an '=' is
+ *	stored as a field with an empty name.  The record is written with a
+ *	single fwrite() so a reader never sees half of one.
+ *
+ * @param[in] fp   - binary accounting file
+ * @param[in] when - time of the record
+ * @param[in] type - record type
+ * @param[in] id   - record id
+ * @param[in] text - record text, may be NULL
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	-1	out of memory or write error
+ *
+ * @par MT-safe: No
+ */
+int
+acctbin_write(FILE *fp, time_t when, int type, char *id, char *text)
+{
+	size_t pos = 4 + 8 + 1 + 2;
+	long long t = (long long)when;
+	int nfld = 0;
+	char *name;
+	char *val;
+	size_t nlen;
+	size_t vlen;
+	char quote;
+	int i;
+
+	if (acctbin_put(&pos, id, strlen(id)) == -1)
+		return -1;
+
+	while ((text != NULL) && (*text != '\0') && (nfld < 0xffff)) {
+		while (*text == ' ')
+			text++;
+		if (*text == '\0')
+			break;
+		name = text;
+		while ((*text != '\0') && (*text != '=') && (*text != ' '))
+			text++;
+		if (*text == '=') {
+			nlen = text - name;
+			text++;
+			if ((*text == '"') || (*text == '\'')) {
+				quote = *text++;
+				val = text;
+				while ((*text != '\0') && (*text != quote))
+					text++;
+				vlen = text - val;
+				if (*text != '\0')
+					text++;
+			} else {
+				val = text;
+				while ((*text != '\0') && (*text != ' '))
+					text++;
+				vlen = text - val;
+			}
+		} else {
+			val = name;
+			vlen = text - name;
+			nlen = 0;
+		}
+		if ((acctbin_put(&pos, name, nlen) == -1) ||
+			(acctbin_put(&pos, val, vlen) == -1))
+			return -1;
+		nfld++;
+	}
+
+	for (i = 0; i < 4; i++)
+		acctbin_buf[i] = ((pos - 4) >> (8 * (3 - i))) & 0xff;
+	for (i = 0; i < 8; i++)
+		acctbin_buf[4 + i] = (t >> (8 * (7 - i))) & 0xff;
+	acctbin_buf[12] = type & 0xff;
+	acctbin_buf[13] = (nfld >> 8) & 0xff;
+	acctbin_buf[14] = nfld & 0xff;
+
+	if (fwrite(acctbin_buf, pos, 1, fp) != 1)
+		return -1;
+	return 0;
+}
+
+/**
+ * @brief
+ *	acctbin_get - take the next string out of a record body
+ *
+ * @param[in,out] pp  - current position, advanced past the string
+ * @param[in]     end - end of the record body
+ *
+ * @return	char *
+ * @retval	the string, pointing into the record body
+ * @retval	NULL	the body is malformed
+ */
+static char *
+acctbin_get(unsigned char **pp, unsigned char *end)
+{
+	unsigned char *p = *pp;
+	size_t len = 0;
+	int i;
+
+	if (end - p < 4)
+		return NULL;
+	for (i = 0; i < 4; i++)
+		len = (len << 8) | p[i];
+	p += 4;
+	if ((len >= (size_t)(end - p)) || (p[len] != '\0'))
+		return NULL;
+	*pp = p + len + 1;
+	return (char *)p;
+}
+
+/**
+ * @brief
+ *	acctbin_read - read the next record of a binary accounting stream
+ *
+ * @par Functionality:
+ *	The strings in rec point into a buffer owned by rec which is reused
+ *	by the next call.  rec must be zeroed before the first call and
+ *	released with acctbin_free().
+ *
+ * @param[in]     fp  - binary accounting file
+ * @param[in,out] rec - record to fill in
+ *
+ * @return	int
+ * @retval	0	record read
+ * @retval	1	end of file or short (partially written) record
+ * @retval	-1	malformed record or out of memory
+ */
+int
+acctbin_read(FILE *fp, acctbin_rec *rec)
+{
+	unsigned char hdr[4];
+	unsigned char *p;
+	unsigned char *end;
+	unsigned long long t = 0;
+	size_t len = 0;
+	int nfld;
+	int i;
+
+	if (fread(hdr, sizeof(hdr), 1, fp) != 1)
+		return 1;
+	for (i = 0; i < 4; i++)
+		len = (len << 8) | hdr[i];
+	if ((len < 8 + 1 + 2) || (len > ACCTBIN_MAXREC))
+		return -1;
+	if (len > rec->ab_bufsz) {
+		char *new;
+
+		if ((new = realloc(rec->ab_buf, len)) == NULL)
+			return -1;
+		rec->ab_buf = new;
+		rec->ab_bufsz = len;
+	}
+	if (fread(rec->ab_buf, len, 1, fp) != 1)
+		return 1;
+
+	p = (unsigned char *)rec->ab_buf;
+	end = p + len;
+	for (i = 0; i < 8; i++)
+		t = (t << 8) | p[i];
+	rec->ab_time = (long long)t;
+	rec->ab_type = p[8];
+	nfld = (p[9] << 8) | p[10];
+	p += 11;
+
+	if (nfld > rec->ab_fldsz) {
+		char **nn;
+		char **nv;
+
+		if ((nn = realloc(rec->ab_name, nfld * sizeof(char *))) == NULL)
+			return -1;
+		rec->ab_name = nn;
+		if ((nv = realloc(rec->ab_value, nfld * sizeof(char *))) == NULL)
+			return -1;
+		rec->ab_value = nv;
+		rec->ab_fldsz = nfld;
+	}
+
+	if ((rec->ab_id = acctbin_get(&p, end)) == NULL)
+		return -1;
+	for (i = 0; i < nfld; i++) {
+		if (((rec->ab_name[i] = acctbin_get(&p, end)) == NULL) ||
+			((rec->ab_value[i] = acctbin_get(&p, end)) == NULL))
+			return -1;
+	}
+	rec->ab_nfld = nfld;
+	return 0;
+}
+
+/**
+ * @brief
+ *	acctbin_value - find a field of a binary accounting record by name
+ *
+ * @param[in] rec  - record returned by acctbin_read()
+ * @param[in] name - field name, e.g. "resources_used.walltime"
+ *
+ * @return	char *
+ * @retval	value of the first field with that name
+ * @retval	NULL	no such field
+ */
+char *
+acctbin_value(acctbin_rec *rec, char *name)
+{
+	int i;
+
+	for (i = 0; i < rec->ab_nfld; i++) {
+		if (strcmp(rec->ab_name[i], name) == 0)
+			return rec->ab_value[i];
+	}
+	return NULL;
+}
+
+/**
+ * @brief
+ *	acctbin_free - release the buffers held by a binary accounting record
+ *
+ * @param[in,out] rec - record to clear
+ *
+ * @return	void
+ */
+void
+acctbin_free(acctbin_rec *rec)
+{
+	free(rec->ab_buf);
+	free(rec->ab_name);
+	free(rec->ab_value);
+	memset(rec, 0, sizeof(*rec));
+}
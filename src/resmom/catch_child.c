@@ -91,6 +91,8 @@ extern pbs_list_head	svr_alljobs;
 extern int		exiting_tasks;
 extern char		*msg_daemonname;
 extern int		svr_hook_resend_job_attrs;
+extern int		resc_update_full;
+extern int		resc_update_coalesce;
 #ifdef	WIN32
 extern char		*mom_home;
 #endif
@@ -456,11 +458,80 @@ update_ajob_status(job *pjob)
 	update_ajob_status_using_cmd(pjob, IS_RESCUSED);
 }
 
+/**
+ * @brief
+ * 	encode_used_delta - encode the resources used by a job which changed
+ *	since they were last sent to the server
+ *
+ *	The server merges the resources_used it is sent into what it has, so
+ *	unchanged values need not be sent again.  What is encoded now becomes
+ *	the job's record of what was last sent.
+ *
+ * @param[in] pjob - pointer to job structure
+ * @param[in] phead - list to which the changed entries are appended
+ * @param[in] full - if non-zero, append every entry
+ *
+ * @return int
+ * @retval number of entries appended
+ *
+ */
+
+static int
+encode_used_delta(job *pjob, pbs_list_head *phead, int full)
+{
+	pbs_list_head	 used;
+	svrattrl	*pal;
+	svrattrl	*psent;
+	svrattrl	*pnew;
+	int		 count = 0;
+
+	CLEAR_HEAD(used);
+	encode_used(pjob, &used);
+
+	for (pal = (svrattrl *)GET_NEXT(used); pal;
+		pal = (svrattrl *)GET_NEXT(pal->al_link)) {
+
+		if (!full) {
+			for (psent = (svrattrl *)GET_NEXT(pjob->ji_usedsent); psent;
+				psent = (svrattrl *)GET_NEXT(psent->al_link)) {
+				if ((psent->al_resc != NULL) && (pal->al_resc != NULL) &&
+					(strcmp(psent->al_resc, pal->al_resc) == 0))
+					break;
+			}
+			if (psent && (strcmp(psent->al_value, pal->al_value) == 0))
+				continue;	/* unchanged */
+		}
+
+		pnew = attrlist_create(pal->al_name, pal->al_resc, pal->al_valln);
+		if (pnew == NULL) {
+			log_err(errno, __func__, "no memory");
+			/* forget what was sent, next update sends it all */
+			free_attrlist(&used);
+			free_attrlist(&pjob->ji_usedsent);
+			return count;
+		}
+		memcpy(pnew->al_value, pal->al_value, pal->al_valln);
+		pnew->al_flags = pal->al_flags;
+		pnew->al_op = pal->al_op;
+		append_link(phead, &pnew->al_link, pnew);
+		count++;
+	}
+
+	free_attrlist(&pjob->ji_usedsent);
+	list_move(&used, &pjob->ji_usedsent);
+	return count;
+}
+
 /**
  * @brief
  * 	update_jobs_status - return the status of jobs to the server
  *
- *	Returns the updated resources_used for all running jobs.
+ *	Returns the updated resources_used for all running jobs, in one
+ *	message.  Unless this is one of the full updates ($resc_update_full),
+ *	only the resources which changed since the last update are sent and
+ *	jobs with none changed are left out.  With $resc_update_coalesce
+ *	set, updates are sent at most that often; the changes made in
+ *	between go together in the next one.
  *	The special listed attrbutes are not returned because they are only
  *	modified when a job is first started and that case is covered by
  *	update_ajob_status() above.
@@ -473,16 +544,33 @@ void
 update_jobs_status(void)
 {
 	int			count = 0;
+	int			full;
 	job			*pjob;
 	struct resc_used_update	*prused;
 	struct resc_used_update	*prusedtop = NULL;
 	struct resc_used_update	**prusednext;	/* keep jobs in order */
+	static int		since_full = 0;
+	static time_t		last_sent = 0;
+
+	/* hold the changes back until the coalescing window is over */
+	if ((resc_update_coalesce > 0) && !svr_hook_resend_job_attrs &&
+		(time_now < last_sent + resc_update_coalesce))
+		return;
+	last_sent = time_now;
 
 	/* pass user-client privilege to encode_resc() */
 
 	resc_access_perm = ATR_DFLAG_MGRD;
 	prusednext = &prusedtop;
 
+	/* after (re)connecting to the server everything is sent again */
+	if ((resc_update_full <= 1) || svr_hook_resend_job_attrs ||
+		(++since_full >= resc_update_full)) {
+		full = 1;
+		since_full = 0;
+	} else
+		full = 0;
+
 	for (pjob = (job *)GET_NEXT(svr_alljobs);
 		pjob; pjob = (job *)GET_NEXT(pjob->ji_alljobs)) {
 
@@ -491,7 +579,6 @@ update_jobs_status(void)
 		if (pjob->ji_qs.ji_substate != JOB_SUBSTATE_RUNNING)
 			continue;
 
-		++count;
 		/* allocate reply structure and fill in header portion */
 		prused = (struct resc_used_update *)
 			malloc(sizeof(struct resc_used_update));
@@ -505,17 +592,23 @@ update_jobs_status(void)
 			prused->ru_hop    = pjob->ji_wattr[(int)JOB_ATR_runcount].at_val.at_long;
 		}
 		CLEAR_HEAD(prused->ru_attr);
-		*prusednext	  = prused;	/* make last on list */
-		prused->ru_next   = NULL;	/* terminate list */
-		prusednext	  = &prused->ru_next;	/* track last link */
 
-		/* now append the session id and resources used */
+		/* the resources used, then if anything goes the session id */
+		if ((encode_used_delta(pjob, &prused->ru_attr, full) == 0) &&
+			!full) {
+			(void)free(prused);
+			continue;	/* nothing changed */
+		}
 		(void)job_attr_def[(int)JOB_ATR_session_id].at_encode(
 			&pjob->ji_wattr[(int)JOB_ATR_session_id],
 			&prused->ru_attr,
 			job_attr_def[(int)JOB_ATR_session_id].at_name,
 			NULL, ATR_ENCODE_CLIENT, NULL);
-		encode_used(pjob, &prused->ru_attr);
+
+		++count;
+		*prusednext	  = prused;	/* make last on list */
+		prused->ru_next   = NULL;	/* terminate list */
+		prusednext	  = &prused->ru_next;	/* track last link */
 
 		if (svr_hook_resend_job_attrs != 0) {
 			int		 index;
@@ -107,6 +107,7 @@ extern unsigned int	pbs_rm_port;
 extern int     mom_net_up;
 extern time_t  mom_net_up_time;
 extern int		max_poll_downtime_val;
+extern int		poll_fanout;
 
 char	task_fmt[] = "/%8.8X";
 
@@ -821,6 +822,31 @@ is_comm_up(int maturity_time)
 	return 0;
 }
 
+/**
+ * @brief
+ *	As Mother Superior, drop the usage my children in the poll tree
+ *	reported for their whole part of the tree.  Called as the job is
+ *	killed, since every sister then sends its own final usage, which
+ *	would otherwise be counted twice.
+ *
+ * @param[in] pjob - structure handle to job
+ *
+ * @return Void
+ *
+ */
+static void
+poll_tree_drop(job *pjob)
+{
+	int	i;
+
+	if (pjob->ji_resources == NULL)
+		return;
+	for (i = 0; i < pjob->ji_numnodes - 1; i++) {
+		if (pjob->ji_resources[i].nr_flags & NR_FLG_SUBTREE)
+			memset(&pjob->ji_resources[i], 0, sizeof(noderes));
+	}
+}
+
 /**
  * @brief
  *	Send a message (command = com) to all the other MOMs in
@@ -956,6 +982,10 @@ send_sisters(job *pjob, int com, pbs_jobndstm_t command_func)
 	tm_event_t	event;
 	char		*cookie;
 
+	/* every sister now sends its own final usage */
+	if (com == IM_KILL_JOB)
+		poll_tree_drop(pjob);
+
 	if (pbs_conf.pbs_use_mcast == 1)
 		return send_sisters_mcast(pjob, com, command_func);
 
@@ -1020,6 +1050,145 @@ send_sisters(job *pjob, int com, pbs_jobndstm_t command_func)
 	return num;
 }
 
+/**
+ * @brief
+ *	Return the number of nodes in the part of the poll tree of a job
+ *	starting at node "top".  In the tree node n polls the nodes
+ *	n*fanout+1 through n*fanout+fanout; Mother Superior is node 0.
+ *
+ * @param[in] top    - node at the top of the part of the tree
+ * @param[in] nnodes - number of nodes in the job
+ * @param[in] fanout - number of children of each node
+ *
+ * @return int
+ * @retval number of nodes, including "top"
+ *
+ */
+static int
+poll_subtree_size(int top, int nnodes, int fanout)
+{
+	long	lo = top;
+	long	hi = top;
+	int	size = 0;
+
+	while (lo < nnodes) {
+		size += ((hi < nnodes) ? hi : nnodes - 1) - lo + 1;
+		lo = lo * fanout + 1;
+		hi = hi * fanout + fanout;
+	}
+	return size;
+}
+
+/**
+ * @brief
+ *	Send IM_POLL_TREE to the children of this node in the poll tree
+ *	of the job.  Each child polls its own children in turn and replies
+ *	with the combined usage of its part of the tree, so a node only
+ *	ever exchanges messages with "fanout" others, and each of them a
+ *	fixed size.  A child which cannot be reached keeps counting with
+ *	the usage it last reported, as a sister does that MS cannot poll.
+ *
+ * @param[in] pjob   - structure handle to job
+ * @param[in] fanout - number of children of each node
+ *
+ * @return int
+ * @retval number of nodes below this one reached through its children
+ *
+ */
+static int
+poll_tree_children(job *pjob, int fanout)
+{
+	long		child, last;
+	int		num = 0;
+	int		ret;
+	hnodent		*np;
+	eventent	*ep;
+	char		*cookie;
+
+	cookie = pjob->ji_wattr[(int)JOB_ATR_Cookie].at_val.at_str;
+	child = (long)pjob->ji_nodeid * fanout + 1;
+	last = child + fanout - 1;
+	if (last >= pjob->ji_numnodes)
+		last = pjob->ji_numnodes - 1;
+
+	for (; child <= last; child++) {
+		np = &pjob->ji_hosts[child];
+
+		/* as in send_sisters(), MS marks the node until it is reached */
+		if ((pjob->ji_qs.ji_svrflags & JOB_SVFLG_HERE) &&
+			(pjob->ji_nodekill == TM_ERROR_NODE))
+			pjob->ji_nodekill = np->hn_node;
+
+		if (np->hn_sister != SISTER_OKAY)	/* sis is gone? */
+			continue;
+
+		/* a sister above MS has not talked to its children yet */
+		if (np->hn_stream == -1)
+			np->hn_stream = rpp_open(np->hn_host, np->hn_port);
+		if (np->hn_stream < 0) {
+			sprintf(log_buffer, "cannot open stream to %s",
+				np->hn_host);
+			log_joberr(-1, __func__, log_buffer,
+				pjob->ji_qs.ji_jobid);
+			continue;
+		}
+
+		ep = event_alloc(pjob, IM_POLL_TREE, -1, np,
+			TM_NULL_EVENT, TM_NULL_TASK);
+		ret = im_compose(np->hn_stream, pjob->ji_qs.ji_jobid,
+			cookie, IM_POLL_TREE, ep->ee_event, TM_NULL_TASK,
+			IM_OLD_PROTOCOL_VER);
+		if (ret == DIS_SUCCESS)
+			ret = diswsi(np->hn_stream, fanout);
+		if ((ret != DIS_SUCCESS) || (rpp_flush(np->hn_stream) == -1)) {
+			delete_link(&ep->ee_next);
+			free(ep);
+			continue;
+		}
+
+		if (pjob->ji_nodekill == np->hn_node)
+			pjob->ji_nodekill = TM_ERROR_NODE;
+		num += poll_subtree_size((int)child, pjob->ji_numnodes, fanout);
+	}
+	return num;
+}
+
+/**
+ * @brief
+ *	As Mother Superior, ask the other MOMs in the job for their resource
+ *	usage.  With $poll_fanout set and more sisters than that, the poll
+ *	goes down a tree of sisters and the usage comes back up it, summed
+ *	at each level; otherwise every sister is sent IM_POLL_JOB.  A job
+ *	keeps the fanout of its first poll.
+ *
+ * @param[in] pjob - structure handle to job
+ *
+ * @return int
+ * @retval num - number of sisters reached
+ * @retval 0   - Failure
+ *
+ */
+int
+send_sisters_poll(job *pjob)
+{
+	/* the usage held for the sisters depends on it, so keep it */
+	if (pjob->ji_numtree == 0) {
+		if ((poll_fanout < 2) || (pjob->ji_numnodes - 1 <= poll_fanout))
+			pjob->ji_numtree = 1;
+		else
+			pjob->ji_numtree = poll_fanout;
+	}
+	if (pjob->ji_numtree < 2)
+		return send_sisters(pjob, IM_POLL_JOB, NULL);
+
+	DBPRT(("send_sisters_poll: fanout %d\n", pjob->ji_numtree))
+	if (!(pjob->ji_wattr[(int)JOB_ATR_Cookie].at_flags & ATR_VFLAG_SET))
+		return 0;
+
+	return (poll_tree_children(pjob, pjob->ji_numtree));
+}
+
+
 #define	SEND_ERR(err) \
 if (reply) { \
 	(void)im_compose(stream, jobid, cookie, IM_ERROR, event, fromtask, IM_OLD_PROTOCOL_VER); \
@@ -1435,6 +1604,19 @@ node_bailout(job *pjob, hnodent *np)
 				pjob->ji_nodekill = np->hn_node;
 				break;
 
+			case	IM_POLL_TREE:
+				/*
+				 ** A child in the poll tree went away.  If I am MS
+				 ** treat it as for IM_POLL_JOB, an intermediate
+				 ** sister leaves it to MS, who has a stream to it.
+				 */
+				sprintf(log_buffer,
+					"POLL_TREE failed from node %d", np->hn_node);
+				log_joberr(-1, __func__, log_buffer, pjob->ji_qs.ji_jobid);
+				if (pjob->ji_qs.ji_svrflags & JOB_SVFLG_HERE)
+					pjob->ji_nodekill = np->hn_node;
+				break;
+
 			default:
 				sprintf(log_buffer,
 					"unknown command %d saved in event %d",
@@ -1655,6 +1837,43 @@ check_ms(int stream, job *pjob)
 	return FALSE;
 }
 
+/**
+ * @brief
+ *	Check that an IM_POLL_TREE request comes on a good port and that I
+ *	am a sister with a parent in the poll tree of the job.  When the
+ *	parent is node 0 this is check_ms().  The reply goes back on the
+ *	stream the request came in on, so the stream of an intermediate
+ *	parent is left as it is.
+ *
+ * @param[in] stream - file descriptor
+ * @param[in] pjob   - structure handle to job
+ * @param[in] parent - node number of my parent in the tree
+ *
+ * @return error code
+ * @retval TRUE  error
+ * @retval FALSE if okay
+ *
+ */
+static int
+check_tree_parent(int stream, job *pjob, int parent)
+{
+	if (parent == 0)
+		return (check_ms(stream, pjob));
+
+	if (check_ms(stream, NULL))	/* port check only */
+		return TRUE;
+
+	if ((pjob->ji_qs.ji_svrflags & JOB_SVFLG_HERE) ||
+		(parent >= pjob->ji_numnodes)) {
+		log_joberr(-1, __func__, "POLL_TREE from unexpected node",
+			pjob->ji_qs.ji_jobid);
+		rpp_eom(stream);
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
 /**
  * @brief
  *	return resource used by job
@@ -1690,6 +1909,98 @@ resc_used(job *pjob, char *name, u_long	(*func)(resource *))
 	return val;
 }
 
+/**
+ * @brief
+ *	Return the table in which a sister keeps the combined usage its
+ *	children in the poll tree last reported, one entry per child.  It
+ *	is (re)allocated when the fanout it was sized for changes.
+ *
+ * @param[in] pjob   - structure handle to job
+ * @param[in] fanout - number of children of each node
+ *
+ * @return treeres *
+ * @retval table indexed by child - (my node * fanout + 1)
+ * @retval NULL - no memory
+ *
+ */
+static treeres *
+poll_tree_res(job *pjob, int fanout)
+{
+	int	i;
+
+	if ((pjob->ji_treeres != NULL) && (pjob->ji_numtree == fanout))
+		return pjob->ji_treeres;
+
+	free(pjob->ji_treeres);
+	pjob->ji_numtree = 0;
+	pjob->ji_treeres = (treeres *)calloc(fanout, sizeof(treeres));
+	if (pjob->ji_treeres == NULL) {
+		log_err(errno, __func__, "no memory");
+		return NULL;
+	}
+	for (i = 0; i < fanout; i++)
+		pjob->ji_treeres[i].tr_nodekill = TM_ERROR_NODE;
+	pjob->ji_numtree = fanout;
+	return pjob->ji_treeres;
+}
+
+/**
+ * @brief
+ *	Write the combined usage of this node and of the nodes below it in
+ *	the poll tree, as last reported by its children, in reply to
+ *	IM_POLL_TREE.  The first node found wanting the job to die, if any,
+ *	goes up with it.
+ *
+ *	auxiliary info (
+ *		recommendation	int;	node wanting a kill, or -1
+ *		cput		u_long;
+ *		mem		u_long;
+ *		cpupercent	u_long;
+ *	)
+ *
+ * @param[in] pjob   - structure handle to job
+ * @param[in] stream - stream to my parent in the tree
+ *
+ * @return int
+ * @retval DIS_SUCCESS or DIS error
+ *
+ */
+static int
+send_poll_tree_usage(job *pjob, int stream)
+{
+	u_long		cput, mem, cpupercent;
+	tm_node_id	nodekill = TM_ERROR_NODE;
+	treeres		*tr;
+	int		i;
+	int		ret;
+
+	cput = resc_used(pjob, "cput", gettime);
+	mem = resc_used(pjob, "mem", getsize);
+	cpupercent = resc_used(pjob, "cpupercent", gettime);
+	if (pjob->ji_qs.ji_svrflags & (JOB_SVFLG_OVERLMT1|JOB_SVFLG_OVERLMT2))
+		nodekill = pjob->ji_nodeid;
+
+	for (i = 0; (pjob->ji_treeres != NULL) && (i < pjob->ji_numtree); i++) {
+		tr = &pjob->ji_treeres[i];
+		if (!tr->tr_valid)
+			continue;
+		cput += tr->tr_cput;
+		mem += tr->tr_mem;
+		cpupercent += tr->tr_cpupercent;
+		if (nodekill == TM_ERROR_NODE)
+			nodekill = tr->tr_nodekill;
+	}
+
+	ret = diswsi(stream, nodekill);
+	if (ret == DIS_SUCCESS)
+		ret = diswul(stream, cput);
+	if (ret == DIS_SUCCESS)
+		ret = diswul(stream, mem);
+	if (ret == DIS_SUCCESS)
+		ret = diswul(stream, cpupercent);
+	return ret;
+}
+
 /**
  * @brief
  *	Find named info for a task.
@@ -1933,6 +2244,8 @@ im_request(int stream, int version)
 	size_t			len;
 	tm_event_t		event, event_client = 0;
 	int			efd = -1;
+	int			fanout;
+	treeres			treenr;
 	pbs_list_head		lhead;
 	svrattrl		*psatl;
 	attribute_def		*pdef;
@@ -2984,6 +3297,42 @@ join_err:
 			ret = diswul(stream, resc_used(pjob, "cpupercent", gettime));
 			break;
 
+		case	IM_POLL_TREE:
+			/*
+			 ** Sender is my parent in the poll tree of the job,
+			 ** mom superior or a sister above me.  Pass the poll
+			 ** on to my children and send the combined usage of
+			 ** my part of the tree as I know it.  What my
+			 ** children report arrives after this reply and
+			 ** goes up with the next poll.
+			 **
+			 ** auxiliary info (
+			 **	fanout		int;
+			 ** )
+			 */
+			fanout = disrsi(stream, &ret);
+			BAIL("POLL_TREE fanout")
+			if ((fanout < 2) || (pjob->ji_nodeid <= 0) ||
+				(pjob->ji_nodeid >= pjob->ji_numnodes)) {
+				SEND_ERR(PBSE_BADSTATE)
+				break;
+			}
+			if (check_tree_parent(stream, pjob,
+				(pjob->ji_nodeid - 1) / fanout))
+				goto fini;
+			pjob->ji_polltime = time_now;
+			DBPRT(("%s: POLL_TREE %s fanout %d\n", __func__, jobid, fanout))
+			if (((long)pjob->ji_nodeid * fanout + 1 < pjob->ji_numnodes) &&
+				(poll_tree_res(pjob, fanout) != NULL))
+				(void)poll_tree_children(pjob, fanout);
+
+			ret = im_compose(stream, jobid, cookie, IM_ALL_OKAY,
+				event, fromtask, IM_OLD_PROTOCOL_VER);
+			if (ret != DIS_SUCCESS)
+				break;
+			ret = send_poll_tree_usage(pjob, stream);
+			break;
+
 		case	IM_SUSPEND:
 		case	IM_RESUME:
 			/*
@@ -3628,6 +3977,55 @@ join_err:
 						pjob->ji_nodekill = np->hn_node;
 					break;
 
+				case	IM_POLL_TREE:
+					/*
+					 ** One of my children in the poll tree is
+					 ** sending the combined usage of its part of
+					 ** the tree.  As MS, count it for the child;
+					 ** otherwise keep it to pass up with the
+					 ** next poll.
+					 **
+					 ** auxiliary info (
+					 **	recommendation	int;
+					 **	cput		u_long;
+					 **	mem		u_long;
+					 **	cpupercent	u_long;
+					 ** )
+					 */
+					index = disrsi(stream, &ret);
+					BAIL("OK-POLL_TREE recommendation")
+					treenr.tr_cput = disrul(stream, &ret);
+					BAIL("OK-POLL_TREE cput")
+					treenr.tr_mem = disrul(stream, &ret);
+					BAIL("OK-POLL_TREE mem")
+					treenr.tr_cpupercent = disrul(stream, &ret);
+					BAIL("OK-POLL_TREE cpupercent")
+
+					/* nodes below the child always number higher */
+					if ((index != TM_ERROR_NODE) &&
+						((index < nodeidx) || (index >= pjob->ji_numnodes)))
+						index = nodeidx;
+					treenr.tr_nodekill = index;
+					treenr.tr_valid = 1;
+					DBPRT(("%s: POLL_TREE %s OKAY from node %d kill %d cpu %lu mem %lu\n",
+						__func__, jobid, nodeidx, index,
+						treenr.tr_cput, treenr.tr_mem))
+
+					if (pjob->ji_qs.ji_svrflags & JOB_SVFLG_HERE) {
+						pjob->ji_resources[nodeidx-1].nr_cput = treenr.tr_cput;
+						pjob->ji_resources[nodeidx-1].nr_mem = treenr.tr_mem;
+						pjob->ji_resources[nodeidx-1].nr_cpupercent =
+							treenr.tr_cpupercent;
+						pjob->ji_resources[nodeidx-1].nr_flags = NR_FLG_SUBTREE;
+						if (index != TM_ERROR_NODE)
+							pjob->ji_nodekill = index;
+					} else if (pjob->ji_treeres != NULL) {
+						i = nodeidx - (pjob->ji_nodeid * pjob->ji_numtree + 1);
+						if ((i >= 0) && (i < pjob->ji_numtree))
+							pjob->ji_treeres[i] = treenr;
+					}
+					break;
+
 				default:
 					sprintf(log_buffer, "unknown request type %d saved",
 						event_com);
@@ -3853,6 +4251,29 @@ join_err:
 					pjob->ji_nodekill = np->hn_node;
 					break;
 
+				case	IM_POLL_TREE:
+					/*
+					 ** A child in the poll tree does not know the
+					 ** job.  MS handles it as a failed IM_POLL_JOB;
+					 ** a sister passes a kill recommendation for
+					 ** the node up with the next poll.
+					 */
+					sprintf(log_buffer, "POLL_TREE returned ERROR %d",
+						errcode);
+					log_joberr(-1, __func__, log_buffer, jobid);
+
+					if (pjob->ji_qs.ji_svrflags & JOB_SVFLG_HERE) {
+						np->hn_sister = errcode ? errcode : SISTER_BADPOLL;
+						pjob->ji_nodekill = np->hn_node;
+					} else if (pjob->ji_treeres != NULL) {
+						i = nodeidx - (pjob->ji_nodeid * pjob->ji_numtree + 1);
+						if ((i >= 0) && (i < pjob->ji_numtree)) {
+							pjob->ji_treeres[i].tr_valid = 1;
+							pjob->ji_treeres[i].tr_nodekill = nodeidx;
+						}
+					}
+					break;
+
 				default:
 					sprintf(log_buffer, "unknown command %d error",
 						event_com);
@@ -60,6 +60,9 @@
 #endif /* _POSIX_MEMLOCK */
 #include        <dirent.h>
 #endif	/* WIN32 */
+#ifdef	linux
+#include	<sys/inotify.h>
+#endif	/* linux */
 
 #include	<assert.h>
 #include	<stdio.h>
@@ -183,6 +186,14 @@ char		*cpuset_error_action = "offline";
 int		lockfds;
 float		max_load_val   = -1.0;
 int		max_poll_downtime_val = PBS_MAX_POLL_DOWNTIME;
+int		poll_fanout = 0;	/* 0: MS polls every sister itself */
+int		stage_concurrency = 1;	/* file pairs staged at once */
+int		deferred_cleanup = 0;	/* job dirs removed by background cleaner */
+int		deferred_cleanup_rate = 0;	/* cleaner removals a second, 0: no limit */
+int		pwd_cache_ttl = 0;	/* seconds job owner lookups are kept */
+int		resc_update_full = 10;	/* send all of resources_used every nth update */
+int		resc_update_coalesce = 0;	/* least seconds between usage updates */
+int		vnode_update_deltas = 0;	/* send only changed vnode attributes */
 char	       *mom_domain;
 char           *mom_home;
 char		mom_host[PBS_MAXHOSTNAME+1];
@@ -192,6 +203,11 @@ char		mom_short_name[PBS_MAXHOSTNAME+1];
 int		next_sample_time = MAX_CHECK_POLL_TIME;
 int		max_check_poll = MAX_CHECK_POLL_TIME;
 int		min_check_poll = MIN_CHECK_POLL_TIME;
+static int	next_limit_time = MAX_CHECK_POLL_TIME;	/* until a job nears a limit */
+#ifdef	linux
+char	       *cgroup_memory_events = NULL;	/* path of job memory.events */
+static int	memory_events_fd = -1;		/* inotify on memory.events */
+#endif	/* linux */
 int		inc_check_poll = 20;
 int		num_acpus = 1;
 int		num_pcpus = 1;
@@ -204,6 +220,7 @@ char	       *path_prolog;
 char	       *path_spool;
 char	       *path_undeliv;
 char	       *path_addconfigs;
+char	       *path_cleanup;
 char		path_addconfigs_reserved_prefix[] = "PBS";
 
 char	       *path_hooks;
@@ -464,6 +481,17 @@ static handler_ret_t	set_reject_root_scripts(char *);
 static handler_ret_t	set_report_hook_checksums(char *);
 static handler_ret_t	setmaxload(char *);
 static handler_ret_t	set_max_poll_downtime(char *);
+static handler_ret_t	set_poll_fanout(char *);
+static handler_ret_t	set_stage_concurrency(char *);
+static handler_ret_t	set_deferred_cleanup(char *);
+static handler_ret_t	set_deferred_cleanup_rate(char *);
+static handler_ret_t	set_pwd_cache_ttl(char *);
+#ifdef	linux
+static handler_ret_t	set_cgroup_memory_events(char *);
+#endif
+static handler_ret_t	set_resc_update_coalesce(char *);
+static handler_ret_t	set_resc_update_full(char *);
+static handler_ret_t	set_vnode_update_deltas(char *);
 #if	MOM_BGL
 static handler_ret_t	set_bgl_reserve_partitions(char *);
 #endif	/* MOM_BGL */
@@ -504,6 +532,9 @@ static struct	specials {
 #if	MOM_BGL
 	{ "bgl_reserve_partitions",	set_bgl_reserve_partitions },
 #endif	/* MOM_BGL */
+#ifdef	linux
+	{ "cgroup_memory_events",	set_cgroup_memory_events },
+#endif	/* linux */
 	{ "checkpoint_path",		set_checkpoint_path },
 #if	defined(__sgi)
 	{ "checkpoint_upgrade",		set_checkpoint_upgrade },
@@ -514,6 +545,8 @@ static struct	specials {
 #if	defined(MOM_CPUSET) && (CPUSET_VERSION >= 4)
 	{ "cpuset_error_action",	set_cpuset_error_action },
 #endif	/* MOM_CPUSET && CPUSET_VERSION >= 4 */
+	{ "deferred_cleanup",		set_deferred_cleanup },
+	{ "deferred_cleanup_rate",	set_deferred_cleanup_rate },
 	{ "enforce",			set_enforcement },
 	{ "ideal_load",			setidealload },
 	{ "jobdir_root",		set_jobdir_root },
@@ -527,8 +560,12 @@ static struct	specials {
 #ifdef	WIN32
 	{ "nrun_factor",		set_nrun_factor },
 #endif
+	{ "poll_fanout",		set_poll_fanout },
 	{ "port",			set_momport },
 	{ "prologalarm",		prologalarm },
+	{ "pwd_cache_ttl",		set_pwd_cache_ttl },
+	{ "resc_update_coalesce",	set_resc_update_coalesce },
+	{ "resc_update_full",		set_resc_update_full },
 	{ "restart_background",		set_restart_background },
 	{ "restart_transmogrify",	set_restart_transmogrify },
 	{ "restrict_user",		set_restrict_user },
@@ -541,8 +578,10 @@ static struct	specials {
 	 */
 	{ "spool_size",			set_spoolsize },
 #endif /* localmod 015 */
+	{ "stage_concurrency",		set_stage_concurrency },
 	{ "suspendsig",			set_suspend_signal },
 	{ "tmpdir",			set_tmpdir },
+	{ "vnode_update_deltas",	set_vnode_update_deltas },
 	{ "vnodedef_additive",		set_vnode_additive },
 	{ "usecp",			usecp },
 	{ "wallmult",			wallmult },
@@ -3425,6 +3464,201 @@ set_max_poll_downtime(char *value)
 	return HANDLER_SUCCESS;
 }
 
+/**
+ * process $poll_fanout directive in config file:
+ *	$poll_fanout 32
+ * As Mother Superior, poll the sisters of a job through a tree in which
+ * each node polls at most this many others and passes their usage up.
+ * 0 (the default) or 1 polls every sister directly.  All MoMs running
+ * the job must understand IM_POLL_TREE.
+ */
+static handler_ret_t
+set_poll_fanout(char *value)
+{
+	char *ebuf;
+	long  fanout;
+
+	log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER,
+		LOG_INFO, "poll_fanout", value);
+	fanout = strtol(value, &ebuf, 10);
+	if ((*ebuf != '\0') || (fanout < 0) || (fanout > INT_MAX))
+		return HANDLER_FAIL;	/* error */
+
+	poll_fanout = (int)fanout;
+	return HANDLER_SUCCESS;
+}
+
+/**
+ * process $stage_concurrency directive in config file:
+ *	$stage_concurrency 8
+ * Stage up to this many file pairs of a stagein or stageout request at
+ * the same time, each in its own process.  1 (the default) stages them
+ * one after the other.
+ */
+static handler_ret_t
+set_stage_concurrency(char *value)
+{
+	char *ebuf;
+	long  n;
+
+	log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER,
+		LOG_INFO, "stage_concurrency", value);
+	n = strtol(value, &ebuf, 10);
+	if ((*ebuf != '\0') || (n < 1) || (n > 256))
+		return HANDLER_FAIL;	/* error */
+
+	stage_concurrency = (int)n;
+	return HANDLER_SUCCESS;
+}
+
+/**
+ * process $deferred_cleanup directive in config file:
+ *	$deferred_cleanup true
+ * Queue the renamed staging and temporary directories of finished jobs
+ * in mom_priv/cleanup for a single low priority background process to
+ * remove, instead of forking an "rm -rf" for each one.
+ */
+static handler_ret_t
+set_deferred_cleanup(char *value)
+{
+	return (set_boolean(__func__, value, &deferred_cleanup));
+}
+
+/**
+ * process $deferred_cleanup_rate directive in config file:
+ *	$deferred_cleanup_rate 1000
+ * The background cleaner removes at most this many files and directories
+ * a second.  0 (the default) does not limit it.
+ */
+static handler_ret_t
+set_deferred_cleanup_rate(char *value)
+{
+	char *ebuf;
+	long  n;
+
+	log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER,
+		LOG_INFO, "deferred_cleanup_rate", value);
+	n = strtol(value, &ebuf, 10);
+	if ((*ebuf != '\0') || (n < 0) || (n > INT_MAX))
+		return HANDLER_FAIL;	/* error */
+
+	deferred_cleanup_rate = (int)n;
+	return HANDLER_SUCCESS;
+}
+
+/**
+ * process $pwd_cache_ttl directive in config file:
+ *	$pwd_cache_ttl 300
+ * Keep the password entry and group list of a job owner this many
+ * seconds, so that starting many jobs for the same user does not go to
+ * the name service for each one.  0 (the default) looks them up every
+ * time.
+ */
+static handler_ret_t
+set_pwd_cache_ttl(char *value)
+{
+	char *ebuf;
+	long  n;
+
+	log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER,
+		LOG_INFO, "pwd_cache_ttl", value);
+	n = strtol(value, &ebuf, 10);
+	if ((*ebuf != '\0') || (n < 0) || (n > INT_MAX))
+		return HANDLER_FAIL;	/* error */
+
+	pwd_cache_ttl = (int)n;
+	return HANDLER_SUCCESS;
+}
+
+#ifdef	linux
+/**
+ * process $cgroup_memory_events directive in config file:
+ *	$cgroup_memory_events /sys/fs/cgroup/pbspro/%s/memory.events
+ * Path of the cgroup v2 memory.events file of a job, "%s" standing for
+ * the job id.  MoM watches the file of each running job with inotify and
+ * checks the job against its limits as soon as the file changes, rather
+ * than at the next sample.
+ */
+static handler_ret_t
+set_cgroup_memory_events(char *value)
+{
+	char *pc;
+
+	log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER,
+		LOG_INFO, "cgroup_memory_events", value);
+	/* exactly one %s and no other conversion */
+	if (((pc = strchr(value, '%')) == NULL) || (pc[1] != 's') ||
+		(strchr(pc + 2, '%') != NULL))
+		return HANDLER_FAIL;	/* error */
+
+	if ((pc = strdup(value)) == NULL)
+		return HANDLER_FAIL;
+	free(cgroup_memory_events);
+	cgroup_memory_events = pc;
+	return HANDLER_SUCCESS;
+}
+#endif	/* linux */
+
+/**
+ * process $resc_update_coalesce directive in config file:
+ *	$resc_update_coalesce 60
+ * Send the resources_used of running jobs to the server at most once in
+ * this many seconds; changes sampled in between go in the next update.
+ * 0 (the default) sends an update after every sample.
+ */
+static handler_ret_t
+set_resc_update_coalesce(char *value)
+{
+	char *ebuf;
+	long  n;
+
+	log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER,
+		LOG_INFO, "resc_update_coalesce", value);
+	n = strtol(value, &ebuf, 10);
+	if ((*ebuf != '\0') || (n < 0) || (n > INT_MAX))
+		return HANDLER_FAIL;	/* error */
+
+	resc_update_coalesce = (int)n;
+	return HANDLER_SUCCESS;
+}
+
+/**
+ * process $resc_update_full directive in config file:
+ *	$resc_update_full 10
+ * Every nth periodic update sends the whole resources_used of each running
+ * job to the server; the ones in between send only the resources whose
+ * value changed and leave out jobs with nothing changed.  0 or 1 sends
+ * everything every time.
+ */
+static handler_ret_t
+set_resc_update_full(char *value)
+{
+	char *ebuf;
+	long  n;
+
+	log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER,
+		LOG_INFO, "resc_update_full", value);
+	n = strtol(value, &ebuf, 10);
+	if ((*ebuf != '\0') || (n < 0) || (n > INT_MAX))
+		return HANDLER_FAIL;	/* error */
+
+	resc_update_full = (int)n;
+	return HANDLER_SUCCESS;
+}
+
+/**
+ * process $vnode_update_deltas directive in config file:
+ *	$vnode_update_deltas true
+ * After the first full vnode list sent following a server HELLO, state
+ * updates carry only the vnode attributes that changed since the last one
+ * (IS_UPDATE2_DELTA).  Needs a server that understands that message.
+ */
+static handler_ret_t
+set_vnode_update_deltas(char *value)
+{
+	return (set_boolean(__func__, value, &vnode_update_deltas));
+}
+
 /**
  * @brief
  *	process $kbd_idle directive in config file:
@@ -6258,6 +6492,8 @@ finish_loop(time_t waittime)
 
 	if (waittime > next_sample_time)
 		waittime = next_sample_time;
+	if (waittime > next_limit_time)
+		waittime = next_limit_time;
 	DBPRT(("%s: waittime %lu\n", __func__, (unsigned long) waittime))
 
 	/* wait for a request to process */
@@ -7036,6 +7272,241 @@ mom_over_limit(job *pjob)
 	return (FALSE);
 }
 
+/**
+ * @brief
+ *	headroom_interval - how soon a job using "used" of a "limit" should
+ *	be sampled again.
+ *
+ * @par	Up to half the limit the job is sampled at the normal rate
+ *	(max_check_poll); from there the interval shrinks linearly to
+ *	min_check_poll at 90% of the limit.
+ *
+ * @param[in] used  - amount in use
+ * @param[in] limit - the limit, 0 if none
+ *
+ * @return	int - seconds
+ */
+static int
+headroom_interval(u_long used, u_long limit)
+{
+	double	frac;
+
+	if (limit == 0)
+		return (max_check_poll);
+	frac = (double)used / (double)limit;
+	if (frac <= 0.5)
+		return (max_check_poll);
+	if (frac >= 0.9)
+		return (min_check_poll);
+	return (min_check_poll +
+		(int)((max_check_poll - min_check_poll) * (0.9 - frac) / 0.4));
+}
+
+/**
+ * @brief
+ *	limit_headroom - the number of seconds before a running job could
+ *	next reach one of the limits mom_over_limit() enforces, or a cput
+ *	or walltime checkpoint, capped at max_check_poll.
+ *
+ * @par	Time based limits are exact: the job cannot reach its walltime
+ *	sooner than the wall clock gets there, nor its cput sooner than
+ *	all of its cpus running flat out would take.  For mem and vmem
+ *	the interval shrinks as the job gets closer to its limit, see
+ *	headroom_interval().
+ *
+ * @param[in] pjob - pointer to job, resources_used just updated
+ *
+ * @return	int - seconds, at least 1
+ */
+static int
+limit_headroom(job *pjob)
+{
+	int		headroom = max_check_poll;
+	int		t;
+	u_long		ncpus;
+	u_long		value, num;
+#if defined(__sgi) || defined(_AIX)
+	rlim64_t	llvalue, llnum;
+#else
+	u_long		llvalue, llnum;
+#endif
+	resource	*pres;
+	resource	*used;
+	attribute	*uattr = &pjob->ji_wattr[(int)JOB_ATR_resc_used];
+	resource_def	*rd;
+
+	ncpus = pjob->ji_hosts[pjob->ji_nodeid].hn_nrlimit.rl_ncpus;
+	if (ncpus == 0)
+		ncpus = 1;
+
+	llvalue = pjob->ji_hosts[pjob->ji_nodeid].hn_nrlimit.rl_vmem << 10;
+	if (llvalue != 0) {
+		rd = find_resc_def(svr_resc_def, "vmem", svr_resc_size);
+		used = find_resc_entry(uattr, rd);
+		if (local_getsize(used, &llnum) == PBSE_NONE) {
+			t = headroom_interval((u_long)(llnum >> 10),
+				(u_long)(llvalue >> 10));
+			headroom = MIN(headroom, t);
+		}
+	}
+
+	llvalue = pjob->ji_hosts[pjob->ji_nodeid].hn_nrlimit.rl_mem << 10;
+	if ((llvalue != 0) && enforce_mem) {
+		rd = find_resc_def(svr_resc_def, "mem", svr_resc_size);
+		used = find_resc_entry(uattr, rd);
+		if (local_getsize(used, &llnum) == PBSE_NONE) {
+			t = headroom_interval((u_long)(llnum >> 10),
+				(u_long)(llvalue >> 10));
+			headroom = MIN(headroom, t);
+		}
+	}
+
+	/* cput and walltime are job wide, checked on the MS only */
+	if ((pjob->ji_qs.ji_svrflags & JOB_SVFLG_HERE) != 0) {
+		pres = (resource *)
+			GET_NEXT(pjob->ji_wattr[(int)JOB_ATR_resource].at_val.at_list);
+		for (; pres != NULL; pres = (resource *)GET_NEXT(pres->rs_link)) {
+			if (strcmp(pres->rs_defin->rs_name, "cput") == 0) {
+				used = find_resc_entry(uattr, pres->rs_defin);
+				if ((local_gettime(pres, &value) != PBSE_NONE) ||
+					(local_gettime(used, &num) != PBSE_NONE))
+					continue;
+				t = (num >= value) ? 1 : (int)((value - num) / ncpus) + 1;
+				headroom = MIN(headroom, t);
+			} else if (strcmp(pres->rs_defin->rs_name, "walltime") == 0) {
+				if ((local_gettime(pres, &value) != PBSE_NONE) ||
+					(wallfactor <= 0.0))
+					continue;
+				num = (u_long)((double)(time_now -
+					pjob->ji_qs.ji_stime) * wallfactor);
+				t = (num >= value) ? 1 :
+					(int)((double)(value - num) / wallfactor) + 1;
+				headroom = MIN(headroom, t);
+			}
+		}
+	}
+
+	/* a checkpoint coming due on cput or walltime */
+	if ((pjob->ji_chkpttype == PBS_CHECKPOINT_CPUT) ||
+		(pjob->ji_chkpttype == PBS_CHECKPOINT_WALLT)) {
+		rd = find_resc_def(svr_resc_def,
+			pjob->ji_chkpttype == PBS_CHECKPOINT_CPUT ?
+			"cput" : "walltime", svr_resc_size);
+		used = find_resc_entry(uattr, rd);
+		if ((used != NULL) && (local_gettime(used, &num) == PBSE_NONE)) {
+			t = ((u_long)pjob->ji_chkptnext <= num) ? 1 :
+				(int)(pjob->ji_chkptnext - num);
+			headroom = MIN(headroom, t);
+		}
+	}
+
+	return (headroom < 1 ? 1 : headroom);
+}
+
+#ifdef	linux
+/**
+ * @brief
+ *	memory_event - read the memory.events notifications that have come in
+ *	on the inotify descriptor, and have the jobs they are for sampled,
+ *	and so checked against their limits, on the next time around the
+ *	main loop.
+ *
+ * @param[in] fd - the inotify descriptor
+ *
+ * @return void
+ */
+static void
+memory_event(int fd)
+{
+	char			buf[4096]
+		__attribute__ ((aligned(__alignof__(struct inotify_event))));
+	struct inotify_event	*ev;
+	ssize_t			len;
+	char			*p;
+	job			*pjob;
+
+	while ((len = read(fd, buf, sizeof(buf))) > 0) {
+		for (p = buf; p < buf + len;
+			p += sizeof(struct inotify_event) + ev->len) {
+			ev = (struct inotify_event *)p;
+			for (pjob = (job *)GET_NEXT(svr_alljobs); pjob;
+				pjob = (job *)GET_NEXT(pjob->ji_alljobs)) {
+				if (pjob->ji_memwatch == ev->wd)
+					break;
+			}
+			if (pjob == NULL)
+				continue;
+			if (ev->mask & IN_IGNORED) {
+				/* the cgroup has gone */
+				pjob->ji_memwatch = 0;
+				continue;
+			}
+			log_event(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB, LOG_DEBUG,
+				pjob->ji_qs.ji_jobid, "memory event");
+			pjob->ji_polldue = 0;
+			next_limit_time = 0;
+		}
+	}
+}
+
+/**
+ * @brief
+ *	memory_watch - start watching the memory.events file of a job's
+ *	cgroup, see $cgroup_memory_events.  The cgroup may not exist yet,
+ *	in which case this is tried again on the next sample.
+ *
+ * @param[in] pjob - running job
+ *
+ * @return void
+ */
+static void
+memory_watch(job *pjob)
+{
+	char	path[MAXPATHLEN+1];
+	int	wd;
+
+	if (memory_events_fd == -1) {
+		memory_events_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (memory_events_fd == -1) {
+			log_err(errno, __func__, "inotify_init1");
+			free(cgroup_memory_events);
+			cgroup_memory_events = NULL;	/* don't keep trying */
+			return;
+		}
+		if (add_conn(memory_events_fd, ChildPipe, (pbs_net_t)0, 0,
+			memory_event) == -1) {
+			log_err(-1, __func__, "connection table is full");
+			(void)close(memory_events_fd);
+			memory_events_fd = -1;
+			return;
+		}
+	}
+
+	snprintf(path, sizeof(path), cgroup_memory_events, pjob->ji_qs.ji_jobid);
+	if ((wd = inotify_add_watch(memory_events_fd, path, IN_MODIFY)) != -1)
+		pjob->ji_memwatch = wd;
+}
+
+/**
+ * @brief
+ *	memory_unwatch - stop watching the memory.events of a job that is
+ *	no longer running.  Also called from job_purge(), so the watch
+ *	descriptor of a job that is purged while it is being watched is not
+ *	left behind.
+ *
+ * @param[in] pjob - the job
+ *
+ * @return void
+ */
+void
+memory_unwatch(job *pjob)
+{
+	if ((memory_events_fd != -1) && (pjob->ji_memwatch != 0))
+		(void)inotify_rm_watch(memory_events_fd, pjob->ji_memwatch);
+	pjob->ji_memwatch = 0;
+}
+#endif	/* linux */
+
 /**
  * @brief
  *	check attr value limits of job
@@ -7895,6 +8366,7 @@ main(int argc, char *argv[])
 	double			myla;
 	job			*nxpjob;
 	job			*pjob;
+	int			headroom;
 	extern time_t		wait_time;
 	time_t			getkbdtime();
 	void			activate_jobs();
@@ -8343,6 +8815,8 @@ main(int argc, char *argv[])
 	for (i = 0; i < (svr_resc_size - 1); ++i)
 		svr_resc_def[i].rs_next = &svr_resc_def[i+1];
 	/* last entry is left with null pointer */
+	(void)build_resc_def_index(svr_resc_def, svr_resc_size);
+	(void)build_attr_index(job_attr_def, JOB_ATR_LAST);
 
 
 	/* set up and validate home paths    */
@@ -8363,6 +8837,7 @@ main(int argc, char *argv[])
 	path_spool = mk_dirs("spool/");
 	path_undeliv = mk_dirs("undelivered/");
 	path_addconfigs = mk_dirs("mom_priv/config.d");
+	path_cleanup = mk_dirs("mom_priv/cleanup");
 
 	/* open log file while std in,out,err still open, forces to fd 4 */
 #ifdef	WIN32
@@ -9195,6 +9670,11 @@ main(int argc, char *argv[])
 	/* recover & abort Jobs which were under MOM's control */
 	init_abort_jobs(recover);
 
+#ifndef	WIN32
+	/* finish removing directories queued before we went down */
+	cleanup_start();
+#endif
+
 	/*
 	 * deploy periodic hooks
 	 *
@@ -9427,8 +9907,10 @@ main(int argc, char *argv[])
 		 * everything from here on in the main loop.
 		 */
 
-		if (time_now < (time_resc_updated + next_sample_time))
+		if (time_now < (time_resc_updated +
+			MIN(next_sample_time, next_limit_time)))
 			continue;
+		next_limit_time = max_check_poll;	/* set again below */
 
 		/*
 		 * time to next resources check is set to MIN when new job run
@@ -9523,12 +10005,33 @@ main(int argc, char *argv[])
 			if (pbs_conf.pbs_use_tcp == 0)
 				(void)rpp_io();
 
-			if (pjob->ji_qs.ji_substate != JOB_SUBSTATE_RUNNING)
+			if (pjob->ji_qs.ji_substate != JOB_SUBSTATE_RUNNING) {
+#ifdef	linux
+				if (pjob->ji_memwatch != 0)
+					memory_unwatch(pjob);
+#endif	/* linux */
+				continue;
+			}
+
+			/* jobs well clear of their limits are sampled less often */
+			if (time_now < pjob->ji_polldue) {
+				if (pjob->ji_polldue - time_now < next_limit_time)
+					next_limit_time = pjob->ji_polldue - time_now;
 				continue;
+			}
 
 			/* update information for my tasks */
 			(void)mom_set_use(pjob);
 
+			headroom = limit_headroom(pjob);
+			pjob->ji_polldue = time_now + MIN(headroom, next_sample_time);
+			if (headroom < next_limit_time)
+				next_limit_time = headroom;
+#ifdef	linux
+			if ((cgroup_memory_events != NULL) && (pjob->ji_memwatch == 0))
+				memory_watch(pjob);
+#endif	/* linux */
+
 			/* see if need to check point any job */
 			if (pjob->ji_chkpttype==PBS_CHECKPOINT_CPUT) {
 				/* checkpoint on cputime used */
@@ -9599,7 +10102,7 @@ main(int argc, char *argv[])
 					 ** If can't send poll to everybody, the
 					 ** time has come to die.
 					 */
-					if (send_sisters(pjob, IM_POLL_JOB, NULL) !=
+					if (send_sisters_poll(pjob) !=
 						pjob->ji_numnodes-1) {
 						log_event(PBSEVENT_JOB|PBSEVENT_FORCE,
 							PBS_EVENTCLASS_JOB, LOG_INFO,
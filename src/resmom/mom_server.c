@@ -128,6 +128,10 @@ extern void	mom_vnlp_report(vnl_t *vnl, char *header);
 extern	char	*path_hooks;
 extern	unsigned long	hooks_rescdef_checksum;
 extern	int	report_hook_checksums;
+extern	int	vnode_update_deltas;
+
+static	vnl_t	*vnl_sent = NULL;	/* vnode list as the server has it */
+static	long	vnl_sent_seq = 0;	/* deltas sent since the full list */
 
 #ifdef	PBS_CRED_GRIDPROXY
 gss_ctx_id_t		svr_context = GSS_C_NO_CONTEXT;
@@ -928,6 +932,9 @@ is_request(int stream, int version)
 			 */
 			server_stream = stream;		/* save stream to server */
 			next_sample_time = min_check_poll;
+			/* the server wants the whole vnode list again */
+			vnl_free(vnl_sent);
+			vnl_sent = NULL;
 			reply_hello4(stream);
 			internal_state_update = UPDATE_MOM_STATE;
 			state_to_server();
@@ -1423,13 +1430,58 @@ hook_requests_to_server_err:
 	return (ret);
 }
 
+/**
+ * @brief
+ *	vnl_sent_update - record what the server now holds of the vnode list
+ *	after a successful IS_UPDATE2 or IS_UPDATE2_DELTA.
+ *
+ * @param[in] delta - the changes just sent, NULL if the whole list was
+ *
+ * @return Void
+ *
+ */
+static void
+vnl_sent_update(vnl_t *delta)
+{
+	if (!vnode_update_deltas) {
+		vnl_free(vnl_sent);
+		vnl_sent = NULL;
+		return;
+	}
+
+	if (delta != NULL) {
+		vnl_sent_seq++;
+		if (vn_merge(vnl_sent, delta, NULL) != NULL) {
+			vnl_sent->vnl_modtime = vnlp->vnl_modtime;
+			return;
+		}
+	} else {
+		vnl_sent_seq = 0;
+		vnl_free(vnl_sent);
+		vnl_sent = NULL;
+		if ((vnl_alloc(&vnl_sent) != NULL) &&
+			(vn_merge(vnl_sent, vnlp, NULL) != NULL)) {
+			vnl_sent->vnl_modtime = vnlp->vnl_modtime;
+			return;
+		}
+	}
+
+	/* out of memory, the next update sends the whole list */
+	log_err(errno, __func__, "unable to copy vnode list");
+	vnl_free(vnl_sent);
+	vnl_sent = NULL;
+}
+
 /**
  * @brief
  * 	state_to_server() - if UPDATE_MOM_STATE is set, send state update message to
  *	the server.
  *
  *	If we have placement set information to send, we use IS_UPDATE2;
- *	otherwise, we fall back to IS_UPDATE.
+ *	otherwise, we fall back to IS_UPDATE.  With $vnode_update_deltas,
+ *	once the server has the whole list, IS_UPDATE2_DELTA carries only
+ *	the vnode attributes changed since, or IS_UPDATE2 again if any were
+ *	dropped.
  *
  * @return Void
  *
@@ -1441,6 +1493,7 @@ state_to_server(void)
 	int			use_UPDATE2;
 	extern const char *dis_emsg[];
 	extern vnl_t		*vnlp;				/* vnode list */
+	vnl_t			*delta = NULL;
 	char			*pv;
 
 	if (internal_state_update == 0)
@@ -1465,7 +1518,12 @@ state_to_server(void)
 	else
 		use_UPDATE2 = 0;
 
-	if (use_UPDATE2)
+	if (use_UPDATE2 && vnode_update_deltas && (vnl_sent != NULL))
+		delta = vn_delta(vnl_sent, vnlp);	/* NULL: send it all */
+
+	if (delta != NULL)
+		ret = is_compose(server_stream, IS_UPDATE2_DELTA);
+	else if (use_UPDATE2)
 		ret = is_compose(server_stream, IS_UPDATE2);
 	else
 		ret = is_compose(server_stream, IS_UPDATE);
@@ -1495,7 +1553,26 @@ state_to_server(void)
 
 	if (ret != DIS_SUCCESS)
 		goto err;
-	if (use_UPDATE2) {
+	if (delta != NULL) {
+		/*
+		 * The number of deltas sent since the full list lets the
+		 * server tell whether it holds the list these apply to.
+		 */
+		ret = diswsl(server_stream, vnl_sent_seq);
+		if (ret != DIS_SUCCESS)
+			goto err;
+		ret = diswsl(server_stream, (long)vnlp->vnl_modtime);
+		if (ret != DIS_SUCCESS)
+			goto err;
+		ret = diswui(server_stream, delta->vnl_used);
+		if (ret != DIS_SUCCESS)
+			goto err;
+		if (delta->vnl_used > 0) {
+			ret = vn_encode_DIS(server_stream, delta);
+			if (ret != DIS_SUCCESS)
+				goto err;
+		}
+	} else if (use_UPDATE2) {
 #ifdef	MOM_ALPS
 		/*
 		 * This is a clumsy workaround for a problem with the reporting
@@ -1529,10 +1606,16 @@ state_to_server(void)
 
 	rpp_flush(server_stream);
 	internal_state_update = 0;
+	if (use_UPDATE2)
+		vnl_sent_update(delta);
+	vnl_free(delta);
 	return;
 
 err:
 	log_err(errno, "state_to_server", (char *)dis_emsg[ret]);
+	vnl_free(delta);
+	vnl_free(vnl_sent);
+	vnl_sent = NULL;
 	rpp_close(server_stream);
 	server_stream = -1;
 }
@@ -3123,10 +3123,7 @@ req_cpyfile(struct batch_request *preq)
 	gid_t			usergid = 0;
 	int			rc;
 	pid_t			pid;
-	struct rqfpair		*pair;
-	int			rmtflag;
 	cpy_files	stage_inout;
-	char			*prmt;
 	char                    dup_rqcpf_jobid[PBS_MAXSVRJOBID+1];
 	struct work_task *wtask = NULL;
 	DBPRT(("%s: entered\n", __func__))
@@ -3244,36 +3241,13 @@ req_cpyfile(struct batch_request *preq)
 	/*
 	 * Child process ...
 	 * Now running in the user's home or job staging and execution directory as the user.
-	 * Build up cp/rcp command(s), one per file pair
+	 * Build up cp/rcp command(s), one per file pair, see stage_pairs()
 	 */
 
 	copy_start = time(0);
-	for (pair=(struct rqfpair *)GET_NEXT(rqcpf->rq_pair);
-		pair != 0;
-		pair = (struct rqfpair *)GET_NEXT(pair->fp_link)) {
-		DBPRT(("%s: local %s remote %s\n", __func__, pair->fp_local, pair->fp_rmt))
-
-		stage_inout.from_spool = 0;
-		prmt = pair->fp_rmt;
-		num_copies++;
-
-		if (local_or_remote(&prmt) == 0) {
-			/* destination host is this host, use cp */
-			rmtflag = 0;
-		} else {
-			/* destination host is another, use (pbs_)rcp */
-			rmtflag = 1;
-		}
-
-		rc = stage_file(dir, rmtflag, rqcpf->rq_owner,
-			pair, preq->rq_conn, &stage_inout, prmt);
-		/*
-		 ** Here we break out of the the loop on error.
-		 ** This will only happen on a stagein failure.
-		 */
-		if (rc != 0)
-			break;
-	}
+	rc = stage_pairs(dir, rqcpf->rq_owner,
+		(struct rqfpair *)GET_NEXT(rqcpf->rq_pair),
+		preq->rq_conn, &stage_inout, &num_copies);
 	copy_stop = time(0);
 
 	/* If there was a stage in failure, remove the job directory.
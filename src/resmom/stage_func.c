@@ -51,7 +51,14 @@
 #include "win.h"
 #else
 #include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/select.h>
 #include <dirent.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#endif
 #include "rpp.h"
 #endif
 #include "pbs_ifl.h"
@@ -63,6 +70,7 @@
 #include "batch_request.h"
 #include "pbs_nodes.h"
 #include "mom_func.h"
+#include "work_task.h"
 
 extern char *path_spool;			/* path to spool directory */
 extern char *path_undeliv;			/* path to undelivered directory */
@@ -78,6 +86,10 @@ extern char *argv[BUF_SIZE];		/* lots of args */
 extern int argc;
 extern int cred_pipe;
 extern char *pwd_buf;
+extern int stage_concurrency;
+extern int deferred_cleanup;
+extern int deferred_cleanup_rate;
+extern char *path_cleanup;
 #endif
 extern char mom_host[PBS_MAXHOSTNAME+1];	/* MoM host name */
 
@@ -780,6 +792,34 @@ copy_file(int dir, int rmtflag, char *owner, char *src, struct rqfpair *pair, in
 	return rc;
 }
 
+/**
+ * @brief
+ *	remove_staged_files - delete the files staged in so far after a
+ *	stagein failure.
+ *
+ * @param[in/out]	stage_inout	-	pointer to cpy_files struct
+ *
+ * @return	void
+ *
+ */
+static void
+remove_staged_files(cpy_files *stage_inout)
+{
+	int i;
+
+	/* delete all the files in the list */
+	for (i=0; i<stage_inout->file_num; i++) {
+		DBPRT(("%s: delete %s\n", __func__, stage_inout->file_list[i]))
+		if (remtree(stage_inout->file_list[i]) != 0 && errno != ENOENT) {
+			char	temp[80 + MAXPATHLEN];
+
+			sprintf(temp, msg_err_unlink, "stage in", stage_inout->file_list[i]);
+			log_err(errno, "req_cpyfile", temp);
+			add_bad_list(&(stage_inout->bad_list), temp, 2);
+		}
+	}
+}
+
 /**
  * @brief	
  *	stage_file - Handle file stage pair. The source could have a wildcard
@@ -804,7 +844,6 @@ int
 stage_file(int dir, int	rmtflag, char *owner, struct rqfpair *pair, int conn, cpy_files *stage_inout, char *prmt)
 {
 	char *ps = NULL;
-	int i = 0;
 	int rc = 0;
 	int len = 0;
 	char dname[MAXPATHLEN+1] = {'\0'};
@@ -969,19 +1008,317 @@ stage_file(int dir, int	rmtflag, char *owner, struct rqfpair *pair, int conn, cp
 	return 0;
 
 error:
-	/* delete all the files in the list */
-	for (i=0; i<stage_inout->file_num; i++) {
-		DBPRT(("%s: delete %s\n", __func__, stage_inout->file_list[i]))
-		if (remtree(stage_inout->file_list[i]) != 0 && errno != ENOENT) {
-			char	temp[80 + MAXPATHLEN];
+	remove_staged_files(stage_inout);
+	return rc;
+}
 
-			sprintf(temp, msg_err_unlink, "stage in", stage_inout->file_list[i]);
-			log_err(errno, "req_cpyfile", temp);
-			add_bad_list(&(stage_inout->bad_list), temp, 2);
+#ifndef WIN32
+/*
+ * What a staging child of stage_pairs() reports about its file pair:
+ * this header, then the nfiles NUL terminated names of the files it
+ * staged in, then badlen bytes of bad file messages.
+ */
+struct stage_result {
+	int	rc;			/* return of stage_file() */
+	int	bad_files;
+	int	stageout_failed;
+	int	nfiles;
+	int	badlen;
+};
+
+/*
+ * A staging child of stage_pairs() and what it has reported so far
+ */
+struct stage_child {
+	pid_t	pid;
+	int	fd;			/* read end of the child's report */
+	char	*local;			/* pair->fp_local, for messages */
+	char	*buf;
+	size_t	len;
+	size_t	size;
+};
+
+/**
+ * @brief
+ *	write_stage_result - report the result of staging one file pair to
+ *	the parent stage_pairs().
+ *
+ * @param[in]	fd		-	write end of the report pipe
+ * @param[in]	rc		-	return of stage_file()
+ * @param[in]	stage_inout	-	the child's staging state
+ *
+ * @return	void
+ *
+ */
+static void
+write_stage_result(int fd, int rc, cpy_files *stage_inout)
+{
+	struct stage_result sr;
+	int i;
+
+	sr.rc = rc;
+	sr.bad_files = stage_inout->bad_files;
+	sr.stageout_failed = stage_inout->stageout_failed;
+	sr.nfiles = stage_inout->file_num;
+	sr.badlen = stage_inout->bad_list ? strlen(stage_inout->bad_list) : 0;
+
+	if (write(fd, &sr, sizeof(sr)) != sizeof(sr))
+		return;
+	for (i = 0; i < sr.nfiles; i++) {
+		if (write(fd, stage_inout->file_list[i],
+			strlen(stage_inout->file_list[i]) + 1) == -1)
+			return;
+	}
+	if (sr.badlen > 0)
+		(void)write(fd, stage_inout->bad_list, sr.badlen);
+}
+
+/**
+ * @brief
+ *	merge_stage_result - fold the report of a staging child into the
+ *	staging state of the whole request.
+ *
+ * @param[in]		kid		-	the child, its report read to EOF
+ * @param[in]		status		-	the child's exit status
+ * @param[in/out]	stage_inout	-	staging state of the request
+ *
+ * @return	int
+ * @retval	return of stage_file() in the child, -1 if it gave none
+ *
+ */
+static int
+merge_stage_result(struct stage_child *kid, int status, cpy_files *stage_inout)
+{
+	struct stage_result sr;
+	char **list;
+	char *p;
+	char *end;
+	int i;
+
+	if ((kid->len < sizeof(sr)) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0)) {
+		snprintf(log_buffer, sizeof(log_buffer),
+			"staging process for %s failed", kid->local);
+		log_event(PBSEVENT_ADMIN, PBS_EVENTCLASS_FILE, LOG_INFO,
+			kid->local, log_buffer);
+		add_bad_list(&(stage_inout->bad_list), log_buffer, 2);
+		stage_inout->bad_files = 1;
+		return -1;
+	}
+
+	memcpy(&sr, kid->buf, sizeof(sr));
+	stage_inout->bad_files |= sr.bad_files;
+	stage_inout->stageout_failed |= sr.stageout_failed;
+
+	p = kid->buf + sizeof(sr);
+	end = kid->buf + kid->len;
+	for (i = 0; (i < sr.nfiles) && (p < end); i++) {
+		if (stage_inout->file_max == stage_inout->file_num) {
+			list = realloc(stage_inout->file_list,
+				(stage_inout->file_max + 10) * sizeof(char *));
+			if (list == NULL) {
+				log_err(ENOMEM, __func__, "Out of Memory!");
+				break;
+			}
+			stage_inout->file_list = list;
+			stage_inout->file_max += 10;
 		}
+		if ((stage_inout->file_list[stage_inout->file_num] = strdup(p)) != NULL)
+			stage_inout->file_num++;
+		p += strlen(p) + 1;
+	}
+	if ((sr.badlen > 0) && (end - p >= sr.badlen)) {
+		*end = '\0';	/* stage_pairs() left room for it */
+		add_bad_list(&(stage_inout->bad_list), p, 0);
 	}
+	return sr.rc;
+}
+
+/**
+ * @brief
+ *	stage_pairs - stage all the file pairs of a copy files request.
+ *
+ *	With $stage_concurrency above one, up to that many pairs are staged
+ *	at the same time, each by its own child process which reports back
+ *	on a pipe.  A stagein failure stops new pairs from being started and
+ *	every file staged in by the request is removed.  Credentials piped to
+ *	the copy agent (cred_pipe) can only serve one copy at a time, so such
+ *	requests are staged one pair after the other.
+ *
+ * @param[in]		dir		-	direction of copy
+ *						STAGE_DIR_IN - for stage in request
+ *						STAGE_DIR_OUT - for stageout request
+ * @param[in]		owner		-	username for owner of copy request
+ * @param[in]		pair		-	first file pair of the request
+ * @param[in]		conn		-	socket on which request is received
+ * @param[in/out]	stage_inout	-	pointer to cpy_files struct
+ * @param[out]		num_copies	-	number of pairs staged
+ *
+ * @return	int
+ * @retval	0 - all OK
+ * @retval	!0 - error, no further pairs were staged
+ *
+ */
+int
+stage_pairs(int dir, char *owner, struct rqfpair *pair, int conn, cpy_files *stage_inout, int *num_copies)
+{
+	struct stage_child *kids;
+	cpy_files kid_inout;
+	fd_set fdset;
+	char *prmt;
+	char *tmp;
+	int rmtflag;
+	int running = 0;
+	int nfds;
+	int status;
+	int pfd[2];
+	int rc = 0;
+	int krc;
+	int i;
+	int j;
+	ssize_t n;
+
+	if ((stage_concurrency <= 1) || (cred_pipe != -1) ||
+		((kids = calloc(stage_concurrency, sizeof(struct stage_child))) == NULL)) {
+		for (; pair != NULL; pair = (struct rqfpair *)GET_NEXT(pair->fp_link)) {
+			DBPRT(("%s: local %s remote %s\n", __func__, pair->fp_local, pair->fp_rmt))
+
+			stage_inout->from_spool = 0;
+			prmt = pair->fp_rmt;
+			(*num_copies)++;
+
+			/* this host uses cp, another host (pbs_)rcp */
+			rmtflag = (local_or_remote(&prmt) == 0) ? 0 : 1;
+
+			rc = stage_file(dir, rmtflag, owner, pair, conn, stage_inout, prmt);
+			/*
+			 ** Here we break out of the the loop on error.
+			 ** This will only happen on a stagein failure.
+			 */
+			if (rc != 0)
+				break;
+		}
+		return rc;
+	}
+	for (i = 0; i < stage_concurrency; i++)
+		kids[i].fd = -1;
+
+	while (((pair != NULL) && (rc == 0)) || (running > 0)) {
+		/* start pairs while there is room */
+		for (i = 0; (i < stage_concurrency) && (pair != NULL) && (rc == 0); i++) {
+			if (kids[i].fd != -1)
+				continue;
+
+			DBPRT(("%s: local %s remote %s\n", __func__, pair->fp_local, pair->fp_rmt))
+			prmt = pair->fp_rmt;
+			(*num_copies)++;
+			rmtflag = (local_or_remote(&prmt) == 0) ? 0 : 1;
+
+			if (pipe(pfd) == -1) {
+				/* no room for another child, stage it here */
+				stage_inout->from_spool = 0;
+				rc = stage_file(dir, rmtflag, owner, pair, conn, stage_inout, prmt);
+				pair = (struct rqfpair *)GET_NEXT(pair->fp_link);
+				continue;
+			}
+			kids[i].pid = fork();
+			if (kids[i].pid == 0) {
+				(void)close(pfd[0]);
+				/* keep the result pipe from the copy programs */
+				(void)fcntl(pfd[1], F_SETFD, FD_CLOEXEC);
+				for (j = 0; j < stage_concurrency; j++) {
+					if (kids[j].fd != -1)
+						(void)close(kids[j].fd);
+				}
+				memset(&kid_inout, 0, sizeof(kid_inout));
+				kid_inout.sandbox_private = stage_inout->sandbox_private;
+				krc = stage_file(dir, rmtflag, owner, pair, conn, &kid_inout, prmt);
+				write_stage_result(pfd[1], krc, &kid_inout);
+				_exit(0);
+			}
+			(void)close(pfd[1]);
+			if (kids[i].pid == -1) {
+				(void)close(pfd[0]);
+				stage_inout->from_spool = 0;
+				rc = stage_file(dir, rmtflag, owner, pair, conn, stage_inout, prmt);
+				pair = (struct rqfpair *)GET_NEXT(pair->fp_link);
+				continue;
+			}
+			kids[i].fd = pfd[0];
+			kids[i].local = pair->fp_local;
+			kids[i].len = 0;
+			running++;
+			pair = (struct rqfpair *)GET_NEXT(pair->fp_link);
+		}
+		if (running == 0)
+			continue;
+
+		/* read the reports of the children which are done */
+		FD_ZERO(&fdset);
+		nfds = 0;
+		for (i = 0; i < stage_concurrency; i++) {
+			if (kids[i].fd != -1) {
+				FD_SET(kids[i].fd, &fdset);
+				if (kids[i].fd >= nfds)
+					nfds = kids[i].fd + 1;
+			}
+		}
+		if (select(nfds, &fdset, NULL, NULL, NULL) == -1) {
+			if (errno == EINTR)
+				continue;
+			log_err(errno, __func__, "select");
+			FD_ZERO(&fdset);
+			for (i = 0; i < stage_concurrency; i++) {
+				if (kids[i].fd != -1)
+					FD_SET(kids[i].fd, &fdset);	/* read them blocking */
+			}
+		}
+
+		for (i = 0; i < stage_concurrency; i++) {
+			if ((kids[i].fd == -1) || !FD_ISSET(kids[i].fd, &fdset))
+				continue;
+
+			if (kids[i].size - kids[i].len < 4096) {
+				tmp = realloc(kids[i].buf, kids[i].size + 16384);
+				if (tmp != NULL) {
+					kids[i].buf = tmp;
+					kids[i].size += 16384;
+				}
+			}
+			/* keep a byte to NUL terminate the report */
+			if (kids[i].size - kids[i].len > 1) {
+				n = read(kids[i].fd, kids[i].buf + kids[i].len,
+					kids[i].size - kids[i].len - 1);
+				if (n > 0) {
+					kids[i].len += n;
+					continue;
+				}
+				if ((n == -1) && (errno == EINTR))
+					continue;
+			} else
+				kids[i].len = 0;	/* out of memory, report is lost */
+
+			/* end of the report, the child is done */
+			(void)close(kids[i].fd);
+			kids[i].fd = -1;
+			running--;
+			while ((waitpid(kids[i].pid, &status, 0) == -1) && (errno == EINTR))
+				;
+			krc = merge_stage_result(&kids[i], status, stage_inout);
+			if ((krc != 0) && (rc == 0))
+				rc = krc;
+		}
+	}
+
+	/* take back everything staged in by the request */
+	if (rc != 0)
+		remove_staged_files(stage_inout);
+
+	for (i = 0; i < stage_concurrency; i++)
+		free(kids[i].buf);
+	free(kids);
 	return rc;
 }
+#endif	/* WIN32 */
 
 /**
  * @brief	
@@ -1001,6 +1338,8 @@ error:
  * @note	This may take awhile so the task is forked and execed to another
  *		process. In *nix, as with mkjobdir(),  the actions must be done
  *		as the User or as root depending on the location of the sandbox.
+ *		With $deferred_cleanup set the renamed directory is queued for
+ *		the background cleaner instead, see cleanup_enqueue().
  *
  */
 void
@@ -1104,6 +1443,16 @@ rmjobdir(char *jobid, char *jobdir, uid_t uid, gid_t gid)
 		sprintf(log_buffer, "rename: %s %s", jobdir, newdir);
 		log_joberr(errno, __func__, log_buffer, jobid);
 		newdir = jobdir;
+	} else if (deferred_cleanup) {
+		/* the queue lives in mom_priv, so queue it as root */
+		if (pbs_jobdir_root[0] == '\0')
+			revert_from_user();
+		if (cleanup_enqueue(jobid, "jobdir", newdir,
+			pbs_jobdir_root[0] == '\0' ? uid : 0, gid) == 0)
+			return;
+		if ((pbs_jobdir_root[0] == '\0') &&
+			(impersonate_user(uid, gid) == -1))
+			return;
 	}
 
 	/* fork and exec the cleantmp process */
@@ -1127,6 +1476,434 @@ rmjobdir(char *jobid, char *jobdir, uid_t uid, gid_t gid)
 
 #ifndef WIN32
 
+/*
+ * Deferred removal of job directories ($deferred_cleanup).
+ *
+ * Once a staging/execution or temporary directory has been renamed out of
+ * the way, an entry naming the renamed tree is written to the queue
+ * directory mom_priv/cleanup, one file per tree holding "<uid> <gid>" on
+ * the first line and the path on the second.  A single background process
+ * at the lowest cpu and i/o priority works through the queue, removing at
+ * most $deferred_cleanup_rate entries a second, and drops a queue file only
+ * when its tree is gone.  Entries left behind by a MoM restart or a failed
+ * removal are picked up the next time the cleaner starts.
+ */
+static pid_t	cleanup_pid = 0;	/* running cleaner, 0 if none */
+
+struct cleanup_stats {
+	long		cs_entries;	/* files and directories removed */
+	long long	cs_kb;		/* space they held, in kb */
+	long		cs_errors;	/* entries that could not be removed */
+	int		cs_errno;	/* errno of the first failure */
+	int		cs_burst;	/* removals in the current second */
+	struct timeval	cs_start;	/* start of the current second */
+};
+
+static void cleanup_reaped(struct work_task *);
+
+/**
+ * @brief
+ *	cleanup_throttle - account for one removed entry and sleep when the
+ *	cleaner has used up its $deferred_cleanup_rate for this second.
+ *
+ * @param[in,out] stats - the running totals of the current tree
+ * @param[in]	  sb    - stat of the entry just removed
+ *
+ * @return void
+ */
+static void
+cleanup_throttle(struct cleanup_stats *stats, struct stat *sb)
+{
+	struct timeval	now;
+	long		usec;
+
+	stats->cs_entries++;
+	stats->cs_kb += ((long long)sb->st_blocks * 512) / 1024;
+
+	if (deferred_cleanup_rate <= 0)
+		return;
+	if (++stats->cs_burst < deferred_cleanup_rate)
+		return;
+
+	gettimeofday(&now, NULL);
+	usec = (now.tv_sec - stats->cs_start.tv_sec) * 1000000L +
+		(now.tv_usec - stats->cs_start.tv_usec);
+	if ((usec >= 0) && (usec < 1000000L)) {
+		struct timespec	ts;
+
+		ts.tv_sec = 0;
+		ts.tv_nsec = (1000000L - usec) * 1000L;
+		(void)nanosleep(&ts, NULL);
+		gettimeofday(&now, NULL);
+	}
+	stats->cs_burst = 0;
+	stats->cs_start = now;
+}
+
+/**
+ * @brief
+ *	cleanup_error - note a failed removal, keeping the first errno.
+ *
+ * @param[in,out] stats - running totals of the removal
+ * @param[in]	  err   - errno of the failure
+ *
+ * @return void
+ */
+static void
+cleanup_error(struct cleanup_stats *stats, int err)
+{
+	if ((err != ENOENT) && (stats->cs_errors++ == 0))
+		stats->cs_errno = err;
+}
+
+/**
+ * @brief
+ *	cleanup_at - remove the entry name in the directory open on dfd,
+ *	and everything under it, the way "rm -rf" would, carrying on past
+ *	entries that cannot be removed.
+ *
+ * @par
+ *	The tree may still be writable by a process the job left behind, so
+ *	it is only ever walked through directory descriptors: a directory is
+ *	opened with O_NOFOLLOW and checked to be the one just looked at, and
+ *	entries are removed relative to it.  A directory swapped for a
+ *	symbolic link is removed as the link, never followed.
+ *
+ * @param[in]	  dfd   - descriptor of the directory holding name
+ * @param[in]	  name  - the entry to remove
+ * @param[in,out] stats - running totals of the removal
+ *
+ * @return void
+ */
+static void
+cleanup_at(int dfd, char *name, struct cleanup_stats *stats)
+{
+	DIR		*dir;
+	struct dirent	*pdir;
+	struct stat	sb;
+	struct stat	fsb;
+	int		fd;
+
+	if (fstatat(dfd, name, &sb, AT_SYMLINK_NOFOLLOW) == -1) {
+		cleanup_error(stats, errno);
+		return;
+	}
+
+	if (S_ISDIR(sb.st_mode)) {
+		fd = openat(dfd, name, O_RDONLY|O_DIRECTORY|O_NOFOLLOW);
+		if (fd == -1) {
+			cleanup_error(stats, errno);
+		} else if ((fstat(fd, &fsb) == -1) ||
+			(fsb.st_dev != sb.st_dev) || (fsb.st_ino != sb.st_ino)) {
+			/* replaced since it was looked at, leave it */
+			(void)close(fd);
+			cleanup_error(stats, EBUSY);
+			return;
+		} else if ((dir = fdopendir(fd)) == NULL) {
+			cleanup_error(stats, errno);
+			(void)close(fd);
+		} else {
+			while ((pdir = readdir(dir)) != NULL) {
+				if (pdir->d_name[0] == '.') {
+					if (pdir->d_name[1] == '\0' ||
+						(pdir->d_name[1] == '.' &&
+						pdir->d_name[2] == '\0'))
+						continue;
+				}
+				cleanup_at(dirfd(dir), pdir->d_name, stats);
+			}
+			(void)closedir(dir);
+		}
+		if (unlinkat(dfd, name, AT_REMOVEDIR) == -1) {
+			cleanup_error(stats, errno);
+			return;
+		}
+	} else if (unlinkat(dfd, name, 0) == -1) {
+		cleanup_error(stats, errno);
+		return;
+	}
+	cleanup_throttle(stats, &sb);
+}
+
+/**
+ * @brief
+ *	cleanup_tree - remove a directory tree the way "rm -rf" would,
+ *	carrying on past entries that cannot be removed.
+ *
+ * @param[in]	  path  - the tree to remove
+ * @param[in,out] stats - running totals of the removal
+ *
+ * @return void
+ */
+static void
+cleanup_tree(char *path, struct cleanup_stats *stats)
+{
+	char	parent[MAXPATHLEN+1];
+	char	*base;
+	int	dfd;
+
+	snprintf(parent, sizeof(parent), "%s", path);
+	if ((base = strrchr(parent, '/')) == NULL) {
+		cleanup_at(AT_FDCWD, parent, stats);
+		return;
+	}
+	*base++ = '\0';
+	dfd = open((parent[0] == '\0') ? "/" : parent, O_RDONLY|O_DIRECTORY);
+	if (dfd == -1) {
+		cleanup_error(stats, errno);
+		return;
+	}
+	cleanup_at(dfd, base, stats);
+	(void)close(dfd);
+}
+
+/**
+ * @brief
+ *	cleanup_entry - remove the tree named by one queue file and, once it
+ *	is gone, the queue file itself.
+ *
+ * @param[in] qfile - full path of the queue file
+ *
+ * @return int
+ * @retval  0	the tree is gone
+ * @retval -1	the tree, or part of it, is still there
+ */
+static int
+cleanup_entry(char *qfile)
+{
+	FILE	*fp;
+	long	uid;
+	long	gid;
+	char	path[MAXPATHLEN+1];
+	char	*nameptr;
+	size_t	len;
+	struct cleanup_stats stats;
+	struct stat sb;
+
+	if ((fp = fopen(qfile, "r")) == NULL)
+		return (errno == ENOENT ? 0 : -1);
+	if ((fscanf(fp, "%ld %ld\n", &uid, &gid) != 2) ||
+		(fgets(path, sizeof(path), fp) == NULL)) {
+		fclose(fp);
+		sprintf(log_buffer, "malformed cleanup entry %s", qfile);
+		log_err(-1, __func__, log_buffer);
+		(void)unlink(qfile);
+		return 0;
+	}
+	fclose(fp);
+	len = strlen(path);
+	if ((len > 0) && (path[len-1] == '\n'))
+		path[--len] = '\0';
+
+	/*
+	 * Only ever remove a tree rmjobdir() or rmtmpdir() renamed,
+	 * "pbs.<jobid>.<x>_remove" or "pbs_remove.<jobid>".
+	 */
+	if ((nameptr = strrchr(path, '/')) != NULL)
+		nameptr++;
+	else
+		nameptr = path;
+	if (!((strncmp(nameptr, "pbs.", 4) == 0 && len > 7 &&
+		strcmp(path + len - 7, "_remove") == 0) ||
+		strncmp(nameptr, "pbs_remove.", 11) == 0)) {
+		sprintf(log_buffer, "%s is not a renamed job directory", path);
+		log_err(-1, __func__, log_buffer);
+		(void)unlink(qfile);
+		return 0;
+	}
+
+	if ((uid != 0) && (impersonate_user((uid_t)uid, (gid_t)gid) == -1)) {
+		sprintf(log_buffer, "unable to become uid %ld to remove %s",
+			uid, path);
+		log_err(errno, __func__, log_buffer);
+		return -1;
+	}
+	memset(&stats, 0, sizeof(stats));
+	gettimeofday(&stats.cs_start, NULL);
+	cleanup_tree(path, &stats);
+	if (uid != 0)
+		revert_from_user();
+
+	if ((lstat(path, &sb) == 0) || (errno != ENOENT)) {
+		sprintf(log_buffer, "%s: %ld entries left in place",
+			path, stats.cs_errors);
+		log_err(stats.cs_errno, __func__, log_buffer);
+		return -1;
+	}
+	(void)unlink(qfile);
+	sprintf(log_buffer, "removed %s, %ld entries, %lld kb",
+		path, stats.cs_entries, stats.cs_kb);
+	log_event(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SERVER, LOG_DEBUG,
+		__func__, log_buffer);
+	return 0;
+}
+
+/**
+ * @brief
+ *	cleanup_worker - body of the background cleaner.  Works through the
+ *	queue until a pass finds nothing new to do.
+ *
+ * @return int - exit status for the cleaner
+ * @retval 0	the queue is empty
+ * @retval 1	some trees could not be removed
+ */
+static int
+cleanup_worker(void)
+{
+	DIR		*dir;
+	struct dirent	*pdir;
+	char		qfile[MAXPATHLEN+1];
+	pid_t		parent = getppid();
+	int		found;
+	int		failed;
+
+	for (;;) {
+		if ((dir = opendir(path_cleanup)) == NULL)
+			return (errno == ENOENT ? 0 : 1);
+		found = 0;
+		failed = 0;
+		while ((pdir = readdir(dir)) != NULL) {
+			if (pdir->d_name[0] == '.')	/* ., .. and partial entries */
+				continue;
+			/* MoM went away, leave the rest to the next one */
+			if (getppid() != parent) {
+				(void)closedir(dir);
+				return 1;
+			}
+			found++;
+			sprintf(qfile, "%s/%s", path_cleanup, pdir->d_name);
+			if (cleanup_entry(qfile) == -1)
+				failed++;
+		}
+		(void)closedir(dir);
+		if (found == 0)
+			return 0;
+		if (failed == found)
+			return 1;
+	}
+}
+
+/**
+ * @brief
+ *	cleanup_start - start the background cleaner if it is not running
+ *	and there is anything queued for it.
+ *
+ * @return void
+ */
+void
+cleanup_start(void)
+{
+	DIR		*dir;
+	struct dirent	*pdir;
+	pid_t		pid;
+
+	if (cleanup_pid != 0)
+		return;
+	if ((dir = opendir(path_cleanup)) == NULL)
+		return;
+	while ((pdir = readdir(dir)) != NULL) {
+		if (pdir->d_name[0] != '.')
+			break;
+	}
+	(void)closedir(dir);
+	if (pdir == NULL)
+		return;		/* nothing queued */
+
+	pid = fork();
+	if (pid == -1) {
+		log_err(errno, __func__, "fork");
+		return;
+	}
+	if (pid > 0) {
+		cleanup_pid = pid;
+		if (set_task(WORK_Deferred_Child, pid, cleanup_reaped, NULL) == NULL)
+			log_err(errno, __func__, "set_task");
+		return;
+	}
+
+	/* child: stay out of the way of running jobs */
+	rpp_terminate();
+	(void)nice(19);
+#if defined(__linux__) && defined(SYS_ioprio_set)
+	/* IOPRIO_WHO_PROCESS, IOPRIO_CLASS_IDLE */
+	(void)syscall(SYS_ioprio_set, 1, 0, 3 << 13);
+#endif
+	exit(cleanup_worker());
+}
+
+/**
+ * @brief
+ *	cleanup_reaped - the background cleaner has exited.  If it drained
+ *	the queue, start it again in case more was queued as it finished.
+ *
+ * @param[in] ptask - work task, wt_aux holds the exit status
+ *
+ * @return void
+ */
+static void
+cleanup_reaped(struct work_task *ptask)
+{
+	cleanup_pid = 0;
+	if (ptask->wt_aux == 0)
+		cleanup_start();
+	else
+		log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_DEBUG,
+			__func__, "some directories left in the cleanup queue");
+}
+
+/**
+ * @brief
+ *	cleanup_enqueue - hand a renamed job directory to the background
+ *	cleaner.
+ *
+ * @param[in] jobid - job the directory belonged to
+ * @param[in] tag   - kind of directory, keeps the queue file name unique
+ * @param[in] path  - the renamed directory
+ * @param[in] uid   - user to remove it as, 0 for root
+ * @param[in] gid   - group to remove it as
+ *
+ * @return int
+ * @retval  0	queued, the caller is done with the directory
+ * @retval -1	not queued, the caller should remove it itself
+ */
+int
+cleanup_enqueue(char *jobid, char *tag, char *path, uid_t uid, gid_t gid)
+{
+	char	tmpname[MAXPATHLEN+1];
+	char	qfile[MAXPATHLEN+1];
+	struct stat sb;
+	FILE	*fp;
+
+	/* a copy child running as the user cannot write mom_priv */
+	if (getuid() != 0)
+		return -1;
+
+	if (stat(path_cleanup, &sb) == -1) {
+		if (mkdir(path_cleanup, S_IRWXU) == -1) {
+			sprintf(log_buffer, "mkdir %s", path_cleanup);
+			log_err(errno, __func__, log_buffer);
+			return -1;
+		}
+	}
+
+	snprintf(tmpname, sizeof(tmpname), "%s/.%s.%s", path_cleanup, jobid, tag);
+	snprintf(qfile, sizeof(qfile), "%s/%s.%s", path_cleanup, jobid, tag);
+	if ((fp = fopen(tmpname, "w")) == NULL) {
+		log_joberr(errno, __func__, tmpname, jobid);
+		return -1;
+	}
+	fprintf(fp, "%ld %ld\n%s\n", (long)uid, (long)gid, path);
+	if ((fclose(fp) != 0) || (rename(tmpname, qfile) == -1)) {
+		log_joberr(errno, __func__, qfile, jobid);
+		(void)unlink(tmpname);
+		return -1;
+	}
+
+	cleanup_start();
+	return 0;
+}
+
+
 /**
  * @brief
  *	copy string quoting whitespace by prefixing with back-slash
@@ -1211,6 +1988,118 @@ is_pbs_rcp_path(void)
 	return (0);
 }
 #endif
+#ifndef WIN32
+/**
+ * @brief
+ *	local_copy - copy a regular file within this host without forking
+ *	"cp", keeping its mode and times as "cp -p" would.  The data is moved
+ *	by the kernel (copy_file_range() or sendfile()) where it can be.
+ *
+ * @param[in]	src	-	path of the file to copy
+ * @param[in]	dst	-	path to copy to, or a directory to copy into
+ *
+ * @return	int
+ * @retval	0 - file copied
+ * @retval	-1 - file not copied, the caller falls back to "cp"
+ *
+ */
+static int
+local_copy(char *src, char *dst)
+{
+	struct stat sb;
+	struct stat db;
+	struct timeval tv[2];
+	char target[MAXPATHLEN+1];
+	char buf[16384];
+	char *slash;
+	char *p;
+	int sfd;
+	int dfd;
+	ssize_t n;
+	ssize_t w;
+	size_t left;
+
+	if ((sfd = open(src, O_RDONLY)) == -1)
+		return -1;
+	if ((fstat(sfd, &sb) == -1) || !S_ISREG(sb.st_mode)) {
+		(void)close(sfd);
+		return -1;
+	}
+
+	if ((stat(dst, &db) == 0) && S_ISDIR(db.st_mode)) {
+		slash = strrchr(src, '/');
+		n = snprintf(target, sizeof(target), "%s/%s", dst,
+			(slash != NULL) ? slash + 1 : src);
+	} else
+		n = snprintf(target, sizeof(target), "%s", dst);
+	if ((n >= (ssize_t)sizeof(target)) ||
+		((stat(target, &db) == 0) && (db.st_dev == sb.st_dev) &&
+		(db.st_ino == sb.st_ino))) {
+		/* leave overlong names and copies onto itself to cp */
+		(void)close(sfd);
+		return -1;
+	}
+
+	if ((dfd = open(target, O_WRONLY|O_CREAT|O_TRUNC, sb.st_mode & 0777)) == -1) {
+		(void)close(sfd);
+		return -1;
+	}
+
+	left = sb.st_size;
+	n = 0;
+#if defined(__linux__) && defined(SYS_copy_file_range)
+	while ((left > 0) &&
+		((n = syscall(SYS_copy_file_range, sfd, NULL, dfd, NULL, left, 0)) > 0))
+		left -= n;
+	if ((n == -1) && (errno != ENOSYS) && (errno != EXDEV) &&
+		(errno != EINVAL) && (errno != EOPNOTSUPP))
+		goto fail;
+#endif
+#ifdef __linux__
+	while ((left > 0) && ((n = sendfile(dfd, sfd, NULL, left)) > 0))
+		left -= n;
+	if ((n == -1) && (errno != ENOSYS) && (errno != EINVAL))
+		goto fail;
+#endif
+	/* whatever the kernel could not move, and anything the file grew by */
+	while ((n = read(sfd, buf, sizeof(buf))) != 0) {
+		if (n == -1) {
+			if (errno == EINTR)
+				continue;
+			goto fail;
+		}
+		for (p = buf; n > 0; p += w, n -= w) {
+			if ((w = write(dfd, p, n)) == -1) {
+				if (errno == EINTR) {
+					w = 0;
+					continue;
+				}
+				goto fail;
+			}
+		}
+	}
+
+	(void)fchmod(dfd, sb.st_mode & 07777);
+	(void)close(sfd);
+	if (close(dfd) == -1) {
+		(void)unlink(target);
+		return -1;
+	}
+	tv[0].tv_sec = sb.st_atime;
+	tv[0].tv_usec = 0;
+	tv[1].tv_sec = sb.st_mtime;
+	tv[1].tv_usec = 0;
+	(void)utimes(target, tv);
+	return 0;
+
+fail:
+	(void)close(sfd);
+	(void)close(dfd);
+	(void)unlink(target);
+	return -1;
+}
+#endif	/* WIN32 */
+
 /**
  * @brief	
  *	sys_copy
@@ -1428,6 +2317,12 @@ sys_copy(int dir, int rmtflg, char *owner, char *src, struct rqfpair *pair, int
 	}
 
 #ifndef WIN32
+	/* a plain file copied within this host needs no cp */
+	if ((rmtflg == 0) && (shell == NULL) && (strcmp(ag3, "/dev/null") != 0)) {
+		if (local_copy(ag2, ag3) == 0)
+			return 0;
+	}
+
 	for (loop = 1; loop < 5; ++loop) {
 		original = 0;
 		if (rmtflg == 0) {	/* local copy */
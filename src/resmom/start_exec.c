@@ -108,6 +108,8 @@ extern	u_long		localaddr;
 extern	int		lockfds;
 extern	pbs_list_head	mom_polljobs;
 extern	int		next_sample_time;
+extern	int		deferred_cleanup;
+extern	int		pwd_cache_ttl;
 extern	int		min_check_poll;
 extern	char		*path_checkpoint;
 extern	char		*path_jobs;
@@ -258,6 +260,192 @@ no_hang(int sig)
 		"alarm timed-out connect to qsub");
 }
 
+/*
+ * Password and group cache ($pwd_cache_ttl).  The password entry of a job
+ * owner is kept for pwd_cache_ttl seconds, along with the supplementary
+ * groups initgroups() would give the user, so that a stream of jobs from
+ * the same user goes to the name service once rather than once per job
+ * and again in each child.
+ */
+#define PWD_CACHE_SIZE	64	/* hash buckets, a power of 2 */
+
+struct pwd_cache {
+	struct pwd_cache *pc_next;
+	time_t		  pc_when;	/* time of the lookup */
+	struct passwd	  pc_pwd;	/* copy of the entry */
+	gid_t		  pc_gid;	/* group pc_groups was built for */
+	int		  pc_ngroups;	/* -1 until looked up */
+	gid_t		 *pc_groups;
+};
+
+static struct pwd_cache	*pwd_cache[PWD_CACHE_SIZE];
+
+/**
+ * @brief
+ *	pwd_cache_bucket - hash a user name to its pwd_cache bucket
+ *
+ * @param[in] name - user name
+ *
+ * @return pointer to the head of the bucket
+ */
+static struct pwd_cache **
+pwd_cache_bucket(char *name)
+{
+	unsigned int	h = 5381;
+
+	while (*name)
+		h = ((h << 5) + h) + (unsigned char)*name++;
+	return (&pwd_cache[h & (PWD_CACHE_SIZE - 1)]);
+}
+
+/**
+ * @brief
+ *	pwd_cache_find - find the cached entry for a user.  Entries that have
+ *	outlived pwd_cache_ttl are passed over and, if purge is set, thrown
+ *	away along with any others in the same bucket.
+ *
+ * @param[in] name  - user name
+ * @param[in] purge - free expired entries
+ *
+ * @return pointer to the entry, or NULL if there is no live entry
+ */
+static struct pwd_cache *
+pwd_cache_find(char *name, int purge)
+{
+	struct pwd_cache	**link;
+	struct pwd_cache	*pc;
+	struct pwd_cache	*found = NULL;
+	time_t			now = time(NULL);
+
+	link = pwd_cache_bucket(name);
+	while ((pc = *link) != NULL) {
+		if ((now - pc->pc_when >= pwd_cache_ttl) || (now < pc->pc_when)) {
+			if (purge) {
+				*link = pc->pc_next;
+				free(pc->pc_groups);
+				free(pc);
+				continue;
+			}
+		} else if (strcmp(pc->pc_pwd.pw_name, name) == 0)
+			found = pc;
+		link = &pc->pc_next;
+	}
+	return found;
+}
+
+/**
+ * @brief
+ *	getpwnam_cached - getpwnam() through the password cache.
+ *
+ * @par	With $pwd_cache_ttl unset this is just getpwnam().  The entry
+ *	returned must not be freed or modified; like that of getpwnam() it
+ *	is good until the next call.
+ *
+ * @param[in] name - user name
+ *
+ * @return	struct passwd *
+ * @retval	NULL	no such user
+ */
+struct passwd *
+getpwnam_cached(char *name)
+{
+	struct pwd_cache	*pc;
+	struct pwd_cache	**bucket;
+	struct passwd		*pwdp;
+	size_t			len;
+	char			*cp;
+
+	if (pwd_cache_ttl <= 0)
+		return (getpwnam(name));
+	if ((pc = pwd_cache_find(name, 1)) != NULL)
+		return (&pc->pc_pwd);
+
+	if ((pwdp = getpwnam(name)) == NULL)
+		return NULL;
+	len = strlen(pwdp->pw_name) + strlen(pwdp->pw_passwd) +
+		strlen(pwdp->pw_gecos) + strlen(pwdp->pw_dir) +
+		strlen(pwdp->pw_shell) + 5;
+	if ((pc = malloc(sizeof(struct pwd_cache) + len)) == NULL)
+		return pwdp;	/* just don't cache it */
+
+	/* the strings are kept in the same block, after the entry */
+	pc->pc_pwd = *pwdp;
+	cp = (char *)(pc + 1);
+	pc->pc_pwd.pw_name = strcpy(cp, pwdp->pw_name);
+	cp += strlen(cp) + 1;
+	pc->pc_pwd.pw_passwd = strcpy(cp, pwdp->pw_passwd);
+	cp += strlen(cp) + 1;
+	pc->pc_pwd.pw_gecos = strcpy(cp, pwdp->pw_gecos);
+	cp += strlen(cp) + 1;
+	pc->pc_pwd.pw_dir = strcpy(cp, pwdp->pw_dir);
+	cp += strlen(cp) + 1;
+	pc->pc_pwd.pw_shell = strcpy(cp, pwdp->pw_shell);
+	pc->pc_when = time(NULL);
+	pc->pc_gid = 0;
+	pc->pc_ngroups = -1;
+	pc->pc_groups = NULL;
+
+	bucket = pwd_cache_bucket(name);
+	pc->pc_next = *bucket;
+	*bucket = pc;
+	return (&pc->pc_pwd);
+}
+
+/**
+ * @brief
+ *	pwd_cache_groups - the group list initgroups() would set up for a
+ *	user, out of the password cache.
+ *
+ * @param[in]  name   - user name
+ * @param[in]  gid    - group to include in the list, as for initgroups()
+ * @param[out] groups - set to the cached list, not to be freed
+ *
+ * @return	int
+ * @retval	>=0	number of groups in the list
+ * @retval	-1	not available, use initgroups()
+ */
+int
+pwd_cache_groups(char *name, gid_t gid, gid_t **groups)
+{
+#ifdef	HAVE_GETGROUPLIST
+	struct pwd_cache	*pc;
+	gid_t			*list;
+	int			ngroups = 64;
+	int			maxgroups = (int)sysconf(_SC_NGROUPS_MAX) + 1;
+
+	if (pwd_cache_ttl <= 0)
+		return -1;
+	/* only users check_pwd() has looked up */
+	if ((pc = pwd_cache_find(name, 0)) == NULL)
+		return -1;
+
+	if ((pc->pc_ngroups < 0) || (pc->pc_gid != gid)) {
+		for (;;) {
+			int	n = ngroups;
+
+			if ((list = malloc(n * sizeof(gid_t))) == NULL)
+				return -1;
+			if (getgrouplist(name, gid, list, &ngroups) != -1)
+				break;
+			free(list);
+			/* ngroups now holds the size needed, where supported */
+			if ((ngroups <= n) && ((ngroups = n * 2) > maxgroups))
+				ngroups = maxgroups;
+			if (n >= maxgroups)
+				return -1;
+		}
+		free(pc->pc_groups);
+		pc->pc_groups = list;
+		pc->pc_ngroups = ngroups;
+		pc->pc_gid = gid;
+	}
+	*groups = pc->pc_groups;
+	return (pc->pc_ngroups);
+#else
+	return -1;
+#endif	/* HAVE_GETGROUPLIST */
+}
+
 /**
  * @brief
  *	validate credentials of user for job.
@@ -276,8 +464,9 @@ check_pwd(job *pjob)
 	struct group		*grpp;
 	char		      **pgnam;
 	struct stat		sb;
+	gid_t		       *groups;
 
-	pwdp = getpwnam(pjob->ji_wattr[(int)JOB_ATR_euser].at_val.at_str);
+	pwdp = getpwnam_cached(pjob->ji_wattr[(int)JOB_ATR_euser].at_val.at_str);
 	if (pwdp == (struct passwd *)0) {
 		(void)sprintf(log_buffer, "No Password Entry for User %s",
 			pjob->ji_wattr[(int)JOB_ATR_euser].at_val.at_str);
@@ -338,6 +527,9 @@ check_pwd(job *pjob)
 		pjob->ji_grpcache->gc_gid = pwdp->pw_gid;
 	}
 
+	/* look up the groups now so each child of the job need not */
+	(void)pwd_cache_groups(pwdp->pw_name, pjob->ji_grpcache->gc_gid, &groups);
+
 	/* perform site specific check on validatity of account */
 	if (site_mom_chkuser(pjob))
 		return NULL;
@@ -1001,7 +1193,8 @@ mkjobdir(char *jobid, char *jobdir, uid_t uid, gid_t gid)
  * @brief
  * 	rmtmpdir - remove the temporary directory
  *	This may take awhile so the task is forked and execed to another
- *	process.
+ *	process, or with $deferred_cleanup set, queued for the background
+ *	cleaner.
  *
  * @param[in] jobid - job id
  *
@@ -1035,6 +1228,9 @@ rmtmpdir(char *jobid)
 		sprintf(log_buffer, "%s %s", tmpdir, newdir);
 		log_joberr(errno, __func__, log_buffer, jobid);
 		newdir = tmpdir;
+	} else if (deferred_cleanup &&
+		(cleanup_enqueue(jobid, "tmpdir", newdir, 0, 0) == 0)) {
+		return;
 	}
 
 	/* fork and exec the cleantmp process */
@@ -1098,6 +1294,7 @@ int
 becomeuser_args(char *eusrname, uid_t euid, gid_t egid, gid_t rgid)
 {
 	gid_t *grplist = NULL;
+	gid_t *cached;
 	int    i;
 	int    numsup;
 	static int   maxgroups=0;
@@ -1106,13 +1303,22 @@ becomeuser_args(char *eusrname, uid_t euid, gid_t egid, gid_t rgid)
 	if (maxgroups == 0)
 		maxgroups = (int)sysconf(_SC_NGROUPS_MAX);
 
-	if (initgroups(eusrname, egid) != -1) {
+	/* use the groups in the password cache rather than initgroups() */
+	if (((numsup = pwd_cache_groups(eusrname, egid, &cached)) != -1) &&
+		(numsup <= maxgroups)) {
+		grplist = calloc((size_t)maxgroups, sizeof(gid_t));
+		if (grplist == NULL)
+			return -1;
+		memcpy(grplist, cached, numsup * sizeof(gid_t));
+	} else if (initgroups(eusrname, egid) != -1) {
 		/* allocate an array for the group list */
 		grplist = calloc((size_t)maxgroups, sizeof(gid_t));
 		if (grplist == NULL)
 			return -1;
 		/* get the current list of groups */
 		numsup = getgroups(maxgroups, grplist);
+	}
+	if (grplist != NULL) {
 		for (i=0; i<numsup; ++i) {
 			if (grplist[i] == rgid)
 				break;
@@ -5320,6 +5526,80 @@ open_std_file(job *pjob, enum job_file which, int mode, gid_t exgid)
 	return (fds);
 }
 
+/**
+ * @brief
+ *	env_name_hash - hash the name part of a "name=value" string.
+ *
+ * @param[in] pstr - environment string
+ * @param[in] len  - length of the name
+ *
+ * @return	unsigned int - hash value
+ */
+static unsigned int
+env_name_hash(char *pstr, int len)
+{
+	unsigned int	h = 5381;
+
+	while (len-- > 0)
+		h = ((h << 5) + h) + (unsigned char)*pstr++;
+	return h;
+}
+
+/**
+ * @brief
+ *	env_index - bring the hash index of an environment table up to date.
+ *
+ * @par	The table may be emptied, by setting v_used to 0, or grown behind
+ *	our back, so entries past v_hused are entered here and the index is
+ *	started over when v_used has gone backwards or the index is too small.
+ *	A lookup checks the entry it finds, so a stale slot can only cost a
+ *	compare.
+ *
+ * @param[in] ptbl - table to index
+ *
+ * @return	int
+ * @retval	0	index usable
+ * @retval	-1	no memory for the index
+ */
+static int
+env_index(struct var_table *ptbl)
+{
+	unsigned int	h;
+	int		len;
+	char		*pc;
+
+	if ((ptbl->v_hsize < 2 * (ptbl->v_used + 1)) ||
+		(ptbl->v_used < ptbl->v_hused)) {
+		int	newsize = ptbl->v_hsize;
+
+		if (newsize == 0)
+			newsize = 64;
+		while (newsize < 2 * (ptbl->v_ensize + 1))
+			newsize *= 2;
+		if (newsize != ptbl->v_hsize) {
+			int *tmp = realloc(ptbl->v_hash, newsize * sizeof(int));
+
+			if (tmp == NULL)
+				return -1;
+			ptbl->v_hash = tmp;
+			ptbl->v_hsize = newsize;
+		}
+		memset(ptbl->v_hash, -1, ptbl->v_hsize * sizeof(int));
+		ptbl->v_hused = 0;
+	}
+
+	for (; ptbl->v_hused < ptbl->v_used; ptbl->v_hused++) {
+		pc = ptbl->v_envp[ptbl->v_hused];
+		for (len = 0; (pc[len] != '=') && (pc[len] != '\0'); ++len)
+			;
+		h = env_name_hash(pc, len) & (ptbl->v_hsize - 1);
+		while (ptbl->v_hash[h] != -1)
+			h = (h + 1) & (ptbl->v_hsize - 1);
+		ptbl->v_hash[h] = ptbl->v_hused;
+	}
+	return 0;
+}
+
 /**
  * @brief
  * 	find_env_slot - find if the environment variable is already in the table,
@@ -5339,12 +5619,23 @@ find_env_slot(struct var_table *ptbl, char *pstr)
 {
 	int	 i;
 	int	 len = 1;	/* one extra for '=' */
+	unsigned int h;
 
 	if (pstr == NULL)
 		return (-1);
 	for (i=0; (*(pstr+i) != '=') && (*(pstr+i) != '\0'); ++i)
 		++len;
 
+	if (env_index(ptbl) == 0) {
+		h = env_name_hash(pstr, len - 1) & (ptbl->v_hsize - 1);
+		for (; (i = ptbl->v_hash[h]) != -1; h = (h + 1) & (ptbl->v_hsize - 1)) {
+			if ((i < ptbl->v_used) &&
+				(strncmp(ptbl->v_envp[i], pstr, len) == 0))
+				return (i);
+		}
+		return (-1);
+	}
+
 	for (i=0; i<ptbl->v_used; ++i) {
 		if (strncmp(ptbl->v_envp[i], pstr, len) == 0)
 			return (i);
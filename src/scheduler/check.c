@@ -101,6 +101,7 @@
 #include "limits_if.h"
 #include "simulate.h"
 #include "resource.h"
+#include "sched_profile.h"
 
 
 /**
@@ -721,6 +722,7 @@ is_ok_to_run(status *policy, int pbs_sd, server_info *sinfo,
 	node_partition *allpart;	/* all partition to use (queue's or servers) */
 	schd_error *prev_err = NULL;
 	schd_error *err;
+	prof_stamp pts;			/* start of profiled phase */
 	
 
 	if (sinfo == NULL || resresv == NULL || perr == NULL)
@@ -821,7 +823,10 @@ is_ok_to_run(status *policy, int pbs_sd, server_info *sinfo,
 		if (resresv->job == NULL || resresv->job->priority != NAS_HWY101)
 #endif /* localmod 032 */
 		if (resresv->is_job) {
-			if ((rc = check_limits(sinfo, qinfo, resresv, err, flags | CHECK_LIMIT))) {
+			prof_begin(&pts);
+			rc = check_limits(sinfo, qinfo, resresv, err, flags | CHECK_LIMIT);
+			prof_end(PROF_CHECK_LIMITS, &pts);
+			if (rc) {
 
 				add_err(&prev_err, err);
 				if (rc == SCHD_ERROR)
@@ -1476,6 +1481,7 @@ check_nodes(status *policy, resource_resv *resresv, node_info **ninfo_arr,
 	selspec *spec;
 	place *pl;
 	place place_spec;
+	prof_stamp pts;			/* start of eval_selspec() */
 
 	int rc;
 
@@ -1506,8 +1512,10 @@ check_nodes(status *policy, resource_resv *resresv, node_info **ninfo_arr,
 	}
 	
 	err->status_code = NOT_RUN;
+	prof_begin(&pts);
 	rc = eval_selspec(policy, spec, pl, ninfo_arr, nodepart, resresv,
 		flags, &nspec_arr, err);
+	prof_end(PROF_EVAL_SELSPEC, &pts);
 
 	/* We can run, yippie! */
 	if (rc > 0)
@@ -1943,7 +1951,7 @@ find_correct_nodes(status *policy, server_info *sinfo, queue_info *qinfo, resour
 	if (resresv->place_spec->group !=NULL) {
 		grouparr[0] = resresv->place_spec->group;
 		grouparr[1] = NULL;
-		npc = find_alloc_np_cache(policy, &(sinfo->npc_arr), grouparr, *ninfo_arr, cmp_placement_sets);
+		npc = find_alloc_np_cache(policy, sinfo, grouparr, *ninfo_arr, cmp_placement_sets);
 		if (npc != NULL)
 			*nodepart = npc->nodepart;
 		else
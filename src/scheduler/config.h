@@ -92,6 +92,11 @@
 
 /* Size of time buffer */
 #define TIMEBUF_SIZE 128
+
+/* defaults for querying the moms (mom_query_window and mom_query_timeout) */
+#define MOM_QUERY_WINDOW 256
+#define MOM_QUERY_TIMEOUT 10
+
 /* parsing -
  * names that appear on the left hand side in the sched config file
  */
@@ -141,6 +146,10 @@
 #define PARSE_STRICT_ORDERING "strict_ordering"
 #define PARSE_RES_UNSET_INFINITE "resource_unset_infinite"
 #define PARSE_SELECT_PROVISION "provision_policy"
+#define PARSE_MOM_QUERY_WINDOW "mom_query_window"
+#define PARSE_MOM_QUERY_TIMEOUT "mom_query_timeout"
+#define PARSE_MOM_CACHE_TTL "mom_cache_ttl"
+#define PARSE_EST_ALL_JOBS_FREQ "est_all_jobs_freq"
 
 #ifdef NAS
 /* localmod 034 */
@@ -164,6 +173,7 @@
 #define PARSE_RESV_CONFIRM_IGNORE "resv_confirm_ignore"
 #define PARSE_ALLOW_AOE_CALENDAR "allow_aoe_calendar"
 #define PARSE_OPT_BACKFILL_FUZZY_TIME "opt_backfill_fuzzy_time"
+#define PARSE_CYCLE_PROFILE "cycle_profile"
 
 /* deprecated */
 #define PARSE_SORT_BY "sort_by"
@@ -182,6 +192,7 @@
 #define MAX_HOLIDAY_SIZE 50
 #define MAX_DEDTIME_SIZE 50
 #define MAX_SERVER_DYN_RES 201    /* 200 elements + 1 sentinel */
+#define DYN_RES_TIMEOUT 30	/* default secs a server_dyn_res program may run */
 #define MAX_LOG_SIZE 1024
 #define MAX_RES_NAME_SIZE 256
 #define MAX_RES_RET_SIZE 256
@@ -583,6 +583,87 @@ enum schd_error_args {
 	SPECMSG
 };
 
+/*
+ * Ids of the attributes the scheduler decodes from the server's
+ * batch_status replies, see sched_attr_id().  ATTR_NODE_ProvisionEnable
+ * has the same name as ATTR_ProvisionEnable and shares its id.
+ */
+enum sched_attr_ids
+{
+	SATTR_UNKNOWN,
+	SATTR_p,
+	SATTR_qtime,
+	SATTR_etime,
+	SATTR_stime,
+	SATTR_N,
+	SATTR_state,
+	SATTR_substate,
+	SATTR_sched_preempted,
+	SATTR_comment,
+	SATTR_euser,
+	SATTR_egroup,
+	SATTR_project,
+	SATTR_resv_ID,
+	SATTR_altid,
+	SATTR_SchedSelect,
+	SATTR_array_id,
+	SATTR_node_set,
+	SATTR_array,
+	SATTR_array_index,
+	SATTR_topjob_ineligible,
+	SATTR_array_indices_remaining,
+	SATTR_execvnode,
+	SATTR_l,
+	SATTR_used,
+	SATTR_accrue_type,
+	SATTR_eligible_time,
+	SATTR_estimated,
+	SATTR_c,
+	SATTR_r,
+	SATTR_NODE_state,
+	SATTR_NODE_Mom,
+	SATTR_NODE_Port,
+	SATTR_NODE_jobs,
+	SATTR_NODE_ntype,
+	SATTR_maxrun,
+	SATTR_maxuserrun,
+	SATTR_maxgrprun,
+	SATTR_queue,
+	SATTR_NODE_pcpus,
+	SATTR_NODE_Sharing,
+	SATTR_NODE_License,
+	SATTR_rescavail,
+	SATTR_rescassn,
+	SATTR_NODE_NoMultiNode,
+	SATTR_ResvEnable,
+	SATTR_NODE_current_aoe,
+	SATTR_NODE_in_multivnode_host,
+	SATTR_start,
+	SATTR_HasNodes,
+	SATTR_backfill_depth,
+	SATTR_qtype,
+	SATTR_NodeGroupKey,
+#ifdef NAS
+	SATTR_maxstarve,	/* localmod 046 */
+	SATTR_maxborrow,	/* localmod 034 */
+#endif
+	SATTR_FLicenses,
+	SATTR_NodeGroupEnable,
+	SATTR_job_sort_formula,
+	SATTR_rpp_retry,
+	SATTR_rpp_highwater,
+	SATTR_EligibleTimeEnable,
+	SATTR_ProvisionEnable,
+	SATTR_sched_cycle_len,
+	SATTR_do_not_span_psets,
+	SATTR_sched_preempt_enforce_resumption,
+	SATTR_preempt_targets_enable,
+	SATTR_job_sort_formula_threshold,
+	SATTR_throughput_mode,
+	SATTR_opt_backfill_fuzzy,
+	SATTR_HIGH
+};
+
 #ifdef	__cplusplus
 }
 #endif
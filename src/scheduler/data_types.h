@@ -58,6 +58,7 @@ extern "C" {
 #include <time.h>
 #include <pbs_ifl.h>
 #include <libutil.h>
+#include <avltree.h>
 #include "constant.h"
 #include "config.h"
 #ifdef NAS
@@ -343,6 +344,7 @@ struct server_info
 	 * just a cache.  It will be regenerated when needed
 	 */
 	np_cache **npc_arr;
+	AVL_IX_DESC *npc_ix;		/* index of npc_arr by resource names and node array */
 
 	resource_resv *qrun_job;	/* used if running a job via qrun request */
 	char *job_formula;		/* formula used for sorting */
@@ -596,6 +598,7 @@ struct node_info
 	node_info *svr_node;		/* ptr to svr's node if we're a resv node */
 	node_partition *hostset;      /* other vnodes on on the same host */
 	node_scratch nscr;            /* scratch space local to node search code */
+	unsigned long np_gen;		/* generation of last change (np_node_changed()) */
 };
 
 struct resv_info
@@ -799,6 +802,7 @@ struct node_partition
 	resource *res;		/* total amount of resources in node part */
 	node_info **ninfo_arr;	/* array of pointers to node structures  */
 	int rank;		/* unique numeric identifier for node partition */
+	unsigned long np_gen;	/* newest node generation reflected in res/free_nodes */
 };
 
 struct np_cache
@@ -807,6 +811,8 @@ struct np_cache
 	node_info **ninfo_arr;	/* ptr to array of nodes used to create pools */
 	int num_parts;		/* number of partitions in nodepart */
 	node_partition **nodepart;	/* node partitions */
+	/* sort function used on nodepart, NULL if unsorted */
+	int (*sort_func)(const void *, const void *);
 };
 
 /* header to usage file.  Needs to be EXACTLY the same size as a
@@ -900,6 +906,8 @@ struct dyn_res
 {
 	char *res;
 	char *program;
+	int interval;		/* secs between runs of program */
+	int timeout;		/* secs program may run */
 };
 
 struct peer_queue
@@ -1015,7 +1023,12 @@ struct config
 	char *fairshare_res;			/* resource to calc fairshare usage */
 	float fairshare_decay_factor;			/* decay factor used when decaying fairshare tree */
 	char *fairshare_ent;			/* job attribute to use as fs entity */
+	char *cycle_profile;			/* file to append cycle profiles to */
 	char **dyn_res_to_get;		/* dynamic resources to get from moms */
+	int mom_query_window;			/* max moms queried at once */
+	int mom_query_timeout;		/* secs to wait for a mom's answer */
+	int mom_cache_ttl;			/* secs to reuse a mom's answers */
+	int est_all_jobs_freq;		/* secs between estimates of all jobs */
 	char **res_to_check;			/* the resources schedule on */
 	resdef **resdef_to_check;             /* the res to schedule on in def form */
 	char **ignore_res;			/* resources - unset implies infinite */
@@ -1074,6 +1087,50 @@ struct timed_event
 	timed_event *prev;
 };
 
+/*
+ * An arena hands out memory that lives for one scheduling cycle, carved
+ * out of large chunks with no per-allocation bookkeeping.  Nothing is
+ * freed on its own: arena_reset() gives every chunk back at the end of
+ * the cycle.  See arena_alloc() in misc.c.
+ */
+struct sched_arena
+{
+	const char *sa_name;		/* name of the arena, for logging */
+	size_t sa_chunksize;		/* size of a chunk */
+	void *sa_chunks;		/* chunks, newest first, linked through their header */
+	char *sa_next;			/* next free byte of the newest chunk */
+	size_t sa_left;			/* bytes left in the newest chunk */
+	long sa_nchunks;		/* chunks allocated */
+};
+typedef struct sched_arena sched_arena;
+
+#define ARENA_INIT(name, chunksize) \
+	{ (name), (chunksize), NULL, NULL, 0, 0 }
+
+/*
+ * A pool hands out objects of one type carved out of blocks of
+ * op_per_block, and takes freed ones back on a free list, so building
+ * and freeing the universe every cycle does not go to malloc() for each
+ * object.  A pool whose objects never outlive the cycle takes its blocks
+ * from an arena and is emptied when the arena is reset.  See pool_alloc()
+ * in misc.c.
+ */
+struct obj_pool
+{
+	const char *op_name;		/* type of object, for logging */
+	size_t op_size;			/* size of one object */
+	int op_per_block;		/* objects carved out of each block */
+	sched_arena *op_arena;		/* arena the blocks come from, NULL for malloc() */
+	void *op_free;			/* free objects, linked through their first word */
+	void *op_blocks;		/* blocks, linked through their header */
+	long op_inuse;			/* objects handed out and not freed */
+	long op_nblocks;		/* blocks allocated */
+};
+typedef struct obj_pool obj_pool;
+
+#define POOL_INIT(name, type, per_block, arena) \
+	{ (name), sizeof(type), (per_block), (arena), NULL, NULL, 0, 0 }
+
 #ifdef	__cplusplus
 }
 #endif
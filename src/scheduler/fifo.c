@@ -57,6 +57,8 @@
  * 	sim_run_update_resresv()
  * 	should_backfill_with_job()
  * 	add_job_to_calendar()
+ * 	estimate_all_jobs()
+ * 	start_estimator()
  * 	find_ready_resv_job()
  * 	find_runnable_resresv()
  * 	find_non_normal_job()
@@ -77,12 +79,17 @@
 #include <string.h>
 #include <errno.h>
 #include <unistd.h>
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
 #include <libutil.h>
 #include <pbs_error.h>
 #include <pbs_ifl.h>
 #include <sched_cmds.h>
 #include <time.h>
 #include <log.h>
+#include <libpbs.h>
 #include "data_types.h"
 #include "fifo.h"
 #include "queue_info.h"
@@ -110,6 +117,7 @@
 #include "pbs_share.h"
 #include "pbs_internal.h"
 #include "limits_if.h"
+#include "sched_profile.h"
 
 
 #ifdef NAS
@@ -120,10 +128,17 @@
 static prev_job_info *last_running = NULL;
 static int last_running_size = 0;
 
+#ifndef WIN32
+/* the background start time estimator, see start_estimator() */
+static pid_t estimator_pid = -1;	/* running estimator, -1 if none */
+static time_t estimator_started = 0;	/* time the last one was started */
+#endif
+
 #ifdef WIN32
 extern void win_toolong(void);
 #endif
 
+extern int	server_sock;
 extern int	second_connection;
 extern int	get_sched_cmd_noblk(int sock, int *val, char **jobid);
 
@@ -158,6 +173,9 @@ schedinit(int argc, char *argv[])
 	init_config();
 	parse_config(CONFIG_FILE);
 
+	/* status replies are only read and freed whole, decode into arenas */
+	(void)pbs_stat_arena(1);
+
 	parse_holidays(HOLIDAYS_FILE);
 	time(&(cstat.current_time));
 
@@ -599,10 +617,14 @@ scheduling_cycle(int sd, char *jobid)
 	int error = 0;                /* error happened, don't run main loop */
 	status *policy;		/* policy structure used for cycle */
 	schd_error *err = NULL;
+	int init_ok;			/* return code from init_scheduling_cycle() */
+	prof_stamp pts;			/* start of profiled phase */
 
 	schdlog(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST, LOG_DEBUG,
 		"", "Starting Scheduling Cycle");
 
+	prof_cycle_begin();
+
 	update_cycle_status(&cstat, 0);
 
 #ifdef NAS /* localmod 030 */
@@ -610,7 +632,10 @@ scheduling_cycle(int sd, char *jobid)
 	do_hard_cycle_interrupt = 0;
 #endif /* localmod 030 */
 	/* create the server / queue / job / node structures */
-	if ((sinfo = query_server(&cstat, sd)) == NULL) {
+	prof_begin(&pts);
+	sinfo = query_server(&cstat, sd);
+	prof_end(PROF_QUERY_SERVER, &pts);
+	if (sinfo == NULL) {
 		schdlog(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_NOTICE,
 			"", "Problem with creating server data structure");
 		end_cycle_tasks(sinfo);
@@ -658,7 +683,10 @@ scheduling_cycle(int sd, char *jobid)
 		}
 	}
 
-	if (init_scheduling_cycle(policy, sinfo) == 0) {
+	prof_begin(&pts);
+	init_ok = init_scheduling_cycle(policy, sinfo);
+	prof_end(PROF_INIT_CYCLE, &pts);
+	if (init_ok == 0) {
 		schdlog(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_DEBUG,
 			sinfo->name, "init_scheduling_cycle failed.");
 		end_cycle_tasks(sinfo);
@@ -669,6 +697,12 @@ scheduling_cycle(int sd, char *jobid)
 	if (error == 0)
 		rc = main_sched_loop(policy, sd, sinfo, &err);
 
+#ifndef WIN32
+	/* hand what is left of the queue to the estimator */
+	if (jobid == NULL && error == 0)
+		start_estimator(policy, sd, sinfo);
+#endif
+
 	if (jobid != NULL) {
 		int def_rc = -1;
 		int i;
@@ -767,6 +801,9 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 	int sort_again = DONT_SORT_JOBS;
 	schd_error *err;
 	schd_error *chk_lim_err;
+	prof_stamp jts;			/* start of decision on njob */
+	prof_stamp pts;			/* start of profiled phase */
+	long nodes_start;		/* nodes examined before njob */
 
 
 	if (policy == NULL || sinfo == NULL || rerr == NULL)
@@ -806,6 +843,8 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 		comment[0] = '\0';
 		log_msg[0] = '\0';
 		qinfo = njob->job->queue;
+		prof_begin(&jts);
+		nodes_start = sprof.nodes_examined;
 		
 		clear_schd_error(err);
 		err->status_code = NOT_RUN;
@@ -813,12 +852,14 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 		schdlog(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_DEBUG,
 			njob->name, "Considering job to run");
 
+		prof_begin(&pts);
 		if (njob->is_shrink_to_fit) {
 			/* Pass the suitable heuristic for shrinking */
 			ns_arr = is_ok_to_run_STF(policy, sd, sinfo, qinfo, njob, err, shrink_job_algorithm);
 		}
 		else
 			ns_arr = is_ok_to_run(policy, sd, sinfo, qinfo, njob, NO_FLAGS, err);
+		prof_end(PROF_IS_OK_TO_RUN, &pts);
 		
 		if (err->status_code == NEVER_RUN)
 			njob->can_never_run = 1;
@@ -849,12 +890,14 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 				free_nspecs(ns_arr);
 		}
 		else if (policy->preempting && in_runnable_state(njob) && (!njob -> can_never_run)) {
+			prof_begin(&pts);
 			if (find_and_preempt_jobs(policy, sd, njob, sinfo, err) > 0) {
 				rc = SUCCESS;
 				sort_again = MUST_RESORT_JOBS;
 			}
 			else
 				sort_again = SORTED;
+			prof_end(PROF_PREEMPTION, &pts);
 		}
 
 #ifdef NAS /* localmod 034 */
@@ -888,7 +931,9 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 #else
 			if (should_backfill_with_job(policy, sinfo, njob, num_topjobs)) {
 #endif
+				prof_begin(&pts);
 				cal_rc = add_job_to_calendar(sd, policy, sinfo, njob);
+				prof_end(PROF_CALENDAR, &pts);
 
 				if (cal_rc > 0) { /* Success! */
 #ifdef NAS /* localmod 038 */
@@ -1012,7 +1057,12 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 #endif /* localmod 030 */
 
 		/* send any attribute updates to server that we've collected */
+		prof_begin(&pts);
 		send_job_updates(sd, njob);
+		prof_end(PROF_SEND_UPDATES, &pts);
+
+		prof_job(njob->name, &jts, sprof.nodes_examined - nodes_start,
+			rc == SUCCESS);
 	}
 
 	*rerr = err;
@@ -1034,6 +1084,10 @@ void
 end_cycle_tasks(server_info *sinfo)
 {
 	int i;
+	int arena_busy;		/* a pool on the cycle arena still has objects */
+	prof_stamp pts;
+
+	prof_begin(&pts);
 
 	/* keep track of update used resources for fairshare */
 	if (sinfo != NULL && sinfo->policy->fair_share)
@@ -1047,6 +1101,28 @@ end_cycle_tasks(server_info *sinfo)
 		free_server(sinfo, 1);	/* free server and queues and jobs */
 	}
 
+	/* with the universe gone, pools with nothing left in use give back
+	 * their blocks and the cycle arena is reset.  An object still in use
+	 * in a pool on the arena is a leak; keep the arena and that pool's
+	 * free list rather than leave the object pointing at freed memory.
+	 */
+	arena_busy = 0;
+	for (i = 0; sched_pools[i] != NULL; i++) {
+		if (sched_pools[i]->op_arena == &cycle_arena &&
+			sched_pools[i]->op_inuse != 0) {
+			schdlog(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_DEBUG,
+				sched_pools[i]->op_name,
+				"objects still in use at end of cycle, cycle arena not reset");
+			arena_busy = 1;
+		}
+	}
+	for (i = 0; sched_pools[i] != NULL; i++) {
+		if (!arena_busy || sched_pools[i]->op_arena == NULL)
+			pool_trim(sched_pools[i]);
+	}
+	if (!arena_busy)
+		arena_reset(&cycle_arena);
+
 	/* close any open connections to peers */
 	for (i = 0; (i < NUM_PEERS) &&
 		(conf.peer_queues[i].local_queue != NULL); i++) {
@@ -1065,6 +1141,8 @@ end_cycle_tasks(server_info *sinfo)
 	}
 
 	got_sigpipe = 0;
+	prof_end(PROF_END_CYCLE, &pts);
+	prof_cycle_end();
 	schdlog(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST, LOG_DEBUG,
 		"", "Leaving Scheduling Cycle");
 }
@@ -1348,6 +1426,7 @@ run_update_resresv(status *policy, int pbs_sd, server_info *sinfo,
 	timed_event *te;			/* used to create timed events */
 	sim_info *sim;			/* simulation event trace */
 	resource_resv *rr;
+	prof_stamp pts;				/* start of run request */
 
 	if (resresv == NULL || sinfo == NULL)
 		ret = -1;
@@ -1494,7 +1573,9 @@ run_update_resresv(status *policy, int pbs_sd, server_info *sinfo,
 					fflush(stdout);
 #endif /* localmod 031 */
 
+					prof_begin(&pts);
 					pbsrc = run_job(pbs_sd, rr, execvnode, sinfo->throughput_mode, err);
+					prof_end(PROF_RUN_JOB, &pts);
 
 #ifdef NAS_CLUSTER /* localmod 125 */
 					ret = translate_runjob_return_code(pbsrc, resresv);
@@ -2013,6 +2094,204 @@ add_job_to_calendar(int pbs_sd, status *policy, server_info *sinfo,
 	return 1;
 }
 
+#ifndef WIN32
+/**
+ * @brief
+ * 		estimate_all_jobs - body of the background estimator.  Runs one
+ *		simulation over the estimator's copy of the universe, placing
+ *		the queued jobs in the order the cycle considered them.  Each
+ *		job is run in the simulation at the first time it fits, with its
+ *		start and end events added to the calendar, so every later job
+ *		sees it.  A job is never placed before the one ahead of it.
+ *		Each job's estimate is sent to the server as soon as it is known.
+ *
+ *		Jobs the cycle already put in the calendar (the top jobs) keep
+ *		the cycle's estimate and are not sent again.
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in]	sinfo	-	the estimator's copy of the universe
+ *
+ * @return	int - exit status for the estimator
+ * @retval	0	: every queued job was considered
+ * @retval	1	: the estimator stopped early
+ */
+static int
+estimate_all_jobs(status *policy, server_info *sinfo)
+{
+	resource_resv *job;
+	resource_resv *rr;
+	resource_resv **topjobs = NULL;
+	timed_event *te;
+	time_t start;
+	pid_t parent = getppid();
+	int pbs_sd;
+	int num = 0;
+	int njobs;
+	int ntop = 0;
+	int i;
+	int j;
+	char log_buf[MAX_LOG_SIZE];
+
+	if (policy == NULL || sinfo == NULL || sinfo->jobs == NULL)
+		return 1;
+
+	if ((pbs_sd = pbs_connect(NULL)) < 0) {
+		schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_SCHED, LOG_WARNING, __func__,
+			"Could not connect to the server");
+		return 1;
+	}
+
+	/* the cycle's top jobs; for a subjob, its array was estimated too */
+	for (te = find_init_timed_event(get_next_event(sinfo->calendar),
+		IGNORE_DISABLED_EVENTS, TIMED_RUN_EVENT); te != NULL;
+		te = find_next_timed_event(te, IGNORE_DISABLED_EVENTS, TIMED_RUN_EVENT))
+		ntop++;
+	if (ntop > 0) {
+		topjobs = calloc(2 * ntop, sizeof(resource_resv *));
+		if (topjobs == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			pbs_disconnect(pbs_sd);
+			return 1;
+		}
+		ntop = 0;
+		for (te = find_init_timed_event(get_next_event(sinfo->calendar),
+			IGNORE_DISABLED_EVENTS, TIMED_RUN_EVENT); te != NULL;
+			te = find_next_timed_event(te, IGNORE_DISABLED_EVENTS, TIMED_RUN_EVENT)) {
+			rr = (resource_resv *) te->event_ptr;
+			if (!rr->is_job || rr->job == NULL)
+				continue;
+			topjobs[ntop++] = rr;
+			if (rr->job->is_subjob && rr->job->parent_job != NULL)
+				topjobs[ntop++] = rr->job->parent_job;
+		}
+	}
+
+	/* subjobs queued below are appended to sinfo->jobs; don't walk them */
+	njobs = count_array((void **) sinfo->jobs);
+	for (i = 0; i < njobs; i++) {
+		/* the scheduler went away or the server hung up on us */
+		if (getppid() != parent || got_sigpipe)
+			break;
+
+		job = sinfo->jobs[i];
+		if (job->job == NULL || job->job->resv != NULL || job->can_never_run)
+			continue;
+		if (!in_runnable_state(job))
+			continue;
+		if (!conf.allow_aoe_calendar && job->aoename != NULL)
+			continue;
+		for (j = 0; j < ntop && topjobs[j] != job; j++)
+			;
+		if (j < ntop)
+			continue;
+
+		/* estimate the array's next subjob, as the cycle does for top jobs */
+		if (job->job->is_array) {
+			rr = queue_subjob(job, sinfo, job->job->queue);
+			if (rr == NULL)
+				continue;
+		} else
+			rr = job;
+
+		start = calc_run_time(rr->name, sinfo, SIM_RUN_JOB);
+		if (start <= 0) {
+			schdlog(PBSEVENT_DEBUG, PBS_EVENTCLASS_JOB, LOG_DEBUG,
+				job->name, "Could not estimate the start time of the job");
+			if (start < 0)
+				break;		/* the simulation is no longer usable */
+			continue;
+		}
+
+		if (update_estimated_attrs(pbs_sd, job, start,
+			create_execvnode(rr->nspec_arr), 0) < 0) {
+			schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_SCHED, LOG_WARNING,
+				job->name, "Failed to update estimated attrs.");
+			continue;
+		}
+		send_job_updates(pbs_sd, job);
+		num++;
+	}
+
+	snprintf(log_buf, sizeof(log_buf), "Estimated %d queued jobs in %ld seconds",
+		num, (long) (time(NULL) - estimator_started));
+	schdlog(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__, log_buf);
+
+	free(topjobs);
+	pbs_disconnect(pbs_sd);
+	return (i == njobs) ? 0 : 1;
+}
+
+/**
+ * @brief
+ * 		start_estimator - start the background estimator once the cycle
+ *		is done with the universe, if est_all_jobs_freq seconds have
+ *		passed since the last one was started and it has exited.
+ *
+ *		The estimator is a child of the scheduler.  fork() hands it a
+ *		copy of the universe as the cycle left it, with the cycle's
+ *		runs and top jobs already in the calendar, so the cycle need
+ *		not wait for it or copy anything for it.  It runs at the lowest
+ *		cpu priority on its own connection to the server.
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in]	sd	-	the cycle's connection to the server
+ * @param[in]	sinfo	-	the universe the cycle ran over
+ *
+ * @return	void
+ */
+void
+start_estimator(status *policy, int sd, server_info *sinfo)
+{
+	pid_t pid;
+	time_t now;
+
+	if (estimator_pid > 0) {
+		if (waitpid(estimator_pid, NULL, WNOHANG) == 0)
+			return;		/* still working on an earlier cycle */
+		estimator_pid = -1;
+	}
+
+	if (conf.est_all_jobs_freq <= 0 || policy == NULL || sinfo == NULL)
+		return;
+
+	now = time(NULL);
+	if (now - estimator_started < conf.est_all_jobs_freq)
+		return;
+
+	/*
+	 * The TPP thread logs under the log mutex.  Hold it across the fork
+	 * so the child never inherits it locked mid-record.  TPP's own
+	 * atfork handler tears down the transport in the child, which
+	 * must not touch rpp.
+	 */
+	(void) log_mutex_lock();
+	pid = fork();
+	(void) log_mutex_unlock();
+	if (pid == -1) {
+		schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_SCHED, LOG_WARNING, __func__,
+			"Could not fork the start time estimator");
+		return;
+	}
+	estimator_started = now;
+	if (pid > 0) {
+		estimator_pid = pid;
+		return;
+	}
+
+	/* child: the server must see the cycle end when the scheduler closes */
+	if (sd >= 0 && connection[sd].ch_socket >= 0)
+		close(connection[sd].ch_socket);
+	if (second_connection != -1)
+		close(second_connection);
+	/* nor may it hold the scheduler's port once the scheduler exits */
+	close(server_sock);
+	(void) nice(19);
+
+	/* leave the scheduler's exit processing to the scheduler */
+	_exit(estimate_all_jobs(policy, sinfo));
+}
+#endif /* !WIN32 */
+
 
 /**
  * @brief
@@ -2172,6 +2451,7 @@ next_job(status *policy, server_info *sinfo, int flag)
 	static int queue_list_size; /* Count of number of priority levels in queue_list */
 	resource_resv *rjob = NULL;		/* the job to return */
 	int i = 0;
+	prof_stamp pts;				/* start of job sort */
 #ifdef NAS
 	resource_resv *(*func)(resource_resv **);
 #else
@@ -2193,7 +2473,9 @@ next_job(status *policy, server_info *sinfo, int flag)
 		else if (policy->by_queue)
 			last_queue = 0;
 		skip = SKIP_NOTHING;
+		prof_begin(&pts);
 		sort_jobs(policy, sinfo);
+		prof_end(PROF_SORT_JOBS, &pts);
 		sort_status = SORTED;
 		return NULL;
 	}
@@ -2313,7 +2595,9 @@ next_job(status *policy, server_info *sinfo, int flag)
 
 	if ((sort_status != SORTED) || ((flag == MAY_RESORT_JOBS) && policy->fair_share)
 		|| (flag == MUST_RESORT_JOBS)) {
+		prof_begin(&pts);
 		sort_jobs(policy, sinfo);
+		prof_end(PROF_SORT_JOBS, &pts);
 		sort_status = SORTED;
 	}
 	if (policy->round_robin) {
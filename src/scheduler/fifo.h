@@ -164,6 +164,14 @@ void end_cycle_tasks(server_info *sinfo);
  */
 int add_job_to_calendar(int pbs_sd, status *policy, server_info *sinfo, resource_resv *topjob);
 
+#ifndef WIN32
+/*
+ *	start_estimator - start the background estimator of the start times
+ *		of all queued jobs if it is due
+ */
+void start_estimator(status *policy, int sd, server_info *sinfo);
+#endif
+
 /*
  * 	run_job - handle the running of a pbs job.  If it's a peer job
  *	       first move it to the local server and then run it.
@@ -138,6 +138,36 @@ const int num_resget = sizeof(res_to_get) / sizeof(char *);
 struct config conf;
 struct status cstat;
 
+/*
+ *	cycle_arena - memory of one scheduling cycle, reset in end_cycle_tasks()
+ */
+sched_arena cycle_arena = ARENA_INIT("cycle_arena", 1024 * 1024);
+
+/*
+ *	object pools - the small objects the scheduler builds for each
+ *		       cycle and for each copy of the universe
+ *
+ *	resource_req objects are kept from one cycle to the next for
+ *	fairshare (see create_prev_job_info()), so their pool stays on malloc()
+ */
+obj_pool resresv_pool = POOL_INIT("resource_resv", resource_resv, 256, &cycle_arena);
+obj_pool ninfo_pool = POOL_INIT("node_info", node_info, 256, &cycle_arena);
+obj_pool resource_pool = POOL_INIT("resource", resource, 1024, &cycle_arena);
+obj_pool resreq_pool = POOL_INIT("resource_req", resource_req, 1024, NULL);
+obj_pool nspec_pool = POOL_INIT("nspec", nspec, 1024, &cycle_arena);
+obj_pool timed_event_pool = POOL_INIT("timed_event", timed_event, 256, &cycle_arena);
+
+obj_pool *sched_pools[] =
+	{
+	&resresv_pool,
+	&ninfo_pool,
+	&resource_pool,
+	&resreq_pool,
+	&nspec_pool,
+	&timed_event_pool,
+	NULL
+};
+
 /* resource definitions from the server */
 
 /* all resources */
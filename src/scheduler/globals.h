@@ -81,6 +81,18 @@ extern resdef **boolres;
  */
 extern char *cmp_aoename;
 
+/* memory of one scheduling cycle */
+extern sched_arena cycle_arena;
+
+/* pools of the objects built for each cycle, NULL terminated */
+extern obj_pool resresv_pool;
+extern obj_pool ninfo_pool;
+extern obj_pool resource_pool;
+extern obj_pool resreq_pool;
+extern obj_pool nspec_pool;
+extern obj_pool timed_event_pool;
+extern obj_pool *sched_pools[];
+
 #ifdef	__cplusplus
 }
 #endif
@@ -878,6 +878,7 @@ query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
 	int count;			/* int used in string -> int conversion */
 	char *endp;			/* used for strtol() */
 	resource_req *resreq;		/* resource_req list for resources requested  */
+	int attr_id;			/* id of attrp->name */
 
 	if ((resresv = new_resource_resv()) == NULL)
 		return NULL;
@@ -887,7 +888,7 @@ query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
 		return NULL;
 	}
 
-	resresv->name = string_dup(job->name);
+	resresv->name = arena_strdup(&cycle_arena, job->name);
 	resresv->rank = get_sched_rank();
 
 	attrp = job->attribs;
@@ -912,6 +913,7 @@ query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
 
 	while (attrp != NULL && !resresv->is_invalid) {
 		clear_schd_error(err);
+		attr_id = sched_attr_id(attrp->name);
 		if (!strcmp(attrp->name, conf.fairshare_ent)) {
 			if (sinfo->fairshare != NULL) {
 #ifdef NAS /* localmod 059 */
@@ -935,7 +937,7 @@ query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
 			else
 				resresv->job->ginfo = NULL;
 		}
-		if (!strcmp(attrp->name, ATTR_p)) { /* priority */
+		if (attr_id == SATTR_p) { /* priority */
 			count = strtol(attrp->value, &endp, 10);
 			if (*endp != '\n')
 				resresv->job->priority = count;
@@ -945,62 +947,62 @@ query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
 			resresv->job->NAS_pri = resresv->job->priority;
 #endif /* localmod 045 */
 		}
-		else if (!strcmp(attrp->name, ATTR_qtime)) { /* queue time */
+		else if (attr_id == SATTR_qtime) { /* queue time */
 			count = strtol(attrp->value, &endp, 10);
 			if (*endp != '\n')
 				resresv->qtime = count;
 			else
 				resresv->qtime = -1;
 		}
-		else if (!strcmp(attrp->name, ATTR_etime)) { /* eligible time */
+		else if (attr_id == SATTR_etime) { /* eligible time */
 			count = strtol(attrp->value, &endp, 10);
 			if (*endp != '\n')
 				resresv->job->etime = count;
 			else
 				resresv->job->etime = -1;
 		}
-		else if (!strcmp(attrp->name, ATTR_stime)) { /* job start time */
+		else if (attr_id == SATTR_stime) { /* job start time */
 			count = strtol(attrp->value, &endp, 10);
 			if (*endp != '\n')
 				resresv->job->stime = count;
 			else
 				resresv->job->stime = -1;
 		}
-		else if (!strcmp(attrp->name, ATTR_N))		/* job name (qsub -N) */
+		else if (attr_id == SATTR_N)		/* job name (qsub -N) */
 			resresv->job->job_name = string_dup(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_state)) { /* state of job */
+		else if (attr_id == SATTR_state) { /* state of job */
 			if (set_job_state(attrp->value, resresv->job) == 0) {
 				set_schd_error_codes(err, NEVER_RUN, ERR_SPECIAL);
 				set_schd_error_arg(err, SPECMSG, "Job is in an invalid state");
 				resresv->is_invalid = 1;
 			}
 		}
-		else if (!strcmp(attrp->name, ATTR_substate)) {
+		else if (attr_id == SATTR_substate) {
 			if (!strcmp(attrp->value, SUSP_BY_SCHED_SUBSTATE))
 				resresv->job->is_susp_sched = 1;
 			if (!strcmp(attrp->value, PROVISIONING_SUBSTATE))
 				resresv->job->is_provisioning = 1;
 		}
-		else if (!strcmp(attrp->name, ATTR_sched_preempted)) {
+		else if (attr_id == SATTR_sched_preempted) {
 			count = strtol(attrp->value, &endp, 10);
 			if (*endp != '\n') {
 				resresv->job->time_preempted = count;
 				resresv->job->is_preempted = 1;
 			}
 		}
-		else if (!strcmp(attrp->name, ATTR_comment))	/* job comment */
+		else if (attr_id == SATTR_comment)	/* job comment */
 			resresv->job->comment = string_dup(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_euser))	/* account name */
+		else if (attr_id == SATTR_euser)	/* account name */
 			resresv->user = string_dup(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_egroup))	/* group name */
+		else if (attr_id == SATTR_egroup)	/* group name */
 			resresv->group = string_dup(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_project))	/* project name */
+		else if (attr_id == SATTR_project)	/* project name */
 			resresv->project = string_dup(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_resv_ID))	/* reserve_ID */
+		else if (attr_id == SATTR_resv_ID)	/* reserve_ID */
 			resresv->job->resv_id = string_dup(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_altid))    /* vendor ID */
+		else if (attr_id == SATTR_altid)    /* vendor ID */
 			resresv->job->alt_id = string_dup(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_SchedSelect))
+		else if (attr_id == SATTR_SchedSelect)
 #ifdef NAS /* localmod 031 */
 		{
 			resresv->job->schedsel = string_dup(attrp->value);
@@ -1010,15 +1012,15 @@ query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
 #ifdef NAS /* localmod 031 */
 		}
 #endif /* localmod 031 */
-		else if (!strcmp(attrp->name, ATTR_array_id))
+		else if (attr_id == SATTR_array_id)
 			resresv->job->array_id = string_dup(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_node_set))
+		else if (attr_id == SATTR_node_set)
 			resresv->node_set_str = break_comma_list(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_array)) { /* array */
+		else if (attr_id == SATTR_array) { /* array */
 			if (!strcmp(attrp->value, ATR_TRUE))
 				resresv->job->is_array = 1;
 		}
-		else if (!strcmp(attrp->name, ATTR_array_index)) { /* array_index */
+		else if (attr_id == SATTR_array_index) { /* array_index */
 			count = strtol(attrp->value, &endp, 10);
 			if (*endp != '\n')
 				resresv->job->array_index = count;
@@ -1027,14 +1029,14 @@ query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
 
 			resresv->job->is_subjob = 1;
 		}
-		else if (!strcmp(attrp->name, ATTR_topjob_ineligible)) {
+		else if (attr_id == SATTR_topjob_ineligible) {
 			if (!strcmp(attrp->value, ATR_TRUE))
 				resresv->job->topjob_ineligible = 1;
 		}
 		/* array_indices_remaining */
-		else if (!strcmp(attrp->name, ATTR_array_indices_remaining))
+		else if (attr_id == SATTR_array_indices_remaining)
 			resresv->job->queued_subjobs = range_parse(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_execvnode)) { /* where job is running*/
+		else if (attr_id == SATTR_execvnode) { /* where job is running*/
 			char *selectspec;
 			/*
 			 * An execvnode may have a vnode chunk in it multiple times.
@@ -1055,7 +1057,7 @@ query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
 			if (resresv->nspec_arr != NULL)
 				resresv->ninfo_arr=create_node_array_from_nspec(resresv->nspec_arr);
 		}
-		else if (!strcmp(attrp->name, ATTR_l)) { /* resources requested*/
+		else if (attr_id == SATTR_l) { /* resources requested*/
 			resreq = find_alloc_resource_req_by_str(resresv->resreq, attrp->resource);
 			if (resreq != NULL)
 				set_resource_req(resreq, attrp->value);
@@ -1071,7 +1073,7 @@ query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
 				}
 			}
 		}
-		else if (!strcmp(attrp->name, ATTR_used)) { /* resources used */
+		else if (attr_id == SATTR_used) { /* resources used */
 			resreq =
 				find_alloc_resource_req_by_str(resresv->job->resused, attrp->resource);
 			if (resreq != NULL)
@@ -1079,16 +1081,16 @@ query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
 			if (resresv->job->resused ==NULL)
 				resresv->job->resused = resreq;
 		}
-		else if (!strcmp(attrp->name, ATTR_accrue_type)) {
+		else if (attr_id == SATTR_accrue_type) {
 			count = strtol(attrp->value, &endp, 10);
 			if (*endp != '\n')
 				resresv->job->accrue_type = count;
 			else
 				resresv->job->accrue_type = 0;
 		}
-		else if (!strcmp(attrp->name, ATTR_eligible_time))
+		else if (attr_id == SATTR_eligible_time)
 			resresv->job->eligible_time = (time_t) res_to_num(attrp->value, NULL);
-		else if (!strcmp(attrp->name, ATTR_estimated)) {
+		else if (attr_id == SATTR_estimated) {
 			if (!strcmp(attrp->resource, "start_time")) {
 				resresv->job->est_start_time =
 					(time_t) res_to_num(attrp->value, NULL);
@@ -1096,11 +1098,11 @@ query_job(struct batch_status *job, server_info *sinfo, schd_error *err)
 			else if (!strcmp(attrp->resource, "execvnode"))
 				resresv->job->est_execvnode = string_dup(attrp->value);
 		}
-		else if (!strcmp(attrp->name, ATTR_c)) { /* checkpoint allowed? */
+		else if (attr_id == SATTR_c) { /* checkpoint allowed? */
 			if (strcmp(attrp->value, "n") == 0)
 				resresv->job->can_checkpoint = 0;
 		}
-		else if (!strcmp(attrp->name, ATTR_r)) { /* reque allowed ? */
+		else if (attr_id == SATTR_r) { /* reque allowed ? */
 			if (strcmp(attrp->value, ATR_FALSE) == 0)
 				resresv->job->can_requeue = 0;
 		}
@@ -3364,7 +3366,7 @@ create_subjob_from_array(resource_resv *array, int index, char *subjob_name)
 	subjob->job->array_id = string_dup(array->name);
 	subjob->job->parent_job = array;
 
-	free(subjob->name);
+	arena_free_str(&cycle_arena, subjob->name);
 	if (subjob_name != NULL)
 		subjob->name = subjob_name;
 	else
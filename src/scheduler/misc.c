@@ -84,6 +84,14 @@
  * 		res_to_str_c()
  * 		res_to_str_r()
  * 		res_to_str_re()
+ * 		sched_attr_id()
+ * 		pool_alloc()
+ * 		pool_free()
+ * 		pool_trim()
+ * 		arena_alloc()
+ * 		arena_strdup()
+ * 		arena_free_str()
+ * 		arena_reset()
  *
  */
 #include <pbs_config.h>
@@ -1780,3 +1788,451 @@ res_to_str_re(void *p, enum resource_fields fld, char **buf,
 		return "";
 	return *buf;
 }
+
+/*
+ * Attribute names the scheduler decodes and their ids.  sched_attr_id()
+ * hashes these once into attr_id_slot so each attribute of a status
+ * reply costs one hash and usually one strcmp() instead of a strcmp()
+ * against every name the query function knows.
+ */
+static struct {
+	char	*name;
+	int	 id;
+} sched_attr_names[] = {
+	{ATTR_p,	SATTR_p},
+	{ATTR_qtime,	SATTR_qtime},
+	{ATTR_etime,	SATTR_etime},
+	{ATTR_stime,	SATTR_stime},
+	{ATTR_N,	SATTR_N},
+	{ATTR_state,	SATTR_state},
+	{ATTR_substate,	SATTR_substate},
+	{ATTR_sched_preempted,	SATTR_sched_preempted},
+	{ATTR_comment,	SATTR_comment},
+	{ATTR_euser,	SATTR_euser},
+	{ATTR_egroup,	SATTR_egroup},
+	{ATTR_project,	SATTR_project},
+	{ATTR_resv_ID,	SATTR_resv_ID},
+	{ATTR_altid,	SATTR_altid},
+	{ATTR_SchedSelect,	SATTR_SchedSelect},
+	{ATTR_array_id,	SATTR_array_id},
+	{ATTR_node_set,	SATTR_node_set},
+	{ATTR_array,	SATTR_array},
+	{ATTR_array_index,	SATTR_array_index},
+	{ATTR_topjob_ineligible,	SATTR_topjob_ineligible},
+	{ATTR_array_indices_remaining,	SATTR_array_indices_remaining},
+	{ATTR_execvnode,	SATTR_execvnode},
+	{ATTR_l,	SATTR_l},
+	{ATTR_used,	SATTR_used},
+	{ATTR_accrue_type,	SATTR_accrue_type},
+	{ATTR_eligible_time,	SATTR_eligible_time},
+	{ATTR_estimated,	SATTR_estimated},
+	{ATTR_c,	SATTR_c},
+	{ATTR_r,	SATTR_r},
+	{ATTR_NODE_state,	SATTR_NODE_state},
+	{ATTR_NODE_Mom,	SATTR_NODE_Mom},
+	{ATTR_NODE_Port,	SATTR_NODE_Port},
+	{ATTR_NODE_jobs,	SATTR_NODE_jobs},
+	{ATTR_NODE_ntype,	SATTR_NODE_ntype},
+	{ATTR_maxrun,	SATTR_maxrun},
+	{ATTR_maxuserrun,	SATTR_maxuserrun},
+	{ATTR_maxgrprun,	SATTR_maxgrprun},
+	{ATTR_queue,	SATTR_queue},
+	{ATTR_NODE_pcpus,	SATTR_NODE_pcpus},
+	{ATTR_NODE_Sharing,	SATTR_NODE_Sharing},
+	{ATTR_NODE_License,	SATTR_NODE_License},
+	{ATTR_rescavail,	SATTR_rescavail},
+	{ATTR_rescassn,	SATTR_rescassn},
+	{ATTR_NODE_NoMultiNode,	SATTR_NODE_NoMultiNode},
+	{ATTR_ResvEnable,	SATTR_ResvEnable},
+	{ATTR_NODE_current_aoe,	SATTR_NODE_current_aoe},
+	{ATTR_NODE_in_multivnode_host,	SATTR_NODE_in_multivnode_host},
+	{ATTR_start,	SATTR_start},
+	{ATTR_HasNodes,	SATTR_HasNodes},
+	{ATTR_backfill_depth,	SATTR_backfill_depth},
+	{ATTR_qtype,	SATTR_qtype},
+	{ATTR_NodeGroupKey,	SATTR_NodeGroupKey},
+#ifdef NAS
+	/* localmod 046 */
+	{ATTR_maxstarve,	SATTR_maxstarve},
+	/* localmod 034 */
+	{ATTR_maxborrow,	SATTR_maxborrow},
+#endif
+	{ATTR_FLicenses,	SATTR_FLicenses},
+	{ATTR_NodeGroupEnable,	SATTR_NodeGroupEnable},
+	{ATTR_job_sort_formula,	SATTR_job_sort_formula},
+	{ATTR_rpp_retry,	SATTR_rpp_retry},
+	{ATTR_rpp_highwater,	SATTR_rpp_highwater},
+	{ATTR_EligibleTimeEnable,	SATTR_EligibleTimeEnable},
+	{ATTR_ProvisionEnable,	SATTR_ProvisionEnable},
+	{ATTR_sched_cycle_len,	SATTR_sched_cycle_len},
+	{ATTR_do_not_span_psets,	SATTR_do_not_span_psets},
+	{ATTR_sched_preempt_enforce_resumption,	SATTR_sched_preempt_enforce_resumption},
+	{ATTR_preempt_targets_enable,	SATTR_preempt_targets_enable},
+	{ATTR_job_sort_formula_threshold,	SATTR_job_sort_formula_threshold},
+	{ATTR_throughput_mode,	SATTR_throughput_mode},
+	{ATTR_opt_backfill_fuzzy,	SATTR_opt_backfill_fuzzy},
+};
+
+#define ATTR_ID_SLOTS	256	/* power of 2, well over the table size */
+static int attr_id_slot[ATTR_ID_SLOTS];	/* index+1 into sched_attr_names */
+
+/**
+ * @brief
+ *		sched_attr_id - map an attribute name from a status reply to its
+ *			id in enum sched_attr_ids
+ *
+ * @param[in]	name	-	attribute name
+ *
+ * @return	int
+ * @retval	the attribute id
+ * @retval	SATTR_UNKNOWN	: the scheduler does not decode this attribute
+ *
+ */
+int
+sched_attr_id(char *name)
+{
+	static int built = 0;
+	unsigned int h;
+	char *p;
+	int i;
+
+	if (name == NULL)
+		return SATTR_UNKNOWN;
+
+	if (!built) {
+		for (i = 0; i < (int)(sizeof(sched_attr_names) / sizeof(sched_attr_names[0])); i++) {
+			for (h = 5381, p = sched_attr_names[i].name; *p; p++)
+				h = ((h << 5) + h) + (unsigned char)*p;
+			for (h &= ATTR_ID_SLOTS - 1; attr_id_slot[h] != 0;
+				h = (h + 1) & (ATTR_ID_SLOTS - 1))
+				;
+			attr_id_slot[h] = i + 1;
+		}
+		built = 1;
+	}
+
+	for (h = 5381, p = name; *p; p++)
+		h = ((h << 5) + h) + (unsigned char)*p;
+	for (h &= ATTR_ID_SLOTS - 1; attr_id_slot[h] != 0;
+		h = (h + 1) & (ATTR_ID_SLOTS - 1)) {
+		i = attr_id_slot[h] - 1;
+		if (strcmp(sched_attr_names[i].name, name) == 0)
+			return sched_attr_names[i].id;
+	}
+	return SATTR_UNKNOWN;
+}
+
+/*
+ * Objects in a pool are rounded up to, and blocks start their objects at,
+ * POOL_ALIGN bytes so that any member of a scheduler struct is aligned.
+ */
+#define POOL_ALIGN	16
+#define POOL_OBJSIZE(pool) \
+	(((pool)->op_size + POOL_ALIGN - 1) & ~((size_t)POOL_ALIGN - 1))
+
+/**
+ * @brief
+ *		pool_alloc - get a zeroed object from a pool.  When the pool has no
+ *		free object a new block of op_per_block of them is allocated.
+ *
+ * @par
+ *		If the scheduler is built with SCHED_POOL_DEBUG each object is
+ *		calloc()ed and free()d on its own, so that memory checkers see every
+ *		object.
+ *
+ * @param[in,out]	pool	-	pool to get the object from
+ *
+ * @return	void *
+ * @retval	NULL	: out of memory
+ *
+ */
+void *
+pool_alloc(obj_pool *pool)
+{
+	void *obj;
+#ifndef SCHED_POOL_DEBUG
+	char *block;
+	size_t objsize;
+	int i;
+
+	if (pool->op_free == NULL) {
+		objsize = POOL_OBJSIZE(pool);
+		if (pool->op_arena != NULL)
+			block = arena_alloc(pool->op_arena, POOL_ALIGN + objsize * pool->op_per_block);
+		else
+			block = malloc(POOL_ALIGN + objsize * pool->op_per_block);
+		if (block == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return NULL;
+		}
+		*(void **) block = pool->op_blocks;
+		pool->op_blocks = block;
+		pool->op_nblocks++;
+
+		for (i = pool->op_per_block - 1; i >= 0; i--) {
+			obj = block + POOL_ALIGN + i * objsize;
+			*(void **) obj = pool->op_free;
+			pool->op_free = obj;
+		}
+	}
+
+	obj = pool->op_free;
+	pool->op_free = *(void **) obj;
+	memset(obj, 0, pool->op_size);
+#else
+	if ((obj = calloc(1, pool->op_size)) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+#endif /* SCHED_POOL_DEBUG */
+
+	pool->op_inuse++;
+	return obj;
+}
+
+/**
+ * @brief
+ *		pool_free - give an object back to the pool it came from
+ *
+ * @param[in,out]	pool	-	pool the object came from
+ * @param[in]	obj	-	object to free
+ *
+ * @return	nothing
+ *
+ */
+void
+pool_free(obj_pool *pool, void *obj)
+{
+	if (obj == NULL)
+		return;
+
+	pool->op_inuse--;
+#ifndef SCHED_POOL_DEBUG
+#ifdef DEBUG
+	/* make a use after free show up */
+	memset(obj, 0xdb, pool->op_size);
+#endif /* DEBUG */
+	*(void **) obj = pool->op_free;
+	pool->op_free = obj;
+#else
+	free(obj);
+#endif /* SCHED_POOL_DEBUG */
+}
+
+/**
+ * @brief
+ *		pool_trim - release the blocks of a pool that has no objects in
+ *		use.  Called once the universe of a cycle has been freed, so the
+ *		memory of one large cycle is not held onto for good.  The blocks
+ *		of a pool on an arena are only forgotten; they go back with the
+ *		arena in arena_reset().
+ *
+ * @param[in,out]	pool	-	pool to trim
+ *
+ * @return	nothing
+ *
+ */
+void
+pool_trim(obj_pool *pool)
+{
+	void *block;
+	char logbuf[MAX_LOG_SIZE];
+
+	if (pool->op_inuse != 0 || pool->op_blocks == NULL)
+		return;
+
+	snprintf(logbuf, sizeof(logbuf), "releasing %ld blocks of %d",
+		pool->op_nblocks, pool->op_per_block);
+	schdlog(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SERVER, LOG_DEBUG,
+		pool->op_name, logbuf);
+
+	if (pool->op_arena == NULL) {
+		while ((block = pool->op_blocks) != NULL) {
+			pool->op_blocks = *(void **) block;
+			free(block);
+		}
+	}
+	pool->op_blocks = NULL;
+	pool->op_free = NULL;
+	pool->op_nblocks = 0;
+}
+
+/*
+ * Header of an arena chunk.  The memory handed out starts ARENA_HDRSIZE
+ * bytes into the chunk.
+ */
+struct arena_chunk
+{
+	struct arena_chunk *ac_next;	/* next older chunk */
+	size_t ac_size;			/* bytes after the header */
+};
+#define ARENA_HDRSIZE \
+	((sizeof(struct arena_chunk) + POOL_ALIGN - 1) & ~((size_t)POOL_ALIGN - 1))
+
+/**
+ * @brief
+ *		arena_carve - carve size bytes aligned to align out of the newest
+ *		chunk of an arena, starting a new chunk if it is too full.  A
+ *		request larger than sa_chunksize gets a chunk of its own.
+ *
+ * @param[in,out]	arena	-	arena to carve from
+ * @param[in]	size	-	number of bytes
+ * @param[in]	align	-	alignment, a power of two no more than POOL_ALIGN
+ *
+ * @return	void *
+ * @retval	NULL	: out of memory
+ *
+ */
+static void *
+arena_carve(sched_arena *arena, size_t size, size_t align)
+{
+	struct arena_chunk *chunk;
+	size_t pad;
+	size_t csize;
+	void *ptr;
+
+	pad = (align - ((size_t) arena->sa_next & (align - 1))) & (align - 1);
+	if (arena->sa_next == NULL || pad + size > arena->sa_left) {
+		csize = size > arena->sa_chunksize ? size : arena->sa_chunksize;
+		if ((chunk = malloc(ARENA_HDRSIZE + csize)) == NULL)
+			return NULL;
+		chunk->ac_next = arena->sa_chunks;
+		chunk->ac_size = csize;
+		arena->sa_chunks = chunk;
+		arena->sa_nchunks++;
+		arena->sa_next = (char *) chunk + ARENA_HDRSIZE;
+		arena->sa_left = csize;
+		pad = 0;
+	}
+
+	ptr = arena->sa_next + pad;
+	arena->sa_next += pad + size;
+	arena->sa_left -= pad + size;
+
+	return ptr;
+}
+
+/**
+ * @brief
+ *		arena_alloc - get size bytes aligned to POOL_ALIGN from an arena.
+ *		The memory is not zeroed and is not freed on its own; it lives
+ *		until arena_reset().
+ *
+ * @param[in,out]	arena	-	arena to allocate from
+ * @param[in]	size	-	number of bytes
+ *
+ * @return	void *
+ * @retval	NULL	: out of memory
+ *
+ */
+void *
+arena_alloc(sched_arena *arena, size_t size)
+{
+	return arena_carve(arena, size, POOL_ALIGN);
+}
+
+/**
+ * @brief
+ *		arena_strdup - duplicate a string into an arena.  Free it with
+ *		arena_free_str(), which leaves it to arena_reset().
+ *
+ * @par
+ *		If the scheduler is built with SCHED_POOL_DEBUG the string is
+ *		malloc()ed on its own like string_dup() does, so that memory
+ *		checkers see it.
+ *
+ * @param[in,out]	arena	-	arena to allocate from
+ * @param[in]	str	-	string to duplicate
+ *
+ * @return	char *
+ * @retval	NULL	: str is NULL or out of memory
+ *
+ */
+char *
+arena_strdup(sched_arena *arena, const char *str)
+{
+	char *newstr;
+	size_t len;
+
+	if (str == NULL)
+		return NULL;
+
+	len = strlen(str) + 1;
+#ifndef SCHED_POOL_DEBUG
+	newstr = arena_carve(arena, len, 1);
+#else
+	newstr = malloc(len);
+#endif /* SCHED_POOL_DEBUG */
+	if (newstr == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+	memcpy(newstr, str, len);
+
+	return newstr;
+}
+
+/**
+ * @brief
+ *		arena_free_str - free a string that came either from arena_strdup()
+ *		or from malloc().  A string in the arena is left to arena_reset().
+ *
+ * @param[in]	arena	-	arena the string may have come from
+ * @param[in]	str	-	string to free
+ *
+ * @return	nothing
+ *
+ */
+void
+arena_free_str(sched_arena *arena, char *str)
+{
+#ifndef SCHED_POOL_DEBUG
+	struct arena_chunk *chunk;
+	char *start;
+
+	if (str == NULL)
+		return;
+
+	for (chunk = arena->sa_chunks; chunk != NULL; chunk = chunk->ac_next) {
+		start = (char *) chunk + ARENA_HDRSIZE;
+		if (str >= start && str < start + chunk->ac_size)
+			return;
+	}
+#endif /* SCHED_POOL_DEBUG */
+
+	free(str);
+}
+
+/**
+ * @brief
+ *		arena_reset - give back all the memory of an arena at once.  Every
+ *		pool on the arena must have been trimmed with no objects in use,
+ *		and nothing may point into the arena any more.
+ *
+ * @param[in,out]	arena	-	arena to reset
+ *
+ * @return	nothing
+ *
+ */
+void
+arena_reset(sched_arena *arena)
+{
+	struct arena_chunk *chunk;
+	char logbuf[MAX_LOG_SIZE];
+
+	if (arena->sa_chunks == NULL)
+		return;
+
+	snprintf(logbuf, sizeof(logbuf), "releasing %ld chunks of %lu bytes",
+		arena->sa_nchunks, (unsigned long) arena->sa_chunksize);
+	schdlog(PBSEVENT_DEBUG3, PBS_EVENTCLASS_SERVER, LOG_DEBUG,
+		arena->sa_name, logbuf);
+
+	while ((chunk = arena->sa_chunks) != NULL) {
+		arena->sa_chunks = chunk->ac_next;
+		free(chunk);
+	}
+	arena->sa_next = NULL;
+	arena->sa_left = 0;
+	arena->sa_nchunks = 0;
+}
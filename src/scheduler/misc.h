@@ -314,6 +314,47 @@ add_str_to_array(char ***str_arr, char *str);
 int 
 add_str_to_unique_array(char ***str_arr, char *str);
 
+/*
+ * map an attribute name from a status reply to its enum sched_attr_ids id
+ */
+int
+sched_attr_id(char *name);
+
+/*
+ * get a zeroed object from an object pool
+ */
+void *pool_alloc(obj_pool *pool);
+
+/*
+ * give an object back to its object pool
+ */
+void pool_free(obj_pool *pool, void *obj);
+
+/*
+ * release the blocks of an object pool with no objects in use
+ */
+void pool_trim(obj_pool *pool);
+
+/*
+ * get memory that lives until the arena is reset
+ */
+void *arena_alloc(sched_arena *arena, size_t size);
+
+/*
+ * duplicate a string into an arena
+ */
+char *arena_strdup(sched_arena *arena, const char *str);
+
+/*
+ * free a string that came from an arena or from malloc()
+ */
+void arena_free_str(sched_arena *arena, char *str);
+
+/*
+ * give back all the memory of an arena
+ */
+void arena_reset(sched_arena *arena);
+
 #ifdef	__cplusplus
 }
 #endif
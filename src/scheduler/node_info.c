@@ -52,6 +52,7 @@
  * 	remove_node_state()
  * 	add_node_state()
  * 	talk_with_mom()
+ * 	talk_with_moms()
  * 	node_filter()
  * 	find_node_info()
  * 	find_node_by_host()
@@ -144,6 +145,7 @@
 #include "pbs_internal.h"
 #include "server_info.h"
 #include "pbs_share.h"
+#include "sched_profile.h"
 #ifdef NAS
 #include "site_code.h"
 #endif
@@ -220,21 +222,15 @@ query_nodes(int pbs_sd, server_info *sinfo)
 
 		ninfo->rank = get_sched_rank();
 
-		/* get node info from mom */
-		if (talk_with_mom(ninfo)) {
-			/* failed to get information from node, mark it not free for this cycle */
-			ninfo->is_free = 0;
-			ninfo->is_offline = 1;
-			schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_NODE, LOG_INFO, ninfo->name,
-				"Failed to talk with mom, marking node offline");
-		}
-
 		ninfo_arr[i] = ninfo;
 
 		cur_node = cur_node->next;
 	}
 	ninfo_arr[i] = NULL;
 
+	/* get node info from the moms */
+	talk_with_moms(ninfo_arr);
+
 	if (update_mom_resources(ninfo_arr) == 0) {
 		pbs_statfree(nodes);
 		free_nodes(ninfo_arr);
@@ -270,13 +266,14 @@ query_node_info(struct batch_status *node, server_info *sinfo)
 	sch_resource_t count;		/* used to convert str -> num */
 	char *endp;			/* end pointer for strtol */
 	char logbuf[256];		/* log buffer */
+	int attr_id;			/* id of attrp->name */
 
 	if ((ninfo = new_node_info()) == NULL)
 		return NULL;
 
 	attrp = node->attribs;
 
-	if ((ninfo->name = string_dup(node->name)) == NULL) {
+	if ((ninfo->name = arena_strdup(&cycle_arena, node->name)) == NULL) {
 		free_node_info(ninfo);
 		return NULL;
 	}
@@ -284,12 +281,13 @@ query_node_info(struct batch_status *node, server_info *sinfo)
 	ninfo->server = sinfo;
 
 	while (attrp != NULL) {
+		attr_id = sched_attr_id(attrp->name);
 		/* Node State... i.e. offline down free etc */
-		if (!strcmp(attrp->name, ATTR_NODE_state))
+		if (attr_id == SATTR_NODE_state)
 			set_node_state(ninfo, attrp->value);
 
 		/* Host name */
-		else if (!strcmp(attrp->name, ATTR_NODE_Mom)) {
+		else if (attr_id == SATTR_NODE_Mom) {
 			if (ninfo->mom)
 				free(ninfo->mom);
 			if ((ninfo->mom = string_dup(attrp->value)) == NULL) {
@@ -301,47 +299,47 @@ query_node_info(struct batch_status *node, server_info *sinfo)
 		 * we need the resource monitor port which is
 		 * defined as mom/server port + 1
 		 */
-		else if (!strcmp(attrp->name, ATTR_NODE_Port)) {
+		else if (attr_id == SATTR_NODE_Port) {
 			count = strtol(attrp->value, &endp, 10);
 			if (*endp == '\0')
 				ninfo->port = count + 1;
 		}
-		else if (!strcmp(attrp->name, ATTR_NODE_jobs))
+		else if (attr_id == SATTR_NODE_jobs)
 			ninfo->jobs = break_comma_list(attrp->value);
 
 		/* the node type... i.e. a pbs node  */
-		else if (!strcmp(attrp->name, ATTR_NODE_ntype))
+		else if (attr_id == SATTR_NODE_ntype)
 			set_node_type(ninfo, attrp->value);
-		else if (!strcmp(attrp->name, ATTR_maxrun)) {
+		else if (attr_id == SATTR_maxrun) {
 			count = strtol(attrp->value, &endp, 10);
 			if (*endp == '\0')
 				ninfo->max_running = count;
 		}
-		else if (!strcmp(attrp->name, ATTR_maxuserrun)) {
+		else if (attr_id == SATTR_maxuserrun) {
 			count = strtol(attrp->value, &endp, 10);
 			if (*endp == '\0')
 				ninfo->max_user_run = count;
 			ninfo->has_hard_limit = 1;
 		}
-		else if (!strcmp(attrp->name, ATTR_maxgrprun)) {
+		else if (attr_id == SATTR_maxgrprun) {
 			count = strtol(attrp->value, &endp, 10);
 			if (*endp == '\0')
 				ninfo->max_group_run = count;
 			ninfo->has_hard_limit = 1;
 		}
-		else if (!strcmp(attrp->name, ATTR_queue))
+		else if (attr_id == SATTR_queue)
 			ninfo->queue_name = string_dup(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_NODE_pcpus)) {
+		else if (attr_id == SATTR_NODE_pcpus) {
 			count = strtol(attrp->value, &endp, 10);
 			if (*endp == '\0')
 				ninfo->pcpus = count;
 		}
-		else if (!strcmp(attrp->name, ATTR_p)) {
+		else if (attr_id == SATTR_p) {
 			count = strtol(attrp->value, &endp, 10);
 			if (*endp == '\0')
 				ninfo->priority = count;
 		}
-		else if (!strcmp(attrp->name, ATTR_NODE_Sharing)) {
+		else if (attr_id == SATTR_NODE_Sharing) {
 			ninfo->sharing = str_to_vnode_sharing(attrp->value);
 			if (ninfo->sharing == VNS_UNSET) {
 				sprintf(logbuf, "Unknown sharing type: %s using default shared", attrp->value);
@@ -350,7 +348,7 @@ query_node_info(struct batch_status *node, server_info *sinfo)
 				ninfo->sharing = VNS_DFLT_SHARED;
 			}
 		}
-		else if (!strcmp(attrp->name, ATTR_NODE_License)) {
+		else if (attr_id == SATTR_NODE_License) {
 			switch (attrp->value[0]) {
 				case ND_LIC_TYPE_locked:
 					ninfo->lic_lock = 1;
@@ -362,7 +360,7 @@ query_node_info(struct batch_status *node, server_info *sinfo)
 						ninfo->name, logbuf);
 			}
 		}
-		else if (!strcmp(attrp->name, ATTR_rescavail)) {
+		else if (attr_id == SATTR_rescavail) {
 			res = find_alloc_resource_by_str(ninfo->res, attrp->resource);
 
 			if (res != NULL) {
@@ -379,7 +377,7 @@ query_node_info(struct batch_status *node, server_info *sinfo)
 #endif /* localmod 034 */
 			}
 		}
-		else if (!strcmp(attrp->name, ATTR_rescassn)) {
+		else if (attr_id == SATTR_rescassn) {
 			res = find_alloc_resource_by_str(ninfo->res, attrp->resource);
 
 			if (ninfo->res == NULL)
@@ -392,23 +390,23 @@ query_node_info(struct batch_status *node, server_info *sinfo)
 				}
 			}
 		}
-		else if (!strcmp(attrp->name, ATTR_NODE_NoMultiNode)) {
+		else if (attr_id == SATTR_NODE_NoMultiNode) {
 			if (!strcmp(attrp->value, ATR_TRUE))
 				ninfo->no_multinode_jobs = 1;
 		}
-		else if (!strcmp(attrp->name, ATTR_ResvEnable)) {
+		else if (attr_id == SATTR_ResvEnable) {
 			if (!strcmp(attrp->value, ATR_TRUE))
 				ninfo->resv_enable = 1;
 		}
-		else if (!strcmp(attrp->name, ATTR_NODE_ProvisionEnable)) {
+		else if (attr_id == SATTR_ProvisionEnable) {
 			if (!strcmp(attrp->value, ATR_TRUE))
 				ninfo->provision_enable = 1;
 		}
-		else if (!strcmp(attrp->name, ATTR_NODE_current_aoe)) {
+		else if (attr_id == SATTR_NODE_current_aoe) {
 			if (attrp->value != NULL)
 				set_current_aoe(ninfo, attrp->value);
 		}
-		else if (!strcmp(attrp->name, ATTR_NODE_in_multivnode_host)) {
+		else if (attr_id == SATTR_NODE_in_multivnode_host) {
 			if (attrp->value != NULL) {
 				count = strtol(attrp->value, &endp, 10);
 				if (*endp == '\0')
@@ -434,10 +432,8 @@ new_node_info()
 {
 	node_info *new;
 
-	if ((new = (node_info *) malloc(sizeof(node_info))) == NULL) {
-		log_err(errno, "new_node_info", MEM_ERR_MSG);
+	if ((new = pool_alloc(&ninfo_pool)) == NULL)
 		return NULL;
-	}
 
 	new->is_down = 0;
 	new->is_free = 0;
@@ -503,6 +499,7 @@ new_node_info()
 	new->hostset = NULL;
 
 	memset(&new->nscr, 0, sizeof(node_scratch));
+	new->np_gen = 0;
 
 #ifdef NAS
 	/* localmod 034 */
@@ -549,8 +546,7 @@ void
 free_node_info(node_info *ninfo)
 {
 	if (ninfo != NULL) {
-		if (ninfo->name != NULL)
-			free(ninfo->name);
+		arena_free_str(&cycle_arena, ninfo->name);
 
 		if (ninfo->mom != NULL)
 			free(ninfo->mom);
@@ -583,7 +579,7 @@ free_node_info(node_info *ninfo)
 			free(ninfo->nodesig);
 
 
-		free(ninfo);
+		pool_free(&ninfo_pool, ninfo);
 	}
 }
 
@@ -795,53 +791,219 @@ add_node_state(node_info *ninfo, char *state)
 	return 0;
 }
 
+/*
+ * Answers from a mom to the res_to_get and mom_resources queries, kept
+ * between cycles so a mom need not be asked again for mom_cache_ttl seconds
+ */
+struct mom_answers {
+	char *name;			/* node name */
+	time_t when;			/* time the answers arrived */
+	int nans;			/* number of queries answered */
+	char **ans;			/* NULL terminated answers */
+	struct mom_answers *next;
+};
+
+#define MOM_CACHE_SIZE 1024
+static struct mom_answers *mom_cache[MOM_CACHE_SIZE];
+
 /**
  * @brief
- *      talk_with_mom - talk to mom and get resources
+ *		mom_cache_slot - hash a node name into mom_cache
  *
- * @param[in,out]	ninfo	-	the node to to talk to its mom
+ * @param[in]	name	-	node name
  *
  * @return	int
- * @return	1	: on error
- * @return	0	: on success
+ * @retval	index into mom_cache
+ */
+static int
+mom_cache_slot(char *name)
+{
+	unsigned int h = 5381;
+
+	while (*name)
+		h = (h * 33) ^ (unsigned char) *name++;
+	return (h % MOM_CACHE_SIZE);
+}
+
+/**
+ * @brief
+ *		find_mom_answers - find answers from a mom which are still
+ *		fresh enough to be used instead of asking it again
+ *
+ * @param[in]	name	-	node name
+ * @param[in]	nans	-	number of queries the answers must cover
  *
+ * @return	char **
+ * @retval	the cached answers (owned by the cache)
+ * @retval	NULL	: nothing cached or it is too old
  */
-int
-talk_with_mom(node_info *ninfo)
+static char **
+find_mom_answers(char *name, int nans)
 {
-	int mom_sd;			/* connection descriptor to mom */
-	int ret = 0;			/* return code of this function */
-	char *mom_ans = NULL;		/* the answer from mom - getreq() */
-	char *endp;			/* used with strtol() */
-	double testd;			/* used to convert string -> double */
-	resource *res;                /* used for dynamic resources from mom */
-	int ncpus = 1;		/* used as a default for loads */
-	char errbuf[MAX_LOG_SIZE];
-	int i;
+	struct mom_answers *ma;
 
-	if (!should_talk_with_mom(ninfo))
-		return 0;
+	if (conf.mom_cache_ttl <= 0)
+		return NULL;
+
+	for (ma = mom_cache[mom_cache_slot(name)]; ma != NULL; ma = ma->next) {
+		if (strcmp(ma->name, name) == 0) {
+			if (ma->nans == nans && ma->when + conf.mom_cache_ttl > time(NULL))
+				return ma->ans;
+			return NULL;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief
+ *		cache_mom_answers - remember the answers from a mom
+ *
+ * @param[in]	name	-	node name
+ * @param[in]	ans	-	answers, the cache takes them over
+ * @param[in]	nans	-	number of answers
+ *
+ * @return	void
+ */
+static void
+cache_mom_answers(char *name, char **ans, int nans)
+{
+	struct mom_answers *ma;
+	int slot;
+
+	if (conf.mom_cache_ttl <= 0) {
+		free_string_array(ans);
+		return;
+	}
+
+	slot = mom_cache_slot(name);
+	for (ma = mom_cache[slot]; ma != NULL; ma = ma->next) {
+		if (strcmp(ma->name, name) == 0)
+			break;
+	}
+	if (ma == NULL) {
+		if ((ma = calloc(1, sizeof(struct mom_answers))) == NULL) {
+			free_string_array(ans);
+			return;
+		}
+		if ((ma->name = string_dup(name)) == NULL) {
+			free(ma);
+			free_string_array(ans);
+			return;
+		}
+		ma->next = mom_cache[slot];
+		mom_cache[slot] = ma;
+	}
+	else
+		free_string_array(ma->ans);
+
+	ma->ans = ans;
+	ma->nans = nans;
+	ma->when = time(NULL);
+}
+
+/**
+ * @brief
+ *		send_mom_query - open a connection to a node's mom and queue the
+ *		res_to_get and mom_resources queries on it.  The queries go out
+ *		with the next getreq() or waitreq().
+ *
+ * @param[in]	ninfo	-	the node whose mom to ask
+ *
+ * @return	int
+ * @retval	connection descriptor to mom
+ * @retval	-1	: on error
+ */
+static int
+send_mom_query(node_info *ninfo)
+{
+	int mom_sd;
+	int i;
 
 	schdlog(PBSEVENT_DEBUG2, PBS_EVENTCLASS_NODE, LOG_DEBUG, ninfo->name,
 		"Initiating communication with mom");
 	if ((mom_sd = openrm(ninfo->mom, ninfo->port)) < 0) {
 		schdlog(PBSEVENT_SYSTEM, PBS_EVENTCLASS_REQUEST, LOG_INFO, ninfo->name,
 			"Cannot open connection to mom");
-		return 1;
+		return -1;
 	}
 
 	for (i = 0; i < num_resget; i++)
-		addreq(mom_sd, (char *) res_to_get[i]);
+		if (addreq(mom_sd, (char *) res_to_get[i]) == -1)
+			return -1;
 
 	if (conf.dyn_res_to_get) {
 		for (i = 0; conf.dyn_res_to_get[i]; i++)
-			addreq(mom_sd, (char *) conf.dyn_res_to_get[i]);
+			if (addreq(mom_sd, (char *) conf.dyn_res_to_get[i]) == -1)
+				return -1;
+	}
+	return mom_sd;
+}
+
+/**
+ * @brief
+ *		read_mom_answers - read the answers to send_mom_query() and close
+ *		the connection to mom
+ *
+ * @param[in]	ninfo	-	the node whose mom was asked
+ * @param[in]	mom_sd	-	connection descriptor to mom
+ * @param[in]	nans	-	number of queries sent
+ *
+ * @return	char **
+ * @retval	NULL terminated answers, fewer than nans if mom stopped answering
+ * @retval	NULL	: out of memory
+ */
+static char **
+read_mom_answers(node_info *ninfo, int mom_sd, int nans)
+{
+	char **ans;
+	int i;
+
+	if ((ans = calloc(nans + 1, sizeof(char *))) != NULL) {
+		for (i = 0; i < nans && (ans[i] = getreq(mom_sd)) != NULL; i++)
+			;
 	}
+	else
+		log_err(errno, __func__, MEM_ERR_MSG);
+
+	closerm(mom_sd);
+	schdlog(PBSEVENT_DEBUG2, PBS_EVENTCLASS_NODE, LOG_DEBUG, ninfo->name,
+		"Ended communication with mom");
+	return ans;
+}
+
+/**
+ * @brief
+ *		set_mom_answers - set a node's loads and mom_resources from the
+ *		answers its mom gave
+ *
+ * @param[in,out]	ninfo	-	the node
+ * @param[in]	ans	-	NULL terminated answers in the order asked
+ *
+ * @return	int
+ * @return	1	: on error
+ * @return	0	: on success
+ *
+ */
+static int
+set_mom_answers(node_info *ninfo, char **ans)
+{
+	int ret = 0;			/* return code of this function */
+	char *mom_ans;		/* the answer from mom */
+	char *endp;			/* used with strtol() */
+	double testd;			/* used to convert string -> double */
+	resource *res;                /* used for dynamic resources from mom */
+	int ncpus = 1;		/* used as a default for loads */
+	char errbuf[MAX_LOG_SIZE];
+	int i, j;
+
+	if (ans == NULL)
+		return 1;
 
 	if ((res = find_resource(ninfo->res, getallres(RES_NCPUS))))
 		ncpus = res->avail;
 
-	for (i = 0; i < num_resget && (mom_ans = getreq(mom_sd)); i++) {
+	for (i = 0; i < num_resget && (mom_ans = ans[i]); i++) {
 		if (!strcmp(res_to_get[i], "max_load")) {
 			testd = strtod(mom_ans, &endp);
 			if (*endp == '\0')
@@ -868,24 +1030,18 @@ talk_with_mom(node_info *ninfo)
 			schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_NODE, LOG_INFO,
 				ninfo->name, errbuf);
 		}
-		free(mom_ans);
-		mom_ans = NULL;
 	}
 
-	/* getreq() returned NULL and we bailed out of the loop */
+	/* mom stopped answering */
 	if (i < num_resget) {
 		ret = 1;
 		schdlog(PBSEVENT_SYSTEM, PBS_EVENTCLASS_REQUEST, LOG_INFO, ninfo->name,
 			"Communications problem talking with mom.");
 	}
 
-	if (mom_ans)
-		free(mom_ans);
-	mom_ans = NULL;
-
 	if (ret == 0 && conf.dyn_res_to_get) {
-		for (i = 0; conf.dyn_res_to_get[i] && (mom_ans = getreq(mom_sd));  i++) {
-			res = find_alloc_resource_by_str(ninfo->res, conf.dyn_res_to_get[i]);
+		for (j = 0; conf.dyn_res_to_get[j] && (mom_ans = ans[i]);  i++, j++) {
+			res = find_alloc_resource_by_str(ninfo->res, conf.dyn_res_to_get[j]);
 			if (res != NULL) {
 				if (mom_ans[0] != '?') {
 					if (set_resource(res, mom_ans, RF_AVAIL) == 0) {
@@ -901,24 +1057,212 @@ talk_with_mom(node_info *ninfo)
 				schdlog(PBSEVENT_DEBUG2, PBS_EVENTCLASS_NODE, LOG_DEBUG,
 					"mom_resources", errbuf);
 			}
-			free(mom_ans);
-			mom_ans = NULL;
 		}
-		if (conf.dyn_res_to_get[i]) {
+		if (ret == 0 && conf.dyn_res_to_get[j]) {
 			ret = 1;
 			schdlog(PBSEVENT_SYSTEM, PBS_EVENTCLASS_REQUEST, LOG_INFO, ninfo->name,
 				"Communications problem talking with mom.");
 		}
 	}
-	if (mom_ans)
-		free(mom_ans);
-	mom_ans = NULL;
+	return (ret);
+}
 
-	closerm(mom_sd);
-	schdlog(PBSEVENT_DEBUG2, PBS_EVENTCLASS_NODE, LOG_DEBUG, ninfo->name,
-		"Ended communication with mom");
+/**
+ * @brief
+ *		num_mom_queries - the number of queries sent to each mom
+ *
+ * @return	int
+ */
+static int
+num_mom_queries(void)
+{
+	int nans = num_resget;
+
+	if (conf.dyn_res_to_get)
+		nans += count_array((void **) conf.dyn_res_to_get);
+	return nans;
+}
+
+/**
+ * @brief
+ *		mom_query_failed - mark a node whose mom could not be talked to
+ *
+ * @param[in,out]	ninfo	-	the node
+ *
+ * @return	void
+ */
+static void
+mom_query_failed(node_info *ninfo)
+{
+	/* failed to get information from node, mark it not free for this cycle */
+	ninfo->is_free = 0;
+	ninfo->is_offline = 1;
+	schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_NODE, LOG_INFO, ninfo->name,
+		"Failed to talk with mom, marking node offline");
+}
+
+/**
+ * @brief
+ *      talk_with_mom - talk to mom and get resources
+ *
+ * @param[in,out]	ninfo	-	the node to to talk to its mom
+ *
+ * @return	int
+ * @return	1	: on error
+ * @return	0	: on success
+ *
+ */
+int
+talk_with_mom(node_info *ninfo)
+{
+	int mom_sd;			/* connection descriptor to mom */
+	char **ans;
+	int nans;
+	int ret;
+
+	if (!should_talk_with_mom(ninfo))
+		return 0;
+
+	nans = num_mom_queries();
+	if ((ans = find_mom_answers(ninfo->name, nans)) != NULL)
+		return set_mom_answers(ninfo, ans);
+
+	if ((mom_sd = send_mom_query(ninfo)) < 0)
+		return 1;
+
+	ans = read_mom_answers(ninfo, mom_sd, nans);
+	ret = set_mom_answers(ninfo, ans);
+	if (ret == 0)
+		cache_mom_answers(ninfo->name, ans, nans);
+	else
+		free_string_array(ans);
 	return (ret);
 }
+
+/**
+ * @brief
+ *      talk_with_moms - talk to the moms of an array of nodes and get
+ *		resources.  Up to conf.mom_query_window moms are asked at once and
+ *		each answer is read as it arrives, so a slow or dead mom only
+ *		holds up its own node, for at most conf.mom_query_timeout seconds.
+ *		Nodes whose moms could not be talked to are marked offline.
+ *
+ * @param[in,out]	ninfo_arr	-	the nodes to talk to the moms of
+ *
+ * @return	void
+ *
+ */
+void
+talk_with_moms(node_info **ninfo_arr)
+{
+	struct mom_query {
+		node_info *ninfo;
+		int sd;			/* connection to mom, -1 if slot is free */
+		time_t start;		/* time the query was sent */
+	} *q;
+	int window;
+	int inflight = 0;
+	int nans;
+	int next = 0;
+	int wait;
+	int sd;
+	char **ans;
+	node_info *ninfo;
+	time_t now;
+	int i;
+
+	if (ninfo_arr == NULL)
+		return;
+
+	window = conf.mom_query_window > 0 ? conf.mom_query_window : 1;
+	if ((q = malloc(window * sizeof(struct mom_query))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		/* fall back to one mom at a time */
+		for (i = 0; ninfo_arr[i] != NULL; i++) {
+			if (talk_with_mom(ninfo_arr[i]))
+				mom_query_failed(ninfo_arr[i]);
+		}
+		return;
+	}
+	for (i = 0; i < window; i++)
+		q[i].sd = -1;
+
+	nans = num_mom_queries();
+
+	while (ninfo_arr[next] != NULL || inflight > 0) {
+		/* fill the window */
+		for (i = 0; i < window && ninfo_arr[next] != NULL; i++) {
+			if (q[i].sd != -1)
+				continue;
+
+			ninfo = ninfo_arr[next++];
+			if (!should_talk_with_mom(ninfo))
+				continue;
+
+			if ((ans = find_mom_answers(ninfo->name, nans)) != NULL) {
+				if (set_mom_answers(ninfo, ans))
+					mom_query_failed(ninfo);
+				continue;
+			}
+
+			if ((sd = send_mom_query(ninfo)) < 0) {
+				mom_query_failed(ninfo);
+				continue;
+			}
+			q[i].ninfo = ninfo;
+			q[i].sd = sd;
+			q[i].start = time(NULL);
+			inflight++;
+		}
+		if (inflight == 0)
+			continue;
+
+		/* wait no longer than the oldest query has left */
+		now = time(NULL);
+		wait = conf.mom_query_timeout;
+		for (i = 0; i < window; i++) {
+			if (q[i].sd != -1 && q[i].start + conf.mom_query_timeout - now < wait)
+				wait = q[i].start + conf.mom_query_timeout - now;
+		}
+		if (wait < 0)
+			wait = 0;
+
+		sd = waitreq(wait);
+		if (sd >= 0) {
+			for (i = 0; i < window && q[i].sd != sd; i++)
+				;
+			if (i < window) {
+				ninfo = q[i].ninfo;
+				q[i].sd = -1;
+				inflight--;
+
+				ans = read_mom_answers(ninfo, sd, nans);
+				if (set_mom_answers(ninfo, ans) == 0)
+					cache_mom_answers(ninfo->name, ans, nans);
+				else {
+					free_string_array(ans);
+					mom_query_failed(ninfo);
+				}
+			}
+		}
+
+		/* give up on the moms which are out of time */
+		now = time(NULL);
+		for (i = 0; i < window; i++) {
+			if (q[i].sd == -1)
+				continue;
+			if (sd == -1 || q[i].start + conf.mom_query_timeout <= now) {
+				schdlog(PBSEVENT_SYSTEM, PBS_EVENTCLASS_REQUEST, LOG_INFO,
+					q[i].ninfo->name, "Timed out waiting for mom to answer");
+				closerm(q[i].sd);
+				mom_query_failed(q[i].ninfo);
+				q[i].sd = -1;
+				inflight--;
+			}
+		}
+	}
+	free(q);
+}
 /**
  * @brief
  *		node_filter - filter a node array and return a new filterd array
@@ -1250,6 +1594,7 @@ dup_node_info(node_info *onode, server_info *nsinfo,
 			onode->hostset->rank);
 
 	nnode->nscr = onode->nscr;
+	nnode->np_gen = onode->np_gen;
 
 #ifdef NAS /* localmod 049 */
 	nnode->NASrank = onode->NASrank;
@@ -1505,6 +1850,8 @@ update_node_on_run(nspec *ns, resource_resv *resresv)
 	if (ninfo->is_offline || ninfo->is_down)
 		return;
 
+	np_node_changed(ninfo);
+
 	if (resresv->is_job) {
 		ninfo->num_jobs++;
 		if (find_resource_resv_by_rank(ninfo->job_arr, resresv->rank) ==NULL) {
@@ -1534,8 +1881,11 @@ update_node_on_run(nspec *ns, resource_resv *resresv)
 			res = find_resource(ninfo->res, resreq->def);
 
 			if (res != NULL) {
-				if (res->indirect_res != NULL)
+				if (res->indirect_res != NULL) {
+					np_node_changed(find_node_info(ninfo->server->nodes,
+						res->indirect_vnode_name));
 					res = res->indirect_res;
+				}
 
 				res->assigned += resreq->amount;
 
@@ -1584,6 +1934,7 @@ update_node_on_run(nspec *ns, resource_resv *resresv)
 			if (resresv->job != NULL && resresv->job->resv != NULL &&
 				ninfo->svr_node != NULL) {
 				set_node_state(ninfo->svr_node, ND_prov);
+				np_node_changed(ninfo->svr_node);
 			}
 
 
@@ -1629,6 +1980,8 @@ update_node_on_end(node_info *ninfo, resource_resv *resresv)
 	if (ninfo->is_offline || ninfo->is_down)
 		return;
 
+	np_node_changed(ninfo);
+
 	if (resresv->is_job) {
 		ninfo->num_jobs--;
 		if (ninfo->num_jobs < 0)
@@ -1654,8 +2007,10 @@ update_node_on_end(node_info *ninfo, resource_resv *resresv)
 	}
 	else if (is_excl(resresv->place_spec, ninfo->sharing)) {
 		if (resresv->is_adv_resv) {
-			if (ninfo->svr_node != NULL)
+			if (ninfo->svr_node != NULL) {
 				remove_node_state(ninfo->svr_node, ND_resv_exclusive);
+				np_node_changed(ninfo->svr_node);
+			}
 		}
 		else {
 			remove_node_state(ninfo, ND_job_exclusive);
@@ -1671,8 +2026,11 @@ update_node_on_end(node_info *ninfo, resource_resv *resresv)
 				if (resreq->type.is_consumable) {
 					res = find_resource(ninfo->res, resreq->def);
 					if (res != NULL) {
-						if (res->indirect_res != NULL)
+						if (res->indirect_res != NULL) {
+							np_node_changed(find_node_info(ninfo->server->nodes,
+								res->indirect_vnode_name));
 							res = res->indirect_res;
+						}
 						res->assigned -= resreq->amount;
 						if (res->assigned < 0) {
 							snprintf(logbuf, MAX_LOG_SIZE,
@@ -1778,10 +2136,8 @@ new_nspec()
 {
 	nspec *ns;
 
-	if ((ns = (nspec *) malloc(sizeof(nspec))) == NULL) {
-		log_err(errno, "new_nspec", MEM_ERR_MSG);
+	if ((ns = pool_alloc(&nspec_pool)) == NULL)
 		return NULL;
-	}
 
 	ns->end_of_chunk = 0;
 	ns->seq_num = 0;
@@ -1811,7 +2167,7 @@ free_nspec(nspec *ns)
 	if (ns->resreq != NULL)
 		free_resource_req_list(ns->resreq);
 
-	free(ns);
+	pool_free(&nspec_pool, ns);
 }
 
 /**
@@ -2208,6 +2564,8 @@ eval_placement(status *policy, selspec *spec, node_info **ninfo_arr, place *pl,
 {
 	np_cache *npc;
 	node_partition **hostsets = NULL;
+	node_partition **own_hostsets = NULL;	/* host sets we built, not cached */
+	int num_hostsets;
 	char *host_arr[2] = {"host", NULL};
 	int i;
 	int k;
@@ -2273,8 +2631,17 @@ eval_placement(status *policy, selspec *spec, node_info **ninfo_arr, place *pl,
 	if (nptr == resresv->server->nodes)
 		hostsets = resresv->server->hostsets;
 
+	/* reorder_nodes() refills the same static array on every call, so the
+	 * np_cache (keyed by the array's address) can't hold its host sets.
+	 */
+	if (hostsets == NULL && nptr != ninfo_arr) {
+		own_hostsets = create_node_partitions(policy, nptr, host_arr,
+			NP_CREATE_REST, &num_hostsets);
+		hostsets = own_hostsets;
+	}
+
 	if (hostsets == NULL) {
-		npc = find_alloc_np_cache(policy, &resresv->server->npc_arr, host_arr, nptr, NULL);
+		npc = find_alloc_np_cache(policy, resresv->server, host_arr, nptr, NULL);
 		if (npc != NULL)
 			hostsets = npc->nodepart;
 	}
@@ -2288,8 +2655,10 @@ eval_placement(status *policy, selspec *spec, node_info **ninfo_arr, place *pl,
 
 		if (pl->scatter || pl->vscatter || pl->free) {
 			dselspec = dup_selspec(spec);
-			if (dselspec == NULL)
+			if (dselspec == NULL) {
+				free_node_partition_array(own_hostsets);
 				return 0;
+			}
 		}
 
 		for (i = 0; hostsets[i] != NULL && tot != spec->total_chunks; i++) {
@@ -2511,6 +2880,7 @@ eval_placement(status *policy, selspec *spec, node_info **ninfo_arr, place *pl,
 #endif /* localmod 049 */
 				if (dup_ninfo_arr == NULL) {
 					free_selspec(dselspec);
+					free_node_partition_array(own_hostsets);
 					return 0;
 				}
 
@@ -2625,6 +2995,8 @@ eval_placement(status *policy, selspec *spec, node_info **ninfo_arr, place *pl,
 	if (dselspec != NULL)
 		free_selspec(dselspec);
 
+	free_node_partition_array(own_hostsets);
+
 	if (tot == spec->total_chunks)
 		return 1;
 	
@@ -3156,6 +3528,8 @@ is_vnode_eligible(node_info *node, resource_resv *resresv,
 	if (node == NULL || resresv == NULL || pl == NULL || err == NULL)
 		return 0;
 
+	PROF_COUNT_NODE();
+
 	/* A node is invalid for an exclusive job if jobs/resvs are running on it
 	 * NOTE: this check must be the first check or exclhost may break
 	 */
@@ -4952,13 +5326,9 @@ node_up_event(node_info *node, void *arg)
 		set_node_state(node, ND_resv_exclusive);
 	else
 		set_node_state(node, ND_free);
+	np_node_changed(node);
 
 	sinfo = node->server;
-	if (sinfo->node_group_enable && sinfo->node_group_key !=NULL) {
-		node_partition_update_array(sinfo->policy, sinfo->nodepart);
-		qsort(sinfo->nodepart, sinfo->num_parts,
-			sizeof(node_partition *), cmp_placement_sets);
-	}
 	update_all_nodepart(sinfo->policy, sinfo, NULL);
 
 	return 1;
@@ -5001,12 +5371,8 @@ node_down_event(node_info *node, void *arg)
 	}
 
 	set_node_state(node, ND_down);
+	np_node_changed(node);
 
-	if (sinfo->node_group_enable && sinfo->node_group_key !=NULL) {
-		node_partition_update_array(sinfo->policy, sinfo->nodepart);
-		qsort(sinfo->nodepart, sinfo->num_parts,
-			sizeof(node_partition *), cmp_placement_sets);
-	}
 	update_all_nodepart(sinfo->policy, sinfo, NULL);
 
 	return 1;
@@ -95,6 +95,11 @@ int add_node_state(node_info *ninfo, char *state);
  */
 int talk_with_mom(node_info *ninfo);
 
+/*
+ *      talk_with_moms - talk to the moms of an array of nodes in parallel
+ */
+void talk_with_moms(node_info **ninfo_arr);
+
 /*
  *      node_filter - filter a node array and return a new filterd array
  */
@@ -53,6 +53,8 @@
  * 	create_node_partitions()
  * 	node_partition_update_array()
  * 	node_partition_update()
+ * 	np_node_changed()
+ * 	node_partition_update_changed()
  * 	new_np_cache()
  * 	free_np_cache_array()
  * 	free_np_cache()
@@ -62,6 +64,7 @@
  * 	resresv_can_fit_nodepart()
  * 	create_specific_nodepart()
  * 	create_placement_sets()
+ * 	update_all_nodepart()
  *
  */
 #include <pbs_config.h>
@@ -88,6 +91,7 @@
 #include "check.h"
 #include "globals.h"
 #include "sort.h"
+#include <avltree.h>
 
 
 /**
@@ -119,6 +123,7 @@ new_node_partition()
 	np->ninfo_arr = NULL;
 
 	np->rank = -1;
+	np->np_gen = 0;
 
 	return np;
 }
@@ -261,6 +266,7 @@ dup_node_partition(node_partition *onp, server_info *nsinfo)
 	nnp->ninfo_arr = copy_node_ptr_array(onp->ninfo_arr, nsinfo->nodes);
 #endif
 	nnp->rank = onp->rank;
+	nnp->np_gen = onp->np_gen;
 
 	/* validity check */
 	if (onp->name == NULL || onp->res_val == NULL ||
@@ -351,6 +357,87 @@ need_to_partition(node_info **ninfo_arr, char *resname)
 	return 1;
 }
 
+/**
+ * @brief
+ *		np_avlkey_create - create an AVL key record for a string key
+ *
+ * @param[in]	keystr	-	the key
+ *
+ * @return	AVL_IX_REC * (caller frees)
+ * @retval	NULL	: on error
+ */
+static AVL_IX_REC *
+np_avlkey_create(char *keystr)
+{
+	size_t keylen;
+	AVL_IX_REC *pkey;
+
+	if (keystr == NULL)
+		return NULL;
+
+	keylen = sizeof(AVL_IX_REC) + strlen(keystr) + 1;
+	if ((pkey = malloc(keylen)) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+
+	memset(pkey, 0, keylen);
+	strcpy(pkey->key, keystr);
+	return pkey;
+}
+
+/**
+ * @brief
+ *		np_name_index - look up (or add) a partition name in the name
+ *			index used while building node partitions
+ *
+ * @param[in]	pix	-	the partition name index
+ * @param[in]	resname	-	placement set resource name
+ * @param[in]	val	-	placement set resource value
+ * @param[in]	add_idx	-	index to store if name is not found, -1 to only look up
+ * @param[out]	found	-	set to 1 if the name was already in the index
+ *
+ * @return	int
+ * @retval	index of the partition in the array being built
+ * @retval	-1	: not found (and not added) or on error
+ */
+static int
+np_name_index(AVL_IX_DESC *pix, char *resname, char *val, int add_idx, int *found)
+{
+	union {
+		AVL_IX_REC xrp;
+		char buf[sizeof(AVL_IX_REC) + 1024];
+	} xxrp;
+	AVL_IX_REC *pkey = &xxrp.xrp;
+	size_t len;
+	int idx = -1;
+
+	*found = 0;
+	/* 2: 1 for '=' 1 for '\0' */
+	len = strlen(resname) + strlen(val) + 2;
+	if (len > sizeof(xxrp.buf) - sizeof(AVL_IX_REC)) {
+		if ((pkey = malloc(sizeof(AVL_IX_REC) + len)) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return -1;
+		}
+	}
+	/* len is the size of the key, so this is never truncated */
+	if (snprintf(pkey->key, len, "%s=%s", resname, val) >= (int) len)
+		idx = -1;
+	else if (avl_find_key(pkey, pix) == AVL_IX_OK) {
+		idx = (int)(long) pkey->recptr;
+		*found = 1;
+	} else if (add_idx >= 0) {
+		pkey->recptr = (AVL_RECPOS)(long) add_idx;
+		if (avl_add_key(pkey, pix) == AVL_IX_OK)
+			idx = add_idx;
+	}
+
+	if (pkey != &xxrp.xrp)
+		free(pkey);
+	return idx;
+}
+
 /**
  * @brief
  * 		break apart nodes into partitions
@@ -364,6 +451,11 @@ need_to_partition(node_info **ninfo_arr, char *resname)
  *		away due to the fact that the node partition has insufficient
  *		resources.
  *
+ * @par
+ *		Partitions are looked up by name through an AVL index, so building
+ *		the partitions is a two pass walk over the nodes (count, then fill)
+ *		rather than a walk over the nodes for every partition.
+ *
  * @param[in]	policy	-	policy info
  * @param[in]	nodes	-	the nodes which to create partitions from
  * @param[in]	resnames	-	node grouping resource names
@@ -383,28 +475,28 @@ create_node_partitions(status *policy, node_info **nodes, char **resnames, unsig
 	node_partition **np_arr;
 	node_partition *np;
 	node_partition **tmp_arr;
-	char buf[1024];
-	char *str;
-	int free_str = 0;
 	int np_arr_size = 0;
 	resource *res;
+	resource **hostres_arr = NULL;	/* first host seen per partition for ok_break */
+	int *fill = NULL;		/* number of nodes added per partition */
+	AVL_IX_DESC np_ix;		/* partition name -> index into np_arr */
 
 	int num_nodes;
-	int reslen;
-	int i;
+	int found;
+	int pass;
 
-	resource *hostres;
 	resource *tmpres;
 
 	int res_i;		/* index of placement set resource name (resnames) */
 	int val_i;		/* index of placement set resource value */
 	int node_i;		/* index into nodes array */
 	int np_i;		/* index into node partition array we are creating */
+	int idx;
 
 	resource unset_res;
 	char *unsetarr[] = {"\"\"", NULL};
 
-	resdef *def;
+	resdef **defs;
 
 	if (nodes == NULL || resnames == NULL)
 		return NULL;
@@ -417,6 +509,14 @@ create_node_partitions(status *policy, node_info **nodes, char **resnames, unsig
 		return NULL;
 	}
 
+	if ((defs = malloc((count_array((void **) resnames) + 1) * sizeof(resdef *))) == NULL) {
+		log_err(errno, "create_node_partitions", MEM_ERR_MSG);
+		free(np_arr);
+		return NULL;
+	}
+	for (res_i = 0; resnames[res_i] != NULL; res_i++)
+		defs[res_i] = find_resdef(allres, resnames[res_i]);
+
 	np_arr_size = num_nodes;
 
 	np_i = 0;
@@ -429,156 +529,139 @@ create_node_partitions(status *policy, node_info **nodes, char **resnames, unsig
 		unset_res.type.is_string = 1;
 	}
 
-	for (res_i = 0; resnames[res_i] != NULL; res_i++) {
-		def = find_resdef(allres, resnames[res_i]);
-		reslen = strlen(resnames[res_i]);
-		for (node_i = 0; nodes[node_i] != NULL; node_i++) {
-			if (nodes[node_i]->is_stale)
-				continue;
-
-			res = find_resource(nodes[node_i]->res, def);
+	avl_create_index(&np_ix, AVL_NO_DUP_KEYS, 0);
 
-			if (res == NULL && (flags & NP_CREATE_REST)) {
-				unset_res.name = resnames[res_i];
-				res = &unset_res;
+	/* pass 0 creates the partitions and counts their nodes, pass 1 fills
+	 * the node arrays of the partitions created in pass 0
+	 */
+	for (pass = 0; pass < 2; pass++) {
+		if (pass == 1) {
+			fill = calloc(np_i + 1, sizeof(int));
+			hostres_arr = calloc(np_i + 1, sizeof(resource *));
+			if (fill == NULL || hostres_arr == NULL) {
+				log_err(errno, "create_node_partitions", MEM_ERR_MSG);
+				goto err;
+			}
+			for (idx = 0; idx < np_i; idx++) {
+				np_arr[idx]->ninfo_arr =
+					malloc((np_arr[idx]->tot_nodes + 1) * sizeof(node_info *));
+				if (np_arr[idx]->ninfo_arr == NULL) {
+					log_err(errno, "create_node_partitions", MEM_ERR_MSG);
+					goto err;
+				}
+				np_arr[idx]->ninfo_arr[0] = NULL;
+				np_arr[idx]->ok_break = 1;
 			}
-			if (res != NULL) {
+		}
+
+		for (res_i = 0; resnames[res_i] != NULL; res_i++) {
+			for (node_i = 0; nodes[node_i] != NULL; node_i++) {
+				if (nodes[node_i]->is_stale)
+					continue;
+
+				res = find_resource(nodes[node_i]->res, defs[res_i]);
+
+				if (res == NULL && (flags & NP_CREATE_REST)) {
+					unset_res.name = resnames[res_i];
+					res = &unset_res;
+				}
+				/* we ignore nodes without the node partition resource set
+				 * unless the NP_CREATE_REST flag is set
+				 */
+				if (res == NULL)
+					continue;
+
 				for (val_i = 0; res->str_avail[val_i] != NULL; val_i++) {
-					/* 2: 1 for '=' 1 for '\0' */
-					if (reslen + strlen(res->str_avail[val_i]) + 2 < 1024) {
-						sprintf(buf, "%s=%s", resnames[res_i], res->str_avail[val_i]);
-						str = buf;
-					}
-					else {
-						str = concat_str(resnames[res_i], "=", res->str_avail[val_i], 0);
-						free_str = 1;
+					idx = np_name_index(&np_ix, resnames[res_i], res->str_avail[val_i],
+						pass == 0 ? np_i : -1, &found);
+					if (idx < 0) {
+						if (pass == 0)
+							goto err;
+						continue;
 					}
-					/* If we find the partition, we've already created it - add the node
-					 * to the existing partition.  If we don't find it, we create it.
-					 */
-					np = find_node_partition(np_arr, str);
-					if (np == NULL) {
+
+					if (pass == 0) {
+						if (found) {
+							np_arr[idx]->tot_nodes++;
+							if (nodes[node_i]->is_free)
+								np_arr[idx]->free_nodes++;
+							continue;
+						}
+						/* If we don't find the partition, we create it */
 						if (np_i >= np_arr_size) {
 							tmp_arr = realloc(np_arr,
 								(np_arr_size * 2 + 1) * sizeof(node_partition *));
 							if (tmp_arr == NULL) {
 								log_err(errno, "create_node_partitions", MEM_ERR_MSG);
-								free_node_partition_array(np_arr);
-								if (free_str == 1)
-									free(str);
-
-								return NULL;
+								goto err;
 							}
 							np_arr = tmp_arr;
 							np_arr_size *= 2;
 						}
 
-						np_arr[np_i] = new_node_partition();
-						if (np_arr[np_i] != NULL) {
-							if (free_str) {
-								np_arr[np_i]->name = str;
-								free_str = 0;
-							}
-							else
-								np_arr[np_i]->name = string_dup(str);
-
-							np_arr[np_i]->def = def;
-							np_arr[np_i]->res_val = string_dup(res->str_avail[val_i]);
-							np_arr[np_i]->tot_nodes = 1;
-							if (nodes[node_i]->is_free)
-								np_arr[np_i]->free_nodes = 1;
-							np_arr[np_i]->rank = get_sched_rank();
-
-							if (np_arr[np_i]->res_val == NULL) {
-								np_arr[np_i+1] = NULL;
-								free_node_partition_array(np_arr);
-								return NULL;
+						if ((np = new_node_partition()) == NULL)
+							goto err;
+						np_arr[np_i] = np;
+						np_arr[np_i + 1] = NULL;
+						np->name = concat_str(resnames[res_i], "=", res->str_avail[val_i], 0);
+						np->def = defs[res_i];
+						np->res_val = string_dup(res->str_avail[val_i]);
+						np->tot_nodes = 1;
+						if (nodes[node_i]->is_free)
+							np->free_nodes = 1;
+						np->rank = get_sched_rank();
+						np_i++;
+
+						if (np->name == NULL || np->res_val == NULL)
+							goto err;
+					} else {
+						np = np_arr[idx];
+						/* a node with multiple identical values is only added once */
+						if (fill[idx] > 0 && np->ninfo_arr[fill[idx] - 1] == nodes[node_i])
+							continue;
+						if (fill[idx] >= np->tot_nodes)
+							continue;
+
+						if (np->ok_break) {
+							tmpres = find_resource(nodes[node_i]->res, getallres(RES_HOST));
+							if (tmpres != NULL) {
+								if (hostres_arr[idx] == NULL)
+									hostres_arr[idx] = tmpres;
+								else if (!compare_res_to_str(hostres_arr[idx], tmpres->str_avail[0], CMP_CASELESS))
+									np->ok_break = 0;
 							}
-
-							np_i++;
-							np_arr[np_i] = NULL;
 						}
-						else {
-							free_node_partition_array(np_arr);
-							return NULL;
-						}
-					}
-					else {
-						np->tot_nodes++;
-						if (nodes[node_i]->is_free)
-							np->free_nodes++;
+						np->ninfo_arr[fill[idx]++] = nodes[node_i];
+						np->ninfo_arr[fill[idx]] = NULL;
 					}
-					if (free_str) {
-						free(str);
-						free_str = 0;
-					}
-
 				}
 			}
-			/* else we ignore nodes without the node partition resource set
-			 * unless the NP_CREATE_REST flag is set
-			 */
 		}
 	}
 
-
-	/* now that we have a list of node partitions and number of nodes in each
-	 * lets allocate a node array and fill it
+	/* if multiple resource values are present, tot_nodes may be incorrect.
+	 * recalculating tot_nodes for each node partition.
 	 */
-
-	for (np_i = 0; np_arr[np_i] != NULL; np_i++) {
-		i = 0;
-		np_arr[np_i]->ok_break = 1;
-		hostres = NULL;
-
-		np_arr[np_i]->ninfo_arr =
-			malloc((np_arr[np_i]->tot_nodes + 1) * sizeof(node_info *));
-
-		if (np_arr[np_i]->ninfo_arr == NULL) {
-			free_node_partition_array(np_arr);
-			return NULL;
-		}
-
-		np_arr[np_i]->ninfo_arr[0] = NULL;
-
-		for (node_i = 0; nodes[node_i] != NULL &&
-			i < np_arr[np_i]->tot_nodes; node_i++) {
-			if (nodes[node_i]->is_stale)
-				continue;
-
-			res = find_resource(nodes[node_i]->res, np_arr[np_i]->def);
-			if (res == NULL && (flags & NP_CREATE_REST)) {
-				unset_res.name = resnames[res_i];
-				res = &unset_res;
-			}
-			if (res != NULL) {
-				if (compare_res_to_str(res, np_arr[np_i]->res_val, CMP_CASE)) {
-					if (np_arr[np_i]->ok_break) {
-						tmpres = find_resource(nodes[node_i]->res, getallres(RES_HOST));
-						if (tmpres != NULL) {
-							if (hostres == NULL)
-								hostres = tmpres;
-							else {
-								if (!compare_res_to_str(hostres, tmpres->str_avail[0], CMP_CASELESS))
-									np_arr[np_i]->ok_break = 0;
-							}
-						}
-					}
-					np_arr[np_i]->ninfo_arr[i] = nodes[node_i];
-					i++;
-					np_arr[np_i]->ninfo_arr[i] = NULL;
-				}
-			}
-		}
-		/* if multiple resource values are present, tot_nodes may be incorrect.
-		 * recalculating tot_nodes for each node partition.
-		 */
-		np_arr[np_i]->tot_nodes = count_array((void**) np_arr[np_i]->ninfo_arr);
-		node_partition_update(policy, np_arr[np_i]);
+	for (idx = 0; idx < np_i; idx++) {
+		np_arr[idx]->tot_nodes = fill[idx];
+		node_partition_update(policy, np_arr[idx]);
 	}
 
+	avl_destroy_index(&np_ix);
+	free(fill);
+	free(hostres_arr);
+	free(defs);
+
 	*num_parts = np_i;
 	return np_arr;
+
+err:
+	avl_destroy_index(&np_ix);
+	free(fill);
+	free(hostres_arr);
+	free(defs);
+	free_node_partition_array(np_arr);
+	return NULL;
 }
 
 /**
@@ -658,8 +741,12 @@ node_partition_update(status *policy, node_partition *np)
 		arl_flags |= ADD_UNSET_BOOLS_FALSE;
 
 	np->free_nodes = 0;
+	np->np_gen = 0;
 
 	for (i = 0; i < np->tot_nodes; i++) {
+		if (np->ninfo_arr[i]->np_gen > np->np_gen)
+			np->np_gen = np->ninfo_arr[i]->np_gen;
+
 		if (np->ninfo_arr[i]->is_free) {
 			np->free_nodes++;
 			arl_flags &= ~ADD_AVAIL_ASSIGNED;
@@ -686,6 +773,83 @@ node_partition_update(status *policy, node_partition *np)
 	return rc;
 }
 
+/**
+ * @brief
+ *		np_node_changed - note that a node's state or resources changed so
+ *			the placement sets it belongs to are refreshed by the next
+ *			node_partition_update_changed()
+ *
+ * @param[in,out]	ninfo	-	the node which changed
+ *
+ * @return	nothing
+ */
+void
+np_node_changed(node_info *ninfo)
+{
+	static unsigned long np_generation = 0;
+
+	if (ninfo != NULL)
+		ninfo->np_gen = ++np_generation;
+}
+
+/**
+ * @brief
+ *		node_partition_needs_update - check if any node of a node partition
+ *			changed since the partition's meta data was last computed
+ *
+ * @param[in]	np	-	the node partition to check
+ *
+ * @return	int
+ * @retval	1	: partition is out of date
+ * @retval	0	: partition is up to date
+ */
+static int
+node_partition_needs_update(node_partition *np)
+{
+	int i;
+
+	if (np->res == NULL)
+		return 1;
+
+	for (i = 0; i < np->tot_nodes; i++)
+		if (np->ninfo_arr[i]->np_gen > np->np_gen)
+			return 1;
+
+	return 0;
+}
+
+/**
+ * @brief
+ * 		update the meta data of the node partitions in an array which
+ *		contain a node which changed since they were last updated
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in]	nodepart	-	partition array to update
+ *
+ * @return	int
+ * @retval	number of partitions updated
+ * @retval	-1	: on failure
+ */
+int
+node_partition_update_changed(status *policy, node_partition **nodepart)
+{
+	int i;
+	int num = 0;
+
+	if (nodepart == NULL)
+		return 0;
+
+	for (i = 0; nodepart[i] != NULL; i++) {
+		if (node_partition_needs_update(nodepart[i])) {
+			if (node_partition_update(policy, nodepart[i]) == 0)
+				return -1;
+			num++;
+		}
+	}
+
+	return num;
+}
+
 /**
  * @brief
  *		new_np_cache - constructor
@@ -706,6 +870,7 @@ new_np_cache(void)
 	npc->ninfo_arr = NULL;
 	npc->nodepart = NULL;
 	npc->num_parts = UNSPECIFIED;
+	npc->sort_func = NULL;
 
 	return npc;
 }
@@ -756,12 +921,48 @@ free_np_cache(np_cache *npc)
 	free(npc);
 }
 
+/**
+ * @brief
+ *		np_cache_key - create the np_cache index key for the array of
+ *			resource names and the node array which created it
+ *
+ * @param[in]	resnames	-	the list of names
+ * @param[in]	ninfo_arr	-	array of nodes
+ *
+ * @return	AVL_IX_REC * (caller frees)
+ * @retval	NULL	: on error
+ */
+static AVL_IX_REC *
+np_cache_key(char **resnames, node_info **ninfo_arr)
+{
+	AVL_IX_REC *pkey;
+	char *key;
+	char buf[64];
+	int i;
+
+	/* node arrays are matched by pointer, resource names by value */
+	snprintf(buf, sizeof(buf), "%p", (void *) ninfo_arr);
+	if ((key = string_dup(buf)) == NULL)
+		return NULL;
+
+	for (i = 0; resnames[i] != NULL; i++) {
+		if ((key = concat_str(key, ":", resnames[i], 1)) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return NULL;
+		}
+	}
+
+	pkey = np_avlkey_create(key);
+	free(key);
+	return pkey;
+}
+
 /**
  * @brief
  *		find_np_cache - find a np_cache by the array of resource names and
  *			nodes which created it.
  *
- * @param[in]	npc_arr	-	the array to search
+ * @param[in]	sinfo	-	the server whose cache to search
  * @param[in]	resnames	-	the list of names
  * @param[in]	ninfo_arr	-	array of nodes
  *
@@ -773,21 +974,23 @@ free_np_cache(np_cache *npc)
  *
  */
 np_cache *
-find_np_cache(np_cache **npc_arr,
+find_np_cache(server_info *sinfo,
 	char **resnames, node_info **ninfo_arr)
 {
-	int i;
+	AVL_IX_REC *pkey;
+	np_cache *npc = NULL;
 
-	if (npc_arr == NULL || resnames == NULL || ninfo_arr == NULL)
+	if (sinfo == NULL || sinfo->npc_ix == NULL || resnames == NULL || ninfo_arr == NULL)
 		return NULL;
 
-	for (i = 0; npc_arr[i] != NULL ; i++) {
-		if (npc_arr[i]->ninfo_arr == ninfo_arr &&
-			match_string_array(npc_arr[i]->resnames, resnames) == SA_FULL_MATCH)
-			break;
-	}
+	if ((pkey = np_cache_key(resnames, ninfo_arr)) == NULL)
+		return NULL;
+
+	if (avl_find_key(pkey, sinfo->npc_ix) == AVL_IX_OK)
+		npc = (np_cache *) pkey->recptr;
 
-	return npc_arr[i];
+	free(pkey);
+	return npc;
 }
 
 /**
@@ -797,13 +1000,12 @@ find_np_cache(np_cache **npc_arr,
  *		does not exist, create it and add it to the list
  *
  * @param[in]	policy	-	policy info
- * @param[in,out]	pnpc_arr	-	pointer to np_cache array -- if *npc_arr == NULL
- *		 	           				a np_cache will be created and it will be set
- *			           				Example: you pass &(sinfo -> npc_arr)
+ * @param[in,out]	sinfo	-	the server whose cache to search and add to
  * @param[in]	resnames	-	the names used to create the pool of node parts
  * @param[in]	ninfo_arr	-	the node array used to create the pool of node_parts
  * @param[in]	sort_func	-	sort function to sort placement sets.
- *				  				sets are only sorted when they are created.
+ *				  				sets are sorted when they are created and
+ *				  				when update_all_nodepart() updates them.
  *				  				If NULL is passed in, no sorting is done
  *
  * @return	np_cache *
@@ -812,7 +1014,7 @@ find_np_cache(np_cache **npc_arr,
  *
  */
 np_cache *
-find_alloc_np_cache(status *policy, np_cache ***pnpc_arr,
+find_alloc_np_cache(status *policy, server_info *sinfo,
 	char **resnames, node_info **ninfo_arr,
 	int (*sort_func)(const void *, const void *))
 {
@@ -821,10 +1023,10 @@ find_alloc_np_cache(status *policy, np_cache ***pnpc_arr,
 	np_cache *npc = NULL;
 	int error = 0;
 
-	if (resnames == NULL || ninfo_arr == NULL || pnpc_arr == NULL)
+	if (resnames == NULL || ninfo_arr == NULL || sinfo == NULL)
 		return NULL;
 
-	npc = find_np_cache(*pnpc_arr, resnames, ninfo_arr);
+	npc = find_np_cache(sinfo, resnames, ninfo_arr);
 
 	if (npc == NULL) {
 		/* didn't find node partition cache, need to allocate and create */
@@ -839,7 +1041,8 @@ find_alloc_np_cache(status *policy, np_cache ***pnpc_arr,
 				npc->resnames = dup_string_array(resnames);
 				npc->num_parts = num_parts;
 				npc->nodepart = nodepart;
-				if (npc->resnames == NULL || add_np_cache(pnpc_arr, npc) ==0) {
+				npc->sort_func = sort_func;
+				if (npc->resnames == NULL || add_np_cache(sinfo, npc) ==0) {
 					free_np_cache(npc);
 					error = 1;
 				}
@@ -862,39 +1065,63 @@ find_alloc_np_cache(status *policy, np_cache ***pnpc_arr,
 
 /**
  * @brief
- *		add_np_cache - add an np_cache to an array
+ *		add_np_cache - add an np_cache to a server's cache array and index
  *
- * @param[in]	policy	-	policy info
- * @param[in,out]	pnpc_arr	-	pointer to np_cache array -- if *npc_arr == NULL
+ * @param[in,out]	sinfo	-	server to add the cache to -- if sinfo->npc_arr
+ *								is NULL, it will be created
+ * @param[in]	npc	-	the np_cache to add
  *
  * @return	1	: on success
  * @return	0	: on failure
  */
 int
-add_np_cache(np_cache ***npc_arr, np_cache *npc)
+add_np_cache(server_info *sinfo, np_cache *npc)
 
 {
 	np_cache **new_cache;
 	np_cache **cur_cache;
+	AVL_IX_REC *pkey;
 	int ct;
+	int rc;
 
-	if (npc_arr == NULL || npc == NULL)
+	if (sinfo == NULL || npc == NULL)
 		return 0;
 
-	cur_cache = *npc_arr;
+	if (sinfo->npc_ix == NULL) {
+		if ((sinfo->npc_ix = malloc(sizeof(AVL_IX_DESC))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+		avl_create_index(sinfo->npc_ix, AVL_NO_DUP_KEYS, 0);
+	}
+
+	if ((pkey = np_cache_key(npc->resnames, npc->ninfo_arr)) == NULL)
+		return 0;
+
+	cur_cache = sinfo->npc_arr;
 
 	ct = count_array((void **) cur_cache);
 
 	/* ct+2: 1 for new element 1 for NULL ptr */
 	new_cache = realloc(cur_cache, (ct+2) * sizeof(np_cache *));
 
-	if (new_cache == NULL)
+	if (new_cache == NULL) {
+		free(pkey);
+		return 0;
+	}
+
+	new_cache[ct] = NULL;
+	sinfo->npc_arr = new_cache;
+
+	pkey->recptr = (AVL_RECPOS) npc;
+	rc = avl_add_key(pkey, sinfo->npc_ix);
+	free(pkey);
+	if (rc != AVL_IX_OK)
 		return 0;
 
 	new_cache[ct] = npc;
 	new_cache[ct+1] = NULL;
 
-	*npc_arr = new_cache;
 	return 1;
 }
 
@@ -1218,6 +1445,13 @@ create_placement_sets(status *policy, server_info *sinfo)
  *	@note Call update_all_nodepart() after all nodes have been processed
  *		by update_node_on_end/update_node_on_run
  *
+ *	@par
+ *		Only placement sets which contain a node marked by np_node_changed()
+ *		since their last update are recomputed, and a pool of placement
+ *		sets is only resorted when one of its sets was recomputed.  This
+ *		covers the server and queue node_group_key sets, the host sets and
+ *		the pools in the server's np_cache.
+ *
  *	  @param[in] policy - policy info
  *	  @param[in] sinfo - server info
  *	  @param[in] resresv- the job that was just run
@@ -1229,6 +1463,7 @@ void
 update_all_nodepart(status *policy, server_info *sinfo, resource_resv *resresv)
 {
 	queue_info *qinfo;
+	np_cache *npc;
 	int update_allpart = 1;
 	int i;
 
@@ -1251,23 +1486,40 @@ update_all_nodepart(status *policy, server_info *sinfo, resource_resv *resresv)
 	if (update_allpart || sinfo->allpart->res == NULL)
 		node_partition_update(policy, sinfo->allpart);
 
-	node_partition_update_array(policy, sinfo->hostsets);
-	if (policy->node_sort[0].res_name != NULL &&
-	    conf.node_sort_unused && sinfo->hostsets != NULL) {
+	if (node_partition_update_changed(policy, sinfo->hostsets) > 0 &&
+	    policy->node_sort[0].res_name != NULL && conf.node_sort_unused) {
 		/* Resort the nodes in host sets to correctly reflect unused resources */
 		qsort(sinfo->hostsets, sinfo->num_hostsets, sizeof(node_partition*), multi_nodepart_sort);
 	}
 
+	if (sinfo->node_group_enable && sinfo->node_group_key != NULL) {
+		if (node_partition_update_changed(policy, sinfo->nodepart) > 0)
+			qsort(sinfo->nodepart, sinfo->num_parts,
+				sizeof(node_partition *), cmp_placement_sets);
+	}
+
 	for (i = 0; sinfo->queues[i] != NULL; i++) {
 		qinfo = sinfo->queues[i];
 
 		if (qinfo->node_group_key) {
-			node_partition_update_array(policy, qinfo->nodepart);
-
-			qsort(qinfo->nodepart, qinfo->num_parts,
-			   sizeof(node_partition *), cmp_placement_sets);
+			if (node_partition_update_changed(policy, qinfo->nodepart) > 0)
+				qsort(qinfo->nodepart, qinfo->num_parts,
+					sizeof(node_partition *), cmp_placement_sets);
 		}
 		if(qinfo->allpart != NULL && qinfo->allpart->res == NULL)
 			node_partition_update(policy, qinfo->allpart);
 	}
-}
\ No newline at end of file
+
+	/* the node partition cache is kept for the life of the universe and
+	 * updated in place rather than being thrown away after every run
+	 */
+	if (sinfo->npc_arr != NULL) {
+		for (i = 0; sinfo->npc_arr[i] != NULL; i++) {
+			npc = sinfo->npc_arr[i];
+			if (node_partition_update_changed(policy, npc->nodepart) > 0 &&
+				npc->sort_func != NULL)
+				qsort(npc->nodepart, npc->num_parts,
+					sizeof(node_partition *), npc->sort_func);
+		}
+	}
+}
@@ -167,6 +167,20 @@ int node_partition_update_array(status *policy, node_partition **nodepart);
  */
 int node_partition_update(status *policy, node_partition *np);
 
+/*
+ *	np_node_changed - note a node changed so the placement sets holding it
+ *			  are refreshed by node_partition_update_changed()
+ */
+void np_node_changed(node_info *ninfo);
+
+/*
+ *	node_partition_update_changed - update the node partitions of an array
+ *			which hold a node changed since their last update
+ *
+ *	returns the number of partitions updated, -1 on failure
+ */
+int node_partition_update_changed(status *policy, node_partition **nodepart);
+
 /*
  *	new_np_cache - constructor
  */
@@ -186,7 +200,7 @@ void free_np_cache(np_cache *npc);
  *	find_np_cache - find a np_cache by the array of resource names and
  *			nodes which created it.
  *
- *	  npc_arr - the array to search
+ *	  sinfo - the server whose np_cache index to search
  *	  resnames - the list of names
  *	  ninfo_arr - array of nodes
  *
@@ -196,7 +210,7 @@ void free_np_cache(np_cache *npc);
  *
  */
 np_cache *
-find_np_cache(np_cache **npc_arr,
+find_np_cache(server_info *sinfo,
 	char **resnames, node_info **ninfo_arr);
 /*
  *	find_alloc_np_cache - find a np_cache by the array of resource names
@@ -204,14 +218,14 @@ find_np_cache(np_cache **npc_arr,
  *			      does not exist, create it and add it to the list
  */
 np_cache *
-find_alloc_np_cache(status *policy, np_cache ***pnpc_arr,
+find_alloc_np_cache(status *policy, server_info *sinfo,
 	char **resnames, node_info **ninfo_arr,
 	int (*sort_func)(const void *, const void *));
 /*
- *	add_np_cache - add an np_cache to an array
+ *	add_np_cache - add an np_cache to a server's cache array and index
  *	returns 1 on success - 0 on failure
  */
-int add_np_cache(np_cache ***npc_arr, np_cache *npc);
+int add_np_cache(server_info *sinfo, np_cache *npc);
 
 /*
  *	remove_noncomplete_sets - remove placement sets from a pool which do
@@ -413,6 +413,11 @@ parse_config(char *fname)
 				}
 				else if (!strcmp(config_name, PARSE_MOM_RESOURCES))
 					conf.dyn_res_to_get = break_comma_list(config_value);
+				else if (!strcmp(config_name, PARSE_CYCLE_PROFILE)) {
+					if (conf.cycle_profile != NULL)
+						free(conf.cycle_profile);
+					conf.cycle_profile = string_dup(config_value);
+				}
 				else if (!strcmp(config_name, PARSE_DEDICATED_PREFIX)) {
 					if (strlen(config_value) > PBS_MAXQUEUENAME)
 						error = 1;
@@ -736,12 +741,31 @@ parse_config(char *fname)
 						if (tok != NULL) {
 							tmp1 = string_dup(tok);
 
-							/* tok is the rest of the config_value string - the program */
+							/*
+							 * tok is the rest of the config_value string - optional
+							 * interval=secs and timeout=secs followed by the program
+							 */
+							conf.dynamic_res[res_num].interval = 0;
+							conf.dynamic_res[res_num].timeout = DYN_RES_TIMEOUT;
 							tok = strtok(NULL, "");
 							while (tok != NULL && isspace(*tok))
 								tok++;
+							while (tok != NULL && *tok != '\0' && *tok != '!') {
+								if (!strncmp(tok, "interval=", 9))
+									conf.dynamic_res[res_num].interval = strtol(tok + 9, &endp, 10);
+								else if (!strncmp(tok, "timeout=", 8))
+									conf.dynamic_res[res_num].timeout = strtol(tok + 8, &endp, 10);
+								else
+									break;
+								if (!isspace(*endp))
+									break;
+								for (tok = endp; isspace(*tok); tok++)
+									;
+							}
 
-							if (tok != NULL && tok[0] == '!') {
+							if (tok != NULL && tok[0] == '!' &&
+								conf.dynamic_res[res_num].interval >= 0 &&
+								conf.dynamic_res[res_num].timeout > 0) {
 								tok++;
 								tmp2 = string_dup(tok);
 								conf.dynamic_res[res_num].res = tmp1;
@@ -841,6 +865,30 @@ parse_config(char *fname)
 				}
 				else if (!strcmp(config_name, PARSE_PREEMPT_ATTEMPTS))
 					conf.max_preempt_attempts = num;
+				else if (!strcmp(config_name, PARSE_MOM_QUERY_WINDOW)) {
+					if (num < 1)
+						error = 1;
+					else
+						conf.mom_query_window = num;
+				}
+				else if (!strcmp(config_name, PARSE_MOM_QUERY_TIMEOUT)) {
+					if (num < 1)
+						error = 1;
+					else
+						conf.mom_query_timeout = num;
+				}
+				else if (!strcmp(config_name, PARSE_MOM_CACHE_TTL)) {
+					if (num < 0)
+						error = 1;
+					else
+						conf.mom_cache_ttl = num;
+				}
+				else if (!strcmp(config_name, PARSE_EST_ALL_JOBS_FREQ)) {
+					if (num < 0)
+						error = 1;
+					else
+						conf.est_all_jobs_freq = num;
+				}
 				else if(!strcmp(config_name, PARSE_OPT_BACKFILL_FUZZY_TIME))
 					conf.dflt_opt_backfill_fuzzy = num;
 				else if (!strcmp(config_name, PARSE_MAX_JOB_CHECK)) {
@@ -1060,6 +1108,9 @@ init_config()
 	conf.max_preempt_attempts = SCHD_INFINITY;
 	conf.max_jobs_to_check = SCHD_INFINITY;
 
+	conf.mom_query_window = MOM_QUERY_WINDOW;
+	conf.mom_query_timeout = MOM_QUERY_TIMEOUT;
+
 	/* default value for ignore_res is the pseudo resources */
 	conf.ignore_res = ignore;
 
@@ -81,6 +81,7 @@ void print_fairshare_entity(group_info *ginfo);
 #define FS_WRITE_FILE 256
 
 int	second_connection;
+int	server_sock;
 /**
  * @brief
  * 		The entry point of pbsfs
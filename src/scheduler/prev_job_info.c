@@ -103,12 +103,14 @@ create_prev_job_info(resource_resv **jobs, int size)
 		if (jobs[i]->job == NULL)
 			continue;
 
-		new[i].name = jobs[i]->name;
+		/* the job's name is in the cycle arena, which is reset at the end
+		 * of the cycle, so it is copied rather than taken over
+		 */
+		new[i].name = string_dup(jobs[i]->name);
 		new[i].resused = jobs[i]->job->resused;
 		new[i].entity_name = string_dup(jobs[i]->job->ginfo->name);
 
 		/* so the memory is not freed at the end of the scheduling cycle */
-		jobs[i]->name = NULL;
 		jobs[i]->job->resused = NULL;
 	}
 
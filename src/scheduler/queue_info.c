@@ -346,6 +346,7 @@ query_queue_info(struct batch_status *queue, server_info *sinfo)
 	resource *resp;               /* resource in resource qres list */
 	char *endp;			/* used with strtol() */
 	sch_resource_t count;		/* used to convert string -> num */
+	int attr_id;			/* id of attrp->name */
 
 	if ((qinfo = new_queue_info(1)) == NULL)
 		return NULL;
@@ -353,7 +354,7 @@ query_queue_info(struct batch_status *queue, server_info *sinfo)
 	if (qinfo->liminfo == NULL)
 		return NULL;
 
-	if ((qinfo->name = string_dup(queue->name)) == NULL) {
+	if ((qinfo->name = arena_strdup(&cycle_arena, queue->name)) == NULL) {
 		free_queue_info(qinfo);
 		return NULL;
 	}
@@ -361,13 +362,14 @@ query_queue_info(struct batch_status *queue, server_info *sinfo)
 	attrp = queue->attribs;
 	qinfo->server = sinfo;
 	while (attrp != NULL) {
-		if (!strcmp(attrp->name, ATTR_start)) { /* started */
+		attr_id = sched_attr_id(attrp->name);
+		if (attr_id == SATTR_start) { /* started */
 			if (!strcmp(attrp->value, ATR_TRUE))
 				qinfo->is_started = 1;
 			else
 				qinfo->is_started = 0;
 		}
-		else if (!strcmp(attrp->name, ATTR_HasNodes)) {
+		else if (attr_id == SATTR_HasNodes) {
 			if (!strcmp(attrp->value, ATR_TRUE)) {
 				sinfo->has_nodes_assoc_queue = 1;
 				qinfo->has_nodes = 1;
@@ -375,7 +377,7 @@ query_queue_info(struct batch_status *queue, server_info *sinfo)
 			else
 				qinfo->has_nodes = 0;
 		}
-		else if(!strcmp(attrp->name, ATTR_backfill_depth)) 
+		else if(attr_id == SATTR_backfill_depth) 
 			qinfo->backfill_depth = strtol(attrp->value, NULL, 10);
 		else if (is_reslimattr(attrp))
 			(void) lim_setlimits(attrp, LIM_RES, qinfo->liminfo);
@@ -383,13 +385,13 @@ query_queue_info(struct batch_status *queue, server_info *sinfo)
 			(void) lim_setlimits(attrp, LIM_RUN, qinfo->liminfo);
 		else if (is_oldlimattr(attrp))
 			(void) lim_setlimits(attrp, LIM_OLD, qinfo->liminfo);
-		else if (!strcmp(attrp->name, ATTR_p)) { /* priority */
+		else if (attr_id == SATTR_p) { /* priority */
 			count = strtol(attrp->value, &endp, 10);
 			if (*endp != '\0')
 				count = -1;
 			qinfo->priority = count;
 		}
-		else if (!strcmp(attrp->name, ATTR_qtype)) { /* queue_type */
+		else if (attr_id == SATTR_qtype) { /* queue_type */
 			if (!strcmp(attrp->value, "Execution")) {
 				qinfo->is_exec = 1;
 				qinfo->is_route = 0;
@@ -399,9 +401,9 @@ query_queue_info(struct batch_status *queue, server_info *sinfo)
 				qinfo->is_exec = 0;
 			}
 		}
-		else if (!strcmp(attrp->name, ATTR_NodeGroupKey))
+		else if (attr_id == SATTR_NodeGroupKey)
 			qinfo->node_group_key = break_comma_list(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_rescavail)) { /* resources_available*/
+		else if (attr_id == SATTR_rescavail) { /* resources_available*/
 #ifdef NAS
 			/* localmod 040 */
 			if (!strcmp(attrp->resource, ATTR_ignore_nodect_sort)) {
@@ -434,7 +436,7 @@ query_queue_info(struct batch_status *queue, server_info *sinfo)
 				}
 			}
 		}
-		else if (!strcmp(attrp->name, ATTR_rescassn)) { /* resources_assigned */
+		else if (attr_id == SATTR_rescassn) { /* resources_assigned */
 			resp = find_alloc_resource_by_str(qinfo->qres, attrp->resource);
 			if (qinfo->qres == NULL)
 				qinfo->qres = resp;
@@ -447,13 +449,13 @@ query_queue_info(struct batch_status *queue, server_info *sinfo)
 		}
 #ifdef NAS
 		/* localmod 046 */
-		else if (!strcmp(attrp->name, ATTR_maxstarve)) {
+		else if (attr_id == SATTR_maxstarve) {
 			time_t	starve;
 			starve = site_decode_time(attrp->value);
 			qinfo->max_starve = starve;
 		}
 		/* localmod 034 */
-		else if (!strcmp(attrp->name, ATTR_maxborrow)) {
+		else if (attr_id == SATTR_maxborrow) {
 			time_t	borrow;
 			borrow = site_decode_time(attrp->value);
 			qinfo->max_borrow = borrow;
@@ -778,8 +780,7 @@ update_queue_on_end(queue_info *qinfo, resource_resv *resresv,
 void
 free_queue_info(queue_info *qinfo)
 {
-	if (qinfo->name != NULL)
-		free(qinfo->name);
+	arena_free_str(&cycle_arena, qinfo->name);
 	if (qinfo->qres != NULL)
 		free_resource_list(qinfo->qres);
 	if (qinfo->running_jobs != NULL)
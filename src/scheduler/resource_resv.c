@@ -113,6 +113,7 @@
 #include "check.h"
 #include "fifo.h"
 #include "range.h"
+#include "sched_profile.h"
 
 
 /**
@@ -127,10 +128,8 @@ new_resource_resv()
 {
 	resource_resv *resresv = NULL;
 
-	if ((resresv = malloc(sizeof(resource_resv))) == NULL) {
-		log_err(errno, "new_resource_resv", "Error allocating memory");
+	if ((resresv = pool_alloc(&resresv_pool)) == NULL)
 		return NULL;
-	}
 
 
 	resresv->name = NULL;
@@ -221,8 +220,7 @@ free_resource_resv(resource_resv *resresv)
 	if (resresv == NULL)
 		return;
 
-	if (resresv->name != NULL)
-		free(resresv->name);
+	arena_free_str(&cycle_arena, resresv->name);
 
 	if (resresv->user != NULL)
 		free(resresv->user);
@@ -266,7 +264,7 @@ free_resource_resv(resource_resv *resresv)
 	if (resresv->node_set != NULL)
 		free(resresv->node_set);
 
-	free(resresv);
+	pool_free(&resresv_pool, resresv);
 }
 
 /**
@@ -761,12 +759,10 @@ new_resource_req()
 {
 	resource_req *resreq;
 
-	if ((resreq = (resource_req *) calloc(1, sizeof(resource_req))) == NULL) {
-		log_err(errno, "new_resource_req", MEM_ERR_MSG);
+	if ((resreq = pool_alloc(&resreq_pool)) == NULL)
 		return NULL;
-	}
 
-	/* member type zero'd by calloc() */
+	/* member type zero'd by pool_alloc() */
 
 	resreq->name = NULL;
 	resreq->res_str = NULL;
@@ -935,6 +931,7 @@ find_resource_req(resource_req *reqlist, resdef *def)
 {
 	resource_req *resreq;
 
+	PROF_COUNT_RESC();
 	resreq = reqlist;
 
 	while (resreq != NULL && resreq->def != def)
@@ -1011,7 +1008,7 @@ free_resource_req(resource_req *req)
 	if (req->res_str != NULL)
 		free(req->res_str);
 
-	free(req);
+	pool_free(&resreq_pool, req);
 }
 
 /**
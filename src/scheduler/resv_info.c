@@ -575,7 +575,7 @@ query_resv(struct batch_status *resv, server_info *sinfo)
 	}
 
 	attrp = resv->attribs;
-	advresv->name = string_dup(resv->name);
+	advresv->name = arena_strdup(&cycle_arena, resv->name);
 	advresv->server = sinfo;
 	advresv->is_adv_resv = 1;
 
@@ -0,0 +1,352 @@
+/*
+ * Copyright (C) 1994-2016 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *  
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ * 
+ * Open Source License Information:
+ *  
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free 
+ * Software Foundation, either version 3 of the License, or (at your option) any 
+ * later version.
+ *  
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  
+ * Commercial License Information: 
+ * 
+ * The PBS Pro software is licensed under the terms of the GNU Affero General 
+ * Public License agreement ("AGPL"), except where a separate commercial license 
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *  
+ * Altair’s dual-license business model allows companies, individuals, and 
+ * organizations to create proprietary derivative works of PBS Pro and distribute 
+ * them - whether embedded or bundled with other software - under a commercial 
+ * license agreement.
+ * 
+ * Use of Altair’s trademarks, including but not limited to "PBS™", 
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's 
+ * trademark licensing policies.
+ *
+ */
+
+/**
+ * @file    sched_profile.c
+ *
+ * @brief
+ * 		sched_profile.c - Scheduling cycle profiler.  When the sched_config
+ *		option cycle_profile names a file, one JSON object per cycle is
+ *		appended to it with per-phase times, cycle counters and the slowest
+ *		job decisions of the cycle.
+ *
+ * Functions included are:
+ * 	prof_cycle_begin()
+ * 	prof_begin()
+ * 	prof_end()
+ * 	prof_job()
+ * 	prof_cycle_end()
+ *
+ */
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+#include <log.h>
+#include "data_types.h"
+#include "globals.h"
+#include "misc.h"
+#include "sched_profile.h"
+
+struct sched_profile sprof;
+
+static char *phase_names[PROF_NUM_PHASES] = {
+	"query_server",
+	"init_cycle",
+	"sort_jobs",
+	"is_ok_to_run",
+	"check_limits",
+	"eval_selspec",
+	"preemption",
+	"calendar",
+	"run_job",
+	"send_job_updates",
+	"end_cycle"
+};
+
+/**
+ * @brief
+ *		prof_now - the current time of a monotonic clock where there is
+ *		one, else the time of day
+ *
+ * @return	prof_stamp
+ */
+static prof_stamp
+prof_now(void)
+{
+#ifdef WIN32
+	LARGE_INTEGER freq;
+	LARGE_INTEGER count;
+
+	if (QueryPerformanceFrequency(&freq) && QueryPerformanceCounter(&count))
+		return (prof_stamp) count.QuadPart / (prof_stamp) freq.QuadPart;
+	return (prof_stamp) GetTickCount() / 1000.0;
+#else
+	struct timeval tv;
+#ifdef CLOCK_MONOTONIC
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+		return (prof_stamp) ts.tv_sec + (prof_stamp) ts.tv_nsec / 1.0e9;
+#endif
+	gettimeofday(&tv, NULL);
+	return (prof_stamp) tv.tv_sec + (prof_stamp) tv.tv_usec / 1.0e6;
+#endif
+}
+
+/**
+ * @brief
+ *		ts_elapsed - seconds elapsed since a timestamp
+ *
+ * @param[in]	ts	-	the starting timestamp
+ *
+ * @return	double
+ */
+static double
+ts_elapsed(prof_stamp *ts)
+{
+	return prof_now() - *ts;
+}
+
+/**
+ * @brief
+ *		prof_cycle_begin - reset the profile at the start of a cycle
+ *
+ * @return	nothing
+ */
+void
+prof_cycle_begin(void)
+{
+	memset(&sprof, 0, sizeof(sprof));
+	sprof.enabled = (conf.cycle_profile != NULL);
+	if (sprof.enabled)
+		sprof.start = prof_now();
+}
+
+/**
+ * @brief
+ *		prof_begin - mark the start of a timed region.  The timestamp is
+ *		kept by the caller so nested and recursive regions are safe.
+ *
+ * @param[out]	ts	-	where to save the start time
+ *
+ * @return	nothing
+ */
+void
+prof_begin(prof_stamp *ts)
+{
+	if (sprof.enabled)
+		*ts = prof_now();
+}
+
+/**
+ * @brief
+ *		prof_end - account the time since prof_begin() to a phase.
+ *		Phase times are inclusive of any phases nested inside them.
+ *
+ * @param[in]	phase	-	the phase to charge
+ * @param[in]	ts	-	start time from prof_begin()
+ *
+ * @return	nothing
+ */
+void
+prof_end(enum prof_phase phase, prof_stamp *ts)
+{
+	if (!sprof.enabled)
+		return;
+
+	sprof.phase_secs[phase] += ts_elapsed(ts);
+	sprof.phase_calls[phase]++;
+}
+
+/**
+ * @brief
+ *		slow_heap_down - restore the min-heap of slow jobs from the root
+ *
+ * @return	nothing
+ */
+static void
+slow_heap_down(void)
+{
+	int i = 0;
+	int c;
+	struct prof_job tmp;
+
+	while ((c = 2 * i + 1) < sprof.num_slow) {
+		if (c + 1 < sprof.num_slow &&
+			sprof.slow[c + 1].secs < sprof.slow[c].secs)
+			c++;
+		if (sprof.slow[i].secs <= sprof.slow[c].secs)
+			break;
+		tmp = sprof.slow[i];
+		sprof.slow[i] = sprof.slow[c];
+		sprof.slow[c] = tmp;
+		i = c;
+	}
+}
+
+/**
+ * @brief
+ *		prof_job - record one job decision.  Only the PROF_SLOW_JOBS
+ *		slowest decisions of the cycle are kept.
+ *
+ * @param[in]	name	-	job name
+ * @param[in]	ts	-	start time from prof_begin()
+ * @param[in]	nodes	-	number of nodes examined for the job
+ * @param[in]	ran	-	did the job run
+ *
+ * @return	nothing
+ */
+void
+prof_job(char *name, prof_stamp *ts, long nodes, int ran)
+{
+	struct prof_job *pj;
+	double secs;
+	int i;
+
+	sprof.jobs_considered++;
+	if (ran)
+		sprof.jobs_run++;
+
+	if (!sprof.enabled || name == NULL)
+		return;
+
+	secs = ts_elapsed(ts);
+	if (sprof.num_slow < PROF_SLOW_JOBS) {
+		/* sift the new entry up */
+		i = sprof.num_slow++;
+		while (i > 0 && sprof.slow[(i - 1) / 2].secs > secs) {
+			sprof.slow[i] = sprof.slow[(i - 1) / 2];
+			i = (i - 1) / 2;
+		}
+		pj = &sprof.slow[i];
+	} else if (secs > sprof.slow[0].secs) {
+		pj = &sprof.slow[0];
+	} else
+		return;
+
+	snprintf(pj->name, sizeof(pj->name), "%s", name);
+	pj->secs = secs;
+	pj->nodes = nodes;
+	pj->ran = ran;
+	if (pj == &sprof.slow[0] && sprof.num_slow == PROF_SLOW_JOBS)
+		slow_heap_down();
+}
+
+/**
+ * @brief
+ *		cmp_prof_job - sort slow jobs slowest first
+ *
+ * @param[in]	v1	-	struct prof_job
+ * @param[in]	v2	-	struct prof_job
+ *
+ * @return	int
+ */
+static int
+cmp_prof_job(const void *v1, const void *v2)
+{
+	double s1 = ((const struct prof_job *) v1)->secs;
+	double s2 = ((const struct prof_job *) v2)->secs;
+
+	if (s1 > s2)
+		return -1;
+	if (s1 < s2)
+		return 1;
+	return 0;
+}
+
+/**
+ * @brief
+ *		fput_json_str - write a string as a quoted, escaped JSON string
+ *
+ * @param[in]	fp	-	output file
+ * @param[in]	str	-	string to write
+ *
+ * @return	nothing
+ */
+static void
+fput_json_str(FILE *fp, char *str)
+{
+	unsigned char *p;
+
+	fputc('"', fp);
+	for (p = (unsigned char *) str; *p != '\0'; p++) {
+		if (*p == '"' || *p == '\\')
+			fprintf(fp, "\\%c", *p);
+		else if (*p < 0x20)
+			fprintf(fp, "\\u%04x", *p);
+		else
+			fputc(*p, fp);
+	}
+	fputc('"', fp);
+}
+
+/**
+ * @brief
+ *		prof_cycle_end - append the cycle's profile as one JSON line to
+ *		the file named by conf.cycle_profile
+ *
+ * @return	nothing
+ */
+void
+prof_cycle_end(void)
+{
+	FILE *fp;
+	int i;
+
+	if (!sprof.enabled || conf.cycle_profile == NULL)
+		return;
+
+	if ((fp = fopen(conf.cycle_profile, "a")) == NULL) {
+		schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_FILE, LOG_WARNING,
+			conf.cycle_profile, "Unable to open cycle profile file");
+		return;
+	}
+
+	fprintf(fp, "{\"time\":%ld,\"duration\":%.6f,\"jobs_considered\":%ld,"
+		"\"jobs_run\":%ld,\"nodes_examined\":%ld,\"resource_lookups\":%ld,"
+		"\"phases\":{", (long) time(NULL), ts_elapsed(&sprof.start),
+		sprof.jobs_considered, sprof.jobs_run, sprof.nodes_examined,
+		sprof.resc_lookups);
+	for (i = 0; i < PROF_NUM_PHASES; i++)
+		fprintf(fp, "%s\"%s\":{\"secs\":%.6f,\"calls\":%ld}",
+			i ? "," : "", phase_names[i], sprof.phase_secs[i],
+			sprof.phase_calls[i]);
+
+	fputs("},\"slow_jobs\":[", fp);
+	qsort(sprof.slow, sprof.num_slow, sizeof(struct prof_job), cmp_prof_job);
+	for (i = 0; i < sprof.num_slow; i++) {
+		fputs(i ? ",{\"job\":" : "{\"job\":", fp);
+		fput_json_str(fp, sprof.slow[i].name);
+		fprintf(fp, ",\"secs\":%.6f,\"nodes\":%ld,\"ran\":%s}",
+			sprof.slow[i].secs, sprof.slow[i].nodes,
+			sprof.slow[i].ran ? "true" : "false");
+	}
+	fputs("]}\n", fp);
+
+	if (fclose(fp) != 0)
+		schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_FILE, LOG_WARNING,
+			conf.cycle_profile, "Error writing cycle profile file");
+	sprof.enabled = 0;
+}
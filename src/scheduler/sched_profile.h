@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 1994-2016 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *  
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ * 
+ * Open Source License Information:
+ *  
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free 
+ * Software Foundation, either version 3 of the License, or (at your option) any 
+ * later version.
+ *  
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  
+ * Commercial License Information: 
+ * 
+ * The PBS Pro software is licensed under the terms of the GNU Affero General 
+ * Public License agreement ("AGPL"), except where a separate commercial license 
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *  
+ * Altair’s dual-license business model allows companies, individuals, and 
+ * organizations to create proprietary derivative works of PBS Pro and distribute 
+ * them - whether embedded or bundled with other software - under a commercial 
+ * license agreement.
+ * 
+ * Use of Altair’s trademarks, including but not limited to "PBS™", 
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's 
+ * trademark licensing policies.
+ *
+ */
+#ifndef	_SCHED_PROFILE_H
+#define	_SCHED_PROFILE_H
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include <time.h>
+#include <pbs_ifl.h>
+
+/* phases of a scheduling cycle which are timed by the cycle profiler */
+enum prof_phase {
+	PROF_QUERY_SERVER,
+	PROF_INIT_CYCLE,
+	PROF_SORT_JOBS,
+	PROF_IS_OK_TO_RUN,
+	PROF_CHECK_LIMITS,
+	PROF_EVAL_SELSPEC,
+	PROF_PREEMPTION,
+	PROF_CALENDAR,
+	PROF_RUN_JOB,
+	PROF_SEND_UPDATES,
+	PROF_END_CYCLE,
+	PROF_NUM_PHASES
+};
+
+/* a point in time for the profiler, in seconds of a monotonic clock */
+typedef double prof_stamp;
+
+/* number of slowest jobs remembered per cycle */
+#define PROF_SLOW_JOBS 20
+
+struct prof_job {
+	char name[PBS_MAXSVRJOBID + 1];
+	double secs;			/* time spent deciding on the job */
+	long nodes;			/* nodes examined for the job */
+	int ran;			/* job was run this cycle */
+};
+
+struct sched_profile {
+	int enabled;			/* conf.cycle_profile was set at cycle start */
+	prof_stamp start;		/* start of the cycle */
+	double phase_secs[PROF_NUM_PHASES];	/* inclusive time per phase */
+	long phase_calls[PROF_NUM_PHASES];
+	long jobs_considered;
+	long jobs_run;
+	long nodes_examined;
+	long resc_lookups;
+	int num_slow;
+	struct prof_job slow[PROF_SLOW_JOBS];	/* min-heap on secs */
+};
+
+extern struct sched_profile sprof;
+
+/* cheap counters: always bumped, only reported when profiling is on */
+#define PROF_COUNT_NODE()	(sprof.nodes_examined++)
+#define PROF_COUNT_RESC()	(sprof.resc_lookups++)
+
+/*
+ *	prof_cycle_begin - reset the profile at the start of a cycle
+ */
+void prof_cycle_begin(void);
+
+/*
+ *	prof_cycle_end - append the cycle's profile to conf.cycle_profile
+ */
+void prof_cycle_end(void);
+
+/*
+ *	prof_begin - mark the start of a timed region
+ */
+void prof_begin(prof_stamp *ts);
+
+/*
+ *	prof_end - account the time since prof_begin() to a phase
+ */
+void prof_end(enum prof_phase phase, prof_stamp *ts);
+
+/*
+ *	prof_job - record the time and nodes examined for one job decision
+ */
+void prof_job(char *name, prof_stamp *ts, long nodes, int ran);
+
+#ifdef	__cplusplus
+}
+#endif
+#endif	/* _SCHED_PROFILE_H */
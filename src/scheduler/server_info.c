@@ -45,6 +45,10 @@
  * 	query_server()
  * 	query_server_info()
  * 	query_server_dyn_res()
+ * 	dyn_res_reset()
+ * 	dyn_res_start()
+ * 	dyn_res_poll()
+ * 	run_server_dyn_res()
  * 	query_sched_obj()
  * 	find_alloc_resource()
  * 	find_alloc_resource_by_str()
@@ -114,6 +118,15 @@
 #include <string.h>
 #include <errno.h>
 #include <ctype.h>
+#ifndef WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/select.h>
+#endif
 #include <pbs_ifl.h>
 #include <pbs_error.h>
 #include <log.h>
@@ -140,6 +153,7 @@
 #include "simulate.h"
 #include "fairshare.h"
 #include "check.h"
+#include "sched_profile.h"
 #ifdef NAS
 #include "site_code.h"
 #endif
@@ -443,6 +457,7 @@ query_server_info(status *pol, struct batch_status *server)
 	sch_resource_t count;	/* used to convert string -> integer */
 	char *endp;		/* used with strtol() */
 	status *policy;
+	int attr_id;		/* id of attrp->name */
 
 	if (pol == NULL || server == NULL)
 		return NULL;
@@ -453,7 +468,7 @@ query_server_info(status *pol, struct batch_status *server)
 	if (sinfo->liminfo == NULL)
 		return NULL;
 
-	if ((sinfo->name = string_dup(server->name)) == NULL) {
+	if ((sinfo->name = arena_strdup(&cycle_arena, server->name)) == NULL) {
 		free_server_info(sinfo);
 		return NULL;
 	}
@@ -468,28 +483,29 @@ query_server_info(status *pol, struct batch_status *server)
 	attrp = server->attribs;
 
 	while (attrp != NULL) {
+		attr_id = sched_attr_id(attrp->name);
 		if (is_reslimattr(attrp))
 			(void) lim_setlimits(attrp, LIM_RES, sinfo->liminfo);
 		else if (is_runlimattr(attrp))
 			(void) lim_setlimits(attrp, LIM_RUN, sinfo->liminfo);
 		else if (is_oldlimattr(attrp))
 			(void) lim_setlimits(attrp, LIM_OLD, sinfo->liminfo);
-		else if (!strcmp(attrp->name, ATTR_FLicenses)) {
+		else if (attr_id == SATTR_FLicenses) {
 			count = strtol(attrp->value, &endp, 10);
 			if (*endp != '\0')
 				count = -1;
 
 			sinfo->flt_lic = count;
 		}
-		else if (!strcmp(attrp->name, ATTR_NodeGroupEnable)) {
+		else if (attr_id == SATTR_NodeGroupEnable) {
 			if (!strcmp(attrp->value, ATR_TRUE))
 				sinfo->node_group_enable = 1;
 			else
 				sinfo->node_group_enable = 0;
 		}
-		else if (!strcmp(attrp->name, ATTR_NodeGroupKey))
+		else if (attr_id == SATTR_NodeGroupKey)
 			sinfo->node_group_key = break_comma_list(attrp->value);
-		else if (!strcmp(attrp->name, ATTR_job_sort_formula)) {
+		else if (attr_id == SATTR_job_sort_formula) {
 			sinfo->job_formula = read_formula();
 			if (policy->sort_by[1].res_name != NULL) /* 0 is the formula itself */
 				schdlog(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_DEBUG,
@@ -498,7 +514,7 @@ query_server_info(status *pol, struct batch_status *server)
 					"The job sorting formula will be used.");
 
 		}
-		else if (!strcmp(attrp->name, ATTR_rescavail)) { /* resources_available*/
+		else if (attr_id == SATTR_rescavail) { /* resources_available*/
 			resp = find_alloc_resource_by_str(sinfo->res, attrp->resource);
 
 			if (resp != NULL) {
@@ -511,7 +527,7 @@ query_server_info(status *pol, struct batch_status *server)
 				}
 			}
 		}
-		else if (!strcmp(attrp->name, ATTR_rescassn)) { /* resources_assigned */
+		else if (attr_id == SATTR_rescassn) { /* resources_assigned */
 			resp = find_alloc_resource_by_str(sinfo->res, attrp->resource);
 			if (sinfo->res == NULL)
 				sinfo->res = resp;
@@ -522,7 +538,7 @@ query_server_info(status *pol, struct batch_status *server)
 				}
 			}
 		}
-		else if (!strcmp(attrp->name, ATTR_rpp_retry)) { /* rpp_retry */
+		else if (attr_id == SATTR_rpp_retry) { /* rpp_retry */
 			count = strtol(attrp->value, &endp, 10);
 			if (*endp != '\0')
 				count = RPP_RETRY;
@@ -539,7 +555,7 @@ query_server_info(status *pol, struct batch_status *server)
 				rpp_retry = (int)count;
 			}
 		}
-		else if (!strcmp(attrp->name, ATTR_rpp_highwater)) { /* rpp_highwater */
+		else if (attr_id == SATTR_rpp_highwater) { /* rpp_highwater */
 			count = strtol(attrp->value, &endp, 10);
 			if (*endp != '\0')
 				count = RPP_HIGHWATER;
@@ -557,19 +573,19 @@ query_server_info(status *pol, struct batch_status *server)
 				rpp_highwater = (int)count;
 			}
 		}
-		else if (!strcmp(attrp->name, ATTR_EligibleTimeEnable)) {
+		else if (attr_id == SATTR_EligibleTimeEnable) {
 			if (!strcmp(attrp->value, ATR_TRUE))
 				sinfo->eligible_time_enable = 1;
 			else
 				sinfo->eligible_time_enable = 0;
 		}
-		else if (!strcmp(attrp->name, ATTR_ProvisionEnable)) {
+		else if (attr_id == SATTR_ProvisionEnable) {
 			if (!strcmp(attrp->value, ATR_TRUE))
 				sinfo->provision_enable = 1;
 			else
 				sinfo->provision_enable = 0;
 		}
-		else if (!strcmp(attrp->name, ATTR_backfill_depth)) {
+		else if (attr_id == SATTR_backfill_depth) {
 			count = strtol(attrp->value, &endp, 10);
 			if (*endp == '\0')
 				sinfo->policy->backfill_depth = count;
@@ -595,9 +611,274 @@ query_server_info(status *pol, struct batch_status *server)
 	return sinfo;
 }
 
+#ifndef WIN32
+/*
+ * A server_dyn_res program run in the background.  Every cycle uses the
+ * last good value it gave until a later run of the program gives another.
+ * Times are those the runs were started, the output is as of then.
+ */
+struct dyn_res_run {
+	char *res;			/* resource name */
+	char *program;			/* program run for the resource */
+	pid_t pid;			/* program's process group, -1 if none */
+	int fd;				/* read end of its output, -1 if none */
+	time_t started;			/* time the program was started */
+	char out[256];			/* output read so far */
+	int outlen;
+	char *value;			/* last good value, NULL if none yet */
+	time_t valtime;			/* start of the run which gave value */
+	int failed;			/* the last finished run gave no value */
+	int err;			/* errno of the last failed run */
+	time_t done;			/* start of the last finished run, 0 if none */
+};
+static struct dyn_res_run dyn_res_runs[MAX_SERVER_DYN_RES];
+
+/**
+ * @brief
+ * 		stop a server_dyn_res program and forget about it
+ *
+ * @param[in,out]	run	-	the program's run state
+ *
+ * @return void
+ */
+static void
+dyn_res_reset(struct dyn_res_run *run)
+{
+	if (run->pid > 0) {
+		kill(-run->pid, SIGKILL);
+		(void) waitpid(run->pid, NULL, 0);
+	}
+	if (run->fd != -1)
+		close(run->fd);
+	free(run->res);
+	free(run->program);
+	free(run->value);
+	memset(run, 0, sizeof(struct dyn_res_run));
+	run->pid = -1;
+	run->fd = -1;
+}
+
+/**
+ * @brief
+ * 		start a server_dyn_res program in its own process group with its
+ *		output on a non-blocking pipe
+ *
+ * @param[in,out]	run	-	the program's run state
+ *
+ * @retval	0	: on success
+ * @retval -1	: on error, run->err is set
+ */
+static int
+dyn_res_start(struct dyn_res_run *run)
+{
+	int pfd[2];
+	int i;
+
+	if (pipe(pfd) == -1) {
+		run->err = errno;
+		return -1;
+	}
+
+	run->pid = fork();
+	if (run->pid == -1) {
+		run->err = errno;
+		close(pfd[0]);
+		close(pfd[1]);
+		return -1;
+	}
+	if (run->pid == 0) {
+		(void) setpgid(0, 0);
+		for (i = 0; i < MAX_SERVER_DYN_RES; i++) {
+			if (dyn_res_runs[i].fd != -1)
+				close(dyn_res_runs[i].fd);
+		}
+		close(pfd[0]);
+		if (pfd[1] != STDOUT_FILENO) {
+			dup2(pfd[1], STDOUT_FILENO);
+			close(pfd[1]);
+		}
+		execl("/bin/sh", "sh", "-c", run->program, (char *) NULL);
+		_exit(127);
+	}
+	(void) setpgid(run->pid, run->pid);
+
+	close(pfd[1]);
+	(void) fcntl(pfd[0], F_SETFL, fcntl(pfd[0], F_GETFL) | O_NONBLOCK);
+	(void) fcntl(pfd[0], F_SETFD, FD_CLOEXEC);
+	run->fd = pfd[0];
+	run->started = time(NULL);
+	run->outlen = 0;
+	return 0;
+}
+
+/**
+ * @brief
+ * 		collect what a running server_dyn_res program has to say.  The
+ *		run is done once the first line of output (or end of file) is
+ *		read; the program is then left to exit and reaped later.  A
+ *		program which runs past its timeout is killed.
+ *
+ * @param[in,out]	run	-	the program's run state
+ * @param[in]	dr	-	the program's configuration
+ * @param[in]	now	-	the current time
+ *
+ * @return void
+ */
+static void
+dyn_res_poll(struct dyn_res_run *run, struct dyn_res *dr, time_t now)
+{
+	int k;
+	char *nl;
+
+	if (run->fd != -1) {
+		while ((k = read(run->fd, run->out + run->outlen,
+			sizeof(run->out) - 1 - run->outlen)) > 0) {
+			run->outlen += k;
+			if (run->outlen == sizeof(run->out) - 1)
+				break;
+		}
+		run->out[run->outlen] = '\0';
+		nl = strpbrk(run->out, "\r\n");
+
+		if (nl != NULL || k == 0 || run->outlen == sizeof(run->out) - 1 ||
+			(k == -1 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+			if (nl != NULL)
+				*nl = '\0';
+			if (run->out[0] != '\0') {
+				free(run->value);
+				run->value = string_dup(run->out);
+				run->valtime = run->started;
+				run->failed = 0;
+			} else {
+				run->err = (k == -1) ? errno : 0;
+				run->failed = 1;
+			}
+			run->done = run->started;
+			close(run->fd);
+			run->fd = -1;
+		}
+	}
+
+	if (run->pid > 0) {
+		if (waitpid(run->pid, NULL, WNOHANG) == run->pid)
+			run->pid = -1;
+		else if (now - run->started >= dr->timeout) {
+			if (run->fd != -1) {
+				snprintf(log_buffer, sizeof(log_buffer),
+					"Program %s timed out after %d seconds",
+					dr->program, dr->timeout);
+				schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_SERVER, LOG_INFO,
+					"server_dyn_res", log_buffer);
+				close(run->fd);
+				run->fd = -1;
+				run->err = ETIMEDOUT;
+				run->failed = 1;
+				run->done = run->started;
+			}
+			kill(-run->pid, SIGKILL);
+			(void) waitpid(run->pid, NULL, 0);
+			run->pid = -1;
+		}
+	}
+}
+
+/**
+ * @brief
+ * 		run the server_dyn_res programs which are due, all at the same
+ *		time and in the background.  Only programs which have never
+ *		given a value are waited for, up to their timeout.
+ *
+ * @return void
+ */
+static void
+run_server_dyn_res(void)
+{
+	struct dyn_res_run *run;
+	struct dyn_res *dr;
+	struct timeval tv;
+	fd_set fdset;
+	time_t now;
+	time_t wait;
+	int nfds;
+	int i;
+	static int init = 0;
+
+	if (!init) {
+		for (i = 0; i < MAX_SERVER_DYN_RES; i++) {
+			dyn_res_runs[i].pid = -1;
+			dyn_res_runs[i].fd = -1;
+		}
+		init = 1;
+	}
+
+	now = time(NULL);
+	for (i = 0; i < MAX_SERVER_DYN_RES; i++) {
+		run = &dyn_res_runs[i];
+		dr = &conf.dynamic_res[i];
+
+		/* the configuration changed since the program was last run */
+		if (run->res != NULL && (dr->res == NULL ||
+			strcmp(run->res, dr->res) || strcmp(run->program, dr->program)))
+			dyn_res_reset(run);
+		if (dr->res == NULL)
+			continue;
+		if (run->res == NULL) {
+			run->res = string_dup(dr->res);
+			run->program = string_dup(dr->program);
+			if (run->res == NULL || run->program == NULL) {
+				dyn_res_reset(run);
+				continue;
+			}
+		}
+
+		dyn_res_poll(run, dr, now);
+		if (run->pid == -1 && (run->done == 0 || now - run->done >= dr->interval)) {
+			if (dyn_res_start(run) == -1) {
+				run->failed = 1;
+				run->done = now;
+			}
+		}
+	}
+
+	for (;;) {
+		FD_ZERO(&fdset);
+		nfds = 0;
+		wait = -1;
+		now = time(NULL);
+		for (i = 0; i < MAX_SERVER_DYN_RES && conf.dynamic_res[i].res != NULL; i++) {
+			run = &dyn_res_runs[i];
+			if (run->done == 0 && run->fd != -1) {
+				FD_SET(run->fd, &fdset);
+				if (run->fd >= nfds)
+					nfds = run->fd + 1;
+				/* wake up for the first one to time out */
+				if (wait == -1 || run->started + conf.dynamic_res[i].timeout - now < wait)
+					wait = run->started + conf.dynamic_res[i].timeout - now;
+			}
+		}
+		if (nfds == 0)
+			break;
+
+		tv.tv_sec = wait > 0 ? wait : 0;
+		tv.tv_usec = 0;
+		if (select(nfds, &fdset, NULL, NULL, &tv) == -1 && errno != EINTR)
+			break;
+
+		now = time(NULL);
+		for (i = 0; i < MAX_SERVER_DYN_RES && conf.dynamic_res[i].res != NULL; i++) {
+			run = &dyn_res_runs[i];
+			if (run->done == 0 && run->fd != -1)
+				dyn_res_poll(run, &conf.dynamic_res[i], now);
+		}
+	}
+}
+#endif /* WIN32 */
+
 /**
  * @brief
- * 		execute all configured server_dyn_res scripts
+ * 		set the resources from all configured server_dyn_res scripts.
+ *		Except on Windows, the scripts are run in the background by
+ *		run_server_dyn_res() and the last value each one gave is used.
  *
  * @param[in]	sinfo	-	server info
  *
@@ -612,10 +893,15 @@ query_server_dyn_res(server_info *sinfo)
 	char res_zero[] = "0";	/* dynamic res failure implies resource <-0 */
 	char buf[256];		/* buffer for reading from pipe */
 	resource *res;		/* used for updating node resources */
-	FILE *fp;			/* for popen() for res_assn */
 #ifdef WIN32
 	struct  pio_handles	  pio;  /* for win_popen() for res_assn */
 	char			  cmd_line[512];
+#else
+	struct dyn_res_run *run;
+	time_t now;
+
+	run_server_dyn_res();
+	now = time(NULL);
 #endif
 
 	for (i = 0; i < MAX_SERVER_DYN_RES && conf.dynamic_res[i].res != NULL; i ++) {
@@ -640,15 +926,29 @@ query_server_dyn_res(server_info *sinfo)
 			if (pio.hReadPipe_out != INVALID_HANDLE_VALUE) /* did win_popen() succeed? */
 				win_pclose(&pio);
 #else
-			if (((fp = popen(conf.dynamic_res[i].program, "r")) == NULL) ||
-				(fgets(buf, 256, fp) == NULL)) {
-				pipe_err = errno;
+			run = &dyn_res_runs[i];
+			if (run->value != NULL) {
+				snprintf(buf, sizeof(buf), "%s", run->value);
+				k = strlen(buf);
+			}
+			else {
+				pipe_err = run->err;
 				k = 0;
 			}
-			else
-				k = strlen(buf);
-			if (fp != NULL)
-				pclose(fp);
+			if (run->value != NULL && (run->fd != -1 || run->failed)) {
+				if (run->fd != -1)
+					snprintf(log_buffer, sizeof(log_buffer),
+						"%s still running, using value from %ld seconds ago",
+						conf.dynamic_res[i].program, (long)(now - run->valtime));
+				else
+					snprintf(log_buffer, sizeof(log_buffer),
+						"%s gave no value: %s, using value from %ld seconds ago",
+						conf.dynamic_res[i].program,
+						run->err ? strerror(run->err) : "no output",
+						(long)(now - run->valtime));
+				schdlog(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SERVER, LOG_DEBUG,
+					"server_dyn_res", log_buffer);
+			}
 #endif
 			if (k > 0) {
 				buf[k] = '\0';
@@ -715,6 +1015,7 @@ int
 query_sched_obj(status *policy, struct batch_status *sched, server_info *sinfo)
 {
 	struct attrl *attrp;          /* linked list of attributes from server */
+	int attr_id;			/* id of attrp->name */
 
 	if (sched == NULL || sinfo == NULL)
 		return 0;
@@ -727,30 +1028,31 @@ query_sched_obj(status *policy, struct batch_status *sched, server_info *sinfo)
 	}
 
 	while (attrp != NULL) {
-		if (!strcmp(attrp->name, ATTR_sched_cycle_len)) {
+		attr_id = sched_attr_id(attrp->name);
+		if (attr_id == SATTR_sched_cycle_len) {
 			sinfo->sched_cycle_len = res_to_num(attrp->value, NULL);
 		}
-		else if (!strcmp(attrp->name, ATTR_do_not_span_psets)) {
+		else if (attr_id == SATTR_do_not_span_psets) {
 			sinfo->dont_span_psets = res_to_num(attrp->value, NULL);
 		}
-		else if (!strcmp(attrp->name, ATTR_sched_preempt_enforce_resumption)) {
+		else if (attr_id == SATTR_sched_preempt_enforce_resumption) {
 			if (!strcasecmp(attrp->value, ATR_FALSE))
 				sinfo->enforce_prmptd_job_resumption = 0;
 			else
 				sinfo->enforce_prmptd_job_resumption = 1;
 		}
-		else if (!strcmp(attrp->name, ATTR_preempt_targets_enable)) {
+		else if (attr_id == SATTR_preempt_targets_enable) {
 			if (!strcasecmp(attrp->value, ATR_FALSE))
 				sinfo->preempt_targets_enable = 0;
 			else
 				sinfo->preempt_targets_enable = 1;
 		}
-		else if (!strcmp(attrp->name, ATTR_job_sort_formula_threshold)) {
+		else if (attr_id == SATTR_job_sort_formula_threshold) {
 			policy->job_form_threshold_set = 1;
 			policy->job_form_threshold = res_to_num(attrp->value, NULL);
-		} else if (!strcmp(attrp->name, ATTR_throughput_mode)) {
+		} else if (attr_id == SATTR_throughput_mode) {
 			sinfo->throughput_mode = res_to_num(attrp->value, NULL);
-		} else if (!strcmp(attrp->name, ATTR_opt_backfill_fuzzy)) {
+		} else if (attr_id == SATTR_opt_backfill_fuzzy) {
 			if (!strcasecmp(attrp->value, "off"))
 				sinfo->opt_backfill_fuzzy_time = BF_OFF;
 			else if (!strcasecmp(attrp->value, "low")) sinfo->opt_backfill_fuzzy_time = BF_LOW;
@@ -892,6 +1194,7 @@ find_resource(resource *reslist, resdef *def)
 	if (reslist == NULL || def == NULL)
 		return NULL;
 
+	PROF_COUNT_RESC();
 	resp = reslist;
 
 	while (resp != NULL && resp->def != def)
@@ -914,8 +1217,7 @@ find_resource(resource *reslist, resdef *def)
 void
 free_server_info(server_info *sinfo)
 {
-	if (sinfo->name != NULL)
-		free(sinfo->name);
+	arena_free_str(&cycle_arena, sinfo->name);
 	if (sinfo->jobs != NULL)
 		free(sinfo->jobs);
 	if (sinfo->all_resresv != NULL)
@@ -955,6 +1257,10 @@ free_server_info(server_info *sinfo)
 		free_string_array(sinfo->nodesigs);
 	if (sinfo->npc_arr != NULL)
 		free_np_cache_array(sinfo->npc_arr);
+	if (sinfo->npc_ix != NULL) {
+		avl_destroy_index(sinfo->npc_ix);
+		free(sinfo->npc_ix);
+	}
 	if (sinfo->node_group_key != NULL)
 		free_string_array(sinfo->node_group_key);
 	if (sinfo->job_formula != NULL)
@@ -1036,7 +1342,7 @@ free_resource(resource *resp)
 	if (resp->str_assigned != NULL)
 		free(resp->str_assigned);
 
-	free(resp);
+	pool_free(&resource_pool, resp);
 }
 
 /**
@@ -1107,6 +1413,7 @@ new_server_info(int limallocflag)
 	sinfo->node_group_key = NULL;
 	sinfo->preempt_targets_enable = 1; /* enabled by default */
 	sinfo->npc_arr = NULL;
+	sinfo->npc_ix = NULL;
 	sinfo->qrun_job = NULL;
 	sinfo->job_formula = NULL;
 	sinfo->policy = NULL;
@@ -1147,12 +1454,10 @@ new_resource()
 {
 	resource *resp;		/* the new resource */
 
-	if ((resp = calloc(1,  sizeof(resource))) == NULL) {
-		log_err(errno, "new_resource", MEM_ERR_MSG);
+	if ((resp = pool_alloc(&resource_pool)) == NULL)
 		return NULL;
-	}
 
-	/* member type zero'd by calloc() */
+	/* member type zero'd by pool_alloc() */
 
 	resp->name = NULL;
 	resp->next = NULL;
@@ -1590,22 +1895,9 @@ update_server_on_run(status *policy, server_info *sinfo,
 			}
 		}
 
-		/* We're running a job or reservation, which will affect the cached data.
-		 * We'll flush the cache and rebuild it if needed
+		/* the server's placement sets and the node partition cache are
+		 * brought up to date by update_all_nodepart()
 		 */
-		if (sinfo->npc_arr != NULL) {
-			free_np_cache_array(sinfo->npc_arr);
-			sinfo->npc_arr = NULL;
-		}
-
-		/* should probably be in update_all_nodepart() for consistency
-		 * when moved, this copy and update_node_on_end() must be moved
-		 */
-		if (sinfo->node_group_enable && sinfo->node_group_key !=NULL) {
-			node_partition_update_array(policy, sinfo->nodepart);
-			qsort(sinfo->nodepart, sinfo->num_parts,
-				sizeof(node_partition *), cmp_placement_sets);
-		}
 
 		/* a new job has been run, recreate running jobs array */
 		free(sinfo->running_jobs);
@@ -1712,22 +2004,9 @@ update_server_on_end(status *policy, server_info *sinfo, queue_info *qinfo,
 		}
 	}
 
-	/* We're ending a job or reservation, which will affect the cached data.
-	 * We'll flush the cache and rebuild it if needed
+	/* the server's placement sets and the node partition cache are
+	 * brought up to date by update_all_nodepart()
 	 */
-	if (sinfo->npc_arr != NULL) {
-		free_np_cache_array(sinfo->npc_arr);
-		sinfo->npc_arr = NULL;
-	}
-
-	/* should probably be in update_all_nodepart() for consistency -
-	 * when moved, both this and update_node_on_run most be moved
-	 */
-	if (sinfo->node_group_enable && sinfo->node_group_key !=NULL) {
-		node_partition_update_array(policy, sinfo->nodepart);
-		qsort(sinfo->nodepart, sinfo->num_parts,
-			sizeof(node_partition *), cmp_placement_sets);
-	}
 
 	if (sinfo->has_soft_limit || sinfo->has_hard_limit) {
 		if (resresv->is_job && resresv->job->is_running) {
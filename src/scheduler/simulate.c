@@ -1007,10 +1007,8 @@ new_timed_event()
 {
 	timed_event *te;
 
-	if ((te = malloc(sizeof(timed_event))) == NULL) {
-		log_err(errno, __func__, MEM_ERR_MSG);
+	if ((te = pool_alloc(&timed_event_pool)) == NULL)
 		return NULL;
-	}
 
 	te->disabled = 0;
 	te->name = NULL;
@@ -1175,7 +1173,7 @@ free_timed_event(timed_event *te)
 	if (te == NULL)
 		return;
 
-	free(te);
+	pool_free(&timed_event_pool, te);
 }
 
 /**
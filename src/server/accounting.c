@@ -42,6 +42,8 @@
  * accounting.c - contains functions to record accounting information
  *
  * Functions included are:
+ *	acct_jobindex_close()
+ *	acct_binary_close()
  *	acct_open()
  *	acct_record()
  *	acct_close()
@@ -55,11 +57,14 @@
 #include <sys/param.h>
 #endif
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <string.h>
+#include <ctype.h>
 #include <errno.h>
 #include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include <time.h>
 #include "list_link.h"
 #include "attribute.h"
@@ -74,10 +79,14 @@
 #include "pbs_license.h"
 #include "server.h"
 #include "svrfunc.h"
+#include "pbs_internal.h"
+#include "libutil.h"
 
 /* Local Data */
 
 static FILE	    *acctfile;		/* open stream for log file */
+static FILE	    *acctjix;		/* job-ID sidecar index of acctfile */
+static FILE	    *acctbin;		/* binary records written with acctfile */
 static volatile int  acct_opened = 0;
 static int	     acct_opened_day;
 static int	     acct_auto_switch = 0;
@@ -810,6 +819,40 @@ acct_resv(resc_resv *presv, char *buf, int len)
 	return (pb);
 }
 
+/**
+ * @brief
+ * acct_jobindex_close - write the close marker and close the job-ID index
+ *
+ * @return	void
+ */
+static void
+acct_jobindex_close(void)
+{
+	struct stat sb;
+
+	if (acctjix == NULL)
+		return;
+	if ((acct_opened > 0) && (fstat(fileno(acctfile), &sb) == 0))
+		(void)jobix_write(acctjix, JOBIX_CLOSE, (long long)sb.st_size);
+	(void)fclose(acctjix);
+	acctjix = NULL;
+}
+
+/**
+ * @brief
+ * acct_binary_close - close the binary accounting stream
+ *
+ * @return	void
+ */
+static void
+acct_binary_close(void)
+{
+	if (acctbin == NULL)
+		return;
+	(void)fclose(acctbin);
+	acctbin = NULL;
+}
+
 /**
  * @brief
  * acct_open() - open the acct file for append.
@@ -871,11 +914,35 @@ acct_open(char *filename)
 	(void)setvbuf(newacct, NULL, _IOLBF, 0); /* set line buffering */
 #endif
 
+	acct_jobindex_close();
+	acct_binary_close();
 	if (acct_opened > 0) 		/* if acct was open, close it */
 		(void)fclose(acctfile);
 
 	acctfile = newacct;
 	acct_opened = 1;			/* note that file is open */
+
+	if (pbs_conf.log_jobindex &&
+		((strlen(filename) + sizeof(JOBIX_SUFFIX)) <= sizeof(filen))) {
+		struct stat sb;
+
+		(void)sprintf(logmsg, "%s%s", filename, JOBIX_SUFFIX);
+		if ((fstat(fileno(acctfile), &sb) == 0) &&
+			((acctjix = fopen(logmsg, "ab")) != NULL)) {
+			(void)setvbuf(acctjix, NULL, _IONBF, 0);
+			(void)jobix_write(acctjix, JOBIX_OPEN, (long long)sb.st_size);
+		}
+	}
+	if (pbs_conf.acct_binary &&
+		((strlen(filename) + sizeof(ACCTBIN_SUFFIX)) <= sizeof(filen))) {
+		(void)sprintf(logmsg, "%s%s", filename, ACCTBIN_SUFFIX);
+		if ((acctbin = fopen(logmsg, "ab")) == NULL)
+			log_err(errno, "acct_open", logmsg);
+#ifdef WIN32
+		else
+			secure_file(logmsg, "Administrators", READS_MASK|WRITES_MASK|STANDARD_RIGHTS_REQUIRED);
+#endif
+	}
 	(void)sprintf(logmsg, "Account file %s opened", filename);
 	log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_INFO,
 		"Act", logmsg);
@@ -893,6 +960,8 @@ void
 acct_close()
 {
 	if (acct_opened == 1) {
+		acct_jobindex_close();
+		acct_binary_close();
 		(void)fclose(acctfile);
 		acct_opened = 0;
 	}
@@ -927,11 +996,27 @@ write_account_record(int acctype, char *id, char *text)
 	if (text == (char *)0)
 		text = "";
 
+	if ((acctjix != NULL) && isdigit((int)*id)) {
+		off_t off;
+
+		if ((off = lseek(fileno(acctfile), (off_t)0, SEEK_END)) != (off_t)-1)
+			(void)jobix_write(acctjix, jobix_hash(id), (long long)off);
+	}
+
 	(void)fprintf(acctfile,
 		"%02d/%02d/%04d %02d:%02d:%02d;%c;%s;%s\n",
 		ptm->tm_mon+1, ptm->tm_mday, ptm->tm_year+1900,
 		ptm->tm_hour, ptm->tm_min, ptm->tm_sec,
 		(char)acctype, id, text);
+
+	if (acctbin != NULL) {
+		if ((acctbin_write(acctbin, time_now, acctype, id, text) == -1) ||
+			(fflush(acctbin) != 0)) {
+			log_err(errno, "write_account_record",
+				"binary accounting record not written");
+			acct_binary_close();
+		}
+	}
 }
 
 /**
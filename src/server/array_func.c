@@ -43,6 +43,11 @@
  * is_job_array()
  * numindex_to_offset()
  * subjob_index_to_offset()
+ * mk_subjob_tbl()
+ * set_subjob_entry()
+ * get_subjob_entry()
+ * next_subjob_dirty()
+ * clear_subjob_dirty()
  * get_index_from_jid()
  * find_arrayparent()
  * set_subjob_tblstate()
@@ -183,9 +188,62 @@ is_job_array(char *id)
 		return IS_ARRAY_Single;
 }
 
+/**
+ * @brief
+ * 		map_scan - find the first bit at or after "from" in a subjob bitmap
+ *		which has the value "val".  Words that cannot contain such a bit
+ *		are skipped whole.
+ *
+ * @param[in]	map   - bitmap
+ * @param[in]	nbits - number of valid bits in the map
+ * @param[in]	from  - offset to start looking at
+ * @param[in]	val   - 1 to find a set bit, 0 to find a clear bit
+ *
+ * @return	offset of bit
+ * @retval	-1	- no such bit
+ */
+static int
+map_scan(unsigned long *map, int nbits, int from, int val)
+{
+	int i = from;
+	unsigned long skip = val ? 0UL : ~0UL;
+
+	while (i < nbits) {
+		if (((i % AJ_MAPBITS) == 0) && (map[i / AJ_MAPBITS] == skip)) {
+			i += AJ_MAPBITS;
+			continue;
+		}
+		if (AJ_MAPTST(map, i) == (unsigned long)val)
+			return i;
+		i++;
+	}
+	return -1;
+}
+/**
+ * @brief
+ * 		find_subjob_offset - find the first entry at or after "offset" in the
+ *		subjob index table whose state is (or with instate == 0, is not)
+ *		"state".
+ *
+ * @param[in]	parent  - pointer to parent job
+ * @param[in]	offset  - offset to start looking at
+ * @param[in]	state   - job state
+ * @param[in]	instate - 1 to find an entry in state, 0 for one not in it
+ *
+ * @return	offset of entry
+ * @retval	-1	- no such entry
+ */
+static int
+find_subjob_offset(job *parent, int offset, int state, int instate)
+{
+	return map_scan(parent->ji_ajmap->tkx_state[state],
+		parent->ji_ajtrk->tkm_ct, offset, instate);
+}
 /**
  * @brief
  * 		numindex_to_offset - return the offset into the table for a numerical
+ *		index.  The table holds the indices of "x-y:z" in order, so the
+ *		offset is computed directly.
  *
  * @param[in]	parent - Pointer to to parent job structure.
  * @param[in]	iindx  - first number of range
@@ -198,14 +256,16 @@ numindex_to_offset(job *parent, int iindx)
 {
 	struct ajtrkhd *ptbl;
 	int i;
+	int step;
 
 	ptbl = parent->ji_ajtrk;
-	if (ptbl == NULL)
+	if ((ptbl == NULL) || (ptbl->tkm_ct <= 0))
 		return -1;
-	for (i=0; i<ptbl->tkm_ct; i++) {
-		if (ptbl->tkm_tbl[i].trk_index == iindx)
-			return i;
-	}
+
+	step = (ptbl->tkm_step > 0) ? ptbl->tkm_step : 1;
+	i = iindx - ptbl->tkm_first;
+	if ((i >= 0) && ((i % step) == 0) && ((i / step) < ptbl->tkm_ct))
+		return (i / step);
 	return -1;
 }
 /**
@@ -221,22 +281,197 @@ numindex_to_offset(job *parent, int iindx)
 int
 subjob_index_to_offset(job *parent, char *index)
 {
-	struct ajtrkhd *ptbl;
-	int i;
-	int nidx;
-
 	if ((index == NULL) || (*index == '\0'))
 		return -1;
 
-	nidx = atoi(index);
-	ptbl = parent->ji_ajtrk;
-	if (ptbl == NULL)
+	return (numindex_to_offset(parent, atoi(index)));
+}
+/**
+ * @brief
+ * 		mk_subjob_tbl - allocate the subjob index table of an Array Job for
+ *		"ct" entries, with its bitmaps.  Any old table is freed.  The
+ *		entries are set to their defaults, no entry is in any state yet
+ *		and none is marked as changed.
+ *
+ * @param[in,out]	parent - pointer to parent job
+ * @param[in]	ct     - number of entries
+ *
+ * @return	int
+ * @retval	0	- success
+ * @retval	-1	- out of memory, the job is left without a table
+ */
+int
+mk_subjob_tbl(job *parent, int ct)
+{
+	struct ajtrkhd  *ptbl;
+	struct ajtrkmap *pmap;
+	unsigned long   *pw;
+	size_t		 sz;
+	size_t		 words;
+	int		 i;
+
+	if (parent->ji_ajtrk) {
+		free(parent->ji_ajtrk);
+		parent->ji_ajtrk = NULL;
+	}
+	if (parent->ji_ajmap) {
+		free(parent->ji_ajmap);
+		parent->ji_ajmap = NULL;
+	}
+	if (ct <= 0)
+		return -1;
+
+	sz = sizeof(struct ajtrkhd) + ((ct-1) * sizeof(struct ajtrkent));
+	words = AJ_MAPWORDS(ct);
+	ptbl = (struct ajtrkhd *)malloc(sz);
+	pmap = (struct ajtrkmap *)calloc(1, sizeof(struct ajtrkmap) +
+		(PBS_NUMJOBSTATE + 1) * words * sizeof(unsigned long));
+	if ((ptbl == NULL) || (pmap == NULL)) {
+		log_err(errno, __func__, "no memory");
+		free(ptbl);
+		free(pmap);
 		return -1;
-	for (i=0; i<ptbl->tkm_ct; i++) {
-		if (ptbl->tkm_tbl[i].trk_index == nidx)
-			return i;
 	}
-	return -1;
+
+	ptbl->tkm_size = sz;
+	ptbl->tkm_ct = ct;
+	ptbl->tkm_step = 1;
+	ptbl->tkm_flags = 0;
+	ptbl->tkm_first = 0;
+	for (i = 0; i < PBS_NUMJOBSTATE; i++)
+		ptbl->tkm_subjsct[i] = 0;
+	for (i = 0; i < ct; i++) {
+		ptbl->tkm_tbl[i].trk_error = 0;
+		ptbl->tkm_tbl[i].trk_substate = JOB_SUBSTATE_FINISHED;
+		ptbl->tkm_tbl[i].trk_stgout = -1;
+		ptbl->tkm_tbl[i].trk_exitstat = 0;
+	}
+
+	pmap->tkx_words = words;
+	pw = (unsigned long *)(pmap + 1);
+	for (i = 0; i < PBS_NUMJOBSTATE; i++, pw += words)
+		pmap->tkx_state[i] = pw;
+	pmap->tkx_dirty = pw;
+
+	parent->ji_ajtrk = ptbl;
+	parent->ji_ajmap = pmap;
+	return 0;
+}
+/**
+ * @brief
+ * 		set_subjob_entry - load the "offset" entry of the subjob index table
+ *		from a saved entry, as on recovery.  The state counts are left
+ *		alone and the entry is not marked as changed.  The index of the
+ *		first entry sets the index of the table.
+ *
+ * @param[in,out]	parent - pointer to parent job
+ * @param[in]	offset - offset of entry in table
+ * @param[in]	trk    - the saved entry
+ *
+ * @return	void
+ */
+void
+set_subjob_entry(job *parent, int offset, struct ajtrk *trk)
+{
+	struct ajtrkhd *ptbl = parent->ji_ajtrk;
+	int i;
+
+	if (offset == 0)
+		ptbl->tkm_first = trk->trk_index;
+	for (i = 0; i < PBS_NUMJOBSTATE; i++)
+		AJ_MAPCLR(parent->ji_ajmap->tkx_state[i], offset);
+	if ((trk->trk_status >= 0) && (trk->trk_status < PBS_NUMJOBSTATE))
+		AJ_MAPSET(parent->ji_ajmap->tkx_state[trk->trk_status], offset);
+
+	ptbl->tkm_tbl[offset].trk_error = trk->trk_error;
+	ptbl->tkm_tbl[offset].trk_substate = trk->trk_substate;
+	ptbl->tkm_tbl[offset].trk_stgout = trk->trk_stgout;
+	ptbl->tkm_tbl[offset].trk_exitstat = trk->trk_exitstat;
+}
+/**
+ * @brief
+ * 		get_subjob_entry - fill in a saved entry from the "offset" entry of
+ *		the subjob index table
+ *
+ * @param[in]	parent - pointer to parent job
+ * @param[in]	offset - offset of entry in table
+ * @param[out]	trk    - the entry to save
+ *
+ * @return	void
+ */
+void
+get_subjob_entry(job *parent, int offset, struct ajtrk *trk)
+{
+	struct ajtrkhd *ptbl = parent->ji_ajtrk;
+
+	trk->trk_index = AJ_INDEX(ptbl, offset);
+	trk->trk_status = get_subjob_state(parent, offset);
+	trk->trk_error = ptbl->tkm_tbl[offset].trk_error;
+	trk->trk_exitstat = ptbl->tkm_tbl[offset].trk_exitstat;
+	trk->trk_substate = ptbl->tkm_tbl[offset].trk_substate;
+	trk->trk_stgout = ptbl->tkm_tbl[offset].trk_stgout;
+}
+/**
+ * @brief
+ * 		mark_subjob_dirty - note that the "offset" entry of the subjob index
+ *		table has changed since the table was last saved
+ *
+ * @param[in,out]	parent - pointer to parent job
+ * @param[in]	offset - offset of entry in table
+ *
+ * @return	void
+ */
+static void
+mark_subjob_dirty(job *parent, int offset)
+{
+	struct ajtrkmap *pmap = parent->ji_ajmap;
+
+	if (AJ_MAPTST(pmap->tkx_dirty, offset))
+		return;
+	AJ_MAPSET(pmap->tkx_dirty, offset);
+	pmap->tkx_ndirty++;
+}
+/**
+ * @brief
+ * 		next_subjob_dirty - return the offset of the first entry of the subjob
+ *		index table at or after "offset" which changed since the table was
+ *		last saved
+ *
+ * @param[in]	parent - pointer to parent job
+ * @param[in]	offset - offset to start looking at
+ *
+ * @return	offset of entry
+ * @retval	-1	- no more changed entries
+ */
+int
+next_subjob_dirty(job *parent, int offset)
+{
+	struct ajtrkhd *ptbl = parent->ji_ajtrk;
+
+	if ((ptbl == NULL) || (offset >= ptbl->tkm_ct))
+		return -1;
+	if (parent->ji_ajmap->tkx_ndirty == 0)
+		return -1;
+	return (map_scan(parent->ji_ajmap->tkx_dirty, ptbl->tkm_ct, offset, 1));
+}
+/**
+ * @brief
+ * 		clear_subjob_dirty - mark every entry of the subjob index table as
+ *		saved
+ *
+ * @param[in,out]	parent - pointer to parent job
+ *
+ * @return	void
+ */
+void
+clear_subjob_dirty(job *parent)
+{
+	struct ajtrkmap *pmap = parent->ji_ajmap;
+
+	if ((pmap == NULL) || (pmap->tkx_ndirty == 0))
+		return;
+	memset(pmap->tkx_dirty, 0, pmap->tkx_words * sizeof(unsigned long));
+	pmap->tkx_ndirty = 0;
 }
 /**
  * @brief
@@ -344,14 +579,17 @@ set_subjob_tblstate(job *parent, int offset, int newstate)
 	if (ptbl == NULL)
 		return;
 
-	oldstate =  ptbl->tkm_tbl[offset].trk_status;
+	oldstate = get_subjob_state(parent, offset);
 	if (oldstate == newstate)
 		return;		/* nothing to do */
 
-	ptbl->tkm_tbl[offset].trk_status = newstate;
-
-	ptbl->tkm_subjsct[oldstate]--;
+	if (oldstate != -1) {
+		ptbl->tkm_subjsct[oldstate]--;
+		AJ_MAPCLR(parent->ji_ajmap->tkx_state[oldstate], offset);
+	}
 	ptbl->tkm_subjsct[newstate]++;
+	AJ_MAPSET(parent->ji_ajmap->tkx_state[newstate], offset);
+	mark_subjob_dirty(parent, offset);
 
 	/* set flags in attribute so stat_job will update the attr string */
 	parent->ji_wattr[(int)JOB_ATR_array_indices_remaining].at_flags |=
@@ -463,6 +701,7 @@ update_subjob_state(job *pjob, int newstate)
 			}
 		}
 		ptbl->tkm_tbl[pjob->ji_subjindx].trk_substate = pjob->ji_qs.ji_substate;
+		mark_subjob_dirty(parent, pjob->ji_subjindx);
 
 		parent->ji_modified = 1;
 	}
@@ -482,9 +721,15 @@ update_subjob_state(job *pjob, int newstate)
 int
 get_subjob_state(job *parent, int iindx)
 {
+	int i;
+
 	if (iindx == -1)
 		return -1;
-	return (parent->ji_ajtrk->tkm_tbl[iindx].trk_status);
+	for (i = 0; i < PBS_NUMJOBSTATE; i++) {
+		if (AJ_MAPTST(parent->ji_ajmap->tkx_state[i], iindx))
+			return i;
+	}
+	return -1;
 }
 /**
  * @brief
@@ -548,7 +793,7 @@ subst_array_index(job *pjob, char *path)
 	if ((pindorg = strstr(path, index_tag)) == NULL)
 		return path;	/* unchanged */
 
-	sprintf(cvt, "%d", pjob->ji_parentaj->ji_ajtrk->tkm_tbl[pjob->ji_subjindx].trk_index);
+	sprintf(cvt, "%d", AJ_INDEX(pjob->ji_parentaj->ji_ajtrk, pjob->ji_subjindx));
 	*pindorg = '\0';
 	(void)strcpy(trail, pindorg+strlen(index_tag));
 	(void)strcat(path, cvt);
@@ -560,47 +805,36 @@ subst_array_index(job *pjob, char *path)
  * 		mk_subjob_index_tbl - make the subjob index tracking table
  *		(struct ajtrkhd) based on the number of indexes in the "range"
  *
+ * @param[in,out]	parent - the Array Job
  * @param[in]	range - subjob index range
  * @param[in]	initialstate - job state
  *
- * @return	ptr to table
- * @retval  NULL	- error
+ * @return	int
+ * @retval	0	- success
+ * @retval  -1	- error
  */
-static struct ajtrkhd *mk_subjob_index_tbl(char *range, int initalstate)
+static int
+mk_subjob_index_tbl(job *parent, char *range, int initalstate)
 {
 	int   ct;
-	int   i, j;
+	int   i;
 	int   x, y, z;
 	char *eptr;
 	struct ajtrkhd *t;
-	size_t  sz;
 
 	i = parse_subjob_index(range, &eptr, &x, &y, &z, &ct);
 	if (i != 0)
-		return NULL; /* parse error */
-
-	sz = sizeof(struct ajtrkhd) + ((ct-1) * sizeof(struct ajtrk));
-	t = (struct ajtrkhd *)malloc(sz);
+		return -1; /* parse error */
 
-	if (t == NULL)
-		return NULL;
-	t->tkm_ct   = ct;
+	if (mk_subjob_tbl(parent, ct) != 0)
+		return -1;
+	t = parent->ji_ajtrk;
+	t->tkm_first = x;
 	t->tkm_step = z;
-	t->tkm_size = sz;
-	t->tkm_flags = 0;
-	for (i=0; i<PBS_NUMJOBSTATE; i++)
-		t->tkm_subjsct[i] = 0;
-	t->tkm_subjsct[1] = ct;
-	j = 0;
-	for (i=x; i<=y; i+=z, j++) {
-		t->tkm_tbl[j].trk_index = i;
-		t->tkm_tbl[j].trk_status = initalstate;
-		t->tkm_tbl[j].trk_error  = 0;
-		t->tkm_tbl[j].trk_substate  = JOB_SUBSTATE_FINISHED;
-		t->tkm_tbl[j].trk_stgout  = -1;
-		t->tkm_tbl[j].trk_exitstat  = 0;
-	}
-	return t;
+	t->tkm_subjsct[initalstate] = ct;
+	for (i = 0; i < ct; i++)
+		AJ_MAPSET(parent->ji_ajmap->tkx_state[initalstate], i);
+	return 0;
 }
 /**
  * @brief
@@ -651,7 +885,10 @@ setup_arrayjob_attrs(attribute *pattr, void *pobj, int mode)
 		if (parse_subjob_index(pattr->at_val.at_str, &ep, &x, &y, &z, &ct) != 0)
 			return PBSE_BADATVAL;
 
-		pjob->ji_ajtrk->tkm_ct = ct;
+		/* the table was sized from the saved entries */
+		if ((pjob->ji_ajtrk == NULL) || (pjob->ji_ajtrk->tkm_ct != ct))
+			return PBSE_BADATVAL;
+		pjob->ji_ajtrk->tkm_first = x;
 		pjob->ji_ajtrk->tkm_step = z;
 		pjob->ji_ajtrk->tkm_flags = 0;
 
@@ -659,15 +896,18 @@ setup_arrayjob_attrs(attribute *pattr, void *pobj, int mode)
 		for (i=0; i < PBS_NUMJOBSTATE; ++i)
 			pjob->ji_ajtrk->tkm_subjsct[i] = 0;
 		for (i=0; i < pjob->ji_ajtrk->tkm_ct; ++i) {
-			if ((pjob->ji_ajtrk->tkm_tbl[i].trk_status == JOB_STATE_RUNNING)
-				|| (pjob->ji_ajtrk->tkm_tbl[i].trk_status == JOB_STATE_EXITING))
-				pjob->ji_ajtrk->tkm_tbl[i].trk_status =JOB_STATE_QUEUED;
-			pjob->ji_ajtrk->tkm_subjsct[pjob->ji_ajtrk->tkm_tbl[i].trk_status]++;
+			int st = get_subjob_state(pjob, i);
+
+			if (st == -1)
+				continue;
+			pjob->ji_ajtrk->tkm_subjsct[st]++;
+			if ((st == JOB_STATE_RUNNING) || (st == JOB_STATE_EXITING))
+				set_subjob_tblstate(pjob, i, JOB_STATE_QUEUED);
 		}
 
 		/* clear and reset array_indices_remaining to new value */
 		job_attr_def[(int)JOB_ATR_array_indices_remaining].at_free(&pjob->ji_wattr[(int)JOB_ATR_array_indices_remaining]);
-		job_attr_def[(int)JOB_ATR_array_indices_remaining].at_decode(&pjob->ji_wattr[(int)JOB_ATR_array_indices_remaining], NULL, NULL, cvt_range(pjob->ji_ajtrk, JOB_STATE_QUEUED));
+		job_attr_def[(int)JOB_ATR_array_indices_remaining].at_decode(&pjob->ji_wattr[(int)JOB_ATR_array_indices_remaining], NULL, NULL, cvt_range(pjob, JOB_STATE_QUEUED));
 
 		return (PBSE_NONE);
 	}
@@ -697,9 +937,7 @@ setup_arrayjob_attrs(attribute *pattr, void *pobj, int mode)
 	pjob->ji_qs.ji_svrflags |= JOB_SVFLG_ArrayJob;
 
 	if (mode == ATR_ACTION_NEW) {
-		if (pjob->ji_ajtrk)
-			free(pjob->ji_ajtrk);
-		if ((pjob->ji_ajtrk = mk_subjob_index_tbl(pjob->ji_wattr[(int)JOB_ATR_array_indices_submitted].at_val.at_str, JOB_STATE_QUEUED)) == NULL)
+		if (mk_subjob_index_tbl(pjob, pjob->ji_wattr[(int)JOB_ATR_array_indices_submitted].at_val.at_str, JOB_STATE_QUEUED) != 0)
 			return PBSE_BADATVAL;
 	}
 
@@ -790,7 +1028,7 @@ create_subjob(job *parent, char *newjid, int *rc)
 		*rc = PBSE_UNKJOBID;
 		return NULL;
 	}
-	if (parent->ji_ajtrk->tkm_tbl[indx].trk_status != JOB_STATE_QUEUED) {
+	if (get_subjob_state(parent, indx) != JOB_STATE_QUEUED) {
 		*rc = PBSE_BADSTATE;
 		return NULL;
 	}
@@ -974,7 +1212,7 @@ mk_subjob_id(job *parent, int offset)
 	char        index[20];
 	char       *pb;
 
-	sprintf(index, "%d", parent->ji_ajtrk->tkm_tbl[offset].trk_index);
+	sprintf(index, "%d", AJ_INDEX(parent->ji_ajtrk, offset));
 	(void)strcpy(jid, parent->ji_qs.ji_jobid);
 
 	pb = strchr(jid, (int)']');
@@ -991,23 +1229,26 @@ mk_subjob_id(job *parent, int offset)
  * 		cvt-range - convert entries in subjob index table which are in "state"
  * 		to a range of indices of subjobs.  range will be of form:
  * 		X,X-Y:Z,...
- * @param[in]	t - pointer to subjob index table
+ *		Each run of entries in the state is found with the state bitmap of
+ *		the Array Job, so the cost follows the number of runs rather than
+ *		the size of the table.
+ * @param[in]	parent - pointer to parent Job
  * @param[in]	state -  job state.
  * @return	Pointer to static buffer
  * @par	MT-safe: No - uses a global buffer, "buf" and "buflen".
  */
 char *
-cvt_range(struct ajtrkhd *t, int state)
+cvt_range(job *parent, int state)
 {
-	unsigned int f;	/* first of a pair or range   */
-	unsigned int n;  /* next one we are looking at */
-	unsigned int l;
-	int pcomma = 0;
+	struct ajtrkhd *t;
+	int f;		/* first entry of a run in "state" */
+	int l;		/* last entry of the run           */
+	size_t len = 0;
 	char *b2;
 	static char *buf = NULL;
 	static size_t   buflen = 0;
 
-	if (t == NULL)
+	if ((parent == NULL) || ((t = parent->ji_ajtrk) == NULL))
 		return NULL;
 
 	if (buf == NULL) {
@@ -1016,51 +1257,38 @@ cvt_range(struct ajtrkhd *t, int state)
 			return NULL;
 	}
 	*buf = '\0';	/* initialize buf to empty */
-	f = 0;
-	while (f < t->tkm_ct) {
 
-		if ((buflen - strlen(buf)) < 20) {
+	f = find_subjob_offset(parent, 0, state, 1);
+	while (f != -1) {
+
+		if ((buflen - len) < 40) {
 			/* expand buf */
-			buflen += 500;
-			b2 = realloc(buf, buflen);
+			b2 = realloc(buf, buflen + 500);
 			if (b2 == NULL)
 				return NULL;
 			buf = b2;
+			buflen += 500;
 		}
 
-		/* find first incompleted entry */
-		if (t->tkm_tbl[f].trk_status == state) {
-			l = f;
-			n = f+1;
-			/* add "f" or ",f" */
-			if (pcomma)
-				sprintf(buf+strlen(buf), ",");
-			else
-				pcomma = 1;
-
-			sprintf(buf+strlen(buf), "%d", t->tkm_tbl[f].trk_index);
+		/* the run ends before the next entry not in "state" */
+		l = find_subjob_offset(parent, f, state, 0);
+		if (l == -1)
+			l = t->tkm_ct;
+		l--;
 
-			/* find next incomplete entry */
+		/* add "f" or ",f" */
+		len += sprintf(buf + len, "%s%d", (len > 0) ? "," : "",
+			AJ_INDEX(t, f));
 
-			while (n < t->tkm_ct) {
-				if (t->tkm_tbl[n].trk_status == state) {
-					l = n++;
-				} else {
-					break;
-				}
-			}
-			if (l > (f+1)) {
-				if (t->tkm_step > 1)
-					sprintf(buf+strlen(buf), "-%d:%d", t->tkm_tbl[l].trk_index, t->tkm_step);
-				else
-					sprintf(buf+strlen(buf), "-%d", t->tkm_tbl[l].trk_index);
-			} else if (l > f) {
-				sprintf(buf+strlen(buf), ",%d", t->tkm_tbl[l].trk_index);
-			}
-			f = l+1;
-		} else {
-			f++;
+		if (l > (f+1)) {
+			if (t->tkm_step > 1)
+				len += sprintf(buf + len, "-%d:%d", AJ_INDEX(t, l), t->tkm_step);
+			else
+				len += sprintf(buf + len, "-%d", AJ_INDEX(t, l));
+		} else if (l > f) {
+			len += sprintf(buf + len, ",%d", AJ_INDEX(t, l));
 		}
+		f = find_subjob_offset(parent, l + 1, state, 1);
 	}
 
 	return buf;
@@ -45,6 +45,7 @@
  *
  * Included public functions are:
  *	save_attr_db		Save attributes to the database
+ *	recov_attr_db_cursor	Read attributes from an open attribute cursor
  *	recov_attr_db		Read attributes from the database
  *	delete_attr_db		Delete a single attribute from the database
  *	make_attr			create a svrattrl structure from the attr_name, and values
@@ -262,9 +263,18 @@ err:
 
 /**
  * @brief
- *	Recover the list of attributes from the database
+ *	Recover attributes from an open attribute cursor
+ *
+ * @par Functionality:
+ *	Without id, every remaining row of the cursor is taken.  With id,
+ *	the cursor spans several parents ordered by parent, and only the
+ *	rows of parent id are taken; the first row of the next parent is
+ *	left in p_attr_info and flagged in *pending for the next call.
  *
  * @param[in]	conn - Database connection handle
+ * @param[in]	state - Open attribute cursor
+ * @param[in]	id - Id of the parent whose rows to take, or NULL for all
+ * @param[in,out] pending - p_attr_info holds a row not yet taken (with id)
  * @param[in]	parent - Address of parent object
  * @param[in]	p_attr_info - Information about the database parent
  * @param[in]	padef - Address of parent's attribute definition array
@@ -277,7 +287,10 @@ err:
  * @retval	-1  - Failure
  */
 int
-recov_attr_db(pbs_db_conn_t *conn,
+recov_attr_db_cursor(pbs_db_conn_t *conn,
+	void *state,
+	char *id,
+	int *pending,
 	void *parent,
 	pbs_db_attr_info_t *p_attr_info,
 	struct attribute_def *padef,
@@ -285,13 +298,11 @@ recov_attr_db(pbs_db_conn_t *conn,
 	int limit,
 	int unknown)
 {
-//	static	  char	id[] = "recov_attr";
 	int	  amt;
 	int	  index;
 	svrattrl *pal = (svrattrl *)0;
 	svrattrl *tmp_pal = (svrattrl *)0;
 	int	  ret;
-	void	 *state = NULL;
 	pbs_db_obj_info_t obj;
 	void **palarray = NULL;
 
@@ -309,16 +320,21 @@ recov_attr_db(pbs_db_conn_t *conn,
 	/* For each attribute, read in the attr_extern header */
 	obj.pbs_db_obj_type = PBS_DB_ATTR;
 	obj.pbs_db_un.pbs_db_attr = p_attr_info;
-	state = pbs_db_cursor_init(conn, &obj, NULL);
-	if (!state) {
-		free(palarray);
-		return -1;
-	}
 
 	while (1) {
-		ret = pbs_db_cursor_next(conn, state, &obj);
-		if (ret != 0)
-			break;		/* end of attributes in DB or error */
+		if (id == NULL || *pending == 0) {
+			ret = pbs_db_cursor_next(conn, state, &obj);
+			if (ret != 0)
+				break;	/* end of attributes in DB or error */
+		}
+		if (id != NULL) {
+			if (strcmp(p_attr_info->parent_id, id) != 0) {
+				*pending = 1;	/* row of a later parent */
+				ret = 0;
+				break;
+			}
+			*pending = 0;
+		}
 
 		/* Below ensures that a server or queue resource is not set */
 		/* if that resource is not known to the current server. */
@@ -398,7 +414,6 @@ recov_attr_db(pbs_db_conn_t *conn,
 			tmp_pal->al_sister = pal;
 		}
 	}
-	pbs_db_cursor_close(conn, state);
 
 	if (ret == -1) {
 		/*
@@ -474,6 +489,47 @@ recov_attr_db(pbs_db_conn_t *conn,
 	return (0);
 }
 
+/**
+ * @brief
+ *	Recover the list of attributes from the database
+ *
+ * @param[in]	conn - Database connection handle
+ * @param[in]	parent - Address of parent object
+ * @param[in]	p_attr_info - Information about the database parent
+ * @param[in]	padef - Address of parent's attribute definition array
+ * @param[in]	pattr - Address of the parent objects attribute array
+ * @param[in]	limit - Number of attributes in the list
+ * @param[in]	unknown	- The index of the unknown attribute if any
+ *
+ * @return      Error code
+ * @retval	 0  - Success
+ * @retval	-1  - Failure
+ */
+int
+recov_attr_db(pbs_db_conn_t *conn,
+	void *parent,
+	pbs_db_attr_info_t *p_attr_info,
+	struct attribute_def *padef,
+	struct attribute *pattr,
+	int limit,
+	int unknown)
+{
+	void	 *state;
+	pbs_db_obj_info_t obj;
+	int	  rc;
+
+	obj.pbs_db_obj_type = PBS_DB_ATTR;
+	obj.pbs_db_un.pbs_db_attr = p_attr_info;
+	state = pbs_db_cursor_init(conn, &obj, NULL);
+	if (!state)
+		return -1;
+
+	rc = recov_attr_db_cursor(conn, state, NULL, NULL, parent, p_attr_info,
+		padef, pattr, limit, unknown);
+	pbs_db_cursor_close(conn, state);
+	return rc;
+}
+
 /**
  * @brief
  *	Recover the list of attributes from the database without triggering
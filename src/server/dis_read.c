@@ -662,6 +662,14 @@ dis_request_read(int sfds, struct batch_request *request)
 			rc = decode_DIS_TrackJob(sfds, request);
 			break;
 
+		case PBS_BATCH_StatusEvents:
+			request->rq_ind.rq_statevents.rq_seq = disrull(sfds, &rc);
+			if (rc) break;
+			request->rq_ind.rq_statevents.rq_epoch = disrull(sfds, &rc);
+			if (rc) break;
+			request->rq_ind.rq_statevents.rq_wait = disrsi(sfds, &rc);
+			break;
+
 		case PBS_BATCH_Rescq:
 		case PBS_BATCH_ReserveResc:
 		case PBS_BATCH_ReleaseResc:
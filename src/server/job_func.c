@@ -332,6 +332,7 @@ job_alloc(void)
 
 #ifdef	PBS_MOM
 	CLEAR_HEAD(pj->ji_tasks);
+	CLEAR_HEAD(pj->ji_usedsent);
 	pj->ji_taskid = TM_INIT_TASK;
 	pj->ji_numnodes = 0;
 	pj->ji_numvnod  = 0;
@@ -340,6 +341,8 @@ job_alloc(void)
 	pj->ji_vnods = NULL;
 	pj->ji_vnods0 = NULL;
 	pj->ji_resources = NULL;
+	pj->ji_treeres = NULL;
+	pj->ji_numtree = 0;
 	pj->ji_obit = TM_NULL_EVENT;
 	pj->ji_postevent = TM_NULL_EVENT;
 	pj->ji_preq = NULL;
@@ -359,6 +362,12 @@ job_alloc(void)
 	pj->ji_prunreq = NULL;
 	CLEAR_HEAD(pj->ji_svrtask);
 	CLEAR_HEAD(pj->ji_rejectdest);
+	CLEAR_LINK(pj->ji_histjobs);
+	CLEAR_LINK(pj->ji_svrstate);
+	CLEAR_LINK(pj->ji_questate);
+	CLEAR_LINK(pj->ji_ownerjobs);
+	CLEAR_LINK(pj->ji_arrayjobs);
+	pj->ji_ownerix = NULL;
 	pj->ji_terminated = 0;
 	pj->ji_deletehistory = 0;
 	pj->ji_newjob = 0;
@@ -519,12 +528,17 @@ job_free(job *pj)
 			free(bp);
 			bp = (badplace *)GET_NEXT(pj->ji_rejectdest);
 		}
+		delete_link(&pj->ji_histjobs);
 	}
 	/* if Arryjob, free the tracking table structure */
 	if (pj->ji_ajtrk) {
 		free(pj->ji_ajtrk);
 		pj->ji_ajtrk = NULL;
 	}
+	if (pj->ji_ajmap) {
+		free(pj->ji_ajmap);
+		pj->ji_ajmap = NULL;
+	}
 	pj->ji_parentaj = NULL;
 	if (pj->ji_discard)
 		free(pj->ji_discard);
@@ -545,6 +559,9 @@ job_free(job *pj)
 	tasks_free(pj);
 	if (pj->ji_resources)
 		free(pj->ji_resources);
+	if (pj->ji_treeres)
+		free(pj->ji_treeres);
+	free_attrlist(&pj->ji_usedsent);
 	/*
 	 ** This gets rid of any dependent job structure(s) from ji_setup.
 	 */
@@ -628,6 +645,10 @@ job_purge(job *pjob)
 		pjob->ji_rerun_preq = NULL;
 	}
 #ifdef	PBS_MOM
+#ifdef	linux
+	if (pjob->ji_memwatch != 0)
+		memory_unwatch(pjob);
+#endif
 	delete_link(&pjob->ji_jobque);
 	delete_link(&pjob->ji_alljobs);
 	delete_link(&pjob->ji_unlicjobs);
@@ -681,6 +702,8 @@ job_purge(job *pjob)
 				(attribute *)0, DECR);
 			svr_dequejob(pjob);
 		}
+		journal_job_purge(pjob->ji_qs.ji_jobid, pjob->ji_qs.ji_state,
+			pjob->ji_qs.ji_substate);
 	}
 #endif	/* PBS_MOM */
 
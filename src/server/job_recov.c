@@ -64,6 +64,7 @@
 #include "pbs_ifl.h"
 #include <errno.h>
 #include <fcntl.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
@@ -104,6 +105,101 @@ extern char   pbs_recov_filename[];
 static const size_t fixedsize = sizeof(struct jobfix);
 static const size_t extndsize = sizeof(union jobextend);
 
+#ifndef PBS_MOM
+/**
+ * @brief
+ *		save_subjob_tbl_fs - write the subjob index table of an Array Job
+ *		in the layout of struct ajtrkhd_fs, which is what the job file
+ *		has always held
+ *
+ * @param[in]	pjob - the Array Job
+ *
+ * @return	int
+ * @retval	0	- success
+ * @retval	-1	- write failed
+ */
+static int
+save_subjob_tbl_fs(job *pjob)
+{
+	struct ajtrkhd	 *ptbl = pjob->ji_ajtrk;
+	struct ajtrkhd_fs fhd;
+	struct ajtrk	  trk;
+	size_t		  hdsz = offsetof(struct ajtrkhd_fs, tkm_tbl);
+	size_t		  pad;
+	int		  i;
+
+	memset(&fhd, 0, sizeof(fhd));
+	fhd.tkm_size = sizeof(struct ajtrkhd_fs) +
+		((ptbl->tkm_ct - 1) * sizeof(struct ajtrk));
+	fhd.tkm_ct = ptbl->tkm_ct;
+	fhd.tkm_step = ptbl->tkm_step;
+	fhd.tkm_flags = ptbl->tkm_flags;
+	memcpy(fhd.tkm_subjsct, ptbl->tkm_subjsct, sizeof(fhd.tkm_subjsct));
+	if (save_struct((char *)&fhd, hdsz) != 0)
+		return -1;
+
+	for (i = 0; i < ptbl->tkm_ct; i++) {
+		get_subjob_entry(pjob, i, &trk);
+		if (save_struct((char *)&trk, sizeof(trk)) != 0)
+			return -1;
+	}
+
+	/* tail padding of the structure, from the zeroed copy */
+	pad = fhd.tkm_size - hdsz - (ptbl->tkm_ct * sizeof(struct ajtrk));
+	if ((pad > 0) && (save_struct((char *)fhd.tkm_tbl, pad) != 0))
+		return -1;
+	return 0;
+}
+
+/**
+ * @brief
+ *		recov_subjob_tbl_fs - read the subjob index table of an Array Job
+ *		written by save_subjob_tbl_fs() and build the in-memory table
+ *
+ * @param[in]	fds - job file, positioned at the table
+ * @param[in,out]	pj - the Array Job
+ *
+ * @return	int
+ * @retval	0	- success
+ * @retval	-1	- read failed or out of memory
+ */
+static int
+recov_subjob_tbl_fs(int fds, job *pj)
+{
+	struct ajtrkhd_fs *ftbl;
+	size_t		   xs;
+	int		   ct;
+	int		   i;
+
+	if (read(fds, (char *)&xs, sizeof(xs)) != sizeof(xs))
+		return -1;
+	if (xs < sizeof(struct ajtrkhd_fs))
+		return -1;
+	if ((ftbl = (struct ajtrkhd_fs *)malloc(xs)) == NULL)
+		return -1;
+	if (read(fds, (char *)ftbl + sizeof(xs), xs - sizeof(xs)) !=
+		(int)(xs - sizeof(xs))) {
+		free(ftbl);
+		return -1;
+	}
+
+	ct = ((xs - sizeof(struct ajtrkhd_fs)) / sizeof(struct ajtrk)) + 1;
+	if (mk_subjob_tbl(pj, ct) != 0) {
+		free(ftbl);
+		return -1;
+	}
+	pj->ji_ajtrk->tkm_step = ftbl->tkm_step;
+	pj->ji_ajtrk->tkm_flags = ftbl->tkm_flags;
+	memcpy(pj->ji_ajtrk->tkm_subjsct, ftbl->tkm_subjsct,
+		sizeof(pj->ji_ajtrk->tkm_subjsct));
+	for (i = 0; i < ct; i++)
+		set_subjob_entry(pj, i, &ftbl->tkm_tbl[i]);
+
+	free(ftbl);
+	return 0;
+}
+#endif	/* not PBS_MOM */
+
 
 /**
  * @brief
@@ -295,9 +391,7 @@ job_save_fs(job *pjob, int updatetype)
 				extndsize) != 0) {
 				redo++;
 #ifndef PBS_MOM
-			} else if (isarray &&
-				(save_struct((char *)pjob->ji_ajtrk,
-				pjob->ji_ajtrk->tkm_size) != 0)) {
+			} else if (isarray && (save_subjob_tbl_fs(pjob) != 0)) {
 				redo++;
 #endif
 			} else if (save_attr_fs(job_attr_def, pjob->ji_wattr,
@@ -574,9 +668,7 @@ job_recov_fs(char *filename, int recov_subjob)
 	}
 #ifndef PBS_MOM
 	if (pj->ji_qs.ji_svrflags & JOB_SVFLG_ArrayJob) {
-		size_t xs;
-
-		if (read(fds, (char *)&xs, sizeof(xs)) != sizeof(xs)) {
+		if (recov_subjob_tbl_fs(fds, pj) != 0) {
 			sprintf(log_buffer,
 				"error reading array section of %s",
 				pbs_recov_filename);
@@ -585,13 +677,6 @@ job_recov_fs(char *filename, int recov_subjob)
 			(void)close(fds);
 			return ((job *)0);
 		}
-		if ((pj->ji_ajtrk = (struct ajtrkhd *)malloc(xs)) == NULL) {
-			free((char *)pj);
-			(void)close(fds);
-			return ((job *)0);
-		}
-		read(fds, (char *)pj->ji_ajtrk + sizeof(xs), xs - sizeof(xs));
-		pj->ji_ajtrk->tkm_size = xs;
 	}
 #endif	/* not PBS_MOM */
 
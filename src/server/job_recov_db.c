@@ -49,6 +49,8 @@
  *	job_save_db()         -	save job to database
  *	job_or_resv_save_db() -	save to database (job/reservation)
  *	job_recov_db()        - recover(read) job from database
+ *	job_recov_db_batch()  - recover job from the current recovery batch
+ *	job_recov_db_batch_end() - close the current recovery batch
  *	job_or_resv_recov_db() -	recover(read) job/reservation from database
  *	svr_to_db_job		  -	Load a server job object to a database job object
  *	db_to_svr_job		  - Load data from database job object to a server job object
@@ -125,6 +127,25 @@ extern int recov_attr_db(pbs_db_conn_t *conn,
 /* global data items */
 extern time_t time_now;
 
+#ifndef PBS_MOM
+/*
+ * Attribute and subjob cursors of the current job recovery batch, each
+ * spanning the JOB_RECOV_BATCH jobs from the first job of the batch on,
+ * ordered as the job cursor walked by pbsd_init().  A row read but
+ * belonging to a later job is kept pending for that job.
+ */
+#define JOB_RECOV_BATCH	1000
+static struct {
+	void			*rb_attr_state;
+	void			*rb_sj_state;
+	pbs_db_attr_info_t	 rb_attr;
+	pbs_db_subjob_info_t	 rb_sj;
+	int			 rb_attr_pending;
+	int			 rb_sj_pending;
+	int			 rb_left;	/* jobs left in the batch */
+} recov_batch;
+#endif
+
 #ifndef PBS_MOM
 
 /**
@@ -378,6 +399,7 @@ job_save_db(job *pjob, int updatetype)
 	pbs_db_attr_info_t attr_info;
 	pbs_db_job_info_t dbjob;
 	pbs_db_subjob_info_t dbsubjob;
+	struct ajtrk trk;
 	int	isarray = 0;
 	pbs_db_obj_info_t obj;
 	pbs_db_conn_t *conn = svr_db_conn;
@@ -432,20 +454,10 @@ job_save_db(job *pjob, int updatetype)
 		 * (5) the dependency list.
 		 */
 		/*
-		 * For an Array Job, we only update it to disk periodically,
-		 * otherwise we would be spending way too much time writting.
+		 * For an Array Job only the subjob entries changed since the
+		 * last save are written, so it is saved like any other job.
 		 */
 		isarray = (pjob->ji_qs.ji_svrflags & JOB_SVFLG_ArrayJob);
-		if (isarray) {
-			if ((pjob->ji_modifyct > 0) &&
-				(updatetype != SAVEJOB_FULLFORCE)) {
-				pjob->ji_modifyct--;
-				return (0);
-			} else {
-				/* reset count and do write this time */
-				pjob->ji_modifyct = 600;
-			}
-		}
 		if (pbs_db_begin_trx(conn, 0, 0) !=0)
 			goto db_err;
 
@@ -462,8 +474,8 @@ job_save_db(job *pjob, int updatetype)
 				obj.pbs_db_obj_type = PBS_DB_SUBJOB;
 				obj.pbs_db_un.pbs_db_subjob = &dbsubjob;
 				for (i = 0; i < pjob->ji_ajtrk->tkm_ct; i++) {
-					svr_to_db_subjob(pjob->ji_qs.ji_jobid,
-						&pjob->ji_ajtrk->tkm_tbl[i],
+					get_subjob_entry(pjob, i, &trk);
+					svr_to_db_subjob(pjob->ji_qs.ji_jobid, &trk,
 						&dbsubjob);
 					if (pbs_db_insert_obj(conn, &obj) != 0)
 						goto db_err;
@@ -484,9 +496,11 @@ job_save_db(job *pjob, int updatetype)
 			if (isarray) {
 				obj.pbs_db_obj_type = PBS_DB_SUBJOB;
 				obj.pbs_db_un.pbs_db_subjob = &dbsubjob;
-				for (i = 0; i < pjob->ji_ajtrk->tkm_ct; i++) {
-					svr_to_db_subjob(pjob->ji_qs.ji_jobid,
-						&pjob->ji_ajtrk->tkm_tbl[i],
+				/* only the entries changed since the last save */
+				for (i = next_subjob_dirty(pjob, 0); i != -1;
+					i = next_subjob_dirty(pjob, i + 1)) {
+					get_subjob_entry(pjob, i, &trk);
+					svr_to_db_subjob(pjob->ji_qs.ji_jobid, &trk,
 						&dbsubjob);
 					if (pbs_db_update_obj(conn, &obj) != 0)
 						goto db_err;
@@ -501,6 +515,8 @@ job_save_db(job *pjob, int updatetype)
 		if (pbs_db_end_trx(conn, PBS_DB_COMMIT) != 0)
 			goto db_err;
 
+		if (isarray)
+			clear_subjob_dirty(pjob);
 		pjob->ji_modified = 0;
 	}
 	return (0);
@@ -632,7 +648,8 @@ job_recov_db(char *jid, int recov_subjob)
 	pbs_db_conn_t *conn = svr_db_conn;
 	pbs_db_subjob_info_t dbsubjob;
 	void *state;
-	int count, xs, i;
+	struct ajtrk trk;
+	int count, i;
 
 	pj = job_alloc();	/* allocate & initialize job structure space */
 	if (pj == (job *)0) {
@@ -672,17 +689,16 @@ job_recov_db(char *jid, int recov_subjob)
 			goto db_err;
 		count = pbs_db_get_rowcount(state);
 		if (count > 0) {
-			xs = ((count - 1) * sizeof(struct ajtrk)) +
-				sizeof(struct ajtrkhd);
-			if ((pj->ji_ajtrk =
-				(struct ajtrkhd *)malloc(xs)) == NULL)
+			if (mk_subjob_tbl(pj, count) != 0) {
+				pbs_db_cursor_close(conn, state);
 				goto db_err;
-			pj->ji_ajtrk->tkm_size = xs;
+			}
 
 			i=0;
-			while (pbs_db_cursor_next(conn, state, &obj) == 0) {
-				db_to_svr_subjob(&pj->ji_ajtrk->tkm_tbl[i],
-					&dbsubjob);
+			while ((i < count) &&
+				(pbs_db_cursor_next(conn, state, &obj) == 0)) {
+				db_to_svr_subjob(&trk, &dbsubjob);
+				set_subjob_entry(pj, i, &trk);
 				i++;
 			}
 			pbs_db_cursor_close(conn, state);
@@ -712,6 +728,199 @@ db_err:
 	return (NULL);
 }
 
+/**
+ * @brief
+ *		Close the cursors of the current job recovery batch
+ *
+ * @return	void
+ */
+void
+job_recov_db_batch_end(void)
+{
+	if (recov_batch.rb_attr_state)
+		pbs_db_cursor_close(svr_db_conn, recov_batch.rb_attr_state);
+	if (recov_batch.rb_sj_state)
+		pbs_db_cursor_close(svr_db_conn, recov_batch.rb_sj_state);
+	memset(&recov_batch, 0, sizeof(recov_batch));
+}
+
+/**
+ * @brief
+ *		Get the next subjob row of a job from the recovery batch
+ *
+ * @param[in]	jid - Job id of the array job
+ *
+ * @return	int
+ * @retval	1 - recov_batch.rb_sj holds a subjob row of jid
+ * @retval	0 - no more subjob rows for jid
+ */
+static int
+job_recov_batch_subjob(char *jid)
+{
+	pbs_db_obj_info_t obj;
+
+	if (recov_batch.rb_sj_pending == 0) {
+		obj.pbs_db_obj_type = PBS_DB_SUBJOB;
+		obj.pbs_db_un.pbs_db_subjob = &recov_batch.rb_sj;
+		if (pbs_db_cursor_next(svr_db_conn, recov_batch.rb_sj_state, &obj) != 0)
+			return 0;
+	}
+	if (strcmp(recov_batch.rb_sj.ji_jobid, jid) != 0) {
+		recov_batch.rb_sj_pending = 1;
+		return 0;
+	}
+	recov_batch.rb_sj_pending = 0;
+	return 1;
+}
+
+/**
+ * @brief
+ *		Skip the attribute and subjob rows of a job in the recovery batch
+ *
+ * @param[in]	jid - Job id of the job not recovered
+ *
+ * @return	void
+ */
+static void
+job_recov_batch_skip(char *jid)
+{
+	pbs_db_obj_info_t obj;
+
+	obj.pbs_db_obj_type = PBS_DB_ATTR;
+	obj.pbs_db_un.pbs_db_attr = &recov_batch.rb_attr;
+	while (recov_batch.rb_attr_pending ||
+		pbs_db_cursor_next(svr_db_conn, recov_batch.rb_attr_state, &obj) == 0) {
+		if (strcmp(recov_batch.rb_attr.parent_id, jid) != 0) {
+			recov_batch.rb_attr_pending = 1;
+			break;
+		}
+		recov_batch.rb_attr_pending = 0;
+	}
+	while (job_recov_batch_subjob(jid))
+		;
+}
+
+/**
+ * @brief
+ *		Recover a job from the current recovery batch
+ *
+ * @par Functionality:
+ *		Used by pbsd_init() while it walks all jobs in (ji_qrank, ji_jobid)
+ *		order.  Instead of querying each job's row, attributes and subjobs,
+ *		the job is built from the row already read by the job cursor and
+ *		its attributes and subjobs are taken from two set based queries
+ *		covering JOB_RECOV_BATCH jobs, issued when the previous batch is
+ *		used up.  After any failure the batch is dropped so the next job
+ *		starts a new one at its own row.
+ *
+ * @param[in]	dbjob - Job row read from the job cursor
+ *
+ * @return      The recovered job
+ * @retval	 NULL - Failure, or job is a subjob
+ * @retval	!NULL - Success, pointer to job structure recovered
+ *
+ */
+job *
+job_recov_db_batch(pbs_db_job_info_t *dbjob)
+{
+	job		*pj;
+	pbs_db_obj_info_t obj;
+	pbs_db_query_options_t opts;
+	char		*jid = dbjob->ji_jobid;
+	struct ajtrk	*trks = NULL;
+	struct ajtrk	*ptrk;
+	int		 ct, max;
+	int		 i;
+
+	if (recov_batch.rb_left <= 0) {
+		job_recov_db_batch_end();
+
+		memset(&opts, 0, sizeof(opts));
+		opts.flags = FIND_JOBS_BATCH;
+		opts.start_id = jid;
+		opts.start_qrank = dbjob->ji_qrank;
+		opts.limit = JOB_RECOV_BATCH;
+
+		recov_batch.rb_attr.parent_obj_type = PARENT_TYPE_JOB;
+		recov_batch.rb_attr.parent_id = jid;
+		obj.pbs_db_obj_type = PBS_DB_ATTR;
+		obj.pbs_db_un.pbs_db_attr = &recov_batch.rb_attr;
+		recov_batch.rb_attr_state = pbs_db_cursor_init(svr_db_conn, &obj, &opts);
+
+		obj.pbs_db_obj_type = PBS_DB_SUBJOB;
+		obj.pbs_db_un.pbs_db_subjob = &recov_batch.rb_sj;
+		recov_batch.rb_sj_state = pbs_db_cursor_init(svr_db_conn, &obj, &opts);
+
+		if (recov_batch.rb_attr_state == NULL || recov_batch.rb_sj_state == NULL) {
+			job_recov_db_batch_end();
+			goto db_err;
+		}
+		recov_batch.rb_left = JOB_RECOV_BATCH;
+	}
+	recov_batch.rb_left--;
+
+	if ((pj = job_alloc()) == NULL) {
+		job_recov_batch_skip(jid);
+		return NULL;
+	}
+	db_to_svr_job(pj, dbjob);
+
+	/* don't recover Array Sub jobs */
+	if (pj->ji_qs.ji_svrflags & JOB_SVFLG_SubJob) {
+		job_recov_batch_skip(jid);
+		job_free(pj);
+		sprintf(log_buffer, "Failed to recover job %s", jid);
+		log_err(-1, "job_recov", log_buffer);
+		return NULL;
+	}
+
+	/* recover subjobs if job is arrayjob */
+	if (pj->ji_qs.ji_svrflags & JOB_SVFLG_ArrayJob) {
+		/* the row count is not known up front, gather the rows first */
+		for (ct = 0, max = 0; job_recov_batch_subjob(jid); ct++) {
+			if (ct == max) {
+				max = (max == 0) ? 64 : max * 2;
+				if ((ptrk = realloc(trks, max * sizeof(struct ajtrk))) == NULL) {
+					free(trks);
+					goto batch_err;
+				}
+				trks = ptrk;
+			}
+			db_to_svr_subjob(&trks[ct], &recov_batch.rb_sj);
+		}
+		if (ct > 0) {
+			if (mk_subjob_tbl(pj, ct) != 0) {
+				free(trks);
+				goto batch_err;
+			}
+			for (i = 0; i < ct; i++)
+				set_subjob_entry(pj, i, &trks[i]);
+		}
+		free(trks);
+	}
+
+	/* read in working attributes */
+	if (recov_attr_db_cursor(svr_db_conn, recov_batch.rb_attr_state, jid,
+		&recov_batch.rb_attr_pending, pj, &recov_batch.rb_attr,
+		job_attr_def, pj->ji_wattr,
+		(int)JOB_ATR_LAST, (int)JOB_ATR_UNKN) != 0) {
+		sprintf(log_buffer, "error loading attributes for %s",
+			jid);
+		log_err(-1, "job_recov", log_buffer);
+		goto batch_err;
+	}
+
+	return (pj);
+
+batch_err:
+	job_recov_db_batch_end();
+	job_free(pj);
+db_err:
+	sprintf(log_buffer, "Failed to recover job %s", jid);
+	log_err(-1, "job_recov", log_buffer);
+	return (NULL);
+}
+
 /**
  * @brief
  *		Recover resv from database
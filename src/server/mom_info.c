@@ -372,10 +372,12 @@ create_svrmom_entry(char *hostname, unsigned int port, unsigned long *pul)
 	CLEAR_HEAD(psvrmom->msr_deferred_cmds);
 	psvrmom->msr_timedown = (time_t)0;
 	psvrmom->msr_timeinit = (time_t)0;
+	psvrmom->msr_timehello = (time_t)0;
 	psvrmom->msr_wktask  = 0;
 	psvrmom->msr_addrs   = pul;
 	psvrmom->msr_jbinxsz = 0;
 	psvrmom->msr_jobindx = NULL;
+	psvrmom->msr_vnl_seq = -1;
 	psvrmom->msr_numvnds = 0;
 	psvrmom->msr_numvslots = 1;
 	psvrmom->msr_children =
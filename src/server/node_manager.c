@@ -188,12 +188,21 @@ int		 svr_chngNodesfile = 0;	/* 1 signals want nodes file update */
 /* on server shutdown, (qmgr mods)  */
 struct pbsnode **pbsndlist = NULL;
 
+/*
+ * Hello admission control for ping_nodes(): number of further IS_HELLOs
+ * the current pass may send (-1 when not limited) and the number held
+ * back for a later pass.
+ */
+static int	 hello_budget = -1;
+static int	 hello_deferred = 0;
+
 static int	 cvt_overflow(size_t, size_t);
 static int	 cvt_realloc(char **, size_t *, char **, size_t *);
 
 extern time_t	 time_now;
 extern time_t	 jan1_yr2038;
 extern int	 server_init_type;
+extern int	 resc_access_perm;
 
 extern int	ctnodes(char *);
 extern char	*resc_in_err;
@@ -238,6 +247,9 @@ extern long node_fail_requeue;
 
 #define GLOB_SZ 511
 
+#define PING_HELLO_RETRY 2	/* secs between passes while hellos are deferred */
+#define PING_HELLO_WAIT	60	/* secs a hello counts as in flight without reply */
+
 /*
  * Tree search generalized from Knuth (6.2.2) Algorithm T just like
  * the AT&T man page says.
@@ -905,6 +917,7 @@ momptr_down(mominfo_t *pmom, char *why)
 	int		 is_provisioning = 0;
 
 	psvrmom->msr_state |= (INUSE_DOWN | INUSE_NEEDS_HELLO_PING);
+	psvrmom->msr_timehello = 0;	/* no answer to a hello is coming */
 
 	/* log message if node just down or been down for an hour */
 	/* mark mom down and vnodes down as well                  */
@@ -1115,6 +1128,18 @@ mom_ping_need(mominfo_t *pmom, int force_hello)
 		/* reset this flag since we are now all set to fire a UPDATE to the mom */
 		psvrmom->msr_state &= ~INUSE_NEEDS_UPDATE;
 	}
+
+	if ((com == IS_HELLO) && (hello_budget != -1)) {
+		if (hello_budget == 0) {
+			/* admission limit reached, greet her on a later pass */
+			psvrmom->msr_state |= INUSE_NEEDS_HELLO_PING;
+			hello_deferred++;
+			return -1;
+		}
+		hello_budget--;
+	}
+	if (com == IS_HELLO)
+		psvrmom->msr_timehello = time_now;
 	return com;
 }
 
@@ -1354,6 +1379,9 @@ set_vnode_state(struct pbsnode *pnode, int state_bits, enum vnode_state_op type)
 			ATR_VFLAG_MODCACHE;
 	}
 
+	if (pnode->nd_state != nd_prev_state)
+		journal_vnode_state(pnode->nd_name, nd_prev_state, pnode->nd_state);
+
 	if (pnode->nd_state & INUSE_PROV) {
 		if (!(pnode->nd_state & VNODE_UNAVAILABLE) ||
 			(pnode->nd_state == INUSE_PROV)) { /* INUSE_FREE is 0 */
@@ -2124,6 +2152,70 @@ decode_stat_update(int stream, struct resc_used_update *prused)
 }
 
 
+/**
+ * @brief
+ *		Apply a periodic update which holds only the session id and
+ *		resources_used of a job in place.
+ * @par Functionality:
+ *		This is by far the most common update, and modify_job_attr()
+ *		would make and set a copy of every job attribute for it.  The
+ *		values sent are decoded into scratch attributes first, so a bad
+ *		value leaves the job untouched, then merged into the job with the
+ *		attributes' own set functions.  Resources not sent keep their
+ *		value, and the attributes are flagged modified as by
+ *		modify_job_attr().  Neither attribute has an action function.
+ *
+ * @param[in,out] pjob - job to update
+ * @param[in] plist - list of attributes sent from Mom
+ *
+ * @return	int
+ * @retval	0	- applied
+ * @retval	1	- list holds something else, use modify_job_attr()
+ * @retval	>1	- PBS error decoding or setting a value
+ */
+static int
+stat_update_used(job *pjob, svrattrl *plist)
+{
+	svrattrl	*pal;
+	attribute	 used;
+	attribute	 sid;
+	int		 rc = 0;
+
+	for (pal = plist; pal; pal = (svrattrl *)GET_NEXT(pal->al_link)) {
+		if (strcmp(pal->al_name, ATTR_session) == 0)
+			continue;
+		if ((strcmp(pal->al_name, ATTR_used) != 0) ||
+			(pal->al_resc == NULL) ||
+			(find_resc_def(svr_resc_def, pal->al_resc, svr_resc_size) == NULL))
+			return 1;
+	}
+
+	clear_attr(&used, &job_attr_def[(int)JOB_ATR_resc_used]);
+	clear_attr(&sid, &job_attr_def[(int)JOB_ATR_session_id]);
+
+	resc_access_perm = ATR_DFLAG_MGWR | ATR_DFLAG_SvWR;
+	for (pal = plist; pal && (rc == 0);
+		pal = (svrattrl *)GET_NEXT(pal->al_link)) {
+		if (strcmp(pal->al_name, ATTR_session) == 0)
+			rc = job_attr_def[(int)JOB_ATR_session_id].at_decode(&sid,
+				pal->al_name, NULL, pal->al_value);
+		else
+			rc = job_attr_def[(int)JOB_ATR_resc_used].at_decode(&used,
+				pal->al_name, pal->al_resc, pal->al_value);
+	}
+
+	if ((rc == 0) && (used.at_flags & ATR_VFLAG_SET))
+		rc = job_attr_def[(int)JOB_ATR_resc_used].at_set(
+			&pjob->ji_wattr[(int)JOB_ATR_resc_used], &used, SET);
+	if ((rc == 0) && (sid.at_flags & ATR_VFLAG_SET))
+		rc = job_attr_def[(int)JOB_ATR_session_id].at_set(
+			&pjob->ji_wattr[(int)JOB_ATR_session_id], &sid, SET);
+
+	job_attr_def[(int)JOB_ATR_resc_used].at_free(&used);
+	job_attr_def[(int)JOB_ATR_session_id].at_free(&sid);
+	return (rc);
+}
+
 /**
  * @brief
  *		Update job resource usage based on information sent from Mom.
@@ -2185,7 +2277,15 @@ stat_update(int stream)
 
 			/* update all the attributes sent from Mom */
 			sattrl = (svrattrl *)GET_NEXT(rused.ru_attr);
-			if(sattrl != NULL) {
+			if ((sattrl != NULL) &&
+				((rc = stat_update_used(pjob, sattrl)) != 1)) {
+				if ((rc != 0) &&
+					((mp = tfind2((u_long)stream, 0, &streams)) != NULL)) {
+					sprintf(log_buffer, "unable to update resources_used, error %d in stat_update", rc);
+					log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_NODE,
+						LOG_NOTICE, mp->mi_host, log_buffer);
+				}
+			} else if (sattrl != NULL) {
 				if (modify_job_attr(pjob, sattrl,
 					ATR_DFLAG_MGWR | ATR_DFLAG_SvWR, &bad) != 0) {
 					if ((mp = tfind2((u_long)stream, 0, &streams)) != NULL) {
@@ -2631,6 +2731,8 @@ stream_eof(int stream, int ret, char *msg)
 
 		/* Down node and all subnodes */
 		((mom_svrinfo_t *)(mp->mi_data))->msr_stream = -1;
+		/* vnode deltas need a full list from the next HELLO */
+		((mom_svrinfo_t *)(mp->mi_data))->msr_vnl_seq = -1;
 
 		/* Since stream is now closed, reset the intermediate
 		 * state INUSE_INIT. This would allow ping_a_mom
@@ -2690,6 +2792,41 @@ mark_nodes_unknown(int all)
 	}
 }
 
+/**
+ * @brief
+ *		Set the number of IS_HELLOs the current ping_nodes() pass may
+ *		send, so a restart against a large cluster does not have every
+ *		Mom send her vnodes and running jobs in the same few seconds.
+ *		Moms which were sent a hello and have not answered it, and Moms
+ *		which answered but are still initializing, count against the
+ *		limit.  The caller sets hello_budget back to -1 after the pass.
+ *
+ * @return	void
+ */
+static void
+hello_budget_init(void)
+{
+	int		 i;
+	mom_svrinfo_t	*psvrmom;
+
+	if (pbs_conf.pbs_mom_hello_limit <= 0)
+		return;
+	hello_budget = pbs_conf.pbs_mom_hello_limit;
+	for (i = 0; (i < mominfo_array_size) && (hello_budget > 0); i++) {
+		if (mominfo_array[i] == NULL)
+			continue;
+		psvrmom = (mom_svrinfo_t *)(mominfo_array[i]->mi_data);
+		if (psvrmom->msr_state & INUSE_INIT)
+			hello_budget--;
+		else if (psvrmom->msr_timehello != 0) {
+			if (time_now < psvrmom->msr_timehello + PING_HELLO_WAIT)
+				hello_budget--;
+			else
+				psvrmom->msr_timehello = 0;	/* no answer, stop counting it */
+		}
+	}
+}
+
 /**
  * @brief
  * 		Send a ping to any node that is in an unknown stat.
@@ -2710,6 +2847,8 @@ ping_nodes(struct work_task *ptask)
 	DOID("ping_nodes")
 	DBPRT(("%s: entered\n", id))
 
+	hello_deferred = 0;
+
 	if (pbs_conf.pbs_use_tcp == 1) {
 		/*
 		 * If this is configured to talk TCP, then do the
@@ -2731,10 +2870,12 @@ ping_nodes(struct work_task *ptask)
 				return;
 			}
 
+			hello_budget_init();
 			for (i=0; i<mominfo_array_size; i++) {
 				if (mominfo_array[i])
 					ping_a_mom_mcast(mominfo_array[i], 0, mtfd_ishello, mtfd_isnull);
 			}
+			hello_budget = -1;
 
 			ping_flush_mcast(mtfd_ishello, IS_HELLO);
 			ping_flush_mcast(mtfd_isnull, IS_NULL);
@@ -2743,10 +2884,19 @@ ping_nodes(struct work_task *ptask)
 			tpp_mcast_close(mtfd_isnull);
 		}
 	} else {
+		hello_budget_init();
 		for (i = 0; i < mominfo_array_size; i++) {
 			if (mominfo_array[i])
 				ping_a_mom(mominfo_array[i], 0);
 		}
+		hello_budget = -1;
+	}
+
+	if (hello_deferred > 0) {
+		sprintf(log_buffer, "hello to %d Moms deferred, %u allowed at once",
+			hello_deferred, pbs_conf.pbs_mom_hello_limit);
+		log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_INFO,
+			msg_daemonname, log_buffer);
 	}
 
 	if (ptask != NULL) {
@@ -2755,6 +2905,8 @@ ping_nodes(struct work_task *ptask)
 			i = 15 < svr_ping_rate ? 15 : svr_ping_rate;
 		} else
 			i = svr_ping_rate; /* normal ping rate for normal run */
+		if ((hello_deferred > 0) && (i > PING_HELLO_RETRY))
+			i = PING_HELLO_RETRY; /* admit the next group of Moms soon */
 
 		global_ping_task = set_task(WORK_Timed, time_now + i, ping_nodes, NULL);
 	}
@@ -3091,6 +3243,10 @@ cross_link_mom_vnode(struct pbsnode *pnode, mominfo_t *pmom)
  * @param[in]  pmom  	- the Mom which sent this update
  * @param[out] madenew 	- set non-zero if any new vnodes were created
  * @param[out] from_hook- set non-zero if request coming from hook
+ * @param[in]  delta	- set non-zero if pvnal holds only the attributes
+ *			  changed since the last UPDATE2 (UPDATE2_DELTA)
+ * @param[out] hostrpt	- if not NULL, set non-zero if resources_available.host
+ *			  was reported
  *
  * @return int
  * @retval	zero	- ok
@@ -3099,7 +3255,7 @@ cross_link_mom_vnode(struct pbsnode *pnode, mominfo_t *pmom)
  * @par MT-safe: No
  */
 static int
-update2_to_vnode(vnal_t *pvnal, int new, mominfo_t *pmom, int *madenew, int from_hook)
+update2_to_vnode(vnal_t *pvnal, int new, mominfo_t *pmom, int *madenew, int from_hook, int delta, int *hostrpt)
 {
 	int bad;
 	int i;
@@ -3124,6 +3280,7 @@ update2_to_vnode(vnal_t *pvnal, int new, mominfo_t *pmom, int *madenew, int from
 	char	hook_buf[HOOK_BUF_SIZE+1];
 	int	vn_state_updates = 0;
 	int	vn_resc_added = 0;
+	int	host_reported = 0;
 
 	CLEAR_HEAD(atrlist);
 
@@ -3237,9 +3394,12 @@ update2_to_vnode(vnal_t *pvnal, int new, mominfo_t *pmom, int *madenew, int from
 	 * sharing - can only be set via this message, so set to the default
 	 *	value to insure it is reset based on what Mom now sends or to
 	 *	the default setting if Mom no longer sends anything
+	 *
+	 * An UPDATE2_DELTA only carries what changed since the last update,
+	 * everything it leaves out keeps its value.
 	 */
 
-	if (!from_hook) {
+	if (!from_hook && !delta) {
 		for (i=0; i < ND_ATR_LAST; ++i) {
 			/* if this vnode has been updated earlier in this update2 */
 			/* then don't free anything but topology */
@@ -3277,6 +3437,8 @@ update2_to_vnode(vnal_t *pvnal, int new, mominfo_t *pmom, int *madenew, int from
 
 	for (i=0; i < pvnal->vnal_used; i++) {
 		psrp = VNAL_NODENUM(pvnal, i);
+		if (strcasecmp(psrp->vna_name, "resources_available.host") == 0)
+			host_reported = 1;
 		strncpy(buf, psrp->vna_name, sizeof(buf)-1);
 		buf[sizeof(buf)-1] = '\0';
 
@@ -3586,7 +3748,15 @@ update2_to_vnode(vnal_t *pvnal, int new, mominfo_t *pmom, int *madenew, int from
 	if (pnode) {
 		int	states_to_clear = 0;
 
-		check_and_set_multivnode(pnode);
+		/* walks every vnode, only needed if "host" may have changed */
+		if (!delta || host_reported)
+			check_and_set_multivnode(pnode);
+		if (host_reported && (hostrpt != NULL))
+			*hostrpt = 1;
+
+		/* everything in a delta is a change, have it saved */
+		if (delta && (pvnal->vnal_used > 0))
+			pnode->nd_modified |= NODE_UPDATE_OTHERS;
 
 		if (from_hook) {
 			/* INUSE_DOWN not part here since it could */
@@ -3932,6 +4102,8 @@ is_request(int stream, int version)
 	int			ivnd;
 	char		       *jid = NULL;
 	int			made_new_vnodes;
+	int			delta_changed;
+	int			delta_host;
 	unsigned long		hook_seq;
 	char		       *hook_euser;
 	job		       *pjob;
@@ -4076,6 +4248,8 @@ found:
 			/* clear INUSE_NEEDS_HELL0 to prevent resending of HELLO */
 			/* and set initializing and the time		     */
 
+			psvrmom->msr_timehello = 0;
+
 			set_all_state(pmom, 0,
 				INUSE_UNKNOWN|INUSE_NEEDS_HELLO_PING, NULL,
 				Set_All_State_Regardless);
@@ -4164,12 +4338,17 @@ found:
 
 		case IS_UPDATE:
 		case IS_UPDATE2:
+		case IS_UPDATE2_DELTA:
 			cr_node = 0;
 			made_new_vnodes = 0;
+			delta_changed = 0;
+			delta_host = 0;
 			if (command == IS_UPDATE) {
 				DBPRT(("%s: IS_UPDATE %s\n", __func__, pmom->mi_host))
-			} else {
+			} else if (command == IS_UPDATE2) {
 				DBPRT(("%s: IS_UPDATE2 %s\n", __func__, pmom->mi_host))
+			} else {
+				DBPRT(("%s: IS_UPDATE2_DELTA %s\n", __func__, pmom->mi_host))
 			}
 
 			set_all_state(pmom, 0, INUSE_BUSY|INUSE_UNKNOWN, NULL,
@@ -4322,6 +4501,8 @@ found:
 				vnlp = vn_decode_DIS(stream, &ret);
 				if (ret != DIS_SUCCESS)
 					goto err;
+				if (vnlp != NULL)
+					psvrmom->msr_vnl_seq = 0; /* deltas build on this */
 				if (vnlp == NULL) {
 					sprintf(log_buffer, "vn_decode_DIS vn failed");
 					log_err(-1, __func__, log_buffer);
@@ -4355,7 +4536,7 @@ found:
 						vnal_t	*vnrlp;
 						vnrlp = VNL_NODENUM(vnlp, i);
 						/* create vnode */
-						(void)update2_to_vnode(vnrlp, cr_node, pmom, &made_new_vnodes, 0);
+						(void)update2_to_vnode(vnrlp, cr_node, pmom, &made_new_vnodes, 0, 0, NULL);
 						for (j = 0; j < vnrlp->vnal_used; j++) {
 							vna_t	*psrp;
 
@@ -4399,6 +4580,97 @@ found:
 				vnlp = NULL;
 			}
 
+			/*
+			 * UPDATE2_DELTA message - only the vnode attributes that
+			 * changed since the Mom's last UPDATE2 or UPDATE2_DELTA,
+			 * numbered so we can tell they apply to what we hold.
+			 */
+
+			if (command == IS_UPDATE2_DELTA) {
+				long		seq;
+				time_t		modtime;
+				unsigned int	nvnds;
+
+				seq = disrsl(stream, &ret);
+				if (ret != DIS_SUCCESS)
+					goto err;
+				modtime = (time_t)disrsl(stream, &ret);
+				if (ret != DIS_SUCCESS)
+					goto err;
+				nvnds = disrui(stream, &ret);
+				if (ret != DIS_SUCCESS)
+					goto err;
+				if (nvnds > 0) {
+					vnlp = vn_decode_DIS(stream, &ret);
+					if (ret != DIS_SUCCESS)
+						goto err;
+				}
+
+				if ((seq != psvrmom->msr_vnl_seq) ||
+					((nvnds > 0) && (vnlp == NULL))) {
+					/* not what we hold, get the whole list again */
+					snprintf(log_buffer, sizeof(log_buffer),
+						"vnode update %ld does not follow %ld, "
+						"requesting full update",
+						seq, psvrmom->msr_vnl_seq);
+					log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_NODE,
+						LOG_NOTICE, pmom->mi_host, log_buffer);
+					psvrmom->msr_vnl_seq = -1;
+					psvrmom->msr_state |= INUSE_NEEDS_HELLO_PING;
+				} else if (modtime < pmom->mi_modtime) {
+					/*
+					 * another Mom of the vnodes sent a newer list,
+					 * Mom will not resend what we drop, so get the
+					 * whole list again rather than follow on from it
+					 */
+					snprintf(log_buffer, sizeof(log_buffer),
+						"vnode update %ld is older than the vnodes, "
+						"requesting full update", seq);
+					log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_NODE,
+						LOG_NOTICE, pmom->mi_host, log_buffer);
+					psvrmom->msr_vnl_seq = -1;
+					psvrmom->msr_state |= INUSE_NEEDS_HELLO_PING;
+				} else {
+					psvrmom->msr_vnl_seq++;
+					if (modtime > pmom->mi_modtime)
+						cr_node = 1;
+					pmom->mi_modtime = modtime;
+
+					for (i = 0; (vnlp != NULL) && (i < vnlp->vnl_used); i++) {
+						(void)update2_to_vnode(VNL_NODENUM(vnlp, i),
+							cr_node, pmom, &made_new_vnodes, 0, 1,
+							&delta_host);
+						delta_changed = 1;
+					}
+
+					/*
+					 * vnodes left out are as the last update
+					 * left them, bring back up those it did
+					 */
+					if ((s & INUSE_DOWN) == 0) {
+						for (i = 0; i < psvrmom->msr_numvnds; ++i) {
+							np = psvrmom->msr_children[i];
+							if ((np->nd_state & INUSE_STALE) == 0)
+								set_vnode_state(np,
+									~(INUSE_DOWN | INUSE_UNKNOWN),
+									Nd_State_And);
+						}
+					}
+
+					/* as for UPDATE2, vnodes with several Moms */
+					if ((psvrmom->msr_numvnds > 1) &&
+						(psvrmom->msr_children[1]->nd_nummoms > 1)) {
+						np = psvrmom->msr_children[1];
+						for (i = 0; i < np->nd_nummoms; ++i)
+							np->nd_moms[i]->mi_modtime = modtime;
+					}
+					if (vnlp != NULL)
+						propagate_socket_licensing(pmom);
+				}
+				vnl_free(vnlp);
+				vnlp = NULL;
+			}
+
 			/*read mom's pbs_version data if appended*/
 
 			val = disrst(stream, &ret);
@@ -4551,8 +4823,15 @@ found:
 				}
 			}
 
-			if (made_new_vnodes || cr_node) {
+			/*
+			 * a delta saves only the vnodes it changed, and moves the
+			 * host-vnode map on only if it reported a host
+			 */
+			if (made_new_vnodes || delta_host ||
+				(cr_node && (command != IS_UPDATE2_DELTA))) {
 				save_nodes_db(1); /* update the node database */
+			} else if (delta_changed) {
+				save_nodes_db(0);
 			}
 			break;
 
@@ -4775,7 +5054,7 @@ found:
 				vnrlp = VNL_NODENUM(vnlp, i);
 				/* update vnode */
 				made_new_vnodes = 0;
-				if (update2_to_vnode(vnrlp, cr_node, pmom, &made_new_vnodes, 1) == PBSE_PERM) {
+				if (update2_to_vnode(vnrlp, cr_node, pmom, &made_new_vnodes, 1, 0, NULL) == PBSE_PERM) {
 					break; /* encountered a bad permission */
 				}
 			}
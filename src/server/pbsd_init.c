@@ -648,6 +648,15 @@ pbsd_init(int type)
 			return (-1);
 	}
 
+	/* index the definition tables before anything can look them up */
+	(void)build_resc_def_index(svr_resc_def, svr_resc_size);
+	(void)build_attr_index(svr_attr_def, SRV_ATR_LAST);
+	(void)build_attr_index(sched_attr_def, SCHED_ATR_LAST);
+	(void)build_attr_index(que_attr_def, QA_ATR_LAST);
+	(void)build_attr_index(job_attr_def, JOB_ATR_LAST);
+	(void)build_attr_index(node_attr_def, ND_ATR_LAST);
+	(void)build_attr_index(resv_attr_def, RESV_ATR_LAST);
+
 	/* 3. Set default server attibutes values */
 
 	if (server.sv_attr[(int)SRV_ATR_scheduling].at_flags & ATR_VFLAG_SET)
@@ -1009,7 +1018,7 @@ pbsd_init(int type)
 		/* Now, for each job found ... */
 		numjobs = 0;
 		while ((rc = pbs_db_cursor_next(conn, state, &obj)) == 0) {
-			if ((pjob = job_recov(dbjob.ji_jobid, NO_RECOV_SUBJOB)) == NULL) {
+			if ((pjob = job_recov_db_batch(&dbjob)) == NULL) {
 				if ((type == RECOV_COLD) || (type == RECOV_CREATE)) {
 					/* remove the loaded job from db */
 					if (pbs_db_delete_obj(conn, &obj) != 0) {
@@ -1055,6 +1064,8 @@ pbsd_init(int type)
 			}
 		}
 
+		job_recov_db_batch_end();
+
 		if ((had != server.sv_qs.sv_numjobs) &&
 			(type != RECOV_CREATE) &&
 			(type != RECOV_COLD))
@@ -1740,6 +1751,9 @@ pbsd_init_job(job *pjob, int type)
 			case JOB_SUBSTATE_TERMINATED:
 				if (pbsd_init_reque(pjob, KEEP_STATE) == -1)
 					return -1;
+				if ((pjob->ji_qs.ji_state == JOB_STATE_MOVED) ||
+					(pjob->ji_qs.ji_state == JOB_STATE_FINISHED))
+					(void)svr_histjob_index(pjob);
 				break;
 
 			case JOB_SUBSTATE_RERUN:
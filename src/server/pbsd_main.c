@@ -284,6 +284,10 @@ pbs_list_head	svr_deferred_req;
 pbs_list_head	svr_queues;            /* list of queues                   */
 pbs_list_head	svr_alljobs;           /* list of all jobs in server       */
 pbs_list_head	svr_newjobs;           /* list of incomming new jobs       */
+pbs_list_head	svr_histjobs;          /* history jobs in expiry order     */
+pbs_list_head	svr_jobs_bystate[PBS_NUMJOBSTATE]; /* jobs by state, in rank order */
+pbs_list_head	svr_arrayjobs;         /* array jobs, in rank order        */
+int		svr_numarrayjobs = 0;
 pbs_list_head	svr_allresvs;          /* all reservations in server */
 pbs_list_head	svr_newresvs;          /* temporary list for new resv jobs */
 pbs_list_head	svr_unlicensedjobs;	/* list of jobs to be licensed */
@@ -1296,6 +1300,10 @@ main(int argc, char **argv)
 	CLEAR_HEAD(svr_queues);
 	CLEAR_HEAD(svr_alljobs);
 	CLEAR_HEAD(svr_newjobs);
+	CLEAR_HEAD(svr_histjobs);
+	CLEAR_HEAD(svr_arrayjobs);
+	for (i = 0; i < PBS_NUMJOBSTATE; i++)
+		CLEAR_HEAD(svr_jobs_bystate[i]);
 	CLEAR_HEAD(svr_allresvs);
 	CLEAR_HEAD(svr_newresvs);
 	CLEAR_HEAD(svr_deferred_req);
@@ -1084,6 +1084,10 @@ dispatch_request(int sfds, struct batch_request *request)
 			req_stat_sched(request);
 			break;
 
+		case PBS_BATCH_StatusEvents:
+			req_stat_events(request);
+			break;
+
 		case PBS_BATCH_StatusHook:
 
 			if (!is_local_root(request->rq_user,
@@ -116,6 +116,8 @@ que_alloc(char *name)
 	(void)memset((char *)pq, (int)0, (size_t)sizeof(pbs_queue));
 	pq->qu_qs.qu_type = QTYPE_Unset;
 	CLEAR_HEAD(pq->qu_jobs);
+	for (i = 0; i < PBS_NUMJOBSTATE; i++)
+		CLEAR_HEAD(pq->qu_jobs_bystate[i]);
 	CLEAR_LINK(pq->qu_link);
 
 	strncpy(pq->qu_qs.qu_name, name, PBS_MAXQUEUENAME);
@@ -227,6 +229,7 @@ que_purge(pbs_queue *pque)
 			while (pjob) {
 				nxpjob = (job *)GET_NEXT(pjob->ji_jobque);
 				delete_link(&pjob->ji_jobque);
+				delete_link(&pjob->ji_questate);
 				--pque->qu_numjobs;
 				--pque->qu_njstate[pjob->ji_qs.ji_state];
 				pjob->ji_qhdr = (pbs_queue *)0;
@@ -498,7 +498,7 @@ req_deletejob(struct batch_request *preq)
 		 index of the highest numbered array subjob */
 
 		count = parent->ji_ajtrk->tkm_ct;
-		maxindex = parent->ji_ajtrk->tkm_tbl[count-1].trk_index;
+		maxindex = AJ_INDEX(parent->ji_ajtrk, count-1);
 		if (x > maxindex) {
 			req_reject(PBSE_UNKJOBID, 0, preq);
 			break;
@@ -3597,6 +3597,9 @@ mgr_resource_delete(struct batch_request *preq)
 			free(prdef);
 			prdef = NULL;
 			svr_resc_size--;
+			/* the head of the chain may have changed */
+			reset_resc_def_index();
+			(void)build_resc_def_index(svr_resc_def, svr_resc_size);
 			break;
 		}
 	}
@@ -48,6 +48,8 @@
  * 	chk_job_statenum()
  * 	add_select_entry()
  * 	add_select_array_entries()
+ * 	sel_walk_init()
+ * 	sel_walk_next()
  * 	req_selectjobs()
  * 	select_job()
  * 	sel_attr()
@@ -63,6 +65,7 @@
 
 #include <sys/types.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include "libpbs.h"
 #include <string.h>
 #include "server_limits.h"
@@ -83,10 +86,28 @@
 
 /* Private Data */
 
+/*
+ * The jobs a select has to look at: one job list, either the queue or
+ * server list or one of the secondary indexes kept by svr_enquejob(),
+ * merged in queue rank order with svr_arrayjobs when the list is a per
+ * state list but Array Jobs are selected whatever their state.
+ */
+struct sel_walk {
+	job		*sw_job[2];	/* next job of the list, of array jobs */
+	size_t		 sw_off[2];	/* offset of the list link in job */
+	pbs_queue	*sw_que;	/* select limited to this queue */
+	int		 sw_state;	/* state of a per state list, else -1 */
+};
+
+#define SEL_LINK(pj, off) ((pbs_list_link *)((char *)(pj) + (off)))
+
 /* Global Data Items  */
 
 extern int	 resc_access_perm;
 extern pbs_list_head svr_alljobs;
+extern pbs_list_head svr_jobs_bystate[];
+extern pbs_list_head svr_arrayjobs;
+extern int svr_numarrayjobs;
 extern time_t	 time_now;
 extern char	 statechars[];
 extern long svr_history_enable;
@@ -296,7 +317,7 @@ add_select_array_entries(job *pjob, int dosub, char *statelist,
 			 * just add the subjobs to the return list.
 			 */
 			if ((statelist == NULL) ||
-				(select_subjob(pjob->ji_ajtrk->tkm_tbl[i].trk_status, psel))) {
+				(select_subjob(get_subjob_state(pjob, i), psel))) {
 				ct += add_select_entry(mk_subjob_id(pjob, i), pselx);
 			}
 		}
@@ -305,6 +326,149 @@ add_select_array_entries(job *pjob, int dosub, char *statelist,
 	return ct;
 }
 
+/**
+ * @brief
+ * 		sel_walk_init - choose the shortest list of jobs that holds every
+ *		job which could match the select list.
+ *
+ * @par
+ *		Besides the queue (or server) job list, an equality select on a
+ *		single job state can use the per state job list, and one on a
+ *		single user the owner index.  When subjobs are selected, an Array
+ *		Job is not matched on its own state, so all Array Jobs are merged
+ *		into a per state list.  Every job returned is still run through
+ *		select_job().
+ *
+ * @param[out]	psw	-	walk to set up
+ * @param[in]	psel	-	select list
+ * @param[in]	pque	-	queue the select is limited to, or NULL
+ * @param[in]	dosubjobs	-	as passed to select_job()
+ *
+ * @return	void
+ */
+static void
+sel_walk_init(struct sel_walk *psw, struct select_list *psel, pbs_queue *pque,
+	int dosubjobs)
+{
+	pbs_list_head	     *phead;
+	struct owner_jobs    *poj;
+	struct array_strings *pas;
+	char		     *pc;
+	int		      count;
+	int		      n;
+	int		      state;
+
+	if (pque) {
+		phead = &pque->qu_jobs;
+		psw->sw_off[0] = offsetof(job, ji_jobque);
+		count = pque->qu_numjobs;
+	} else {
+		phead = &svr_alljobs;
+		psw->sw_off[0] = offsetof(job, ji_alljobs);
+		count = server.sv_qs.sv_numjobs;
+	}
+	psw->sw_que = pque;
+	psw->sw_state = -1;
+
+	for (; psel; psel = psel->sl_next) {
+		if (psel->sl_op != EQ)
+			continue;
+
+		if (psel->sl_atindx == (int)JOB_ATR_state) {
+			pc = psel->sl_attr.at_val.at_str;
+			if ((pc == NULL) || (*pc == '\0') || (*(pc + 1) != '\0'))
+				continue;
+			/* suspended jobs are in the running state */
+			if ((*pc == 'S') || (*pc == 'U'))
+				state = JOB_STATE_RUNNING;
+			else if ((state = state_char2int(*pc)) < 0)
+				continue;
+			if (pque)
+				n = pque->qu_njstate[state];
+			else
+				n = server.sv_jobstates[state];
+			if (dosubjobs)
+				n += svr_numarrayjobs;
+			if (n < count) {
+				if (pque) {
+					phead = &pque->qu_jobs_bystate[state];
+					psw->sw_off[0] = offsetof(job, ji_questate);
+				} else {
+					phead = &svr_jobs_bystate[state];
+					psw->sw_off[0] = offsetof(job, ji_svrstate);
+				}
+				psw->sw_state = state;
+				count = n;
+			}
+
+		} else if (psel->sl_atindx == (int)JOB_ATR_userlst) {
+			pas = psel->sl_attr.at_val.at_arst;
+			if ((pas == NULL) || (pas->as_usedptr != 1))
+				continue;
+			/* a leading + or - makes it an acl_check() entry */
+			pc = pas->as_string[0];
+			if ((*pc == '+') || (*pc == '-'))
+				continue;
+			if (find_owner_jobs(pas->as_string[0], &poj) != 0)
+				continue;
+			n = poj ? poj->oj_numjobs : 0;
+			if (n < count) {
+				phead = poj ? &poj->oj_jobs : NULL;
+				psw->sw_off[0] = offsetof(job, ji_ownerjobs);
+				psw->sw_state = -1;
+				count = n;
+			}
+		}
+	}
+
+	psw->sw_job[0] = phead ? (job *)GET_NEXT(*phead) : NULL;
+	psw->sw_job[1] = NULL;
+	psw->sw_off[1] = offsetof(job, ji_arrayjobs);
+	if ((psw->sw_state >= 0) && dosubjobs)
+		psw->sw_job[1] = (job *)GET_NEXT(svr_arrayjobs);
+}
+
+/**
+ * @brief
+ * 		sel_walk_next - return the next job of a walk set up by
+ *		sel_walk_init(), in queue rank order.
+ *
+ * @param[in,out]	psw	-	the walk
+ *
+ * @return	job *
+ * @retval	NULL	: no more jobs
+ */
+static job *
+sel_walk_next(struct sel_walk *psw)
+{
+	job	*pjob;
+	int	 i;
+
+	for (;;) {
+		/* array jobs in the listed state are already in list 0 */
+		while (((pjob = psw->sw_job[1]) != NULL) &&
+			(pjob->ji_qs.ji_state == psw->sw_state))
+			psw->sw_job[1] = (job *)GET_NEXT(*SEL_LINK(pjob, psw->sw_off[1]));
+
+		if (psw->sw_job[1] == NULL)
+			i = 0;
+		else if (psw->sw_job[0] == NULL)
+			i = 1;
+		else if ((unsigned long)psw->sw_job[1]->ji_wattr[(int)JOB_ATR_qrank].at_val.at_long <
+			(unsigned long)psw->sw_job[0]->ji_wattr[(int)JOB_ATR_qrank].at_val.at_long)
+			i = 1;
+		else
+			i = 0;
+
+		if ((pjob = psw->sw_job[i]) == NULL)
+			return (NULL);
+		psw->sw_job[i] = (job *)GET_NEXT(*SEL_LINK(pjob, psw->sw_off[i]));
+
+		if ((psw->sw_que == NULL) || (pjob->ji_qhdr == psw->sw_que))
+			return (pjob);
+	}
+}
+
 /**
  * @brief
  * 		req_selectjobs - service both the Select Job Request and the (special
@@ -326,6 +490,7 @@ req_selectjobs(struct batch_request *preq)
 	job		   *pjob;
 	svrattrl	   *plist;
 	pbs_queue	   *pque;
+	struct sel_walk	    walk;
 	struct batch_reply *preply;
 	struct brp_select **pselx;
 	int		    dosubjobs = 0;
@@ -394,11 +559,8 @@ req_selectjobs(struct batch_request *preq)
 
 	/* now start checking for jobs that match the selection criteria */
 
-	if (pque)
-		pjob = (job *)GET_NEXT(pque->qu_jobs);
-	else
-		pjob = (job *)GET_NEXT(svr_alljobs);
-	while (pjob) {
+	sel_walk_init(&walk, selistp, pque, dosubjobs);
+	while ((pjob = sel_walk_next(&walk)) != NULL) {
 		if (server.sv_attr[(int)SRV_ATR_query_others].at_val.at_long ||
 			(svr_authorize_jobreq(preq, pjob) == 0)) {
 
@@ -427,7 +589,7 @@ req_selectjobs(struct batch_request *preq)
 					plist = (svrattrl *)GET_NEXT(preq->rq_ind.rq_select.rq_rtnattr);
 					if ((dosubjobs == 1) && pjob->ji_ajtrk) {
 						for (i=0; i<pjob->ji_ajtrk->tkm_ct; ++i) {
-							if ((pstate == 0) || chk_job_statenum(pjob->ji_ajtrk->tkm_tbl[i].trk_status, pstate)) {
+							if ((pstate == 0) || chk_job_statenum(get_subjob_state(pjob, i), pstate)) {
 								rc = status_subjob(pjob, preq, plist, i, &preply->brp_un.brp_status, &bad);
 								if (rc && (rc != PBSE_PERM))
 									goto out;
@@ -445,10 +607,6 @@ req_selectjobs(struct batch_request *preq)
 				}
 			}
 		}
-		if (pque)
-			pjob = (job *)GET_NEXT(pjob->ji_jobque);
-		else
-			pjob = (job *)GET_NEXT(pjob->ji_alljobs);
 	}
 out:
 	free_sellist(selistp);
@@ -363,6 +363,7 @@ expand_resc_array(char *rname, int rtype, int rflag)
 
 	pold->rs_next  = pnew;
 	svr_resc_size++;
+	(void)build_resc_def_index(svr_resc_def, svr_resc_size);
 
 	return 0;
 }
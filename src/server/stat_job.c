@@ -250,7 +250,7 @@ status_job(job *pjob, struct batch_request *preq, svrattrl *pal, pbs_list_head *
 
 		premain = &pjob->ji_wattr[(int)JOB_ATR_array_indices_remaining];
 		if (premain->at_flags & ATR_VFLAG_MODCACHE) {
-			pnewstr = cvt_range(pjob->ji_ajtrk, JOB_STATE_QUEUED);
+			pnewstr = cvt_range(pjob, JOB_STATE_QUEUED);
 			if (pnewstr == NULL)
 				pnewstr = "-";
 			job_attr_def[JOB_ATR_array_indices_remaining].at_free(premain);
@@ -0,0 +1,508 @@
+/*
+ * Copyright (C) 1994-2016 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *  
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ * 
+ * Open Source License Information:
+ *  
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free 
+ * Software Foundation, either version 3 of the License, or (at your option) any 
+ * later version.
+ *  
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  
+ * Commercial License Information: 
+ * 
+ * The PBS Pro software is licensed under the terms of the GNU Affero General 
+ * Public License agreement ("AGPL"), except where a separate commercial license 
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *  
+ * Altair’s dual-license business model allows companies, individuals, and 
+ * organizations to create proprietary derivative works of PBS Pro and distribute 
+ * them - whether embedded or bundled with other software - under a commercial 
+ * license agreement.
+ * 
+ * Use of Altair’s trademarks, including but not limited to "PBS™", 
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's 
+ * trademark licensing policies.
+ *
+ */
+/**
+ * @file    state_journal.c
+ *
+ * @brief
+ * 	state_journal.c - the vnode and job state change journal and the
+ *	Status Events request which reads it.
+ *
+ *	Every change of a vnode's state made through set_vnode_state() and of
+ *	a job's state made through svr_setjobstate(), and the removal of a
+ *	job from the server by job_purge(), is recorded, with a
+ *	sequence number, in a fixed size ring.  A client asks for the changes
+ *	from a sequence number on and, if there are none yet, may wait for
+ *	the next one.  Once the ring wraps the oldest changes are lost; the
+ *	client sees this from the sequence number of the first change it gets.
+ *	Numbering starts again when the server restarts, so each change also
+ *	carries the journal's epoch, the time the server started.
+ *
+ * Functions included are:
+ *	journal_vnode_state()
+ *	journal_job_state()
+ *	journal_job_purge()
+ *	req_stat_events()
+ *
+ */
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include "libpbs.h"
+#include "server_limits.h"
+#include "list_link.h"
+#include "attribute.h"
+#include "server.h"
+#include "credential.h"
+#include "batch_request.h"
+#include "job.h"
+#include "pbs_error.h"
+#include "work_task.h"
+#include "log.h"
+#include "pbs_nodes.h"
+#include "svrfunc.h"
+
+
+#define STATE_JOURNAL_SIZE	8192	/* changes kept */
+#define STATEV_MAXREPLY		1000	/* changes sent in one reply */
+
+struct state_event {
+	unsigned long long se_seq;	/* sequence number, 0 if unused */
+	time_t	se_time;		/* time of the change */
+	int	se_objtype;		/* MGR_OBJ_NODE or MGR_OBJ_JOB */
+	int	se_old;			/* vnode state bits or job state */
+	int	se_new;			/* -1 for a job which was purged */
+	int	se_oldsub;		/* job substates */
+	int	se_newsub;
+	char	se_name[PBS_MAXSVRJOBID+1];	/* vnode name or job id */
+};
+
+/* a Status Events request waiting for the next change */
+struct state_waiter {
+	pbs_list_link	sw_link;
+	struct batch_request *sw_preq;
+	struct work_task *sw_timeout;	/* replies with nothing when it fires */
+};
+
+static struct state_event *journal = NULL;
+static unsigned long long journal_next = 1;	/* sequence of the next change */
+static pbs_list_head state_waiters;
+static int waiters_init = 0;
+static int wakeup_pending = 0;
+
+extern char statechars[];
+extern time_t time_now;
+
+static void journal_wakeup(struct work_task *);
+
+/**
+ * @brief
+ * 		journal_first - the sequence number of the first change to send
+ *		to a client which wants the changes from seq on.  A seq that is
+ *		older than the ring, newer than anything journaled, or read from
+ *		another epoch (the client saw an earlier server), starts at the
+ *		oldest change kept.
+ *
+ * @param[in]	seq	-	first sequence number the client wants
+ * @param[in]	epoch	-	epoch seq was read in, 0 if not known
+ *
+ * @return	unsigned long long
+ * @retval	journal_next	: there is nothing to send yet
+ */
+static unsigned long long
+journal_first(unsigned long long seq, unsigned long long epoch)
+{
+	unsigned long long oldest;
+
+	if (journal_next > STATE_JOURNAL_SIZE)
+		oldest = journal_next - STATE_JOURNAL_SIZE;
+	else
+		oldest = 1;
+
+	if ((seq < oldest) || (seq > journal_next))
+		return oldest;
+	if ((epoch != 0) && (epoch != (unsigned long long)server.sv_started))
+		return oldest;
+	return seq;
+}
+
+/**
+ * @brief
+ * 		journal_reply - reply to a Status Events request with the changes
+ *		from sequence number first on, at most STATEV_MAXREPLY of them.
+ *
+ * @param[in]	preq	-	the request
+ * @param[in]	first	-	sequence number of the first change to send
+ *
+ * @return	void
+ */
+static void
+journal_reply(struct batch_request *preq, unsigned long long first)
+{
+	struct batch_reply *preply = &preq->rq_reply;
+	struct brp_status *pstat;
+	struct state_event *pse;
+	svrattrl *pal;
+	attribute state;
+	unsigned long long seq;
+	char buf[64];
+	int n;
+
+	preply->brp_choice = BATCH_REPLY_CHOICE_Status;
+	CLEAR_HEAD(preply->brp_un.brp_status);
+
+	for (seq = first, n = 0; (seq < journal_next) && (n < STATEV_MAXREPLY); seq++, n++) {
+		pse = &journal[seq % STATE_JOURNAL_SIZE];
+
+		pstat = (struct brp_status *)malloc(sizeof(struct brp_status));
+		if (pstat == NULL) {
+			reply_free(preply);
+			req_reject(PBSE_SYSTEM, 0, preq);
+			return;
+		}
+		CLEAR_LINK(pstat->brp_stlink);
+		CLEAR_HEAD(pstat->brp_attr);
+		pstat->brp_objtype = pse->se_objtype;
+		(void)strcpy(pstat->brp_objname, pse->se_name);
+		append_link(&preply->brp_un.brp_status, &pstat->brp_stlink, pstat);
+
+		sprintf(buf, "%llu", pse->se_seq);
+		if ((pal = attrlist_create(STATEV_SEQ, NULL, strlen(buf)+1)) == NULL)
+			goto nomem;
+		(void)strcpy(pal->al_value, buf);
+		append_link(&pstat->brp_attr, &pal->al_link, pal);
+
+		sprintf(buf, "%ld", (long)server.sv_started);
+		if ((pal = attrlist_create(STATEV_EPOCH, NULL, strlen(buf)+1)) == NULL)
+			goto nomem;
+		(void)strcpy(pal->al_value, buf);
+		append_link(&pstat->brp_attr, &pal->al_link, pal);
+
+		sprintf(buf, "%ld", (long)pse->se_time);
+		if ((pal = attrlist_create(STATEV_TIME, NULL, strlen(buf)+1)) == NULL)
+			goto nomem;
+		(void)strcpy(pal->al_value, buf);
+		append_link(&pstat->brp_attr, &pal->al_link, pal);
+
+		if (pse->se_objtype == MGR_OBJ_NODE) {
+			if ((pal = attrlist_create(STATEV_TYPE, NULL, strlen(STATEV_NODE)+1)) == NULL)
+				goto nomem;
+			(void)strcpy(pal->al_value, STATEV_NODE);
+			append_link(&pstat->brp_attr, &pal->al_link, pal);
+
+			/* the same form as the vnode's state attribute */
+			memset(&state, 0, sizeof(state));
+			state.at_flags = ATR_VFLAG_SET;
+			state.at_val.at_short = pse->se_old;
+			if (encode_state(&state, &pstat->brp_attr, STATEV_OLD, NULL, 0, NULL) != 0)
+				goto nomem;
+			state.at_val.at_short = pse->se_new;
+			if (encode_state(&state, &pstat->brp_attr, STATEV_NEW, NULL, 0, NULL) != 0)
+				goto nomem;
+		} else {
+			if ((pal = attrlist_create(STATEV_TYPE, NULL, strlen(STATEV_JOB)+1)) == NULL)
+				goto nomem;
+			(void)strcpy(pal->al_value, STATEV_JOB);
+			append_link(&pstat->brp_attr, &pal->al_link, pal);
+
+			/* job state letter and substate, e.g. "Q/10" */
+			sprintf(buf, "%c/%d", statechars[pse->se_old], pse->se_oldsub);
+			if ((pal = attrlist_create(STATEV_OLD, NULL, strlen(buf)+1)) == NULL)
+				goto nomem;
+			(void)strcpy(pal->al_value, buf);
+			append_link(&pstat->brp_attr, &pal->al_link, pal);
+
+			if (pse->se_new < 0)
+				strcpy(buf, STATEV_PURGED);
+			else
+				sprintf(buf, "%c/%d", statechars[pse->se_new],
+					pse->se_newsub);
+			if ((pal = attrlist_create(STATEV_NEW, NULL, strlen(buf)+1)) == NULL)
+				goto nomem;
+			(void)strcpy(pal->al_value, buf);
+			append_link(&pstat->brp_attr, &pal->al_link, pal);
+		}
+	}
+
+	(void)reply_send(preq);
+	return;
+
+nomem:
+	reply_free(preply);
+	req_reject(PBSE_SYSTEM, 0, preq);
+}
+
+/**
+ * @brief
+ * 		journal_waiter_done - forget a waiting request, its timeout task
+ *		and its connection's close function.
+ *
+ * @param[in]	psw	-	the waiting request
+ *
+ * @return	struct batch_request * - the request, for the caller to finish
+ */
+static struct batch_request *
+journal_waiter_done(struct state_waiter *psw)
+{
+	struct batch_request *preq = psw->sw_preq;
+
+	delete_link(&psw->sw_link);
+	if (psw->sw_timeout != NULL)
+		delete_task(psw->sw_timeout);
+	net_add_close_func(preq->rq_conn, (void (*)(int))0);
+	free(psw);
+	return preq;
+}
+
+/**
+ * @brief
+ * 		journal_timeout - nothing changed while a request waited,
+ *		reply with no changes.
+ *
+ * @param[in]	ptask	-	work task, wt_parm1 is the state_waiter
+ *
+ * @return	void
+ */
+static void
+journal_timeout(struct work_task *ptask)
+{
+	struct state_waiter *psw = (struct state_waiter *)ptask->wt_parm1;
+
+	psw->sw_timeout = NULL;		/* this task is done with */
+	journal_reply(journal_waiter_done(psw), journal_next);
+}
+
+/**
+ * @brief
+ * 		journal_close - the client of a waiting request went away,
+ *		throw the request away.
+ *
+ * @param[in]	sd	-	the connection which closed
+ *
+ * @return	void
+ */
+static void
+journal_close(int sd)
+{
+	struct state_waiter *psw;
+	struct state_waiter *next;
+
+	for (psw = (struct state_waiter *)GET_NEXT(state_waiters); psw; psw = next) {
+		next = (struct state_waiter *)GET_NEXT(psw->sw_link);
+		if (psw->sw_preq->rq_conn == sd)
+			free_br(journal_waiter_done(psw));
+	}
+}
+
+/**
+ * @brief
+ * 		journal_wakeup - reply to the waiting requests with the changes
+ *		journaled since they started to wait.  Run as an immediate
+ *		work task so the replies are not sent from inside whatever
+ *		changed the state.
+ *
+ * @param[in]	ptask	-	work task, unused
+ *
+ * @return	void
+ */
+static void
+journal_wakeup(struct work_task *ptask)
+{
+	struct state_waiter *psw;
+	struct batch_request *preq;
+
+	wakeup_pending = 0;
+	while ((psw = (struct state_waiter *)GET_NEXT(state_waiters)) != NULL) {
+		preq = journal_waiter_done(psw);
+		journal_reply(preq, journal_first(preq->rq_ind.rq_statevents.rq_seq,
+			preq->rq_ind.rq_statevents.rq_epoch));
+	}
+}
+
+/**
+ * @brief
+ * 		journal_add - record a state change and wake up the waiting
+ *		requests.
+ *
+ * @param[in]	objtype	-	MGR_OBJ_NODE or MGR_OBJ_JOB
+ * @param[in]	name	-	vnode name or job id
+ * @param[in]	old	-	state before the change
+ * @param[in]	oldsub	-	job substate before the change
+ * @param[in]	new	-	state after the change
+ * @param[in]	newsub	-	job substate after the change
+ *
+ * @return	void
+ */
+static void
+journal_add(int objtype, char *name, int old, int oldsub, int new, int newsub)
+{
+	struct state_event *pse;
+
+	if (journal == NULL) {
+		journal = (struct state_event *)calloc(STATE_JOURNAL_SIZE,
+			sizeof(struct state_event));
+		if (journal == NULL) {
+			log_err(errno, __func__, "no memory for the state journal");
+			return;
+		}
+	}
+
+	pse = &journal[journal_next % STATE_JOURNAL_SIZE];
+	pse->se_seq = journal_next++;
+	pse->se_time = time_now;
+	pse->se_objtype = objtype;
+	pse->se_old = old;
+	pse->se_oldsub = oldsub;
+	pse->se_new = new;
+	pse->se_newsub = newsub;
+	(void)strncpy(pse->se_name, name, PBS_MAXSVRJOBID);
+	pse->se_name[PBS_MAXSVRJOBID] = '\0';
+
+	if (waiters_init && !wakeup_pending &&
+		(GET_NEXT(state_waiters) != NULL)) {
+		if (set_task(WORK_Immed, 0, journal_wakeup, NULL) != NULL)
+			wakeup_pending = 1;
+	}
+}
+
+/**
+ * @brief
+ * 		journal_vnode_state - record a change of a vnode's state.
+ *
+ * @param[in]	name	-	vnode name
+ * @param[in]	old	-	state bits before the change
+ * @param[in]	new	-	state bits after the change
+ *
+ * @return	void
+ */
+void
+journal_vnode_state(char *name, int old, int new)
+{
+	journal_add(MGR_OBJ_NODE, name, old, 0, new, 0);
+}
+
+/**
+ * @brief
+ * 		journal_job_state - record a change of a job's state.
+ *
+ * @param[in]	jobid	-	job id
+ * @param[in]	old	-	job state before the change
+ * @param[in]	oldsub	-	job substate before the change
+ * @param[in]	new	-	job state after the change
+ * @param[in]	newsub	-	job substate after the change
+ *
+ * @return	void
+ */
+void
+journal_job_state(char *jobid, int old, int oldsub, int new, int newsub)
+{
+	journal_add(MGR_OBJ_JOB, jobid, old, oldsub, new, newsub);
+}
+
+/**
+ * @brief
+ * 		journal_job_purge - record that a job left the server.
+ *
+ * @param[in]	jobid	-	job id
+ * @param[in]	old	-	job state when it was purged
+ * @param[in]	oldsub	-	job substate when it was purged
+ *
+ * @return	void
+ */
+void
+journal_job_purge(char *jobid, int old, int oldsub)
+{
+	journal_add(MGR_OBJ_JOB, jobid, old, oldsub, -1, 0);
+}
+
+/**
+ * @brief
+ * 		req_stat_events - service a PBS_BATCH_StatusEvents request.
+ *		Reply with the vnode and job state changes from the requested
+ *		sequence number on.  If there are none yet, wait up to the
+ *		requested number of seconds for one.
+ *
+ *		Only managers and operators may read the journal.
+ *
+ * @param[in]	preq	-	the request
+ *
+ * @return	void
+ */
+void
+req_stat_events(struct batch_request *preq)
+{
+	struct state_waiter *psw;
+	unsigned long long seq;
+	unsigned long long epoch;
+	unsigned long long first;
+	int wait;
+
+	if ((preq->rq_perm & PRIV_READ) == 0) {
+		req_reject(PBSE_PERM, 0, preq);
+		return;
+	}
+
+	if (!waiters_init) {
+		CLEAR_HEAD(state_waiters);
+		waiters_init = 1;
+	}
+
+	seq = preq->rq_ind.rq_statevents.rq_seq;
+	epoch = preq->rq_ind.rq_statevents.rq_epoch;
+	first = journal_first(seq, epoch);
+	if ((seq != 0) && (first != seq)) {
+		if ((first > seq) && ((epoch == 0) ||
+			(epoch == (unsigned long long)server.sv_started)))
+			sprintf(log_buffer, "%s@%s fell behind the state journal, "
+				"%llu changes lost", preq->rq_user, preq->rq_host,
+				first - seq);
+		else
+			sprintf(log_buffer, "%s@%s asked for state change %llu, "
+				"the journal restarted", preq->rq_user, preq->rq_host, seq);
+		log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST, LOG_DEBUG,
+			__func__, log_buffer);
+	}
+	wait = preq->rq_ind.rq_statevents.rq_wait;
+	if (wait > STATEV_MAXWAIT)
+		wait = STATEV_MAXWAIT;
+
+	if ((first < journal_next) || (wait <= 0) ||
+		(preq->rq_conn == PBS_LOCAL_CONNECTION)) {
+		journal_reply(preq, first);
+		return;
+	}
+
+	psw = (struct state_waiter *)malloc(sizeof(struct state_waiter));
+	if (psw == NULL) {
+		req_reject(PBSE_SYSTEM, 0, preq);
+		return;
+	}
+	CLEAR_LINK(psw->sw_link);
+	psw->sw_preq = preq;
+	psw->sw_timeout = set_task(WORK_Timed, time_now + wait, journal_timeout, psw);
+	if (psw->sw_timeout == NULL) {
+		free(psw);
+		req_reject(PBSE_SYSTEM, 0, preq);
+		return;
+	}
+	append_link(&state_waiters, &psw->sw_link, psw);
+	/* the request goes with its connection */
+	net_add_close_func(preq->rq_conn, journal_close);
+}
@@ -71,12 +71,18 @@
  *		determine_accruetype() - determines accruetype
  *		alter_eligibletime() - resets sampletime of job
  *		eval_chkpnt()	   - insure job checkpoint .ge. queues min. time
+ *		find_owner_jobs()  - find the jobs of a user through the owner index
+ *		svr_jobidx_reorder() - relink two jobs whose queue ranks were swapped
  *
  * Private functions
  *		chk_svr_resc_limit() - check job requirements againt queue/server limits
  *		default_std()	   - make the default name for standard out/error
  *		set_deflt_resc()   - set unspecified resource_limit to default values
  *		job_wait_over()	   - event handler for job_set_wait()
+ *		svr_jobidx_state() - relink job into the per state job lists
+ *		svr_jobidx_add()   - link job into the owner and array job indexes
+ *		svr_jobidx_unlink() - remove job from the secondary job indexes
+ *		owner_lookup()	   - look up the owner index entry for a user
  */
 #include <pbs_config.h>   /* the master config generated by configure */
 
@@ -90,6 +96,7 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <string.h>
+#include <stddef.h>
 #include <ctype.h>
 #include <time.h>
 #include <netdb.h>
@@ -156,6 +163,9 @@ static void running_jobs_count(struct work_task *);
 
 /** For faster job lookup through AVL tree */
 static void svr_avljob_oper(job *pjob, int delkey);
+static void svr_jobidx_state(job *pjob);
+static void svr_jobidx_add(job *pjob);
+static void svr_jobidx_unlink(job *pjob);
 
 /* Global Data Items: */
 extern char* msg_noloopbackif;
@@ -163,6 +173,10 @@ extern char* msg_noloopbackif;
 extern struct server server;
 
 extern pbs_list_head svr_alljobs;
+extern pbs_list_head svr_histjobs;
+extern pbs_list_head svr_jobs_bystate[];
+extern pbs_list_head svr_arrayjobs;
+extern int svr_numarrayjobs;
 extern pbs_list_head svr_unlicensedjobs;
 extern char  *msg_badwait;		/* error message */
 extern char  *msg_daemonname;
@@ -263,6 +277,8 @@ svr_enquejob(job *pjob)
 				 * faster compared to linked list traverse.
 				 */
 				svr_avljob_oper(pjob, 0);
+				svr_jobidx_state(pjob);
+				svr_jobidx_add(pjob);
 			}
 			server.sv_qs.sv_numjobs++;
 			server.sv_jobstates[pjob->ji_qs.ji_state]++;
@@ -346,6 +362,11 @@ svr_enquejob(job *pjob)
 	pque->qu_numjobs++;
 	pque->qu_njstate[pjob->ji_qs.ji_state]++;
 
+	/* and the secondary indexes used by req_selectjobs() */
+
+	svr_jobidx_state(pjob);
+	svr_jobidx_add(pjob);
+
 	if ((pjob->ji_qs.ji_state == JOB_STATE_MOVED) ||
 		(pjob->ji_qs.ji_state == JOB_STATE_FINISHED)) {
 		if (pjob->ji_qs.ji_svrflags & JOB_SVFLG_ArrayJob) {
@@ -518,6 +539,7 @@ svr_dequejob(job *pjob)
 		 * added for faster job search i.e. find_job().
 		 */
 		svr_avljob_oper(pjob, 1);
+		svr_jobidx_unlink(pjob);
 
 		if (--server.sv_qs.sv_numjobs < 0)
 			bad_ct = 1;
@@ -543,6 +565,7 @@ svr_dequejob(job *pjob)
 		}
 		if (is_linked(&pque->qu_jobs, &pjob->ji_jobque)) {
 			delete_link(&pjob->ji_jobque);
+			delete_link(&pjob->ji_questate);
 			if (--pque->qu_numjobs < 0)
 				bad_ct = 1;
 			if (--pque->qu_njstate[pjob->ji_qs.ji_state] < 0)
@@ -586,6 +609,7 @@ svr_setjobstate(job *pjob, int newstate, int newsubstate)
 {
 	int    changed = 0;
 	int    oldstate;
+	int    oldsubstate;
 	pbs_queue *pque = pjob->ji_qhdr;
 	long newaccruetype;
 
@@ -661,10 +685,17 @@ svr_setjobstate(job *pjob, int newstate, int newsubstate)
 
 	/* set the states accordingly */
 
+	oldstate = pjob->ji_qs.ji_state;
+	oldsubstate = pjob->ji_qs.ji_substate;
 	pjob->ji_qs.ji_state = newstate;
 	pjob->ji_qs.ji_substate = newsubstate;
 	pjob->ji_wattr[(int)JOB_ATR_substate].at_val.at_long = newsubstate;
 	pjob->ji_wattr[(int)JOB_ATR_substate].at_flags |= ATR_VFLAG_MODCACHE;
+	if (oldstate != newstate) {
+		svr_jobidx_state(pjob);
+		journal_job_state(pjob->ji_qs.ji_jobid, oldstate, oldsubstate,
+			newstate, newsubstate);
+	}
 
 	set_statechar(pjob);
 	Update_Resvstate_if_resv(pjob);
@@ -5538,6 +5569,91 @@ svr_saveorpurge_finjobhist(job *pjob)
 		job_purge(pjob);
 	}
 }
+/**
+ * @brief
+ *		svr_histjob_index - link a history job into svr_histjobs, which is
+ *		kept sorted on JOB_ATR_history_timestamp (oldest first) so that the
+ *		periodic clean up only needs to look at the head of the list.
+ *
+ * @par Functionality:
+ *		If the job does not yet have a history timestamp (recovered from an
+ *		older server), one is derived: time_now for a moved job, start time
+ *		plus walltime used for a finished job.  Since new history jobs are stamped with time_now,
+ *		the insertion point is searched for from the tail of the list.
+ *		Transient data which is never used again once the job is history
+ *		is released at the same time.
+ *
+ * @par Note:
+ *		A history job keeps its whole job structure.  qstat -x, selstat
+ *		and the subjob status code read ji_wattr and ji_ajtrk of history
+ *		jobs directly, so a smaller history record would have to be turned
+ *		back into a job on every stat.
+ *
+ * @param[in,out]	pjob	-	history job
+ *
+ * @return	int
+ * @retval	0	: job indexed
+ * @retval	-1	: no timestamp could be determined, job not indexed
+ */
+int
+svr_histjob_index(job *pjob)
+{
+	attribute	*pattr;
+	job		*pcur;
+	badplace	*bp;
+	long		 ts;
+	int		 walltime_used;
+
+	pattr = &pjob->ji_wattr[(int) JOB_ATR_history_timestamp];
+	if (!(pattr->at_flags & ATR_VFLAG_SET)) {
+		if (pjob->ji_qs.ji_state == JOB_STATE_MOVED)
+			pattr->at_val.at_long = time_now;
+		else {
+			if (((walltime_used = get_used_wall(pjob)) == -1) ||
+				!(pjob->ji_wattr[(int) JOB_ATR_stime].at_flags & ATR_VFLAG_SET)) {
+				log_err(-1, "svr_histjob_index",
+					"Finished job missing start-time/walltime used, cannot clean history");
+				return -1;
+			}
+			pattr->at_val.at_long =
+				pjob->ji_wattr[(int) JOB_ATR_stime].at_val.at_long + walltime_used;
+		}
+		pattr->at_flags |= ATR_VFLAG_SET | ATR_VFLAG_MODCACHE;
+		pjob->ji_modified = 1;
+		/* save the full job */
+		(void)job_save(pjob, SAVEJOB_FULL);
+	}
+	ts = pattr->at_val.at_long;
+
+	delete_link(&pjob->ji_histjobs);
+	for (pcur = (job *)GET_PRIOR(svr_histjobs); pcur != NULL;
+		pcur = (job *)GET_PRIOR(pcur->ji_histjobs)) {
+		if (pcur->ji_wattr[(int) JOB_ATR_history_timestamp].at_val.at_long <= ts)
+			break;
+	}
+	if (pcur != NULL)
+		insert_link(&pcur->ji_histjobs, &pjob->ji_histjobs, pjob,
+			LINK_INSET_AFTER);
+	else
+		insert_link(&svr_histjobs, &pjob->ji_histjobs, pjob,
+			LINK_INSET_AFTER);
+
+	/* the job will not be routed or requeued again, drop what it kept for that */
+	while ((bp = (badplace *)GET_NEXT(pjob->ji_rejectdest)) != NULL) {
+		delete_link(&bp->bp_link);
+		free(bp);
+	}
+	if (pjob->ji_clterrmsg) {
+		free(pjob->ji_clterrmsg);
+		pjob->ji_clterrmsg = NULL;
+	}
+	if (pjob->ji_script) {
+		free(pjob->ji_script);
+		pjob->ji_script = NULL;
+	}
+	return 0;
+}
+
 /**
  * @brief
  *		Function name: svr_clean_job_history
@@ -5545,7 +5661,9 @@ svr_saveorpurge_finjobhist(job *pjob)
  *		 purge the history jobs whose history duration exceeds the
  *		 configured job_history_duration server attribute.
  * @par Functionality: It is a work_task and reschedule itself after 2 mins if
- *		 and only if job_history_enable is set.
+ *		 and only if job_history_enable is set.  History jobs are
+ *		 kept in svr_histjobs ordered by history timestamp, so only the
+ *		 expired jobs at the head of that list are visited.
  *		Output: None
  *
  * @param[in]	pwt	-	work_task structure
@@ -5554,8 +5672,6 @@ void
 svr_clean_job_history(struct work_task *pwt)
 {
 	job 	*pjob = (job *)0;
-	job 	*nxpjob = (job *)0;
-	int 	walltime_used = 0;
 
 	/* set up another work task for next time period */
 	if (pwt && svr_history_enable) {
@@ -5568,49 +5684,17 @@ svr_clean_job_history(struct work_task *pwt)
 		}
 	}
 
-	/*
-	 * Traverse through the SERVER job list and find the history
-	 * jobs (job with state JOB_STATE_MOVED and JOB_STATE_FINISHED)
-	 * which exceed the configured job_history_duration value and
-	 * purge them immediately.
-	 */
-	pjob = (job *)GET_NEXT(svr_alljobs);
-
-	while (pjob != NULL) {
-		/* save the next job */
-		nxpjob = (job *)GET_NEXT(pjob->ji_alljobs);
-
-		if ((pjob->ji_qs.ji_state == JOB_STATE_MOVED) ||
-			(pjob->ji_qs.ji_state == JOB_STATE_FINISHED)) {
-
-			if (!(pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_flags & ATR_VFLAG_SET)) {
-				if (pjob->ji_qs.ji_state == JOB_STATE_MOVED)
-					pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_val.at_long = time_now;
-				else {
-					if (((walltime_used = get_used_wall(pjob)) == -1) ||
-						!(pjob->ji_wattr[(int) JOB_ATR_stime].at_flags & ATR_VFLAG_SET)) {
-						log_err(-1, "svr_clean_job_history",
-							"Finished job missing start-time/walltime used, cannot clean history");
-						pjob = nxpjob;
-						continue;
-					}
-					pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_val.at_long =
-						pjob->ji_wattr[(int) JOB_ATR_stime].at_val.at_long + walltime_used;
-				}
-				pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_flags |= ATR_VFLAG_SET | ATR_VFLAG_MODCACHE;
-				pjob->ji_modified = 1;
-				/* save the full job */
-				(void)job_save(pjob, SAVEJOB_FULL);
-			}
-
-			if (time_now >= (pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_val.at_long
-				+ svr_history_duration)) {
-				job_purge(pjob);
-				pjob = (job *) 0;
-			}
+	while ((pjob = (job *)GET_NEXT(svr_histjobs)) != NULL) {
+		if ((pjob->ji_qs.ji_state != JOB_STATE_MOVED) &&
+			(pjob->ji_qs.ji_state != JOB_STATE_FINISHED)) {
+			/* no longer a history job, just drop it from the index */
+			delete_link(&pjob->ji_histjobs);
+			continue;
 		}
-		/* restore the saved next in pjob */
-		pjob = nxpjob;
+		if (time_now < (pjob->ji_wattr[(int) JOB_ATR_history_timestamp].at_val.at_long
+			+ svr_history_duration))
+			break;
+		job_purge(pjob);
 	}
 }
 
@@ -5647,6 +5731,8 @@ svr_histjob_update(job * pjob, int newstate, int newsubstate)
 	pjob->ji_qs.ji_state = newstate;
 	pjob->ji_qs.ji_substate = newsubstate;
 	set_statechar(pjob);
+	if (oldstate != newstate)
+		svr_jobidx_state(pjob);
 
 	/* set the status of each subjob if it is an array job */
 	if (pjob->ji_qs.ji_svrflags & JOB_SVFLG_ArrayJob) {
@@ -5927,6 +6013,7 @@ svr_setjob_histinfo(job *pjob, histjob_type type)
 	pjob->ji_modified = 1;
 	/* update the history job state and substate */
 	svr_histjob_update(pjob, newstate, newsubstate);
+	(void)svr_histjob_index(pjob);
 
 	/*
 	 * Work tasks on history jobs are not required and may change the
@@ -6106,3 +6193,290 @@ AVL_OP_FAIL:
 	}
 }
 
+#define JOB_IDXLINK(pj, off) ((pbs_list_link *)((char *)(pj) + (off)))
+
+/**
+ * @brief
+ *		Link a job into one of the secondary job index lists, keeping the
+ *		list in queue rank order as svr_enquejob() does for svr_alljobs.
+ *
+ * @param[in]	phead	-	head of the index list
+ * @param[in]	pjob	-	job to link
+ * @param[in]	off	-	offset of the pbs_list_link for this list in job
+ *
+ * @par	Linkage scope:
+ *		static (local)
+ *
+ * @return	void
+ */
+static void
+svr_jobidx_link(pbs_list_head *phead, job *pjob, size_t off)
+{
+	job *pjcur;
+
+	pjcur = (job *)GET_PRIOR(*phead);
+	while (pjcur) {
+		if ((unsigned long)pjob->ji_wattr[(int)JOB_ATR_qrank].
+			at_val.at_long >=
+			(unsigned long)pjcur->ji_wattr[(int)JOB_ATR_qrank].
+			at_val.at_long)
+			break;
+		pjcur = (job *)GET_PRIOR(*JOB_IDXLINK(pjcur, off));
+	}
+	if (pjcur == NULL)
+		insert_link(phead, JOB_IDXLINK(pjob, off), pjob,
+			LINK_INSET_AFTER);
+	else
+		insert_link(JOB_IDXLINK(pjcur, off), JOB_IDXLINK(pjob, off),
+			pjob, LINK_INSET_AFTER);
+}
+
+/**
+ * @brief
+ *		(Re)link a job into the per state lists of the server and of its
+ *		queue.  Called whenever a job enters the server job list or its
+ *		ji_state changes while it is there.
+ *
+ * @param[in]	pjob	-	job whose state index entries are updated
+ *
+ * @par	Linkage scope:
+ *		static (local)
+ *
+ * @return	void
+ */
+static void
+svr_jobidx_state(job *pjob)
+{
+	int state = pjob->ji_qs.ji_state;
+
+	delete_link(&pjob->ji_svrstate);
+	delete_link(&pjob->ji_questate);
+	if ((state < 0) || (state >= PBS_NUMJOBSTATE))
+		return;
+	if (is_linked(&svr_alljobs, &pjob->ji_alljobs) == 0)
+		return;
+
+	svr_jobidx_link(&svr_jobs_bystate[state], pjob,
+		offsetof(job, ji_svrstate));
+	if (pjob->ji_qhdr != NULL)
+		svr_jobidx_link(&pjob->ji_qhdr->qu_jobs_bystate[state], pjob,
+			offsetof(job, ji_questate));
+}
+
+/* index of owner user name to struct owner_jobs, created on first use */
+static AVL_IX_DESC *AVL_owners = NULL;
+/* cleared if a job could not be indexed, the index is then not trusted */
+static int owner_idx_ok = 1;
+
+/**
+ * @brief
+ *		Copy the user name part of a Job_Owner value ("user@host").
+ *
+ * @param[in]	owner	-	owner string
+ * @param[out]	user	-	buffer of PBS_MAXUSER+1 bytes
+ *
+ * @return	void
+ */
+static void
+owner_user(char *owner, char *user)
+{
+	int i;
+
+	for (i = 0; (i < PBS_MAXUSER) && owner[i] && (owner[i] != '@'); i++)
+		user[i] = owner[i];
+	user[i] = '\0';
+}
+
+/**
+ * @brief
+ *		Look up the owner index entry for a user name.
+ *
+ * @param[in]	user	-	user name, any "@host" part is ignored
+ *
+ * @par	Linkage scope:
+ *		static (local)
+ *
+ * @return	struct owner_jobs *
+ * @retval	NULL	: no entry for that user
+ */
+static struct owner_jobs *
+owner_lookup(char *user)
+{
+	union {
+		AVL_IX_REC xrp;
+		char	buf[PBS_MAXUSER + sizeof(AVL_IX_REC) + 1];
+	} xxrp;
+	AVL_IX_REC *rp = &xxrp.xrp;
+
+	if (AVL_owners == NULL)
+		return (NULL);
+	owner_user(user, rp->key);
+	if (avl_find_key(rp, AVL_owners) != AVL_IX_OK)
+		return (NULL);
+	return ((struct owner_jobs *)rp->recptr);
+}
+
+/**
+ * @brief
+ *		find_owner_jobs - find the jobs owned by a user through the owner
+ *		index.
+ *
+ * @param[in]	user	-	user name, any "@host" part is ignored
+ * @param[out]	ppoj	-	the owner index entry, NULL if the user has
+ *				no jobs
+ *
+ * @return	int
+ * @retval	0	: *ppoj is set
+ * @retval	-1	: the owner index is not usable, search all jobs
+ */
+int
+find_owner_jobs(char *user, struct owner_jobs **ppoj)
+{
+	*ppoj = NULL;
+	if (!owner_idx_ok || (user == NULL))
+		return (-1);
+	*ppoj = owner_lookup(user);
+	return (0);
+}
+
+/**
+ * @brief
+ *		svr_jobidx_reorder - relink two jobs into the secondary job
+ *		indexes after their queue ranks have been exchanged, so each
+ *		index stays in rank order.  Both jobs are taken out before
+ *		either is put back, as each is placed relative to the other.
+ *
+ * @param[in]	pjob1	-	first job
+ * @param[in]	pjob2	-	second job
+ *
+ * @return	void
+ */
+void
+svr_jobidx_reorder(job *pjob1, job *pjob2)
+{
+	svr_jobidx_unlink(pjob1);
+	svr_jobidx_unlink(pjob2);
+	svr_jobidx_state(pjob1);
+	svr_jobidx_state(pjob2);
+	svr_jobidx_add(pjob1);
+	svr_jobidx_add(pjob2);
+}
+
+/**
+ * @brief
+ *		Link a job into the owner index under the user name of its
+ *		Job_Owner, creating the index entry for that user if needed, and
+ *		an Array Job into svr_arrayjobs.  If a job cannot be indexed,
+ *		the owner index is no longer used by find_owner_jobs().
+ *
+ * @param[in]	pjob	-	job to index
+ *
+ * @par	Linkage scope:
+ *		static (local)
+ *
+ * @return	void
+ */
+static void
+svr_jobidx_add(job *pjob)
+{
+	struct owner_jobs *poj;
+	char *owner;
+	union {
+		AVL_IX_REC xrp;
+		char	buf[PBS_MAXUSER + sizeof(AVL_IX_REC) + 1];
+	} xxrp;
+	AVL_IX_REC *rp = &xxrp.xrp;
+
+	if ((pjob->ji_qs.ji_svrflags & JOB_SVFLG_ArrayJob) &&
+		(is_linked(&svr_arrayjobs, &pjob->ji_arrayjobs) == 0)) {
+		svr_jobidx_link(&svr_arrayjobs, pjob,
+			offsetof(job, ji_arrayjobs));
+		svr_numarrayjobs++;
+	}
+
+	if ((pjob->ji_ownerix != NULL) || !owner_idx_ok)
+		return;
+	owner = pjob->ji_wattr[(int)JOB_ATR_job_owner].at_val.at_str;
+	if (((pjob->ji_wattr[(int)JOB_ATR_job_owner].at_flags & ATR_VFLAG_SET) == 0) ||
+		(owner == NULL)) {
+		owner_idx_ok = 0;
+		return;
+	}
+
+	if (AVL_owners == NULL) {
+		AVL_owners = (AVL_IX_DESC *)malloc(sizeof(AVL_IX_DESC));
+		if (AVL_owners == NULL) {
+			log_err(errno, "svr_jobidx_add", "no memory");
+			owner_idx_ok = 0;
+			return;
+		}
+		avl_create_index(AVL_owners, AVL_NO_DUP_KEYS, 0);
+	}
+
+	if ((poj = owner_lookup(owner)) == NULL) {
+		poj = (struct owner_jobs *)malloc(sizeof(struct owner_jobs));
+		if (poj == NULL) {
+			log_err(errno, "svr_jobidx_add", "no memory");
+			owner_idx_ok = 0;
+			return;
+		}
+		CLEAR_HEAD(poj->oj_jobs);
+		poj->oj_numjobs = 0;
+		owner_user(owner, poj->oj_name);
+		(void)strcpy(rp->key, poj->oj_name);
+		rp->recptr = poj;
+		if (avl_add_key(rp, AVL_owners) != AVL_IX_OK) {
+			log_event(PBSEVENT_DEBUG4, PBS_EVENTCLASS_JOB, LOG_DEBUG,
+				pjob->ji_qs.ji_jobid,
+				"AVL: owner index insert failed, not using it");
+			free(poj);
+			owner_idx_ok = 0;
+			return;
+		}
+	}
+	svr_jobidx_link(&poj->oj_jobs, pjob, offsetof(job, ji_ownerjobs));
+	poj->oj_numjobs++;
+	pjob->ji_ownerix = poj;
+}
+
+/**
+ * @brief
+ *		Remove a job from all the secondary job indexes, dropping its
+ *		owner index entry once the owner has no jobs left.
+ *
+ * @param[in]	pjob	-	job leaving the server job list
+ *
+ * @par	Linkage scope:
+ *		static (local)
+ *
+ * @return	void
+ */
+static void
+svr_jobidx_unlink(job *pjob)
+{
+	struct owner_jobs *poj;
+	union {
+		AVL_IX_REC xrp;
+		char	buf[PBS_MAXUSER + sizeof(AVL_IX_REC) + 1];
+	} xxrp;
+	AVL_IX_REC *rp = &xxrp.xrp;
+
+	delete_link(&pjob->ji_svrstate);
+	delete_link(&pjob->ji_questate);
+	if (is_linked(&svr_arrayjobs, &pjob->ji_arrayjobs)) {
+		delete_link(&pjob->ji_arrayjobs);
+		svr_numarrayjobs--;
+	}
+
+	if ((poj = pjob->ji_ownerix) == NULL)
+		return;
+	delete_link(&pjob->ji_ownerjobs);
+	pjob->ji_ownerix = NULL;
+	if (--poj->oj_numjobs > 0)
+		return;
+
+	(void)strcpy(rp->key, poj->oj_name);
+	rp->recptr = poj;
+	(void)avl_delete_key(rp, AVL_owners);
+	free(poj);
+}
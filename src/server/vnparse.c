@@ -524,6 +524,76 @@ vn_merge2(vnl_t *cur, vnl_t *new, char *allow_attribs, callfunc_t callback)
 	return (cur);
 }
 
+/**
+ * @brief
+ *		Build the list of changes that turn a vnode list the receiver already
+ *		holds (old) into the current one (new):  every attribute of new that
+ *		old lacks or holds with a different value, type or flags.  Vnodes
+ *		with no such attribute are left out.
+ *
+ * @param[in]	old	-	vnode list the receiver holds
+ * @param[in]	new	-	current vnode list
+ *
+ * @return	vnl_t *
+ * @retval	the changes, possibly no vnodes at all, with new's modtime
+ * @retval	NULL	: new drops a vnode or attribute that old has, which
+ *			  cannot be expressed as changes, or out of memory
+ *
+ * @par Side-effects
+ *	Space allocated for the result should be freed with vnl_free().
+ */
+vnl_t *
+vn_delta(vnl_t *old, vnl_t *new)
+{
+	unsigned long	i, j;
+	vnl_t		*delta = NULL;
+	vnal_t		*oldreslist;
+	vnal_t		*newreslist;
+	vna_t		*oldres;
+	vna_t		*newres;
+
+	for (i = 0; i < old->vnl_used; i++) {
+		oldreslist = VNL_NODENUM(old, i);
+		if ((newreslist = id2vnrl(new, oldreslist->vnal_id, NULL)) == NULL)
+			return (NULL);
+		for (j = 0; j < oldreslist->vnal_used; j++) {
+			oldres = VNAL_NODENUM(oldreslist, j);
+			if (attr2vnr(newreslist, oldres->vna_name) == NULL)
+				return (NULL);
+		}
+	}
+
+	if (vnl_alloc(&delta) == NULL)
+		return (NULL);
+
+	for (i = 0; i < new->vnl_used; i++) {
+		newreslist = VNL_NODENUM(new, i);
+		oldreslist = id2vnrl(old, newreslist->vnal_id, NULL);
+
+		for (j = 0; j < newreslist->vnal_used; j++) {
+			newres = VNAL_NODENUM(newreslist, j);
+			if ((oldreslist != NULL) &&
+				((oldres = attr2vnr(oldreslist,
+				newres->vna_name)) != NULL) &&
+				(strcmp(oldres->vna_val, newres->vna_val) == 0) &&
+				(oldres->vna_type == newres->vna_type) &&
+				(oldres->vna_flag == newres->vna_flag))
+				continue;
+
+			if (vn_addvnr(delta, newreslist->vnal_id,
+				newres->vna_name, newres->vna_val,
+				newres->vna_type, newres->vna_flag,
+				NULL) == -1) {
+				vnl_free(delta);
+				return (NULL);
+			}
+		}
+	}
+
+	delta->vnl_modtime = new->vnl_modtime;
+	return (delta);
+}
+
 /**
  * @brief
  * 		Search for an attribute in a vnode.
@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 1994-2016 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *  
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ * 
+ * Open Source License Information:
+ *  
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free 
+ * Software Foundation, either version 3 of the License, or (at your option) any 
+ * later version.
+ *  
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY 
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Affero General Public License for more details.
+ *  
+ * You should have received a copy of the GNU Affero General Public License along 
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *  
+ * Commercial License Information: 
+ * 
+ * The PBS Pro software is licensed under the terms of the GNU Affero General 
+ * Public License agreement ("AGPL"), except where a separate commercial license 
+ * agreement for PBS Pro version 14 or later has been executed in writing with Altair.
+ *  
+ * Altair’s dual-license business model allows companies, individuals, and 
+ * organizations to create proprietary derivative works of PBS Pro and distribute 
+ * them - whether embedded or bundled with other software - under a commercial 
+ * license agreement.
+ * 
+ * Use of Altair’s trademarks, including but not limited to "PBS™", 
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's 
+ * trademark licensing policies.
+ *
+ */
+
+/**
+ * @file    pbs_acctconv.c
+ *
+ * @brief
+ * 		pbs_acctconv.c - convert between text and binary accounting files
+ *
+ * Functions included are:
+ * 	usage()
+ * 	print_value()
+ * 	print_text()
+ * 	print_fields()
+ * 	text_to_binary()
+ * 	main()
+ */
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "cmds.h"
+#include "libutil.h"
+#include "pbs_version.h"
+
+#define MAX_FIELDS	64
+
+/**
+ * @brief
+ * 		usage - shows the usage of the command
+ *
+ * @param[in]	name	-	command name
+ */
+static void
+usage(char *name)
+{
+	fprintf(stderr, "Usage: %s [-f field[,field...]] binfile ...\n", name);
+	fprintf(stderr, "       %s -b [-o outfile] textfile ...\n", name);
+	fprintf(stderr, "       %s --version\n", name);
+	fprintf(stderr, "\t -b convert text accounting files to binary\n");
+	fprintf(stderr, "\t -f print only the named fields, tab separated\n");
+	fprintf(stderr, "\t -o write to outfile instead of standard out\n");
+}
+
+/**
+ * @brief
+ * 		print_value - print a field value quoted the way the server
+ *		quotes it in the text accounting file
+ *
+ * @param[in]	out	-	output stream
+ * @param[in]	value	-	field value
+ */
+static void
+print_value(FILE *out, char *value)
+{
+	if (strchr(value, ' ') == NULL)
+		fputs(value, out);
+	else if (strchr(value, '"') == NULL)
+		fprintf(out, "\"%s\"", value);
+	else
+		fprintf(out, "'%s'", value);
+}
+
+/**
+ * @brief
+ * 		print_text - print a binary record as a text accounting line
+ *
+ * @param[in]	out	-	output stream
+ * @param[in]	rec	-	record
+ */
+static void
+print_text(FILE *out, acctbin_rec *rec)
+{
+	time_t t = (time_t)rec->ab_time;
+	struct tm *ptm;
+	int i;
+
+	ptm = localtime(&t);
+	fprintf(out, "%02d/%02d/%04d %02d:%02d:%02d;%c;%s;",
+		ptm->tm_mon+1, ptm->tm_mday, ptm->tm_year+1900,
+		ptm->tm_hour, ptm->tm_min, ptm->tm_sec,
+		(char)rec->ab_type, rec->ab_id);
+	for (i = 0; i < rec->ab_nfld; i++) {
+		if (*rec->ab_name[i] != '\0')
+			fprintf(out, "%s=", rec->ab_name[i]);
+		print_value(out, rec->ab_value[i]);
+		fputc(' ', out);
+	}
+	fputc('\n', out);
+}
+
+/**
+ * @brief
+ * 		print_fields - print selected fields of a binary record
+ *
+ * @par
+ *		The names "time", "type" and "id" select the record header.
+ *		A field missing from the record prints as an empty column.
+ *
+ * @param[in]	out	-	output stream
+ * @param[in]	rec	-	record
+ * @param[in]	names	-	field names
+ * @param[in]	n	-	number of names
+ */
+static void
+print_fields(FILE *out, acctbin_rec *rec, char **names, int n)
+{
+	char *val;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		if (i > 0)
+			fputc('\t', out);
+		if (strcmp(names[i], "time") == 0)
+			fprintf(out, "%lld", rec->ab_time);
+		else if (strcmp(names[i], "type") == 0)
+			fputc(rec->ab_type, out);
+		else if (strcmp(names[i], "id") == 0)
+			fputs(rec->ab_id, out);
+		else if ((val = acctbin_value(rec, names[i])) != NULL)
+			fputs(val, out);
+	}
+	fputc('\n', out);
+}
+
+/**
+ * @brief
+ * 		text_to_binary - convert a text accounting file to binary records
+ *
+ * @param[in]	in	-	text accounting file
+ * @param[in]	out	-	binary output stream
+ * @param[in]	name	-	name of the input, for messages
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	1	a line could not be converted or written
+ */
+static int
+text_to_binary(FILE *in, FILE *out, char *name)
+{
+	char *buf = NULL;
+	int bufsz = 0;
+	int lineno = 0;
+	int rc = 0;
+	struct tm tm;
+	char *type;
+	char *id;
+	char *text;
+	char *nl;
+
+	while (pbs_fgets(&buf, &bufsz, in) != NULL) {
+		lineno++;
+		if ((nl = strchr(buf, '\n')) != NULL)
+			*nl = '\0';
+		memset(&tm, 0, sizeof(tm));
+		type = strchr(buf, ';');
+		id = type ? strchr(type + 1, ';') : NULL;
+		text = id ? strchr(id + 1, ';') : NULL;
+		if ((text == NULL) || (sscanf(buf, "%d/%d/%d %d:%d:%d",
+			&tm.tm_mon, &tm.tm_mday, &tm.tm_year,
+			&tm.tm_hour, &tm.tm_min, &tm.tm_sec) != 6)) {
+			fprintf(stderr, "%s: line %d: not an accounting record\n",
+				name, lineno);
+			rc = 1;
+			continue;
+		}
+		tm.tm_mon -= 1;
+		tm.tm_year -= 1900;
+		tm.tm_isdst = -1;
+		*id++ = '\0';
+		*text++ = '\0';
+		if (acctbin_write(out, mktime(&tm), *(type + 1), id, text) == -1) {
+			perror(name);
+			rc = 1;
+			break;
+		}
+	}
+	free(buf);
+	return rc;
+}
+
+/**
+ * @brief
+ * 		main - the entry point in pbs_acctconv.c
+ *
+ * @param[in]	argc	-	argument count
+ * @param[in]	argv	-	argument variables.
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	1	: error
+ */
+int
+main(int argc, char *argv[])
+{
+	acctbin_rec rec;
+	char *names[MAX_FIELDS];
+	int nnames = 0;
+	char *outfile = NULL;
+	int to_binary = 0;
+	FILE *in;
+	FILE *out = stdout;
+	int rc = 0;
+	int ret;
+	int c;
+
+	/*the real deal or output pbs_version and exit?*/
+	execution_mode(argc, argv);
+
+	while ((c = getopt(argc, argv, "bf:o:-:")) != EOF) {
+		switch (c) {
+			case 'b':
+				to_binary = 1;
+				break;
+			case 'f':
+				names[nnames] = strtok(optarg, ",");
+				while ((names[nnames] != NULL) && (nnames < MAX_FIELDS - 1))
+					names[++nnames] = strtok(NULL, ",");
+				break;
+			case 'o':
+				outfile = optarg;
+				break;
+			default:
+				usage(argv[0]);
+				return 1;
+		}
+	}
+
+	if ((optind == argc) || (to_binary && nnames)) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (outfile != NULL) {
+		if ((out = fopen(outfile, to_binary ? "ab" : "w")) == NULL) {
+			perror(outfile);
+			return 1;
+		}
+	}
+
+	memset(&rec, 0, sizeof(rec));
+	for (; optind < argc; optind++) {
+		if ((in = fopen(argv[optind], to_binary ? "r" : "rb")) == NULL) {
+			perror(argv[optind]);
+			rc = 1;
+			continue;
+		}
+		if (to_binary) {
+			if (text_to_binary(in, out, argv[optind]) != 0)
+				rc = 1;
+		} else {
+			while ((ret = acctbin_read(in, &rec)) == 0) {
+				if (nnames > 0)
+					print_fields(out, &rec, names, nnames);
+				else
+					print_text(out, &rec);
+			}
+			if (ret == -1) {
+				fprintf(stderr, "%s: malformed record\n", argv[optind]);
+				rc = 1;
+			}
+		}
+		fclose(in);
+	}
+	acctbin_free(&rec);
+
+	if (fclose(out) != 0) {
+		perror(outfile ? outfile : "stdout");
+		rc = 1;
+	}
+	return rc;
+}
@@ -43,7 +43,13 @@
  * Functions included are:
  * 	get_cols()
  * 	main()
+ * 	parse_log_line()
  * 	parse_log()
+ * 	log_line_jobid()
+ * 	cmp_offset()
+ * 	add_offset()
+ * 	parse_log_indexed()
+ * 	build_log_index()
  * 	sort_by_date()
  * 	sort_by_message()
  * 	strip_path()
@@ -63,6 +69,9 @@
 #include <unistd.h>
 #include <ctype.h>
 #include <termios.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/param.h>
 #if defined(HAVE_SYS_IOCTL_H)
 #include <sys/ioctl.h>
 #endif
@@ -70,6 +79,7 @@
 #include "pbs_version.h"
 #include "pbs_ifl.h"
 #include "log.h"
+#include "libutil.h"
 #include "tracejob.h"
 
 
@@ -146,6 +156,7 @@ main(int argc, char *argv[])
 	struct stat sbuf;
 #endif /* localmod 022 */
 	int unknw_job = 0;
+	char build_index = 0;
 
 	/*the real deal or output pbs_version and exit?*/
 	execution_mode(argc, argv);
@@ -160,12 +171,16 @@ main(int argc, char *argv[])
 
 	pbs_loadconf(0);
 
-	while ((c = getopt(argc, argv, "zvamslw:p:n:f:c:-:")) != EOF) {
+	while ((c = getopt(argc, argv, "izvamslw:p:n:f:c:-:")) != EOF) {
 		switch (c) {
 			case 'v':
 				verbose = 1;
 				break;
 
+			case 'i':
+				build_index = 1;
+				break;
+
 			case 'a':
 				no_acct = 1;
 				break;
@@ -271,6 +286,9 @@ main(int argc, char *argv[])
 			"   -m : don't use mom log files\n"
 			"   -v : verbose mode - show more error messages\n");
 
+		printf("\n       %s -i logfile...\n", strip_path(argv[0]));
+		printf("   -i : write the job-ID index of each log file\n");
+
 		printf("\n       %s --version\n", strip_path(argv[0]));
 		printf("   --version : display PBSPro version only\n\n");
 
@@ -283,6 +301,12 @@ main(int argc, char *argv[])
 		return 1;
 	}
 
+	if (build_index) {
+		for (opt = optind; opt < argc; opt++)
+			error |= build_log_index(argv[opt]);
+		return (error ? 1 : 0);
+	}
+
 	if (wrap == -1)
 		wrap = get_cols();
 
@@ -317,7 +341,10 @@ main(int argc, char *argv[])
 					continue;
 				}
 
-				parse_log(fp, argv[opt], j);
+				if (parse_log_indexed(fp, filename, argv[opt], j) == -1) {
+					rewind(fp);
+					parse_log(fp, argv[opt], j);
+				}
 
 				fclose(fp);
 			}
@@ -363,6 +390,148 @@ main(int argc, char *argv[])
 	return 0;
 }
 
+/**
+ * @brief
+ *		parse_log_line - parse one log line and, if it belongs to the job,
+ *		    add it to the log_entry structures
+ *
+ * @param[in,out]	buf	-	the log line, it is modified by strtok
+ * @param[in]	job_buf	-	the name of the job
+ * @param[in]	ind	-	which log file - index in enum index
+ * @param[in]	lineno	-	position of the line in the file
+ *
+ * @return	nothing
+ * @note
+ *		modifies global variables: loglines, ll_cur_amm, ll_max_amm
+ *
+ * @par MT-safe: No
+ */
+static void
+parse_log_line(char *buf, char *job_buf, int ind, int lineno)
+{
+	struct log_entry tmp;	/* temporary log entry */
+	char *p;		/* pointer to use for strtok */
+	int field_count;	/* which field in log entry */
+	struct tm tms;	/* used to convert date to unix date */
+	int slen;
+	char *pdot;
+
+	tms.tm_isdst = -1;	/* mktime() will attempt to figure it out */
+
+	slen = strlen(buf);
+	if (slen > 0 && buf[slen-1] == '\n')
+		buf[slen-1] = '\0';
+	p = strtok(buf, ";");
+	field_count = 0;
+	memset(&tmp, 0, sizeof(struct log_entry));
+
+	for (field_count = 0; field_count < 6 && p != NULL; field_count++) {
+		switch (field_count) {
+			case FLD_DATE:
+				tmp.date = p;
+				if (ind == IND_ACCT)
+					field_count = 2;
+				break;
+
+			case FLD_EVENT:
+				tmp.event = p;
+				break;
+
+			case FLD_OBJ:
+				tmp.obj = p;
+				break;
+
+			case FLD_TYPE:
+				tmp.type = p;
+				break;
+
+			case FLD_NAME:
+				tmp.name = p;
+				break;
+
+			case FLD_MSG:
+				tmp.msg = p;
+				break;
+
+			default:
+				printf("Field count too big!\n");
+				printf("%s\n", p);
+		}
+
+		p = strtok(NULL, ";");
+	}
+
+	pdot = strchr(job_buf, (int)'.');
+	if (pdot == NULL && tmp.name != NULL) {
+		int	tlen = strlen(job_buf);
+
+		slen = strcspn(tmp.name, ".");
+		if (tlen > slen)
+			slen = tlen;
+	} else
+		slen = strlen(job_buf);
+
+	if (tmp.name != NULL && strncmp(job_buf, tmp.name, slen) == 0) {
+		if (ll_cur_amm >= ll_max_amm)
+			alloc_more_space();
+
+		free_log_entry(&log_lines[ll_cur_amm]);
+
+		if (tmp.date != NULL) {
+			log_lines[ll_cur_amm].date = strdup(tmp.date);
+			if (sscanf(tmp.date, "%d/%d/%d %d:%d:%d", &tms.tm_mon, &tms.tm_mday, &tms.tm_year, &tms.tm_hour, &tms.tm_min, &tms.tm_sec) != 6)
+				log_lines[ll_cur_amm].date_time = -1;	/* error in date field */
+			else {
+				if (tms.tm_year > 1900)
+					tms.tm_year -= 1900;
+				tms.tm_mon--;         /* The number of months since January, in the range 0 to 11 for mktime */
+				log_lines[ll_cur_amm].date_time = mktime(&tms);
+			}
+		}
+		if (tmp.event != NULL)
+			log_lines[ll_cur_amm].event = strdup(tmp.event);
+		else
+			log_lines[ll_cur_amm].event = none;
+		if (tmp.obj != NULL)
+			log_lines[ll_cur_amm].obj = strdup(tmp.obj);
+		else
+			log_lines[ll_cur_amm].obj = none;
+		if (tmp.type != NULL)
+			log_lines[ll_cur_amm].type = strdup(tmp.type);
+		else
+			log_lines[ll_cur_amm].type = none;
+		if (tmp.name != NULL)
+			log_lines[ll_cur_amm].name = strdup(tmp.name);
+		else
+			log_lines[ll_cur_amm].name = none;
+		if (tmp.msg != NULL)
+			log_lines[ll_cur_amm].msg = strdup(tmp.msg);
+		else
+			log_lines[ll_cur_amm].msg = none;
+		switch (ind) {
+			case IND_SERVER:
+				log_lines[ll_cur_amm].log_file = 'S';
+				break;
+
+			case IND_SCHED:
+				log_lines[ll_cur_amm].log_file = 'L';
+				break;
+
+			case IND_ACCT:
+				log_lines[ll_cur_amm].log_file = 'A';
+				break;
+
+			case IND_MOM:
+				log_lines[ll_cur_amm].log_file = 'M';
+				break;
+			default:
+				log_lines[ll_cur_amm].log_file = 'U';	/* undefined */
+		}
+		log_lines[ll_cur_amm].lineno = lineno;
+		ll_cur_amm++;
+	}
+}
+
 /**
  * @brief
  *		parse_log - parse out entires of a log file for a specific job
@@ -381,135 +550,329 @@ main(int argc, char *argv[])
 void
 parse_log(FILE *fp, char *job, int ind)
 {
-	struct log_entry tmp;	/* temporary log entry */
 	char buf[16384];	/* buffer to read in from file */
 	char job_buf[128];	/* hold the jobid and the . */
-	char *p;		/* pointer to use for strtok */
-	int field_count;	/* which field in log entry */
-	int j = 0;
-	struct tm tms;	/* used to convert date to unix date */
 	int lineno		= 0;
-	int slen;
-	char *pdot;
-
-	tms.tm_isdst = -1;	/* mktime() will attempt to figure it out */
 
 	strcpy(job_buf, job);
 
-	while (fgets(buf, 16384, fp) != NULL) {
-		lineno++;
-		j++;
-		buf[strlen(buf)-1] = '\0';
-		p = strtok(buf, ";");
-		field_count = 0;
-		memset(&tmp, 0, sizeof(struct log_entry));
-
-		for (field_count = 0; field_count < 6 && p != NULL; field_count++) {
-			switch (field_count) {
-				case FLD_DATE:
-					tmp.date = p;
-					if (ind == IND_ACCT)
-						field_count = 2;
-					break;
-
-				case FLD_EVENT:
-					tmp.event = p;
-					break;
-
-				case FLD_OBJ:
-					tmp.obj = p;
-					break;
-
-				case FLD_TYPE:
-					tmp.type = p;
-					break;
-
-				case FLD_NAME:
-					tmp.name = p;
-					break;
-
-				case FLD_MSG:
-					tmp.msg = p;
-					break;
-
-				default:
-					printf("Field count too big!\n");
-					printf("%s\n", p);
+	while (fgets(buf, 16384, fp) != NULL)
+		parse_log_line(buf, job_buf, ind, ++lineno);
+}
+
+/**
+ * @brief
+ *		log_line_jobid - copy the object name of a log or accounting line
+ *
+ * @par Functionality:
+ *		An accounting record has a one character record type as its
+ *		second field and the id as its third, any other log line has
+ *		the object name as its fifth field.
+ *
+ * @param[in]	line	-	the log line
+ * @param[out]	id	-	buffer for the object name
+ * @param[in]	idsz	-	size of id
+ *
+ * @return	int
+ * @retval	0	: name copied to id
+ * @retval	-1	: line is too short
+ */
+static int
+log_line_jobid(char *line, char *id, size_t idsz)
+{
+	char *p;
+	int field;
+	int want;
+	size_t len;
+
+	if ((p = strchr(line, ';')) == NULL)
+		return -1;
+	p++;
+	want = (p[0] != '\0' && p[1] == ';') ? 2 : FLD_NAME;
+	for (field = 1; field < want; field++) {
+		if ((p = strchr(p, ';')) == NULL)
+			return -1;
+		p++;
+	}
+	len = strcspn(p, ";\n");
+	if (len >= idsz)
+		len = idsz - 1;
+	strncpy(id, p, len);
+	id[len] = '\0';
+	return (*id == '\0') ? -1 : 0;
+}
+
+/**
+ * @brief
+ *		cmp_offset - qsort compare function for log file offsets
+ *
+ * @param[in]	v1	-	first offset
+ * @param[in]	v2	-	second offset
+ *
+ * @return	int
+ * @retval	-1, 0, 1	: v1 is less than, equal to or greater than v2
+ */
+static int
+cmp_offset(const void *v1, const void *v2)
+{
+	long long o1 = *(const long long *)v1;
+	long long o2 = *(const long long *)v2;
+
+	return (o1 < o2) ? -1 : ((o1 > o2) ? 1 : 0);
+}
+
+/**
+ * @brief
+ *		add_offset - append an offset to a growable array of offsets
+ *
+ * @param[in,out]	arr	-	the array
+ * @param[in,out]	num	-	number of entries used
+ * @param[in,out]	max	-	number of entries allocated
+ * @param[in]	off	-	the offset to append
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	-1	: out of memory
+ */
+static int
+add_offset(long long **arr, int *num, int *max, long long off)
+{
+	long long *tmp;
+
+	if (*num >= *max) {
+		tmp = realloc(*arr, (*max + DEFAULT_LOG_LINES) * sizeof(long long));
+		if (tmp == NULL)
+			return -1;
+		*arr = tmp;
+		*max += DEFAULT_LOG_LINES;
+	}
+	(*arr)[(*num)++] = off;
+	return 0;
+}
+
+/**
+ * @brief
+ *		parse_log_indexed - parse the entries of a log file for a specific
+ *		    job using the job-ID sidecar index written next to the log
+ *
+ * @par Functionality:
+ *		The index holds the offset of every line written while a daemon
+ *		had the log open with PBS_LOG_JOBINDEX set, framed by open and
+ *		close markers.  Only the lines whose id hashes like the job are
+ *		read, plus any stretch of the log not covered by the markers
+ *		(written before indexing was turned on, or while no indexing
+ *		daemon had the log open), which is scanned in full.  Every
+ *		indexed line is checked to start a line and to carry the job's
+ *		hash; if not, the index is stale and the caller must fall back
+ *		to parse_log().
+ *
+ * @param[in]	fp	-	the log file
+ * @param[in]	filename	-	path of the log file
+ * @param[in]	job	-	the name of the job
+ * @param[in]	ind	-	which log file - index in enum index
+ *
+ * @return	int
+ * @retval	0	: log parsed through the index
+ * @retval	-1	: no usable index, nothing added to log_lines
+ *
+ * @par MT-safe: No
+ */
+int
+parse_log_indexed(FILE *fp, char *filename, char *job, int ind)
+{
+	char buf[16384];
+	char job_buf[128];
+	char id[128];
+	char ixname[MAXPATHLEN + 1];
+	FILE *ixfp;
+	struct stat sb;
+	unsigned int want;
+	unsigned int hash;
+	long long off;
+	long long eof;
+	long long uncov = 0;	/* start of the stretch not covered by markers */
+	int covered = 0;
+	long long *offs = NULL;	/* indexed lines of the job */
+	int noffs = 0, maxoffs = 0;
+	long long *rng = NULL;	/* start/end pairs of stretches to scan */
+	int nrng = 0, maxrng = 0;
+	int save_amm = ll_cur_amm;
+	int lineno = 0;
+	int i, r, k;
+	int rc = -1;
+
+	if (!isdigit((int)*job))
+		return -1;
+	if (snprintf(ixname, sizeof(ixname), "%s%s", filename, JOBIX_SUFFIX) >= (int)sizeof(ixname))
+		return -1;
+	if ((ixfp = fopen(ixname, "rb")) == NULL)
+		return -1;
+	if (fstat(fileno(fp), &sb) == -1) {
+		fclose(ixfp);
+		return -1;
+	}
+	eof = (long long)sb.st_size;
+	want = jobix_hash(job);
+
+	while (jobix_read(ixfp, &hash, &off) == 0) {
+		if (off < 0 || off > eof)
+			goto done;	/* index does not describe this log */
+		if (hash == JOBIX_OPEN) {
+			if (!covered && off > uncov) {
+				if (add_offset(&rng, &nrng, &maxrng, uncov) ||
+					add_offset(&rng, &nrng, &maxrng, off))
+					goto done;
 			}
+			covered = 1;
+		} else if (hash == JOBIX_CLOSE) {
+			if (covered)
+				uncov = off;
+			covered = 0;
+		} else if (hash == want) {
+			if (add_offset(&offs, &noffs, &maxoffs, off))
+				goto done;
+		}
+	}
+	if (!covered && eof > uncov) {
+		if (add_offset(&rng, &nrng, &maxrng, uncov) ||
+			add_offset(&rng, &nrng, &maxrng, eof))
+			goto done;
+	}
 
-			p = strtok(NULL, ";");
+	/* merge the stretches to scan, then drop indexed lines inside them */
+	qsort(rng, nrng / 2, 2 * sizeof(long long), cmp_offset);
+	for (r = 0, k = 0; r < nrng; r += 2) {
+		if (k > 0 && rng[r] <= rng[k - 1]) {
+			if (rng[r + 1] > rng[k - 1])
+				rng[k - 1] = rng[r + 1];
+		} else {
+			rng[k++] = rng[r];
+			rng[k++] = rng[r + 1];
 		}
+	}
+	nrng = k;
+	qsort(offs, noffs, sizeof(long long), cmp_offset);
+	for (i = 0, k = 0, r = 0; i < noffs; i++) {
+		if (k > 0 && offs[i] == offs[k - 1])
+			continue;
+		while (r < nrng && rng[r + 1] <= offs[i])
+			r += 2;
+		if (r < nrng && offs[i] >= rng[r])
+			continue;
+		offs[k++] = offs[i];
+	}
+	noffs = k;
 
-		pdot = strchr(job_buf, (int)'.');
-		if (pdot == NULL && tmp.name != NULL) {
-			int	tlen = strlen(job_buf);
-
-			slen = strcspn(tmp.name, ".");
-			if (tlen > slen)
-				slen = tlen;
-		} else
-			slen = strlen(job_buf);
-
-		if (tmp.name != NULL && strncmp(job_buf, tmp.name, slen) == 0) {
-			if (ll_cur_amm >= ll_max_amm)
-				alloc_more_space();
-
-			free_log_entry(&log_lines[ll_cur_amm]);
-
-			if (tmp.date != NULL) {
-				log_lines[ll_cur_amm].date = strdup(tmp.date);
-				if (sscanf(tmp.date, "%d/%d/%d %d:%d:%d", &tms.tm_mon, &tms.tm_mday, &tms.tm_year, &tms.tm_hour, &tms.tm_min, &tms.tm_sec) != 6)
-					log_lines[ll_cur_amm].date_time = -1;	/* error in date field */
-				else {
-					if (tms.tm_year > 1900)
-						tms.tm_year -= 1900;
-					tms.tm_mon--;         /* The number of months since January, in the range 0 to 11 for mktime */
-					log_lines[ll_cur_amm].date_time = mktime(&tms);
-				}
-			}
-			if (tmp.event != NULL)
-				log_lines[ll_cur_amm].event = strdup(tmp.event);
-			else
-				log_lines[ll_cur_amm].event = none;
-			if (tmp.obj != NULL)
-				log_lines[ll_cur_amm].obj = strdup(tmp.obj);
-			else
-				log_lines[ll_cur_amm].obj = none;
-			if (tmp.type != NULL)
-				log_lines[ll_cur_amm].type = strdup(tmp.type);
-			else
-				log_lines[ll_cur_amm].type = none;
-			if (tmp.name != NULL)
-				log_lines[ll_cur_amm].name = strdup(tmp.name);
-			else
-				log_lines[ll_cur_amm].name = none;
-			if (tmp.msg != NULL)
-				log_lines[ll_cur_amm].msg = strdup(tmp.msg);
-			else
-				log_lines[ll_cur_amm].msg = none;
-			switch (ind) {
-				case IND_SERVER:
-					log_lines[ll_cur_amm].log_file = 'S';
-					break;
-
-				case IND_SCHED:
-					log_lines[ll_cur_amm].log_file = 'L';
-					break;
-
-				case IND_ACCT:
-					log_lines[ll_cur_amm].log_file = 'A';
-					break;
-
-				case IND_MOM:
-					log_lines[ll_cur_amm].log_file = 'M';
-					break;
-				default:
-					log_lines[ll_cur_amm].log_file = 'U';	/* undefined */
+	strcpy(job_buf, job);
+	for (i = 0, r = 0; i < noffs || r < nrng; ) {
+		if (r < nrng && (i >= noffs || rng[r] < offs[i])) {
+			/* scan a stretch not covered by the index */
+			if (fseeko(fp, (off_t)rng[r], SEEK_SET) == -1)
+				goto fallback;
+			if (rng[r] > 0) {
+				if (fseeko(fp, (off_t)(rng[r] - 1), SEEK_SET) == -1 ||
+					getc(fp) != '\n')
+					goto fallback;
 			}
-			log_lines[ll_cur_amm].lineno = lineno;
-			ll_cur_amm++;
+			while ((long long)ftello(fp) < rng[r + 1] &&
+				fgets(buf, sizeof(buf), fp) != NULL)
+				parse_log_line(buf, job_buf, ind, ++lineno);
+			r += 2;
+		} else {
+			off = offs[i++];
+			if (off > 0) {
+				if (fseeko(fp, (off_t)(off - 1), SEEK_SET) == -1 ||
+					getc(fp) != '\n')
+					goto fallback;
+			} else if (fseeko(fp, (off_t)0, SEEK_SET) == -1)
+				goto fallback;
+			if (fgets(buf, sizeof(buf), fp) == NULL ||
+				log_line_jobid(buf, id, sizeof(id)) == -1 ||
+				jobix_hash(id) != want)
+				goto fallback;
+			parse_log_line(buf, job_buf, ind, ++lineno);
 		}
 	}
+	rc = 0;
+	goto done;
+
+fallback:
+	ll_cur_amm = save_amm;	/* entries past here are freed on reuse */
+	rc = -1;
+done:
+	fclose(ixfp);
+	free(offs);
+	free(rng);
+	return rc;
+}
+
+/**
+ * @brief
+ *		build_log_index - write the job-ID sidecar index for an existing log
+ *
+ * @par Functionality:
+ *		Used for logs written before PBS_LOG_JOBINDEX was turned on.  The
+ *		index is written to a temporary file and renamed into place so a
+ *		concurrent tracejob never sees a partial one.
+ *
+ * @param[in]	filename	-	path of the log file
+ *
+ * @return	int
+ * @retval	0	: index written
+ * @retval	1	: failure, reported on stderr
+ */
+int
+build_log_index(char *filename)
+{
+	char buf[16384];
+	char id[128];
+	char ixname[MAXPATHLEN + 1];
+	char tmpname[MAXPATHLEN + 1];
+	FILE *fp;
+	FILE *ixfp;
+	long long off = 0;
+	int atstart = 1;
+	size_t len;
+	int err = 0;
+
+	if (snprintf(ixname, sizeof(ixname), "%s%s", filename, JOBIX_SUFFIX) >= (int)sizeof(ixname) ||
+		snprintf(tmpname, sizeof(tmpname), "%s.tmp", ixname) >= (int)sizeof(tmpname)) {
+		fprintf(stderr, "tracejob: %s: path too long\n", filename);
+		return 1;
+	}
+	if ((fp = fopen(filename, "r")) == NULL) {
+		perror(filename);
+		return 1;
+	}
+	if ((ixfp = fopen(tmpname, "wb")) == NULL) {
+		perror(tmpname);
+		fclose(fp);
+		return 1;
+	}
+
+	err |= jobix_write(ixfp, JOBIX_OPEN, 0);
+	while (fgets(buf, sizeof(buf), fp) != NULL) {
+		if (atstart && log_line_jobid(buf, id, sizeof(id)) == 0 &&
+			isdigit((int)*id))
+			err |= jobix_write(ixfp, jobix_hash(id), off);
+		len = strlen(buf);
+		atstart = (len > 0 && buf[len - 1] == '\n');
+		off += len;
+	}
+	err |= jobix_write(ixfp, JOBIX_CLOSE, off);
+	fclose(fp);
+
+	if (fclose(ixfp) != 0 || err) {
+		fprintf(stderr, "tracejob: %s: write failed\n", tmpname);
+		unlink(tmpname);
+		return 1;
+	}
+	if (rename(tmpname, ixname) == -1) {
+		perror(ixname);
+		unlink(tmpname);
+		return 1;
+	}
+	return 0;
 }
 
 /**
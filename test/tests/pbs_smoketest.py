@@ -52,6 +52,46 @@ class SmokeTest(PBSTestSuite):
     resc_name = "ptl_custom_res"
     avail_resc_name = 'resources_available.' + resc_name
     pu = ProcUtils()
+    # client that prints "seq epoch lost" and then one line per change
+    # returned by pbs_statevents(), "name attr=value ..."
+    statev_src = """
+#include <stdio.h>
+#include <stdlib.h>
+#include <pbs_error.h>
+#include <pbs_ifl.h>
+
+int
+main(int argc, char *argv[])
+{
+    long long seq, epoch, lost;
+    struct batch_status *bs, *p;
+    struct attrl *a;
+    int c;
+
+    if (argc != 4)
+        return 2;
+    seq = atoll(argv[1]);
+    epoch = atoll(argv[2]);
+    if ((c = pbs_connect(NULL)) < 0)
+        return 1;
+    bs = pbs_statevents(c, &seq, &epoch, atoi(argv[3]), &lost, NULL);
+    if (bs == NULL && pbs_errno != 0) {
+        fprintf(stderr, "pbs_statevents: %d\\n", pbs_errno);
+        return 1;
+    }
+    printf("%lld %lld %lld\\n", seq, epoch, lost);
+    for (p = bs; p != NULL; p = p->next) {
+        printf("%s", p->name);
+        for (a = p->attribs; a != NULL; a = a->next)
+            printf(" %s=%s", a->name, a->value);
+        printf("\\n");
+    }
+    pbs_statfree(bs);
+    pbs_disconnect(c);
+    return 0;
+}
+"""
+    statev_bin = None
 
     def test_submit_job(self):
         """
@@ -1258,3 +1298,248 @@ class SmokeTest(PBSTestSuite):
                         self.delete_resource_helper(
                             self.resc_name, t, f, c, k, v)
                         self.logger.info("")
+
+    def statevents(self, seq=0, epoch=0, wait=0):
+        """
+        Read the server's state change journal through pbs_statevents()
+        from sequence number seq of epoch on.  The client is built the
+        first time with the headers and libpbs.a of PBS_EXEC.
+
+        Return the next sequence number, the epoch, the number of changes
+        lost and a list of (name, attribute dictionary), one per change
+        """
+        if self.statev_bin is None:
+            gcc = self.du.which(self.server.hostname, exe='gcc')
+            if not os.path.isabs(gcc):
+                self.skipTest('gcc is needed to build a pbs_statevents client')
+            pbs_exec = self.server.pbs_conf['PBS_EXEC']
+            (fd, src) = self.du.mkstemp(suffix='.c', body=self.statev_src)
+            os.close(fd)
+            self.statev_bin = src[:-2]
+            cmd = [gcc, '-I' + os.path.join(pbs_exec, 'include'), src,
+                   os.path.join(pbs_exec, 'lib', 'libpbs.a'), '-lcrypto',
+                   '-lpthread', '-o', self.statev_bin]
+            ret = self.du.run_cmd(self.server.hostname, cmd)
+            os.remove(src)
+            self.assertEqual(ret['rc'], 0)
+        cmd = [self.statev_bin, str(seq), str(epoch), str(wait)]
+        ret = self.du.run_cmd(self.server.hostname, cmd, sudo=True)
+        self.assertEqual(ret['rc'], 0)
+        (seq, epoch, lost) = [int(v) for v in ret['out'][0].split()]
+        changes = []
+        for line in ret['out'][1:]:
+            if not line:
+                continue
+            f = line.split()
+            changes.append((f[0], dict(a.split('=', 1) for a in f[1:])))
+        return (seq, epoch, lost, changes)
+
+    def statevents_drain(self):
+        """
+        Read the state change journal up to its end, return the sequence
+        number and epoch to follow on from
+        """
+        (seq, epoch, lost, changes) = self.statevents()
+        while changes:
+            (seq, epoch, lost, changes) = self.statevents(seq, epoch)
+        return (seq, epoch)
+
+    def test_statevents_follow(self):
+        """
+        Follow the state change journal with pbs_statevents() while a job
+        runs and is deleted and a vnode is offlined, and check that every
+        change comes back in order with nothing lost
+        """
+        j = Job(TEST_USER)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        (seq, epoch) = self.statevents_drain()
+        self.assertNotEqual(epoch, 0)
+
+        self.server.manager(MGR_CMD_SET, NODE, {'state': 'offline'},
+                            self.mom.shortname)
+        self.server.delete(jid)
+        seen = []
+        while ('node', 'offline') not in seen or \
+                ('job', 'purged') not in seen:
+            (nseq, nepoch, lost, changes) = self.statevents(seq, epoch, 30)
+            self.assertNotEqual(changes, [])
+            self.assertEqual(lost, 0)
+            self.assertEqual(nepoch, epoch)
+            for (name, attrs) in changes:
+                self.assertEqual(int(attrs['event_seq']), seq)
+                seq += 1
+                if attrs['event_type'] == 'node' and \
+                        name == self.mom.shortname and \
+                        'offline' in attrs['new_state'].split(','):
+                    seen.append(('node', 'offline'))
+                elif attrs['event_type'] == 'job' and name == jid and \
+                        attrs['new_state'] == 'purged':
+                    seen.append(('job', 'purged'))
+            self.assertEqual(nseq, seq)
+
+    @timeout(1200)
+    def test_statevents_wrap(self):
+        """
+        Make more state changes than the journal keeps and check that a
+        client which fell behind is told how many changes it lost
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        (seq, epoch) = self.statevents_drain()
+        jids = []
+        for i in range(500):
+            jids.append(self.server.submit(Job(TEST_USER)))
+        # each round is two changes of every job, past the 8192 kept
+        for i in range(9):
+            self.server.holdjob(jids)
+            self.server.rlsjob(jids, USER_HOLD)
+        self.server.expect(JOB, {'job_state=Q': 500}, count=True)
+
+        (nseq, nepoch, lost, changes) = self.statevents(seq, epoch)
+        self.assertEqual(nepoch, epoch)
+        self.assertTrue(lost > 0)
+        self.assertEqual(int(changes[0][1]['event_seq']), seq + lost)
+        rv = self.server.log_match('fell behind the state journal')
+        self.assertTrue(rv)
+
+    def test_statevents_restart(self):
+        """
+        Restart the server and check that a client following the state
+        change journal is told its changes were lost
+        """
+        j = Job(TEST_USER)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+        (seq, epoch) = self.statevents_drain()
+        self.assertNotEqual(epoch, 0)
+        # the epoch is the server start time, in seconds
+        time.sleep(1)
+        self.server.restart()
+        self.server.manager(MGR_CMD_SET, NODE, {'state': 'offline'},
+                            self.mom.shortname)
+
+        (nseq, nepoch, lost, changes) = self.statevents(seq, epoch, 30)
+        self.assertNotEqual(changes, [])
+        self.assertNotEqual(nepoch, epoch)
+        self.assertEqual(lost, -1)
+        rv = self.server.log_match('the journal restarted')
+        self.assertTrue(rv)
+
+    def test_tracejob_index(self):
+        """
+        Index the server log with tracejob -i and check that tracejob
+        reports the same lines for a job as it does without the index
+        """
+        a = {'job_history_enable': 'True'}
+        self.server.manager(MGR_CMD_SET, SERVER, a, expect=True)
+        j = Job(TEST_USER)
+        j.set_sleep_time(1)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'F'}, extend='x', offset=1,
+                           interval=1, id=jid)
+
+        tracejob = os.path.join(self.server.pbs_conf['PBS_EXEC'], 'bin',
+                                'tracejob')
+        log = os.path.join(self.server.pbs_conf['PBS_HOME'], 'server_logs',
+                           time.strftime('%Y%m%d'))
+        self.du.rm(self.server.hostname, log + '.jix', force=True, sudo=True)
+        cmd = [tracejob, '-l', '-m', '-a', jid]
+        before = self.du.run_cmd(self.server.hostname, cmd, sudo=True)
+        self.assertEqual(before['rc'], 0)
+
+        ret = self.du.run_cmd(self.server.hostname, [tracejob, '-i', log],
+                              sudo=True)
+        self.assertEqual(ret['rc'], 0)
+        self.assertTrue(self.du.isfile(self.server.hostname,
+                                       path=log + '.jix', sudo=True))
+        after = self.du.run_cmd(self.server.hostname, cmd, sudo=True)
+        self.assertEqual(after['rc'], 0)
+        self.assertEqual(before['out'], after['out'])
+
+    def test_acctconv_round_trip(self):
+        """
+        Convert the accounting file to binary with pbs_acctconv -b and
+        back to text, and check the text comes back unchanged
+        """
+        a = {'job_history_enable': 'True'}
+        self.server.manager(MGR_CMD_SET, SERVER, a, expect=True)
+        j = Job(TEST_USER)
+        j.set_sleep_time(1)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'F'}, extend='x', offset=1,
+                           interval=1, id=jid)
+        rv = self.server.accounting_match(';E;' + jid + ';', max_attempts=10)
+        self.assertTrue(rv)
+
+        conv = os.path.join(self.server.pbs_conf['PBS_EXEC'], 'bin',
+                            'pbs_acctconv')
+        acct = os.path.join(self.server.pbs_conf['PBS_HOME'], 'server_priv',
+                            'accounting', time.strftime('%Y%m%d'))
+        (fd, binf) = self.du.mkstemp(suffix='.bin')
+        os.close(fd)
+        ret = self.du.run_cmd(self.server.hostname,
+                              [conv, '-b', '-o', binf, acct], sudo=True)
+        self.assertEqual(ret['rc'], 0)
+        text = self.du.run_cmd(self.server.hostname, [conv, binf], sudo=True)
+        self.assertEqual(text['rc'], 0)
+        fields = self.du.run_cmd(self.server.hostname,
+                                 [conv, '-f', 'type,id', binf], sudo=True)
+        self.assertEqual(fields['rc'], 0)
+        orig = self.du.cat(self.server.hostname, acct, sudo=True)
+        self.du.rm(self.server.hostname, binf, force=True, sudo=True)
+
+        # the server may have added records since the conversion
+        self.assertTrue(len(text['out']) > 0)
+        self.assertEqual(text['out'], orig['out'][:len(text['out'])])
+        self.assertIn('E\t' + jid, fields['out'])
+
+    def test_select_state_owner(self):
+        """
+        Select jobs by state, by owner and by both, before and after a
+        state change, and check the jobs come back in submission order
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = []
+        for user in [TEST_USER, TEST_USER1, TEST_USER, TEST_USER1]:
+            jids.append(self.server.submit(Job(user)))
+        self.server.holdjob([jids[1], jids[2]])
+        self.server.expect(JOB, {'job_state=H': 2}, count=True)
+
+        jobs = self.server.select({'job_state': 'H'})
+        self.assertEqual(jobs, [jids[1], jids[2]])
+        jobs = self.server.select({ATTR_u: str(TEST_USER1)})
+        self.assertEqual(jobs, [jids[1], jids[3]])
+        jobs = self.server.select({'job_state': 'Q', ATTR_u: str(TEST_USER)})
+        self.assertEqual(jobs, [jids[0]])
+
+        self.server.rlsjob(jids[1], USER_HOLD)
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jids[1])
+        jobs = self.server.select({'job_state': 'H'})
+        self.assertEqual(jobs, [jids[2]])
+        jobs = self.server.select({'job_state': 'Q', ATTR_u: str(TEST_USER1)})
+        self.assertEqual(jobs, [jids[1], jids[3]])
+
+    def test_vnode_update_deltas(self):
+        """
+        With $vnode_update_deltas set, change the vnode definitions of a
+        MoM and check the server picks up the changed values from the
+        delta, without asking for a full update
+        """
+        self.mom.add_config({'$vnode_update_deltas': 'True'})
+        a = {'resources_available.ncpus': 2}
+        self.server.create_vnodes('vn', a, num=2, mom=self.mom)
+
+        vdef = self.mom.create_vnode_def('vn',
+                                         {'resources_available.ncpus': 4},
+                                         numnodes=2)
+        self.mom.insert_vnode_def(vdef, restart=False)
+        self.mom.signal('-HUP')
+        a = {'resources_available.ncpus=4': 2, 'state=free': 2}
+        self.server.expect(VNODE, a, attrop=PTL_AND)
+        rv = self.server.log_match('requesting full update', n='ALL',
+                                   starttime=self.server.ctime)
+        self.assertEqual(rv, None)
+
+        # the values hold over a server restart, which resends the full list
+        self.server.restart()
+        self.server.expect(VNODE, a, attrop=PTL_AND)